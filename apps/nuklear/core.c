@@ -771,6 +771,7 @@ static void dg_nuklear_default_room_type_slot(dg_nuklear_room_type_ui_t *slot, i
     dg_default_map_edge_opening_query(&slot->template_opening_query);
     slot->template_required_opening_matches = 0;
     slot->prefer_template_entrance_room = 0;
+    slot->template_variant_step = 0;
     slot->area_min = 0;
     slot->area_max = -1;
     slot->degree_min = 0;
@@ -926,6 +927,10 @@ static void dg_nuklear_sanitize_room_type_slot(dg_nuklear_room_type_ui_t *slot)
     slot->template_required_opening_matches =
         dg_nuklear_clamp_int(slot->template_required_opening_matches, 0, INT_MAX);
     slot->prefer_template_entrance_room = slot->prefer_template_entrance_room ? 1 : 0;
+    slot->template_variant_step = dg_nuklear_clamp_int(slot->template_variant_step, 0, INT_MAX);
+    if (slot->template_variant_step > 0) {
+        slot->template_required_opening_matches = 0;
+    }
 
     slot->template_opening_query.side_mask &= DG_MAP_EDGE_MASK_ALL;
     slot->template_opening_query.role_mask &= DG_MAP_EDGE_OPENING_ROLE_MASK_ANY;
@@ -1618,6 +1623,7 @@ static void dg_nuklear_apply_room_type_slot_snapshot(
     slot->template_opening_query = definition->template_opening_query;
     slot->template_required_opening_matches = definition->template_required_opening_matches;
     slot->prefer_template_entrance_room = definition->prefer_template_entrance_room;
+    slot->template_variant_step = definition->template_variant_step;
     slot->area_min = definition->constraints.area_min;
     slot->area_max = definition->constraints.area_max;
     slot->degree_min = definition->constraints.degree_min;
@@ -1954,6 +1960,7 @@ static uint64_t dg_nuklear_compute_live_config_hash(const dg_nuklear_app_t *app)
                 hash = dg_nuklear_hash_i32(hash, slot->template_opening_query.require_component);
                 hash = dg_nuklear_hash_i32(hash, slot->template_required_opening_matches);
                 hash = dg_nuklear_hash_i32(hash, slot->prefer_template_entrance_room);
+                hash = dg_nuklear_hash_i32(hash, slot->template_variant_step);
                 hash = dg_nuklear_hash_i32(hash, slot->area_min);
                 hash = dg_nuklear_hash_i32(hash, slot->area_max);
                 hash = dg_nuklear_hash_i32(hash, slot->degree_min);
@@ -2072,6 +2079,7 @@ static void dg_nuklear_generate_map(dg_nuklear_app_t *app)
                 definition->template_opening_query = slot->template_opening_query;
                 definition->template_required_opening_matches = slot->template_required_opening_matches;
                 definition->prefer_template_entrance_room = slot->prefer_template_entrance_room;
+                definition->template_variant_step = slot->template_variant_step;
                 definition->constraints.area_min = slot->area_min;
                 definition->constraints.area_max = slot->area_max;
                 definition->constraints.degree_min = slot->degree_min;
@@ -3056,6 +3064,17 @@ static void dg_nuklear_draw_metadata(struct nk_context *ctx, const dg_nuklear_ap
         );
         nk_label(ctx, line, NK_TEXT_LEFT);
 
+        if (app->map.metadata.diagnostics.room_type_min_shortfall > 0) {
+            (void)snprintf(
+                line,
+                sizeof(line),
+                "type minimums infeasible: type %u short, %llu room(s) missing",
+                (unsigned)app->map.metadata.diagnostics.room_type_short_type_id,
+                (unsigned long long)app->map.metadata.diagnostics.room_type_min_shortfall
+            );
+            nk_label(ctx, line, NK_TEXT_LEFT);
+        }
+
         for (i = 0; i < app->map.metadata.diagnostics.room_type_count; ++i) {
             const dg_room_type_quota_diagnostics_t *quota =
                 &app->map.metadata.diagnostics.room_type_quotas[i];
@@ -4201,6 +4220,16 @@ static void dg_nuklear_draw_room_type_slot(
             "Prefer For Template Entrance Patches",
             slot->prefer_template_entrance_room
         );
+        nk_layout_row_dynamic(ctx, 24.0f, 1);
+        nk_property_int(
+            ctx,
+            "Variant Step (0 = per room)",
+            0,
+            &slot->template_variant_step,
+            INT_MAX,
+            1,
+            0.25f
+        );
 
         nk_layout_row_dynamic(ctx, 19.0f, 1);
         nk_label(ctx, "Opening Side Mask (none = any)", NK_TEXT_LEFT);
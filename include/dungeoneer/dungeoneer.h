@@ -4,6 +4,7 @@
 #include "dungeoneer/generator.h"
 #include "dungeoneer/io.h"
 #include "dungeoneer/map.h"
+#include "dungeoneer/metadata_binary.h"
 #include "dungeoneer/rng.h"
 #include "dungeoneer/types.h"
 
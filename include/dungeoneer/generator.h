@@ -298,6 +298,14 @@ typedef struct dg_room_type_definition {
      * for entrance-patch handling (room-like template entrance rooms).
      */
     int prefer_template_entrance_room;
+    /*
+     * When > 0, rooms of this type stamp a shared size variant of the
+     * template, generated at the room size rounded to the nearest multiple
+     * of this step and resampled to the room, instead of running one nested
+     * generation per room. 0 disables variants. Cannot be combined with
+     * template_required_opening_matches.
+     */
+    int template_variant_step;
     dg_room_type_constraints_t constraints;
     dg_room_type_preferences_t preferences;
 } dg_room_type_definition_t;
@@ -15,10 +15,223 @@ dg_status_t dg_map_save_file(const dg_map_t *map, const char *path);
 
 /*
  * Loads generation configuration and regenerates the map on demand.
+ * Baked files are detected and loaded as-is without regeneration.
  * `out_map` must be zero-initialized or previously destroyed.
  */
 dg_status_t dg_map_load_file(const char *path, dg_map_t *out_map);
 
+/*
+ * Serializes the generation configuration into a caller buffer, in the same
+ * format as dg_map_save_file. `out_size` always receives the full size; when
+ * it exceeds `buffer_capacity`, DG_STATUS_BUFFER_TOO_SMALL is returned and
+ * the buffer contents are unspecified. Pass a NULL buffer to measure.
+ */
+dg_status_t dg_map_save_config_to_buffer(
+    const dg_map_t *map,
+    void *buffer,
+    size_t buffer_capacity,
+    size_t *out_size
+);
+
+/*
+ * Serializes the generation configuration into a library-allocated buffer.
+ * Release it with dg_buffer_free.
+ */
+dg_status_t dg_map_save_config_to_allocated_buffer(
+    const dg_map_t *map,
+    void **out_buffer,
+    size_t *out_size
+);
+
+void dg_buffer_free(void *buffer);
+
+/*
+ * Loads a serialized generation configuration and regenerates the map.
+ * `out_map` must be zero-initialized or previously destroyed.
+ */
+dg_status_t dg_map_load_config_from_buffer(const void *data, size_t size, dg_map_t *out_map);
+
+/*
+ * Writes a fully generated map to disk: packed tiles, rooms, corridors,
+ * entrances, edge openings, room adjacency, diagnostics, and the generation
+ * request snapshot, guarded by a format version and payload checksum.
+ */
+dg_status_t dg_map_save_baked_file(const dg_map_t *map, const char *path);
+
+typedef enum dg_baked_layout {
+    /* Little-endian records, readable on any platform. */
+    DG_BAKED_LAYOUT_PORTABLE = 0,
+    /*
+     * Raw in-memory arrays for tiles and metadata lists, so dg_map_view_open
+     * can use them in place. Only readable by builds with the same byte order
+     * and struct layout.
+     */
+    DG_BAKED_LAYOUT_NATIVE = 1
+} dg_baked_layout_t;
+
+/* How the portable layout stores tiles; native files always keep raw tiles. */
+typedef enum dg_baked_tile_encoding {
+    /* Row run-length tokens, as produced by dg_map_encode_tiles. */
+    DG_BAKED_TILES_RLE = 0,
+    /* 2 bits per tile with no run coding. */
+    DG_BAKED_TILES_PACKED = 1
+} dg_baked_tile_encoding_t;
+
+typedef struct dg_baked_save_options {
+    dg_baked_layout_t layout;
+    dg_baked_tile_encoding_t tile_encoding;
+} dg_baked_save_options_t;
+
+void dg_default_baked_save_options(dg_baked_save_options_t *options);
+
+dg_status_t dg_map_save_baked_file_with_options(
+    const dg_map_t *map,
+    const char *path,
+    const dg_baked_save_options_t *options
+);
+
+/*
+ * Loads a map written by dg_map_save_baked_file without running the generator.
+ * `out_map` must be zero-initialized or previously destroyed.
+ */
+dg_status_t dg_map_load_baked_file(const char *path, dg_map_t *out_map);
+
+/*
+ * Compresses the tile grid alone with the run-length codec used by baked
+ * files: each row is split into runs of one tile and 2-bit packed literals.
+ * Release the buffer with dg_buffer_free.
+ */
+dg_status_t dg_map_encode_tiles(const dg_map_t *map, void **out_data, size_t *out_size);
+
+/*
+ * Decodes dg_map_encode_tiles output into a map with tiles and no metadata.
+ * `out_map` must be zero-initialized or previously destroyed.
+ */
+dg_status_t dg_map_decode_tiles(const void *data, size_t size, dg_map_t *out_map);
+
+/*
+ * Room template cache. dg_generate loads `template_map_path` files through a
+ * process-wide cache keyed by path and a hash of the file bytes, so each
+ * template is parsed (and, for config files, regenerated) once per process
+ * and reloaded only when its contents change. All functions are thread-safe
+ * in builds with pthreads or on Windows; other builds must not use the cache,
+ * or call dg_generate with templates, from more than one thread at a time.
+ */
+typedef struct dg_template_cache_stats {
+    size_t entry_count;
+    size_t hit_count;
+    size_t miss_count;
+    size_t pack_count;
+    size_t variant_count;
+} dg_template_cache_stats_t;
+
+/* Loads `path` into the cache ahead of the first generation that uses it. */
+dg_status_t dg_template_cache_preload(const char *path);
+
+/*
+ * Drops the cached entry for `path`, or every entry (and the hit/miss
+ * counters) when `path` is NULL. Generations already using an entry keep it
+ * until they finish.
+ */
+void dg_template_cache_invalidate(const char *path);
+
+void dg_template_cache_get_stats(dg_template_cache_stats_t *out_stats);
+
+/*
+ * Size variants serve room types with a `template_variant_step`: each room
+ * stamps the template block generated at its bucket size (width and height
+ * rounded to the nearest multiple of the step), resampled to the room, and
+ * only re-runs the entrance connectivity pass. A variant depends on nothing
+ * but the template and its bucket, so the output is the same whether or not
+ * it was cached; dg_generate generates and caches missing buckets itself.
+ *
+ * Preparing a template generates, ahead of generation, every (width, height)
+ * bucket pair that rooms sized `min_size`..`max_size` reach with `step`, so
+ * `step` should match the room type's. Buckets already cached are kept and
+ * the rest added, at most 64 bucket sizes per call. Variants live on the
+ * cache entry until it is invalidated or its file changes. An entry holds at
+ * most 4096 variants; buckets past that are skipped and still return
+ * DG_STATUS_OK, and rooms in them get their variant generated on every
+ * dg_generate call. Rooms-and-mazes templates are rejected with
+ * DG_STATUS_INVALID_ARGUMENT, here and when a room type with a variant step
+ * uses one.
+ */
+typedef struct dg_template_variant_options {
+    int min_size;
+    int max_size;
+    int step;
+} dg_template_variant_options_t;
+
+void dg_default_template_variant_options(dg_template_variant_options_t *options);
+
+dg_status_t dg_template_cache_prepare_variants(
+    const char *path,
+    const dg_template_variant_options_t *options
+);
+
+/*
+ * Template packs bundle many template files behind one name-sorted index, so
+ * a library of templates is read and indexed with a single file load. A room
+ * type refers to a member with `template_map_path` set to "<pack path>#<name>".
+ * The pack is read on the first such use and kept until
+ * dg_template_cache_invalidate(pack path) or (NULL); unlike plain template
+ * files it is not re-read to notice edits.
+ *
+ * Members are stored as config files, regenerated when first used, or with
+ * `baked` set as baked maps, which load without running the generator. Names
+ * must be unique, non-empty, shorter than DG_ROOM_TEMPLATE_PATH_MAX and free
+ * of '#'.
+ */
+typedef struct dg_template_pack_member {
+    const char *name;
+    const dg_map_t *map;
+    int baked;
+} dg_template_pack_member_t;
+
+dg_status_t dg_template_pack_save_file(
+    const dg_template_pack_member_t *members,
+    size_t member_count,
+    const char *path
+);
+
+/* Same bytes as dg_template_pack_save_file; release with dg_buffer_free. */
+dg_status_t dg_template_pack_save_to_allocated_buffer(
+    const dg_template_pack_member_t *members,
+    size_t member_count,
+    void **out_data,
+    size_t *out_size
+);
+
+/*
+ * Read-only map backed by a memory-mapped baked file.
+ * For native-layout files, `map.tiles` and the metadata arrays point into the
+ * mapping and pages are only read when touched. Portable files are decoded
+ * into owned memory instead. Never modify or destroy `map` directly, and keep
+ * the file unchanged while the view is open.
+ */
+typedef struct dg_map_view {
+    dg_map_t map;
+
+    /* Internal; managed by dg_map_view_open/dg_map_view_close. */
+    void *mapping;
+    size_t mapping_size;
+    void *mapping_handle;
+    bool owns_map;
+} dg_map_view_t;
+
+/*
+ * Maps a baked file without copying it. Structure and bounds are validated,
+ * including the room and corridor ids metadata records refer to, but the
+ * payload checksum is not; call dg_map_view_verify to check it.
+ * `out_view` must be zero-initialized or previously closed.
+ */
+dg_status_t dg_map_view_open(const char *path, dg_map_view_t *out_view);
+
+/* Checks the payload checksum and tile values of an open view. */
+dg_status_t dg_map_view_verify(const dg_map_view_t *view);
+
+void dg_map_view_close(dg_map_view_t *view);
+
 /*
  * Exports the current map to a colorized PNG plus a JSON sidecar.
  * JSON includes a tile legend and useful map metadata.
@@ -29,6 +242,72 @@ dg_status_t dg_map_export_png_json(
     const char *json_path
 );
 
+typedef enum dg_png_color_mode {
+    DG_PNG_COLOR_MODE_RGBA = 0,
+    /*
+     * 8-bit palette built from the tile legend and room-type colors.
+     * Maps with more room types than fit in 256 entries are written as RGBA.
+     */
+    DG_PNG_COLOR_MODE_INDEXED = 1
+} dg_png_color_mode_t;
+
+/* zlib strategy for the PNG stream; AUTO keeps libpng's own choice. */
+typedef enum dg_png_compression_strategy {
+    DG_PNG_COMPRESSION_STRATEGY_AUTO = 0,
+    DG_PNG_COMPRESSION_STRATEGY_STANDARD = 1,
+    DG_PNG_COMPRESSION_STRATEGY_FILTERED = 2,
+    DG_PNG_COMPRESSION_STRATEGY_HUFFMAN_ONLY = 3,
+    DG_PNG_COMPRESSION_STRATEGY_RLE = 4,
+    DG_PNG_COMPRESSION_STRATEGY_FIXED = 5
+} dg_png_compression_strategy_t;
+
+/* Lets zlib pick its default level. */
+#define DG_PNG_COMPRESSION_LEVEL_DEFAULT (-1)
+
+/* JSON arrays that can be left out of summary exports; counts stay in "metadata". */
+#define DG_EXPORT_JSON_OMIT_ROOMS ((uint32_t)(1u << 0))
+#define DG_EXPORT_JSON_OMIT_CORRIDORS ((uint32_t)(1u << 1))
+#define DG_EXPORT_JSON_OMIT_ROOM_ENTRANCES ((uint32_t)(1u << 2))
+#define DG_EXPORT_JSON_OMIT_EDGE_OPENINGS ((uint32_t)(1u << 3))
+#define DG_EXPORT_JSON_OMIT_LARGE_ARRAYS                                        \
+    (DG_EXPORT_JSON_OMIT_ROOMS | DG_EXPORT_JSON_OMIT_CORRIDORS |                \
+     DG_EXPORT_JSON_OMIT_ROOM_ENTRANCES | DG_EXPORT_JSON_OMIT_EDGE_OPENINGS)
+
+typedef struct dg_export_options {
+    dg_png_color_mode_t png_color_mode;
+    int png_compression_level; /* DG_PNG_COMPRESSION_LEVEL_DEFAULT or 0..9 */
+    dg_png_compression_strategy_t png_compression_strategy;
+    int png_pixels_per_tile; /* >= 1; each tile becomes an N x N pixel block */
+    int json_compact; /* 1 drops all optional whitespace from the JSON */
+    uint32_t json_omit_mask; /* Bitmask of DG_EXPORT_JSON_OMIT_* values. */
+} dg_export_options_t;
+
+void dg_default_export_options(dg_export_options_t *options);
+
+dg_status_t dg_map_export_png_json_with_options(
+    const dg_map_t *map,
+    const char *png_path,
+    const char *json_path,
+    const dg_export_options_t *options
+);
+
+/*
+ * Produces the same PNG and JSON as dg_map_export_png_json_with_options into
+ * library-allocated buffers, for callers that never touch the filesystem.
+ * `png_name` is the image path recorded in the JSON. Either output pair may
+ * be NULL to skip it, but not both. The JSON buffer is NUL-terminated; the
+ * terminator is not counted in its size. Release buffers with dg_buffer_free.
+ */
+dg_status_t dg_map_export_png_json_to_buffers(
+    const dg_map_t *map,
+    const char *png_name,
+    const dg_export_options_t *options,
+    void **out_png,
+    size_t *out_png_size,
+    void **out_json,
+    size_t *out_json_size
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -240,6 +240,7 @@ typedef struct dg_snapshot_room_type_definition {
     dg_map_edge_opening_query_t template_opening_query;
     int template_required_opening_matches;
     int prefer_template_entrance_room;
+    int template_variant_step;
     dg_snapshot_room_type_constraints_t constraints;
     dg_snapshot_room_type_preferences_t preferences;
 } dg_snapshot_room_type_definition_t;
@@ -345,6 +346,13 @@ typedef struct dg_generation_diagnostics {
     size_t room_type_min_miss_count;
     size_t room_type_max_excess_count;
     size_t room_type_target_miss_count;
+    /*
+     * Rooms the min_count quotas lack even in the best possible assignment
+     * (0 when every minimum can be met at once), and the first enabled type
+     * left short. Strict mode fails generation whenever this is non-zero.
+     */
+    size_t room_type_min_shortfall;
+    uint32_t room_type_short_type_id;
 } dg_generation_diagnostics_t;
 
 typedef struct dg_map_metadata {
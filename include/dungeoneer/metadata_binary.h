@@ -0,0 +1,196 @@
+#ifndef DUNGEONEER_METADATA_BINARY_H
+#define DUNGEONEER_METADATA_BINARY_H
+
+#include "dungeoneer/io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Binary metadata sidecar ("DGMD") for game runtimes.
+ *
+ * Every integer is little-endian and every record below is a fixed-width
+ * struct with no implicit padding, so on little-endian hosts a loaded or
+ * memory-mapped file can be used in place:
+ *
+ *   header    dg_metadata_binary_header_t at offset 0
+ *   table     `section_count` dg_metadata_binary_section_t entries at
+ *             `section_table_offset`
+ *   sections  arrays of `count` records of `record_size` bytes at `offset`,
+ *             each 8-byte aligned
+ *
+ * Readers should skip section ids they do not know. Sections are always
+ * written, with count 0 when the map has no such entries.
+ */
+#define DG_METADATA_BINARY_VERSION 2u
+
+/* Stored for edge openings whose component is DG_MAP_EDGE_COMPONENT_UNKNOWN. */
+#define DG_METADATA_BINARY_COMPONENT_UNKNOWN UINT64_MAX
+
+typedef enum dg_metadata_binary_section_id {
+    DG_METADATA_BINARY_SECTION_ROOMS = 1,
+    DG_METADATA_BINARY_SECTION_CORRIDORS = 2,
+    DG_METADATA_BINARY_SECTION_ROOM_ENTRANCES = 3,
+    DG_METADATA_BINARY_SECTION_EDGE_OPENINGS = 4,
+    DG_METADATA_BINARY_SECTION_ROOM_ADJACENCY = 5,
+    DG_METADATA_BINARY_SECTION_ROOM_NEIGHBORS = 6,
+    DG_METADATA_BINARY_SECTION_ROOM_TYPE_QUOTAS = 7
+} dg_metadata_binary_section_id_t;
+
+typedef struct dg_metadata_binary_header {
+    uint8_t magic[4]; /* "DGMD" */
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t section_count;
+    uint64_t section_table_offset;
+    uint64_t total_size;
+
+    uint64_t seed;
+    int32_t algorithm_id;
+    int32_t generation_class;
+    int32_t width;
+    int32_t height;
+    int32_t primary_entrance_opening_id;
+    int32_t primary_exit_opening_id;
+    int32_t entrance_exit_distance;
+    uint32_t connected_floor;
+    uint64_t walkable_tile_count;
+    uint64_t wall_tile_count;
+    uint64_t corridor_total_length;
+    uint64_t connected_component_count;
+    uint64_t largest_component_size;
+    uint64_t generation_attempts;
+    uint64_t special_room_count;
+    uint64_t entrance_room_count;
+    uint64_t exit_room_count;
+    uint64_t boss_room_count;
+    uint64_t treasure_room_count;
+    uint64_t shop_room_count;
+    uint64_t leaf_room_count;
+    uint64_t typed_room_count;
+    uint64_t untyped_room_count;
+    uint64_t room_type_min_shortfall;
+    uint32_t room_type_short_type_id;
+    uint32_t reserved;
+} dg_metadata_binary_header_t;
+
+typedef struct dg_metadata_binary_section {
+    uint32_t id;
+    uint32_t record_size;
+    uint64_t offset;
+    uint64_t count;
+} dg_metadata_binary_section_t;
+
+typedef struct dg_metadata_binary_room {
+    int32_t id;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    uint32_t flags;
+    int32_t role;
+    uint32_t type_id;
+} dg_metadata_binary_room_t;
+
+typedef struct dg_metadata_binary_corridor {
+    int32_t from_room_id;
+    int32_t to_room_id;
+    int32_t width;
+    int32_t length;
+} dg_metadata_binary_corridor_t;
+
+typedef struct dg_metadata_binary_room_entrance {
+    int32_t room_id;
+    int32_t room_x;
+    int32_t room_y;
+    int32_t corridor_x;
+    int32_t corridor_y;
+    int32_t normal_x;
+    int32_t normal_y;
+} dg_metadata_binary_room_entrance_t;
+
+typedef struct dg_metadata_binary_edge_opening {
+    int32_t id;
+    int32_t side;
+    int32_t start;
+    int32_t end;
+    int32_t length;
+    int32_t edge_x;
+    int32_t edge_y;
+    int32_t inward_x;
+    int32_t inward_y;
+    int32_t normal_x;
+    int32_t normal_y;
+    int32_t role;
+    uint64_t component_id;
+} dg_metadata_binary_edge_opening_t;
+
+/* Neighbors of room i are room_neighbors[start_index ... start_index + count). */
+typedef struct dg_metadata_binary_room_adjacency {
+    uint32_t start_index;
+    uint32_t count;
+} dg_metadata_binary_room_adjacency_t;
+
+typedef struct dg_metadata_binary_room_neighbor {
+    int32_t room_id;
+    int32_t corridor_index;
+} dg_metadata_binary_room_neighbor_t;
+
+typedef struct dg_metadata_binary_room_type_quota {
+    uint32_t type_id;
+    int32_t enabled;
+    int32_t min_count;
+    int32_t max_count;
+    int32_t target_count;
+    uint32_t assigned_count;
+    int32_t min_satisfied;
+    int32_t max_satisfied;
+    int32_t target_satisfied;
+} dg_metadata_binary_room_type_quota_t;
+
+/* Pointers into a validated DGMD buffer; absent sections are NULL with count 0. */
+typedef struct dg_metadata_binary_view {
+    const dg_metadata_binary_header_t *header;
+    const dg_metadata_binary_room_t *rooms;
+    size_t room_count;
+    const dg_metadata_binary_corridor_t *corridors;
+    size_t corridor_count;
+    const dg_metadata_binary_room_entrance_t *room_entrances;
+    size_t room_entrance_count;
+    const dg_metadata_binary_edge_opening_t *edge_openings;
+    size_t edge_opening_count;
+    const dg_metadata_binary_room_adjacency_t *room_adjacency;
+    size_t room_adjacency_count;
+    const dg_metadata_binary_room_neighbor_t *room_neighbors;
+    size_t room_neighbor_count;
+    const dg_metadata_binary_room_type_quota_t *room_type_quotas;
+    size_t room_type_quota_count;
+} dg_metadata_binary_view_t;
+
+dg_status_t dg_map_export_metadata_binary(const dg_map_t *map, const char *path);
+
+/* Release the buffer with dg_buffer_free. */
+dg_status_t dg_map_export_metadata_binary_to_buffer(
+    const dg_map_t *map,
+    void **out_data,
+    size_t *out_size
+);
+
+/*
+ * Validates a DGMD buffer, including the room and corridor ids its records
+ * refer to, and points `out_view` at its records without copying. `data`
+ * must be 8-byte aligned (malloc and mmap results are) and must outlive the
+ * view. Big-endian hosts get DG_STATUS_UNSUPPORTED_FORMAT.
+ */
+dg_status_t dg_metadata_binary_view_init(
+    const void *data,
+    size_t size,
+    dg_metadata_binary_view_t *out_view
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
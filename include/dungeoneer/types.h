@@ -15,7 +15,8 @@ typedef enum dg_status {
     DG_STATUS_ALLOCATION_FAILED = 2,
     DG_STATUS_GENERATION_FAILED = 3,
     DG_STATUS_IO_ERROR = 4,
-    DG_STATUS_UNSUPPORTED_FORMAT = 5
+    DG_STATUS_UNSUPPORTED_FORMAT = 5,
+    DG_STATUS_BUFFER_TOO_SMALL = 6
 } dg_status_t;
 
 typedef struct dg_point {
@@ -15,6 +15,8 @@ const char *dg_status_string(dg_status_t status)
         return "io error";
     case DG_STATUS_UNSUPPORTED_FORMAT:
         return "unsupported format";
+    case DG_STATUS_BUFFER_TOO_SMALL:
+        return "buffer too small";
     default:
         return "unknown status";
     }
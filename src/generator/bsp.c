@@ -10,6 +10,26 @@ typedef struct dg_bsp_node {
     bool is_leaf;
 } dg_bsp_node_t;
 
+/*
+ * All nodes of one partition live in a single flat allocation. Children are
+ * always appended as a pair, so node indices grow in split order.
+ * `split_tree` is a Fenwick tree over node indices marking leaves that can
+ * still split, which lets the split loop pick the k-th candidate in index
+ * order without rescanning the whole tree.
+ */
+typedef struct dg_bsp_arena {
+    dg_bsp_node_t *nodes;
+    int *split_tree;
+    size_t count;
+    size_t capacity;
+} dg_bsp_arena_t;
+
+typedef struct dg_bsp_connect_frame {
+    int node_index;
+    int stage;
+    int left_room;
+} dg_bsp_connect_frame_t;
+
 static int dg_bsp_min_int(int a, int b)
 {
     return a < b ? a : b;
@@ -35,6 +55,68 @@ static void dg_carve_room(dg_map_t *map, const dg_rect_t *room)
     }
 }
 
+static dg_status_t dg_bsp_arena_init(dg_bsp_arena_t *arena, size_t capacity)
+{
+    arena->count = 0u;
+    arena->capacity = capacity;
+    arena->nodes = (dg_bsp_node_t *)calloc(capacity, sizeof(dg_bsp_node_t));
+    arena->split_tree = (int *)calloc(capacity + 1u, sizeof(int));
+    if (arena->nodes == NULL || arena->split_tree == NULL) {
+        free(arena->nodes);
+        free(arena->split_tree);
+        arena->nodes = NULL;
+        arena->split_tree = NULL;
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    return DG_STATUS_OK;
+}
+
+static void dg_bsp_arena_destroy(dg_bsp_arena_t *arena)
+{
+    free(arena->nodes);
+    free(arena->split_tree);
+    arena->nodes = NULL;
+    arena->split_tree = NULL;
+    arena->count = 0u;
+    arena->capacity = 0u;
+}
+
+static void dg_bsp_split_tree_add(dg_bsp_arena_t *arena, size_t node_index, int delta)
+{
+    size_t i;
+
+    for (i = node_index + 1u; i <= arena->capacity; i += i & (~i + 1u)) {
+        arena->split_tree[i] += delta;
+    }
+}
+
+/*
+ * Returns the node index of the `rank`-th (0-based) split candidate in
+ * ascending node order.
+ */
+static int dg_bsp_split_tree_find(const dg_bsp_arena_t *arena, int rank)
+{
+    size_t position;
+    size_t step;
+
+    position = 0u;
+    step = 1u;
+    while (step * 2u <= arena->capacity) {
+        step *= 2u;
+    }
+
+    for (; step > 0u; step /= 2u) {
+        size_t next = position + step;
+        if (next <= arena->capacity && arena->split_tree[next] <= rank) {
+            position = next;
+            rank -= arena->split_tree[next];
+        }
+    }
+
+    return (int)position;
+}
+
 static void dg_carve_horizontal_path(dg_map_t *map, int x0, int x1, int y)
 {
     int x;
@@ -111,15 +193,14 @@ static bool dg_node_can_split(const dg_bsp_node_t *node, int min_leaf_width, int
 }
 
 static dg_status_t dg_split_leaf(
-    dg_bsp_node_t *nodes,
-    size_t *node_count,
-    size_t node_capacity,
+    dg_bsp_arena_t *arena,
     int leaf_index,
     int min_leaf_width,
     int min_leaf_height,
     dg_rng_t *rng
 )
 {
+    dg_bsp_node_t *nodes;
     dg_bsp_node_t *leaf;
     bool can_split_vertical;
     bool can_split_horizontal;
@@ -128,18 +209,19 @@ static dg_status_t dg_split_leaf(
     dg_bsp_node_t left_child;
     dg_bsp_node_t right_child;
 
-    if (nodes == NULL || node_count == NULL || rng == NULL) {
+    if (arena == NULL || arena->nodes == NULL || rng == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    if (leaf_index < 0 || (size_t)leaf_index >= *node_count) {
+    if (leaf_index < 0 || (size_t)leaf_index >= arena->count) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    if (*node_count + 2 > node_capacity) {
+    if (arena->count + 2u > arena->capacity) {
         return DG_STATUS_ALLOCATION_FAILED;
     }
 
+    nodes = arena->nodes;
     leaf = &nodes[leaf_index];
     if (!leaf->is_leaf) {
         return DG_STATUS_INVALID_ARGUMENT;
@@ -209,22 +291,30 @@ static dg_status_t dg_split_leaf(
     right_child.room_id = -1;
     right_child.is_leaf = true;
 
-    leaf->left = (int)(*node_count);
-    leaf->right = (int)(*node_count + 1);
+    leaf->left = (int)arena->count;
+    leaf->right = (int)arena->count + 1;
     leaf->is_leaf = false;
+    dg_bsp_split_tree_add(arena, (size_t)leaf_index, -1);
 
-    nodes[*node_count] = left_child;
-    nodes[*node_count + 1] = right_child;
-    *node_count += 2;
+    nodes[arena->count] = left_child;
+    nodes[arena->count + 1u] = right_child;
+    if (dg_node_can_split(&left_child, min_leaf_width, min_leaf_height)) {
+        dg_bsp_split_tree_add(arena, arena->count, 1);
+    }
+    if (dg_node_can_split(&right_child, min_leaf_width, min_leaf_height)) {
+        dg_bsp_split_tree_add(arena, arena->count + 1u, 1);
+    }
+    arena->count += 2u;
 
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_place_room_in_leaf(
-    dg_map_t *map,
-    dg_bsp_node_t *leaf,
+static dg_status_t dg_choose_room_in_leaf(
+    const dg_map_t *map,
+    const dg_bsp_node_t *leaf,
     const dg_bsp_config_t *config,
-    dg_rng_t *rng
+    dg_rng_t *rng,
+    dg_rect_t *out_room
 )
 {
     int left_margin;
@@ -239,8 +329,6 @@ static dg_status_t dg_place_room_in_leaf(
     int max_x;
     int min_y;
     int max_y;
-    dg_rect_t room;
-    dg_status_t status;
 
     left_margin = (leaf->bounds.x > 0) ? 1 : 0;
     top_margin = (leaf->bounds.y > 0) ? 1 : 0;
@@ -272,64 +360,83 @@ static dg_status_t dg_place_room_in_leaf(
         return DG_STATUS_GENERATION_FAILED;
     }
 
-    room.x = dg_rng_range(rng, min_x, max_x);
-    room.y = dg_rng_range(rng, min_y, max_y);
-    room.width = room_width;
-    room.height = room_height;
-
-    dg_carve_room(map, &room);
-    status = dg_map_add_room(map, &room, DG_ROOM_FLAG_NONE);
-    if (status != DG_STATUS_OK) {
-        return status;
-    }
-
-    leaf->room_id = (int)map->metadata.room_count - 1;
+    out_room->x = dg_rng_range(rng, min_x, max_x);
+    out_room->y = dg_rng_range(rng, min_y, max_y);
+    out_room->width = room_width;
+    out_room->height = room_height;
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_connect_tree_recursive(
+/*
+ * Post-order walk joining the two subtrees of every internal node, using an
+ * explicit stack so very deep trees cannot overflow the call stack. Each
+ * subtree reports one representative room upward.
+ */
+static dg_status_t dg_connect_tree(
     dg_map_t *map,
     dg_rng_t *rng,
-    dg_bsp_node_t *nodes,
-    int node_index,
-    int *out_room_id
+    const dg_bsp_arena_t *arena
 )
 {
+    dg_bsp_connect_frame_t *stack;
+    size_t stack_count;
+    int returned_room;
     dg_status_t status;
-    int left_room;
-    int right_room;
 
-    if (nodes[node_index].is_leaf) {
-        if (nodes[node_index].room_id < 0) {
-            return DG_STATUS_GENERATION_FAILED;
-        }
-
-        *out_room_id = nodes[node_index].room_id;
-        return DG_STATUS_OK;
+    if (arena->count == 0u) {
+        return DG_STATUS_GENERATION_FAILED;
     }
 
-    status = dg_connect_tree_recursive(map, rng, nodes, nodes[node_index].left, &left_room);
-    if (status != DG_STATUS_OK) {
-        return status;
+    stack = (dg_bsp_connect_frame_t *)malloc(arena->count * sizeof(*stack));
+    if (stack == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
     }
 
-    status = dg_connect_tree_recursive(map, rng, nodes, nodes[node_index].right, &right_room);
-    if (status != DG_STATUS_OK) {
-        return status;
-    }
+    stack_count = 0u;
+    stack[stack_count++] = (dg_bsp_connect_frame_t){0, 0, -1};
+    returned_room = -1;
+    status = DG_STATUS_OK;
 
-    status = dg_connect_rooms(map, rng, left_room, right_room);
-    if (status != DG_STATUS_OK) {
-        return status;
-    }
+    while (stack_count > 0u) {
+        dg_bsp_connect_frame_t *frame = &stack[stack_count - 1u];
+        const dg_bsp_node_t *node = &arena->nodes[frame->node_index];
 
-    if ((dg_rng_next_u32(rng) & 1u) != 0u) {
-        *out_room_id = left_room;
-    } else {
-        *out_room_id = right_room;
+        if (node->is_leaf) {
+            if (node->room_id < 0) {
+                status = DG_STATUS_GENERATION_FAILED;
+                break;
+            }
+            returned_room = node->room_id;
+            stack_count -= 1u;
+            continue;
+        }
+
+        if (frame->stage == 0) {
+            frame->stage = 1;
+            stack[stack_count++] = (dg_bsp_connect_frame_t){node->left, 0, -1};
+            continue;
+        }
+
+        if (frame->stage == 1) {
+            frame->left_room = returned_room;
+            frame->stage = 2;
+            stack[stack_count++] = (dg_bsp_connect_frame_t){node->right, 0, -1};
+            continue;
+        }
+
+        status = dg_connect_rooms(map, rng, frame->left_room, returned_room);
+        if (status != DG_STATUS_OK) {
+            break;
+        }
+
+        if ((dg_rng_next_u32(rng) & 1u) != 0u) {
+            returned_room = frame->left_room;
+        }
+        stack_count -= 1u;
     }
 
-    return DG_STATUS_OK;
+    free(stack);
+    return status;
 }
 
 dg_status_t dg_generate_bsp_tree_impl(
@@ -341,16 +448,12 @@ dg_status_t dg_generate_bsp_tree_impl(
     const dg_bsp_config_t *config;
     int target_rooms;
     int min_leaf_size;
-    dg_bsp_node_t *nodes;
-    size_t node_capacity;
-    size_t node_count;
+    dg_bsp_arena_t arena;
     size_t i;
-    int *split_candidates;
-    size_t split_candidate_count;
-    int *leaf_indices;
+    int split_candidate_count;
+    dg_rect_t room;
     size_t leaf_count;
     dg_status_t status;
-    int representative_room;
 
     if (request == NULL || map == NULL || rng == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
@@ -370,102 +473,73 @@ dg_status_t dg_generate_bsp_tree_impl(
         return DG_STATUS_GENERATION_FAILED;
     }
 
-    node_capacity = (size_t)target_rooms * 8u + 8u;
-    nodes = (dg_bsp_node_t *)calloc(node_capacity, sizeof(dg_bsp_node_t));
-    split_candidates = (int *)malloc(node_capacity * sizeof(int));
-    leaf_indices = (int *)malloc(node_capacity * sizeof(int));
-    if (nodes == NULL || split_candidates == NULL || leaf_indices == NULL) {
-        free(nodes);
-        free(split_candidates);
-        free(leaf_indices);
-        return DG_STATUS_ALLOCATION_FAILED;
+    /* A binary tree with target_rooms leaves never needs more than 2n-1 nodes. */
+    status = dg_bsp_arena_init(&arena, (size_t)target_rooms * 2u + 1u);
+    if (status != DG_STATUS_OK) {
+        return status;
     }
 
-    nodes[0].bounds = (dg_rect_t){0, 0, map->width, map->height};
-    nodes[0].left = -1;
-    nodes[0].right = -1;
-    nodes[0].room_id = -1;
-    nodes[0].is_leaf = true;
-    node_count = 1;
-
-    while (true) {
-        split_candidate_count = 0;
-        leaf_count = 0;
-
-        for (i = 0; i < node_count; ++i) {
-            if (!nodes[i].is_leaf) {
-                continue;
-            }
-
-            leaf_indices[leaf_count++] = (int)i;
-            if (dg_node_can_split(&nodes[i], min_leaf_size, min_leaf_size)) {
-                split_candidates[split_candidate_count++] = (int)i;
-            }
-        }
+    arena.nodes[0].bounds = (dg_rect_t){0, 0, map->width, map->height};
+    arena.nodes[0].left = -1;
+    arena.nodes[0].right = -1;
+    arena.nodes[0].room_id = -1;
+    arena.nodes[0].is_leaf = true;
+    arena.count = 1u;
+    leaf_count = 1u;
+    split_candidate_count = 0;
+    if (dg_node_can_split(&arena.nodes[0], min_leaf_size, min_leaf_size)) {
+        dg_bsp_split_tree_add(&arena, 0u, 1);
+        split_candidate_count = 1;
+    }
 
-        if ((int)leaf_count >= target_rooms) {
-            break;
-        }
+    while ((int)leaf_count < target_rooms && split_candidate_count > 0) {
+        int rank = dg_rng_range(rng, 0, split_candidate_count - 1);
+        int chosen = dg_bsp_split_tree_find(&arena, rank);
+        size_t first_child = arena.count;
 
-        if (split_candidate_count == 0) {
-            break;
+        status = dg_split_leaf(&arena, chosen, min_leaf_size, min_leaf_size, rng);
+        if (status != DG_STATUS_OK) {
+            dg_bsp_arena_destroy(&arena);
+            return status;
         }
 
-        {
-            int chosen = split_candidates[dg_rng_range(rng, 0, (int)split_candidate_count - 1)];
-            status = dg_split_leaf(
-                nodes,
-                &node_count,
-                node_capacity,
-                chosen,
-                min_leaf_size,
-                min_leaf_size,
-                rng
-            );
-            if (status != DG_STATUS_OK) {
-                free(nodes);
-                free(split_candidates);
-                free(leaf_indices);
-                return status;
-            }
+        leaf_count += 1u;
+        split_candidate_count -= 1;
+        if (dg_node_can_split(&arena.nodes[first_child], min_leaf_size, min_leaf_size)) {
+            split_candidate_count += 1;
         }
-    }
-
-    leaf_count = 0;
-    for (i = 0; i < node_count; ++i) {
-        if (nodes[i].is_leaf) {
-            leaf_indices[leaf_count++] = (int)i;
+        if (dg_node_can_split(&arena.nodes[first_child + 1u], min_leaf_size, min_leaf_size)) {
+            split_candidate_count += 1;
         }
     }
 
     if ((int)leaf_count < config->min_rooms) {
-        free(nodes);
-        free(split_candidates);
-        free(leaf_indices);
+        dg_bsp_arena_destroy(&arena);
         return DG_STATUS_GENERATION_FAILED;
     }
 
-    for (i = 0; i < leaf_count; ++i) {
-        status = dg_place_room_in_leaf(map, &nodes[leaf_indices[i]], config, rng);
+    /* Rooms are drawn in leaf order, which is split order in the arena. */
+    for (i = 0; i < arena.count; ++i) {
+        dg_bsp_node_t *node = &arena.nodes[i];
+
+        if (!node->is_leaf) {
+            continue;
+        }
+
+        status = dg_choose_room_in_leaf(map, node, config, rng, &room);
+        if (status == DG_STATUS_OK) {
+            status = dg_map_add_room(map, &room, DG_ROOM_FLAG_NONE);
+        }
         if (status != DG_STATUS_OK) {
-            free(nodes);
-            free(split_candidates);
-            free(leaf_indices);
+            dg_bsp_arena_destroy(&arena);
             return status;
         }
-    }
 
-    status = dg_connect_tree_recursive(map, rng, nodes, 0, &representative_room);
-    if (status != DG_STATUS_OK) {
-        free(nodes);
-        free(split_candidates);
-        free(leaf_indices);
-        return status;
+        dg_carve_room(map, &room);
+        node->room_id = (int)map->metadata.room_count - 1;
     }
 
-    (void)representative_room;
-    free(nodes);
-    free(split_candidates);
-    free(leaf_indices);
-    return DG_STATUS_OK;
+    status = dg_connect_tree(map, rng, &arena);
+    dg_bsp_arena_destroy(&arena);
+    return status;
 }
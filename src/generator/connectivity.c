@@ -3,36 +3,38 @@
 #include <stdlib.h>
 #include <string.h>
 
-static bool dg_point_in_any_room(const dg_map_t *map, int x, int y)
+static bool dg_point_in_any_room(
+    const dg_map_t *map,
+    const unsigned char *room_mask,
+    int x,
+    int y
+)
 {
-    size_t i;
-
-    if (map == NULL || map->metadata.rooms == NULL) {
+    if (map == NULL || room_mask == NULL || !dg_map_in_bounds(map, x, y)) {
         return false;
     }
 
-    for (i = 0; i < map->metadata.room_count; ++i) {
-        const dg_rect_t *room = &map->metadata.rooms[i].bounds;
-        if (x >= room->x && y >= room->y && x < room->x + room->width && y < room->y + room->height) {
-            return true;
-        }
-    }
-
-    return false;
+    return room_mask[dg_tile_index(map, x, y)] != 0u;
 }
 
-static bool dg_is_corridor_floor(const dg_map_t *map, int x, int y)
+static bool dg_is_corridor_floor(
+    const dg_map_t *map,
+    const unsigned char *room_mask,
+    int x,
+    int y
+)
 {
     if (map == NULL || !dg_map_in_bounds(map, x, y)) {
         return false;
     }
 
     return dg_is_walkable_tile(dg_map_get_tile(map, x, y)) &&
-           !dg_point_in_any_room(map, x, y);
+           !dg_point_in_any_room(map, room_mask, x, y);
 }
 
 static bool dg_is_corridor_floor_in_tiles(
     const dg_map_t *map,
+    const unsigned char *room_mask,
     const dg_tile_t *tiles,
     int x,
     int y
@@ -43,21 +45,27 @@ static bool dg_is_corridor_floor_in_tiles(
     }
 
     return dg_is_walkable_tile(tiles[dg_tile_index(map, x, y)]) &&
-           !dg_point_in_any_room(map, x, y);
+           !dg_point_in_any_room(map, room_mask, x, y);
 }
 
-static bool dg_is_walkable_room_tile(const dg_map_t *map, int x, int y)
+static bool dg_is_walkable_room_tile(
+    const dg_map_t *map,
+    const unsigned char *room_mask,
+    int x,
+    int y
+)
 {
     if (map == NULL || !dg_map_in_bounds(map, x, y)) {
         return false;
     }
 
-    return dg_point_in_any_room(map, x, y) &&
+    return dg_point_in_any_room(map, room_mask, x, y) &&
            dg_is_walkable_tile(dg_map_get_tile(map, x, y));
 }
 
 static bool dg_is_walkable_room_tile_in_tiles(
     const dg_map_t *map,
+    const unsigned char *room_mask,
     const dg_tile_t *tiles,
     int x,
     int y
@@ -67,11 +75,16 @@ static bool dg_is_walkable_room_tile_in_tiles(
         return false;
     }
 
-    return dg_point_in_any_room(map, x, y) &&
+    return dg_point_in_any_room(map, room_mask, x, y) &&
            dg_is_walkable_tile(tiles[dg_tile_index(map, x, y)]);
 }
 
-static bool dg_corridor_touches_room(const dg_map_t *map, int x, int y)
+static bool dg_corridor_touches_room(
+    const dg_map_t *map,
+    const unsigned char *room_mask,
+    int x,
+    int y
+)
 {
     static const int directions[4][2] = {
         {1, 0},
@@ -81,7 +94,7 @@ static bool dg_corridor_touches_room(const dg_map_t *map, int x, int y)
     };
     int d;
 
-    if (!dg_is_corridor_floor(map, x, y)) {
+    if (!dg_is_corridor_floor(map, room_mask, x, y)) {
         return false;
     }
 
@@ -89,7 +102,7 @@ static bool dg_corridor_touches_room(const dg_map_t *map, int x, int y)
         int nx = x + directions[d][0];
         int ny = y + directions[d][1];
 
-        if (dg_is_walkable_room_tile(map, nx, ny)) {
+        if (dg_is_walkable_room_tile(map, room_mask, nx, ny)) {
             return true;
         }
     }
@@ -99,6 +112,7 @@ static bool dg_corridor_touches_room(const dg_map_t *map, int x, int y)
 
 static bool dg_corridor_touches_room_in_tiles(
     const dg_map_t *map,
+    const unsigned char *room_mask,
     const dg_tile_t *tiles,
     int x,
     int y
@@ -112,7 +126,7 @@ static bool dg_corridor_touches_room_in_tiles(
     };
     int d;
 
-    if (!dg_is_corridor_floor_in_tiles(map, tiles, x, y)) {
+    if (!dg_is_corridor_floor_in_tiles(map, room_mask, tiles, x, y)) {
         return false;
     }
 
@@ -120,7 +134,7 @@ static bool dg_corridor_touches_room_in_tiles(
         int nx = x + directions[d][0];
         int ny = y + directions[d][1];
 
-        if (dg_is_walkable_room_tile_in_tiles(map, tiles, nx, ny)) {
+        if (dg_is_walkable_room_tile_in_tiles(map, room_mask, tiles, nx, ny)) {
             return true;
         }
     }
@@ -128,89 +142,6 @@ static bool dg_corridor_touches_room_in_tiles(
     return false;
 }
 
-static bool dg_has_corridor_path_when_blocked(
-    const dg_map_t *map,
-    const dg_tile_t *tiles,
-    int start_x,
-    int start_y,
-    int target_x,
-    int target_y,
-    int block_x,
-    int block_y,
-    unsigned char *visited,
-    size_t *queue
-)
-{
-    static const int directions[4][2] = {
-        {1, 0},
-        {-1, 0},
-        {0, 1},
-        {0, -1}
-    };
-    size_t cell_count;
-    size_t head;
-    size_t tail;
-
-    if (map == NULL || tiles == NULL || visited == NULL || queue == NULL) {
-        return false;
-    }
-    if (!dg_map_in_bounds(map, start_x, start_y) ||
-        !dg_map_in_bounds(map, target_x, target_y)) {
-        return false;
-    }
-    if (!dg_is_corridor_floor_in_tiles(map, tiles, start_x, start_y) ||
-        !dg_is_corridor_floor_in_tiles(map, tiles, target_x, target_y)) {
-        return false;
-    }
-    if (start_x == target_x && start_y == target_y) {
-        return true;
-    }
-
-    cell_count = (size_t)map->width * (size_t)map->height;
-    memset(visited, 0, cell_count * sizeof(*visited));
-    head = 0;
-    tail = 0;
-
-    queue[tail++] = dg_tile_index(map, start_x, start_y);
-    visited[dg_tile_index(map, start_x, start_y)] = 1u;
-
-    while (head < tail) {
-        size_t current = queue[head++];
-        int x = (int)(current % (size_t)map->width);
-        int y = (int)(current / (size_t)map->width);
-        int d;
-
-        for (d = 0; d < 4; ++d) {
-            int nx = x + directions[d][0];
-            int ny = y + directions[d][1];
-            size_t nindex;
-
-            if (!dg_map_in_bounds(map, nx, ny)) {
-                continue;
-            }
-            if (nx == block_x && ny == block_y) {
-                continue;
-            }
-            if (!dg_is_corridor_floor_in_tiles(map, tiles, nx, ny)) {
-                continue;
-            }
-
-            nindex = dg_tile_index(map, nx, ny);
-            if (visited[nindex] != 0u) {
-                continue;
-            }
-            if (nx == target_x && ny == target_y) {
-                return true;
-            }
-
-            visited[nindex] = 1u;
-            queue[tail++] = nindex;
-        }
-    }
-
-    return false;
-}
-
 size_t dg_count_walkable_tiles(const dg_map_t *map)
 {
     size_t i;
@@ -423,8 +354,8 @@ dg_status_t dg_smooth_walkable_regions(
     dg_tile_t *inner_buffer;
     dg_tile_t *outer_buffer;
     unsigned char *protected_tiles;
-    unsigned char *visited;
-    size_t *queue;
+    unsigned char *room_mask;
+    dg_status_t status;
     int outer_passes;
     int pass;
     int x;
@@ -435,23 +366,25 @@ dg_status_t dg_smooth_walkable_regions(
     }
 
     cell_count = (size_t)map->width * (size_t)map->height;
+    status = dg_build_room_coverage_mask(map, &room_mask);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
     source_tiles = (dg_tile_t *)malloc(cell_count * sizeof(dg_tile_t));
     outer_source_tiles = (dg_tile_t *)malloc(cell_count * sizeof(dg_tile_t));
     inner_buffer = (dg_tile_t *)malloc(cell_count * sizeof(dg_tile_t));
     outer_buffer = (dg_tile_t *)malloc(cell_count * sizeof(dg_tile_t));
     protected_tiles = (unsigned char *)calloc(cell_count, sizeof(*protected_tiles));
-    visited = (unsigned char *)malloc(cell_count * sizeof(*visited));
-    queue = (size_t *)malloc(cell_count * sizeof(*queue));
     if (source_tiles == NULL || outer_source_tiles == NULL ||
         inner_buffer == NULL || outer_buffer == NULL ||
-        protected_tiles == NULL || visited == NULL || queue == NULL) {
+        protected_tiles == NULL) {
         free(source_tiles);
         free(outer_source_tiles);
         free(inner_buffer);
         free(outer_buffer);
         free(protected_tiles);
-        free(visited);
-        free(queue);
+        free(room_mask);
         return DG_STATUS_ALLOCATION_FAILED;
     }
     memcpy(source_tiles, map->tiles, cell_count * sizeof(dg_tile_t));
@@ -474,28 +407,28 @@ dg_status_t dg_smooth_walkable_regions(
                     size_t index = dg_tile_index(map, x, y);
 
                     if (map->tiles[index] != DG_TILE_WALL ||
-                        dg_point_in_any_room(map, x, y)) {
+                        dg_point_in_any_room(map, room_mask, x, y)) {
                         continue;
                     }
 
                     /*
                      * Do not open extra room entrances while smoothing corridors.
                      */
-                    if ((dg_point_in_any_room(map, x, y - 1) &&
+                    if ((dg_point_in_any_room(map, room_mask, x, y - 1) &&
                          dg_is_walkable_tile(dg_map_get_tile(map, x, y - 1))) ||
-                        (dg_point_in_any_room(map, x + 1, y) &&
+                        (dg_point_in_any_room(map, room_mask, x + 1, y) &&
                          dg_is_walkable_tile(dg_map_get_tile(map, x + 1, y))) ||
-                        (dg_point_in_any_room(map, x, y + 1) &&
+                        (dg_point_in_any_room(map, room_mask, x, y + 1) &&
                          dg_is_walkable_tile(dg_map_get_tile(map, x, y + 1))) ||
-                        (dg_point_in_any_room(map, x - 1, y) &&
+                        (dg_point_in_any_room(map, room_mask, x - 1, y) &&
                          dg_is_walkable_tile(dg_map_get_tile(map, x - 1, y)))) {
                         continue;
                     }
 
-                    n = dg_is_corridor_floor(map, x, y - 1);
-                    e = dg_is_corridor_floor(map, x + 1, y);
-                    s = dg_is_corridor_floor(map, x, y + 1);
-                    w = dg_is_corridor_floor(map, x - 1, y);
+                    n = dg_is_corridor_floor(map, room_mask, x, y - 1);
+                    e = dg_is_corridor_floor(map, room_mask, x + 1, y);
+                    s = dg_is_corridor_floor(map, room_mask, x, y + 1);
+                    w = dg_is_corridor_floor(map, room_mask, x - 1, y);
 
                     /*
                      * Inner smoothing:
@@ -534,8 +467,8 @@ dg_status_t dg_smooth_walkable_regions(
                     /*
                      * Do not smooth corridor corners that terminate into rooms.
                      */
-                    if (dg_corridor_touches_room(map, leg_a_x, leg_a_y) ||
-                        dg_corridor_touches_room(map, leg_b_x, leg_b_y)) {
+                    if (dg_corridor_touches_room(map, room_mask, leg_a_x, leg_a_y) ||
+                        dg_corridor_touches_room(map, room_mask, leg_b_x, leg_b_y)) {
                         continue;
                     }
 
@@ -559,7 +492,7 @@ dg_status_t dg_smooth_walkable_regions(
 
                 x_index = (int)(i % (size_t)map->width);
                 y_index = (int)(i / (size_t)map->width);
-                if (dg_point_in_any_room(map, x_index, y_index)) {
+                if (dg_point_in_any_room(map, room_mask, x_index, y_index)) {
                     continue;
                 }
 
@@ -593,7 +526,7 @@ dg_status_t dg_smooth_walkable_regions(
                     bool can_trim = false;
                     size_t index = dg_tile_index(map, x, y);
 
-                    if (!dg_is_corridor_floor(map, x, y)) {
+                    if (!dg_is_corridor_floor(map, room_mask, x, y)) {
                         continue;
                     }
                     if (protected_tiles[index] != 0u) {
@@ -605,13 +538,13 @@ dg_status_t dg_smooth_walkable_regions(
                      * `protected_tiles` prevents trimming inner-added bridge tiles
                      * when both modes are enabled in one step.
                      */
-                    if (!dg_is_corridor_floor_in_tiles(map, outer_source_tiles, x, y)) {
+                    if (!dg_is_corridor_floor_in_tiles(map, room_mask, outer_source_tiles, x, y)) {
                         continue;
                     }
-                    source_n = dg_is_corridor_floor_in_tiles(map, outer_source_tiles, x, y - 1);
-                    source_e = dg_is_corridor_floor_in_tiles(map, outer_source_tiles, x + 1, y);
-                    source_s = dg_is_corridor_floor_in_tiles(map, outer_source_tiles, x, y + 1);
-                    source_w = dg_is_corridor_floor_in_tiles(map, outer_source_tiles, x - 1, y);
+                    source_n = dg_is_corridor_floor_in_tiles(map, room_mask, outer_source_tiles, x, y - 1);
+                    source_e = dg_is_corridor_floor_in_tiles(map, room_mask, outer_source_tiles, x + 1, y);
+                    source_s = dg_is_corridor_floor_in_tiles(map, room_mask, outer_source_tiles, x, y + 1);
+                    source_w = dg_is_corridor_floor_in_tiles(map, room_mask, outer_source_tiles, x - 1, y);
 
                     /*
                      * Outer smoothing:
@@ -663,48 +596,35 @@ dg_status_t dg_smooth_walkable_regions(
 
                     if (!can_trim ||
                         !dg_map_in_bounds(map, bridge_x, bridge_y) ||
-                        dg_point_in_any_room(map, bridge_x, bridge_y)) {
+                        dg_point_in_any_room(map, room_mask, bridge_x, bridge_y)) {
                         continue;
                     }
-                    if (dg_corridor_touches_room_in_tiles(map, outer_source_tiles, x, y) ||
-                        dg_corridor_touches_room_in_tiles(map, outer_source_tiles, leg_a_x, leg_a_y) ||
-                        dg_corridor_touches_room_in_tiles(map, outer_source_tiles, leg_b_x, leg_b_y)) {
+                    if (dg_corridor_touches_room_in_tiles(map, room_mask, outer_source_tiles, x, y) ||
+                        dg_corridor_touches_room_in_tiles(map, room_mask, outer_source_tiles, leg_a_x, leg_a_y) ||
+                        dg_corridor_touches_room_in_tiles(map, room_mask, outer_source_tiles, leg_b_x, leg_b_y)) {
                         continue;
                     }
 
-                    if (!dg_is_corridor_floor(map, bridge_x, bridge_y)) {
+                    if (!dg_is_corridor_floor(map, room_mask, bridge_x, bridge_y)) {
                         continue;
                     }
-                    if (dg_is_corridor_floor(map, opposite_x, opposite_y)) {
+                    if (dg_is_corridor_floor(map, room_mask, opposite_x, opposite_y)) {
                         continue;
                     }
 
                     /*
                      * Prevent cascading trims from disconnecting paths:
                      * only trim if both bend legs and bridge are still present
-                     * in the current output buffer.
+                     * in the current output buffer. The bridge is adjacent to
+                     * both legs, so the corner is never an articulation point
+                     * once this holds and no path search is needed.
                      */
-                    if (!dg_is_corridor_floor_in_tiles(map, outer_buffer, leg_a_x, leg_a_y) ||
-                        !dg_is_corridor_floor_in_tiles(map, outer_buffer, leg_b_x, leg_b_y) ||
-                        !dg_is_corridor_floor_in_tiles(map, outer_buffer, bridge_x, bridge_y) ||
-                        dg_is_corridor_floor_in_tiles(map, outer_buffer, opposite_x, opposite_y)) {
+                    if (!dg_is_corridor_floor_in_tiles(map, room_mask, outer_buffer, leg_a_x, leg_a_y) ||
+                        !dg_is_corridor_floor_in_tiles(map, room_mask, outer_buffer, leg_b_x, leg_b_y) ||
+                        !dg_is_corridor_floor_in_tiles(map, room_mask, outer_buffer, bridge_x, bridge_y) ||
+                        dg_is_corridor_floor_in_tiles(map, room_mask, outer_buffer, opposite_x, opposite_y)) {
                         continue;
                     }
-                    if (!dg_has_corridor_path_when_blocked(
-                            map,
-                            outer_buffer,
-                            leg_a_x,
-                            leg_a_y,
-                            leg_b_x,
-                            leg_b_y,
-                            x,
-                            y,
-                            visited,
-                            queue
-                        )) {
-                        continue;
-                    }
-
                     outer_buffer[index] = DG_TILE_WALL;
                 }
             }
@@ -718,7 +638,6 @@ dg_status_t dg_smooth_walkable_regions(
     free(inner_buffer);
     free(outer_buffer);
     free(protected_tiles);
-    free(visited);
-    free(queue);
+    free(room_mask);
     return DG_STATUS_OK;
 }
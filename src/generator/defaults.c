@@ -148,6 +148,7 @@ void dg_default_room_type_definition(dg_room_type_definition_t *definition, uint
     dg_default_map_edge_opening_query(&definition->template_opening_query);
     definition->template_required_opening_matches = 0;
     definition->prefer_template_entrance_room = 0;
+    definition->template_variant_step = 0;
     dg_default_room_type_constraints(&definition->constraints);
     dg_default_room_type_preferences(&definition->preferences);
 }
@@ -25,6 +25,12 @@ void dg_paint_outer_walls(dg_map_t *map);
 bool dg_has_outer_walls(const dg_map_t *map);
 void dg_carve_brush(dg_map_t *map, int cx, int cy, int radius, dg_tile_t tile);
 
+/*
+ * Allocates a width*height byte mask with 1 for every tile covered by some
+ * room's bounds, giving O(1) room membership. The caller frees the mask.
+ */
+dg_status_t dg_build_room_coverage_mask(const dg_map_t *map, unsigned char **out_mask);
+
 size_t dg_count_walkable_tiles(const dg_map_t *map);
 dg_status_t dg_enforce_single_connected_region(dg_map_t *map);
 dg_status_t dg_analyze_connectivity(const dg_map_t *map, dg_connectivity_stats_t *out_stats);
@@ -35,6 +41,15 @@ dg_status_t dg_smooth_walkable_regions(
     int outer_enabled
 );
 
+/*
+ * Builds the CSR room graph (room_adjacency/room_neighbors) from the valid
+ * corridors, keeping the existing arrays when they already match.
+ */
+dg_status_t dg_build_room_graph_metadata(
+    dg_map_t *map,
+    size_t *out_leaf_room_count,
+    size_t *out_corridor_total_length
+);
 dg_status_t dg_populate_runtime_metadata(
     dg_map_t *map,
     uint64_t seed,
@@ -54,6 +69,24 @@ dg_status_t dg_apply_explicit_edge_opening_roles(
 
 void dg_init_empty_map(dg_map_t *map);
 
+/*
+ * Splits [0, count) into contiguous chunks of at least `min_chunk` items,
+ * several per worker, and runs `fn` on them across a process-wide worker
+ * pool (started on first use) and the calling thread. Threads claim chunks
+ * one at a time, so uneven chunks balance out. Returns once all finish.
+ * Without thread support (or for small counts) `fn` runs once on the calling
+ * thread, as does a loop started from inside a chunk. Callers must keep
+ * chunks independent so results never depend on scheduling.
+ */
+typedef void (*dg_parallel_range_fn)(void *context, size_t begin, size_t end);
+size_t dg_parallel_worker_count(void);
+void dg_parallel_for(
+    size_t count,
+    size_t min_chunk,
+    dg_parallel_range_fn fn,
+    void *context
+);
+
 dg_status_t dg_generate_bsp_tree_impl(
     const dg_generate_request_t *request,
     dg_map_t *map,
@@ -110,6 +143,54 @@ dg_status_t dg_apply_room_type_templates(
 );
 dg_status_t dg_validate_generate_request(const dg_generate_request_t *request);
 dg_status_t dg_snapshot_generation_request(const dg_generate_request_t *request, dg_map_t *map);
+/*
+ * Shared, read-only template map from the process-wide cache
+ * (src/template_cache.c). Each successful acquire must be paired with a
+ * release.
+ */
+typedef struct dg_cached_template dg_cached_template_t;
+dg_status_t dg_template_cache_acquire(
+    const char *path,
+    dg_cached_template_t **out_entry,
+    const dg_map_t **out_map
+);
+void dg_template_cache_release(dg_cached_template_t *entry);
+
+/*
+ * Size variants published on a cache entry, keyed by exact bucket size and
+ * valid while the entry is held. find returns NULL when the bucket has not
+ * been generated yet. publish takes ownership of `*variant` (clearing it)
+ * and returns the stored block, which is an equal one if another thread got
+ * there first; it returns NULL and leaves `*variant` with the caller when
+ * the entry has no room for it.
+ */
+const dg_map_t *dg_template_cache_find_variant(
+    dg_cached_template_t *entry,
+    int width,
+    int height
+);
+const dg_map_t *dg_template_cache_publish_variant(
+    dg_cached_template_t *entry,
+    int width,
+    int height,
+    dg_map_t *variant
+);
+
+/* Nearest multiple of `step` to `size`, and never below `step`. */
+int dg_template_variant_bucket_size(int size, int step);
+
+/*
+ * Generates one shared block of `template_map` at a bucket size, through the
+ * same nested generation per-room blocks use but without entrance openings.
+ * Rooms-and-mazes templates are rejected.
+ */
+dg_status_t dg_generate_room_template_variant(
+    const dg_map_t *template_map,
+    int width,
+    int height,
+    dg_map_t *out_map
+);
+
 dg_status_t dg_generate_internal_allow_small(
     const dg_generate_request_t *request,
     dg_map_t *out_map
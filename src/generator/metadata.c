@@ -879,7 +879,68 @@ static bool dg_corridor_endpoints_valid(const dg_map_t *map, const dg_corridor_m
     return true;
 }
 
-static dg_status_t dg_build_room_graph_metadata(
+/*
+ * True when the stored CSR is exactly what a rebuild from `degrees` would
+ * produce: matching spans, and each room's entries naming its incident
+ * corridors in ascending index order.
+ */
+static bool dg_room_graph_is_current(
+    const dg_map_t *map,
+    const int *degrees,
+    size_t neighbor_count
+)
+{
+    size_t i;
+    size_t running_index;
+
+    if (map->metadata.room_adjacency == NULL ||
+        map->metadata.room_adjacency_count != map->metadata.room_count ||
+        map->metadata.room_neighbor_count != neighbor_count ||
+        (neighbor_count > 0 && map->metadata.room_neighbors == NULL)) {
+        return false;
+    }
+
+    running_index = 0;
+    for (i = 0; i < map->metadata.room_count; ++i) {
+        const dg_room_adjacency_span_t *span = &map->metadata.room_adjacency[i];
+        int previous_corridor;
+        size_t n;
+
+        if (span->start_index != running_index || span->count != (size_t)degrees[i]) {
+            return false;
+        }
+
+        previous_corridor = -1;
+        for (n = 0; n < span->count; ++n) {
+            const dg_room_neighbor_t *neighbor = &map->metadata.room_neighbors[running_index + n];
+            const dg_corridor_metadata_t *corridor;
+
+            if (neighbor->corridor_index <= previous_corridor ||
+                (size_t)neighbor->corridor_index >= map->metadata.corridor_count) {
+                return false;
+            }
+
+            corridor = &map->metadata.corridors[neighbor->corridor_index];
+            if (!dg_corridor_endpoints_valid(map, corridor)) {
+                return false;
+            }
+            if ((size_t)corridor->from_room_id == i) {
+                if (corridor->to_room_id != neighbor->room_id) {
+                    return false;
+                }
+            } else if ((size_t)corridor->to_room_id != i ||
+                       corridor->from_room_id != neighbor->room_id) {
+                return false;
+            }
+            previous_corridor = neighbor->corridor_index;
+        }
+        running_index += span->count;
+    }
+
+    return true;
+}
+
+dg_status_t dg_build_room_graph_metadata(
     dg_map_t *map,
     size_t *out_leaf_room_count,
     size_t *out_corridor_total_length
@@ -905,14 +966,13 @@ static dg_status_t dg_build_room_graph_metadata(
     *out_leaf_room_count = 0;
     *out_corridor_total_length = 0;
 
-    free(map->metadata.room_adjacency);
-    free(map->metadata.room_neighbors);
-    map->metadata.room_adjacency = NULL;
-    map->metadata.room_adjacency_count = 0;
-    map->metadata.room_neighbors = NULL;
-    map->metadata.room_neighbor_count = 0;
-
     if (room_count == 0) {
+        free(map->metadata.room_adjacency);
+        free(map->metadata.room_neighbors);
+        map->metadata.room_adjacency = NULL;
+        map->metadata.room_adjacency_count = 0;
+        map->metadata.room_neighbors = NULL;
+        map->metadata.room_neighbor_count = 0;
         return DG_STATUS_OK;
     }
 
@@ -945,13 +1005,29 @@ static dg_status_t dg_build_room_graph_metadata(
         }
     }
 
+    neighbor_count = valid_corridor_count * 2;
+    *out_leaf_room_count = leaf_room_count;
+    *out_corridor_total_length = corridor_total_length;
+
+    /* Later passes (post-processing, templates) rarely touch the room graph. */
+    if (dg_room_graph_is_current(map, degrees, neighbor_count)) {
+        free(degrees);
+        return DG_STATUS_OK;
+    }
+
+    free(map->metadata.room_adjacency);
+    free(map->metadata.room_neighbors);
+    map->metadata.room_adjacency = NULL;
+    map->metadata.room_adjacency_count = 0;
+    map->metadata.room_neighbors = NULL;
+    map->metadata.room_neighbor_count = 0;
+
     room_adjacency = (dg_room_adjacency_span_t *)calloc(room_count, sizeof(dg_room_adjacency_span_t));
     if (room_adjacency == NULL) {
         free(degrees);
         return DG_STATUS_ALLOCATION_FAILED;
     }
 
-    neighbor_count = valid_corridor_count * 2;
     room_neighbors = NULL;
     if (neighbor_count > 0) {
         room_neighbors = (dg_room_neighbor_t *)malloc(neighbor_count * sizeof(dg_room_neighbor_t));
@@ -1013,9 +1089,6 @@ static dg_status_t dg_build_room_graph_metadata(
     map->metadata.room_adjacency_count = room_count;
     map->metadata.room_neighbors = room_neighbors;
     map->metadata.room_neighbor_count = neighbor_count;
-
-    *out_leaf_room_count = leaf_room_count;
-    *out_corridor_total_length = corridor_total_length;
     return DG_STATUS_OK;
 }
 
@@ -0,0 +1,220 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "internal.h"
+
+#if defined(DG_HAVE_PTHREADS)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define DG_PARALLEL_MAX_WORKERS 16
+/* Several chunks per worker, so threads that finish early take more. */
+#define DG_PARALLEL_CHUNKS_PER_WORKER 4u
+
+#if defined(DG_HAVE_PTHREADS)
+/*
+ * Process-wide worker pool, started on the first loop that can use it and
+ * kept for the life of the process. A loop publishes a job whose chunks are
+ * claimed one at a time by idle workers and by the calling thread, which
+ * then waits for the chunks others claimed. Jobs from concurrent callers
+ * queue up, so several dg_generate calls can share the pool.
+ */
+typedef struct dg_parallel_job {
+    dg_parallel_range_fn fn;
+    void *context;
+    size_t count;
+    size_t chunk_size;
+    size_t chunk_count;
+    size_t next_chunk;
+    size_t finished_chunks;
+    struct dg_parallel_job *next;
+} dg_parallel_job_t;
+
+/* Set while a thread runs a chunk, so nested loops stay on that thread. */
+static _Thread_local bool dg_parallel_in_chunk = false;
+
+static pthread_once_t dg_parallel_pool_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t dg_parallel_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dg_parallel_work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dg_parallel_work_finished = PTHREAD_COND_INITIALIZER;
+static dg_parallel_job_t *dg_parallel_queue_head = NULL;
+static dg_parallel_job_t *dg_parallel_queue_tail = NULL;
+static size_t dg_parallel_pool_size = 0u;
+
+/* Claims the next chunk of the queue head; the caller holds the pool mutex. */
+static dg_parallel_job_t *dg_parallel_claim_locked(size_t *out_chunk)
+{
+    dg_parallel_job_t *job = dg_parallel_queue_head;
+
+    if (job == NULL) {
+        return NULL;
+    }
+
+    *out_chunk = job->next_chunk;
+    job->next_chunk += 1u;
+    if (job->next_chunk == job->chunk_count) {
+        dg_parallel_queue_head = job->next;
+        if (dg_parallel_queue_head == NULL) {
+            dg_parallel_queue_tail = NULL;
+        }
+    }
+    return job;
+}
+
+/* Runs one claimed chunk without the pool mutex held. */
+static void dg_parallel_run_chunk(const dg_parallel_job_t *job, size_t chunk)
+{
+    size_t begin = chunk * job->chunk_size;
+    size_t end = begin + job->chunk_size;
+
+    if (end > job->count) {
+        end = job->count;
+    }
+    if (begin < end) {
+        dg_parallel_in_chunk = true;
+        job->fn(job->context, begin, end);
+        dg_parallel_in_chunk = false;
+    }
+}
+
+static void dg_parallel_finish_chunk_locked(dg_parallel_job_t *job)
+{
+    job->finished_chunks += 1u;
+    if (job->finished_chunks == job->chunk_count) {
+        (void)pthread_cond_broadcast(&dg_parallel_work_finished);
+    }
+}
+
+static void *dg_parallel_worker_main(void *arg)
+{
+    dg_parallel_job_t *job;
+    size_t chunk;
+
+    (void)arg;
+    (void)pthread_mutex_lock(&dg_parallel_pool_mutex);
+    for (;;) {
+        job = dg_parallel_claim_locked(&chunk);
+        if (job == NULL) {
+            (void)pthread_cond_wait(&dg_parallel_work_ready, &dg_parallel_pool_mutex);
+            continue;
+        }
+
+        (void)pthread_mutex_unlock(&dg_parallel_pool_mutex);
+        dg_parallel_run_chunk(job, chunk);
+        (void)pthread_mutex_lock(&dg_parallel_pool_mutex);
+        dg_parallel_finish_chunk_locked(job);
+    }
+    return NULL;
+}
+
+/* A worker that cannot be started just leaves the pool smaller. */
+static void dg_parallel_start_pool(void)
+{
+    pthread_t thread;
+    size_t target = dg_parallel_worker_count() - 1u;
+    size_t i;
+
+    for (i = 0; i < target; ++i) {
+        if (pthread_create(&thread, NULL, dg_parallel_worker_main, NULL) != 0) {
+            break;
+        }
+        (void)pthread_detach(thread);
+        dg_parallel_pool_size += 1u;
+    }
+}
+#endif
+
+size_t dg_parallel_worker_count(void)
+{
+#if defined(DG_HAVE_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (online <= 1) {
+        return 1u;
+    }
+    if (online > DG_PARALLEL_MAX_WORKERS) {
+        return DG_PARALLEL_MAX_WORKERS;
+    }
+    return (size_t)online;
+#else
+    return 1u;
+#endif
+}
+
+void dg_parallel_for(
+    size_t count,
+    size_t min_chunk,
+    dg_parallel_range_fn fn,
+    void *context
+)
+{
+#if defined(DG_HAVE_PTHREADS)
+    dg_parallel_job_t job;
+    dg_parallel_job_t *claimed;
+    size_t worker_count;
+    size_t chunk;
+#endif
+
+    if (fn == NULL || count == 0u) {
+        return;
+    }
+
+#if defined(DG_HAVE_PTHREADS)
+    if (min_chunk == 0u) {
+        min_chunk = 1u;
+    }
+
+    worker_count = 1u;
+    if (!dg_parallel_in_chunk && count / min_chunk > 1u) {
+        (void)pthread_once(&dg_parallel_pool_once, dg_parallel_start_pool);
+        worker_count = dg_parallel_pool_size + 1u;
+    }
+    if (count / min_chunk < worker_count) {
+        worker_count = count / min_chunk;
+    }
+    if (worker_count <= 1u) {
+        fn(context, 0u, count);
+        return;
+    }
+
+    job = (dg_parallel_job_t){0};
+    job.fn = fn;
+    job.context = context;
+    job.count = count;
+    job.chunk_size = count / (worker_count * DG_PARALLEL_CHUNKS_PER_WORKER);
+    if (job.chunk_size < min_chunk) {
+        job.chunk_size = min_chunk;
+    }
+    job.chunk_count = (count + job.chunk_size - 1u) / job.chunk_size;
+
+    (void)pthread_mutex_lock(&dg_parallel_pool_mutex);
+    if (dg_parallel_queue_tail != NULL) {
+        dg_parallel_queue_tail->next = &job;
+    } else {
+        dg_parallel_queue_head = &job;
+    }
+    dg_parallel_queue_tail = &job;
+    (void)pthread_cond_broadcast(&dg_parallel_work_ready);
+
+    /*
+     * The caller works through the queue too, so its own job always
+     * completes even when every worker is busy with other callers' chunks.
+     */
+    while (job.next_chunk < job.chunk_count) {
+        claimed = dg_parallel_claim_locked(&chunk);
+        (void)pthread_mutex_unlock(&dg_parallel_pool_mutex);
+        dg_parallel_run_chunk(claimed, chunk);
+        (void)pthread_mutex_lock(&dg_parallel_pool_mutex);
+        dg_parallel_finish_chunk_locked(claimed);
+    }
+    while (job.finished_chunks < job.chunk_count) {
+        (void)pthread_cond_wait(&dg_parallel_work_finished, &dg_parallel_pool_mutex);
+    }
+    (void)pthread_mutex_unlock(&dg_parallel_pool_mutex);
+#else
+    (void)min_chunk;
+    fn(context, 0u, count);
+#endif
+}
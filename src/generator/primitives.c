@@ -1,6 +1,9 @@
 #include "internal.h"
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 int dg_min_int(int a, int b)
 {
@@ -164,3 +167,45 @@ void dg_carve_brush(dg_map_t *map, int cx, int cy, int radius, dg_tile_t tile)
         }
     }
 }
+
+dg_status_t dg_build_room_coverage_mask(const dg_map_t *map, unsigned char **out_mask)
+{
+    unsigned char *mask;
+    size_t cell_count;
+    size_t i;
+
+    if (map == NULL || out_mask == NULL || map->width <= 0 || map->height <= 0) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    *out_mask = NULL;
+    if ((size_t)map->width > SIZE_MAX / (size_t)map->height) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    cell_count = (size_t)map->width * (size_t)map->height;
+    mask = (unsigned char *)calloc(cell_count, sizeof(unsigned char));
+    if (mask == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    for (i = 0; i < map->metadata.room_count && map->metadata.rooms != NULL; ++i) {
+        const dg_rect_t *room = &map->metadata.rooms[i].bounds;
+        int x0 = dg_max_int(room->x, 0);
+        int y0 = dg_max_int(room->y, 0);
+        int x1 = dg_min_int(room->x + room->width, map->width);
+        int y1 = dg_min_int(room->y + room->height, map->height);
+        int y;
+
+        if (x0 >= x1) {
+            continue;
+        }
+
+        for (y = y0; y < y1; ++y) {
+            memset(&mask[dg_tile_index(map, x0, y)], 1, (size_t)(x1 - x0));
+        }
+    }
+
+    *out_mask = mask;
+    return DG_STATUS_OK;
+}
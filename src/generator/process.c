@@ -2,6 +2,7 @@
 
 #include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
 static void dg_clear_process_step_diagnostics(dg_map_t *map)
 {
@@ -52,239 +53,303 @@ static bool dg_mul_int_checked(int value, int factor, int *out)
     return true;
 }
 
-static bool dg_point_in_any_room_bounds(const dg_map_t *map, int x, int y)
-{
-    size_t i;
+typedef struct dg_roughen_index_list {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+} dg_roughen_index_list_t;
+
+/*
+ * State shared by all depth levels of one corridor roughen. `candidate_mask`
+ * marks the wall tiles bordering corridor floor; `candidates` lists the same
+ * tiles in row-major order so every pass draws from the RNG exactly as a
+ * full-map scan would.
+ */
+typedef struct dg_roughen_state {
+    dg_map_t *map;
+    unsigned char *room_mask;
+    unsigned char *candidate_mask;
+    unsigned char *random_field;
+    dg_roughen_index_list_t candidates;
+    dg_roughen_index_list_t next_candidates;
+    dg_roughen_index_list_t carved;
+} dg_roughen_state_t;
 
-    if (map == NULL || map->metadata.rooms == NULL) {
-        return false;
-    }
+static dg_status_t dg_roughen_index_list_push(dg_roughen_index_list_t *list, size_t value)
+{
+    if (list->count == list->capacity) {
+        size_t new_capacity;
+        size_t *items;
 
-    for (i = 0; i < map->metadata.room_count; ++i) {
-        const dg_rect_t *room = &map->metadata.rooms[i].bounds;
+        new_capacity = list->capacity == 0 ? 64u : list->capacity * 2u;
+        if (new_capacity < list->capacity || new_capacity > (SIZE_MAX / sizeof(size_t))) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
 
-        if (x >= room->x &&
-            y >= room->y &&
-            x < room->x + room->width &&
-            y < room->y + room->height) {
-            return true;
+        items = (size_t *)realloc(list->items, new_capacity * sizeof(size_t));
+        if (items == NULL) {
+            return DG_STATUS_ALLOCATION_FAILED;
         }
+
+        list->items = items;
+        list->capacity = new_capacity;
     }
 
-    return false;
+    list->items[list->count++] = value;
+    return DG_STATUS_OK;
 }
 
-static bool dg_is_corridor_floor(const dg_map_t *map, int x, int y)
+static bool dg_roughen_is_corridor_floor(const dg_roughen_state_t *state, size_t index)
 {
-    if (map == NULL || !dg_map_in_bounds(map, x, y)) {
+    return dg_is_walkable_tile(state->map->tiles[index]) && state->room_mask[index] == 0u;
+}
+
+static bool dg_roughen_is_new_candidate(const dg_roughen_state_t *state, size_t index)
+{
+    const dg_map_t *map = state->map;
+    size_t width = (size_t)map->width;
+    size_t x = index % width;
+    size_t y = index / width;
+
+    if (x == 0u || y == 0u || x >= width - 1u || y >= (size_t)map->height - 1u) {
         return false;
     }
 
-    return dg_is_walkable_tile(dg_map_get_tile(map, x, y)) &&
-           !dg_point_in_any_room_bounds(map, x, y);
+    return state->candidate_mask[index] == 0u &&
+           map->tiles[index] == DG_TILE_WALL &&
+           state->room_mask[index] == 0u;
 }
 
-static bool dg_is_corridor_border_wall_candidate(const dg_map_t *map, int x, int y)
+static int dg_roughen_corridor_neighbor_count(const dg_roughen_state_t *state, size_t index)
 {
-    static const int k_dirs[4][2] = {
-        {1, 0},
-        {-1, 0},
-        {0, 1},
-        {0, -1}
-    };
-    int d;
-
-    if (map == NULL || !dg_map_in_bounds(map, x, y)) {
-        return false;
-    }
+    size_t width = (size_t)state->map->width;
 
-    if (dg_map_get_tile(map, x, y) != DG_TILE_WALL) {
-        return false;
-    }
+    return (dg_roughen_is_corridor_floor(state, index + 1u) ? 1 : 0) +
+           (dg_roughen_is_corridor_floor(state, index - 1u) ? 1 : 0) +
+           (dg_roughen_is_corridor_floor(state, index + width) ? 1 : 0) +
+           (dg_roughen_is_corridor_floor(state, index - width) ? 1 : 0);
+}
 
-    if (dg_point_in_any_room_bounds(map, x, y)) {
-        return false;
-    }
+static dg_status_t dg_roughen_collect_initial_candidates(dg_roughen_state_t *state)
+{
+    dg_map_t *map = state->map;
+    int x;
+    int y;
+
+    for (y = 1; y < map->height - 1; ++y) {
+        for (x = 1; x < map->width - 1; ++x) {
+            size_t index = dg_tile_index(map, x, y);
+            dg_status_t status;
 
-    for (d = 0; d < 4; ++d) {
-        int nx = x + k_dirs[d][0];
-        int ny = y + k_dirs[d][1];
+            if (map->tiles[index] != DG_TILE_WALL ||
+                state->room_mask[index] != 0u ||
+                dg_roughen_corridor_neighbor_count(state, index) == 0) {
+                continue;
+            }
 
-        if (dg_is_corridor_floor(map, nx, ny)) {
-            return true;
+            status = dg_roughen_index_list_push(&state->candidates, index);
+            if (status != DG_STATUS_OK) {
+                return status;
+            }
+            state->candidate_mask[index] = 1u;
         }
     }
 
-    return false;
+    return DG_STATUS_OK;
 }
 
-static dg_status_t dg_apply_corridor_roughen_pass(
-    dg_map_t *map,
-    int strength,
-    dg_corridor_roughen_mode_t mode,
-    dg_rng_t *rng,
-    size_t *out_carved_count
-)
+/*
+ * Carving only ever turns candidates into corridor floor, so the next level's
+ * candidates are the survivors of this level plus the fresh walls around the
+ * tiles just carved. Both inputs are row-major, and so are the four neighbor
+ * offsets of the carved list, which makes the next list a sorted merge of
+ * five streams.
+ */
+static dg_status_t dg_roughen_advance_frontier(dg_roughen_state_t *state)
 {
-    unsigned char *candidate_mask;
-    unsigned char *random_field;
-    size_t carved_count;
-    size_t candidate_count;
-    size_t cell_count;
-    int x;
-    int y;
+    const dg_roughen_index_list_t *carved = &state->carved;
+    dg_roughen_index_list_t *current = &state->candidates;
+    dg_roughen_index_list_t *next = &state->next_candidates;
+    size_t width = (size_t)state->map->width;
+    size_t cursors[5];
+    size_t i;
 
-    if (map == NULL || map->tiles == NULL || rng == NULL || out_carved_count == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
+    for (i = 0; i < carved->count; ++i) {
+        state->candidate_mask[carved->items[i]] = 0u;
     }
 
-    *out_carved_count = 0;
-    if (strength < 0 || strength > 100) {
-        return DG_STATUS_INVALID_ARGUMENT;
+    next->count = 0;
+    for (i = 0; i < 5; ++i) {
+        cursors[i] = 0;
     }
 
-    if (mode != DG_CORRIDOR_ROUGHEN_UNIFORM && mode != DG_CORRIDOR_ROUGHEN_ORGANIC) {
-        return DG_STATUS_INVALID_ARGUMENT;
-    }
+    while (true) {
+        size_t best_value = SIZE_MAX;
+        size_t best_stream = 5;
+        size_t s;
 
-    if (strength == 0 || map->width < 3 || map->height < 3) {
-        return DG_STATUS_OK;
-    }
+        for (s = 0; s < 5; ++s) {
+            size_t value;
 
-    carved_count = 0;
-    cell_count = (size_t)map->width * (size_t)map->height;
-    candidate_mask = (unsigned char *)calloc(cell_count, sizeof(unsigned char));
-    if (candidate_mask == NULL) {
-        return DG_STATUS_ALLOCATION_FAILED;
-    }
+            if (s == 0) {
+                while (cursors[0] < current->count &&
+                       state->candidate_mask[current->items[cursors[0]]] == 0u) {
+                    cursors[0] += 1;
+                }
+                if (cursors[0] >= current->count) {
+                    continue;
+                }
+                value = current->items[cursors[0]];
+            } else {
+                if (cursors[s] >= carved->count) {
+                    continue;
+                }
+                value = carved->items[cursors[s]];
+                if (s == 1) {
+                    value -= width;
+                } else if (s == 2) {
+                    value -= 1u;
+                } else if (s == 3) {
+                    value += 1u;
+                } else {
+                    value += width;
+                }
+            }
 
-    candidate_count = 0;
-    for (y = 1; y < map->height - 1; ++y) {
-        for (x = 1; x < map->width - 1; ++x) {
-            size_t index;
+            if (value < best_value) {
+                best_value = value;
+                best_stream = s;
+            }
+        }
 
-            if (!dg_is_corridor_border_wall_candidate(map, x, y)) {
+        if (best_stream == 5) {
+            break;
+        }
+        cursors[best_stream] += 1;
+
+        if (best_stream != 0) {
+            if (!dg_roughen_is_new_candidate(state, best_value)) {
                 continue;
             }
+            state->candidate_mask[best_value] = 1u;
+        }
 
-            index = dg_tile_index(map, x, y);
-            candidate_mask[index] = 1u;
-            candidate_count += 1;
+        {
+            dg_status_t status = dg_roughen_index_list_push(next, best_value);
+            if (status != DG_STATUS_OK) {
+                return status;
+            }
         }
     }
 
-    if (candidate_count == 0) {
-        free(candidate_mask);
+    {
+        dg_roughen_index_list_t swap = *current;
+        *current = *next;
+        *next = swap;
+    }
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_apply_corridor_roughen_pass(
+    dg_roughen_state_t *state,
+    int strength,
+    dg_corridor_roughen_mode_t mode,
+    dg_rng_t *rng
+)
+{
+    dg_map_t *map = state->map;
+    const dg_roughen_index_list_t *candidates = &state->candidates;
+    size_t width = (size_t)map->width;
+    size_t i;
+
+    state->carved.count = 0;
+    if (candidates->count == 0) {
         return DG_STATUS_OK;
     }
 
     if (mode == DG_CORRIDOR_ROUGHEN_UNIFORM) {
-        for (y = 1; y < map->height - 1; ++y) {
-            for (x = 1; x < map->width - 1; ++x) {
-                size_t index = dg_tile_index(map, x, y);
+        for (i = 0; i < candidates->count; ++i) {
+            size_t index = candidates->items[i];
 
-                if (candidate_mask[index] == 0u) {
-                    continue;
-                }
+            if (dg_rng_range(rng, 0, 99) < strength) {
+                dg_status_t status;
 
-                if (dg_rng_range(rng, 0, 99) < strength) {
-                    map->tiles[index] = DG_TILE_FLOOR;
-                    carved_count += 1;
+                map->tiles[index] = DG_TILE_FLOOR;
+                status = dg_roughen_index_list_push(&state->carved, index);
+                if (status != DG_STATUS_OK) {
+                    return status;
                 }
             }
         }
 
-        free(candidate_mask);
-        *out_carved_count = carved_count;
         return DG_STATUS_OK;
     }
 
-    random_field = (unsigned char *)calloc(cell_count, sizeof(unsigned char));
-    if (random_field == NULL) {
-        free(candidate_mask);
-        return DG_STATUS_ALLOCATION_FAILED;
+    for (i = 0; i < candidates->count; ++i) {
+        state->random_field[candidates->items[i]] = (unsigned char)dg_rng_range(rng, 0, 100);
     }
 
-    for (y = 1; y < map->height - 1; ++y) {
-        for (x = 1; x < map->width - 1; ++x) {
-            size_t index = dg_tile_index(map, x, y);
+    for (i = 0; i < candidates->count; ++i) {
+        size_t index = candidates->items[i];
+        size_t row;
+        int dy;
+        int dx;
+        int sum;
+        int weight;
+        int corridor_neighbors;
+        int threshold;
+        int averaged;
 
-            if (candidate_mask[index] == 0u) {
-                continue;
-            }
-
-            random_field[index] = (unsigned char)dg_rng_range(rng, 0, 100);
-        }
-    }
-
-    for (y = 1; y < map->height - 1; ++y) {
-        for (x = 1; x < map->width - 1; ++x) {
-            static const int k_dirs[4][2] = {
-                {1, 0},
-                {-1, 0},
-                {0, 1},
-                {0, -1}
-            };
-            size_t index = dg_tile_index(map, x, y);
-            int dy;
-            int dx;
-            int sum;
-            int weight;
-            int corridor_neighbors;
-            int threshold;
-            int averaged;
-            int d;
-
-            if (candidate_mask[index] == 0u) {
-                continue;
-            }
+        sum = (int)state->random_field[index] * 3;
+        weight = 3;
 
-            sum = (int)random_field[index] * 3;
-            weight = 3;
+        for (dy = -1; dy <= 1; ++dy) {
+            row = index + (size_t)dy * width;
+            for (dx = -1; dx <= 1; ++dx) {
+                size_t nindex;
 
-            for (dy = -1; dy <= 1; ++dy) {
-                for (dx = -1; dx <= 1; ++dx) {
-                    size_t nindex;
-
-                    if (dx == 0 && dy == 0) {
-                        continue;
-                    }
+                if (dx == 0 && dy == 0) {
+                    continue;
+                }
 
-                    nindex = dg_tile_index(map, x + dx, y + dy);
-                    if (candidate_mask[nindex] != 0u) {
-                        sum += (int)random_field[nindex];
-                        weight += 1;
-                    }
+                nindex = row + (size_t)dx;
+                if (state->candidate_mask[nindex] != 0u) {
+                    sum += (int)state->random_field[nindex];
+                    weight += 1;
                 }
             }
+        }
 
-            corridor_neighbors = 0;
-            for (d = 0; d < 4; ++d) {
-                int nx = x + k_dirs[d][0];
-                int ny = y + k_dirs[d][1];
+        corridor_neighbors = dg_roughen_corridor_neighbor_count(state, index);
 
-                if (dg_is_corridor_floor(map, nx, ny)) {
-                    corridor_neighbors += 1;
-                }
-            }
+        averaged = sum / weight;
+        threshold = strength + (corridor_neighbors * 8) + dg_rng_range(rng, -8, 8);
+        threshold = dg_clamp_int(threshold, 0, 100);
 
-            averaged = sum / weight;
-            threshold = strength + (corridor_neighbors * 8) + dg_rng_range(rng, -8, 8);
-            threshold = dg_clamp_int(threshold, 0, 100);
+        if (averaged <= threshold) {
+            dg_status_t status;
 
-            if (averaged <= threshold) {
-                map->tiles[index] = DG_TILE_FLOOR;
-                carved_count += 1;
+            map->tiles[index] = DG_TILE_FLOOR;
+            status = dg_roughen_index_list_push(&state->carved, index);
+            if (status != DG_STATUS_OK) {
+                return status;
             }
         }
     }
 
-    free(random_field);
-    free(candidate_mask);
-    *out_carved_count = carved_count;
     return DG_STATUS_OK;
 }
 
+static void dg_roughen_state_destroy(dg_roughen_state_t *state)
+{
+    free(state->room_mask);
+    free(state->candidate_mask);
+    free(state->random_field);
+    free(state->candidates.items);
+    free(state->next_candidates.items);
+    free(state->carved.items);
+}
+
 static dg_status_t dg_apply_corridor_roughen(
     dg_map_t *map,
     int strength,
@@ -293,7 +358,10 @@ static dg_status_t dg_apply_corridor_roughen(
     dg_rng_t *rng
 )
 {
+    dg_roughen_state_t state;
+    size_t cell_count;
     int depth;
+    dg_status_t status;
 
     if (map == NULL || map->tiles == NULL || rng == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
@@ -303,26 +371,51 @@ static dg_status_t dg_apply_corridor_roughen(
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    for (depth = 0; depth < max_depth; ++depth) {
-        size_t carved_count;
-        dg_status_t status;
+    if (strength < 0 || strength > 100) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
 
-        status = dg_apply_corridor_roughen_pass(
-            map,
-            strength,
-            mode,
-            rng,
-            &carved_count
-        );
-        if (status != DG_STATUS_OK) {
-            return status;
-        }
-        if (carved_count == 0) {
+    if (mode != DG_CORRIDOR_ROUGHEN_UNIFORM && mode != DG_CORRIDOR_ROUGHEN_ORGANIC) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (strength == 0 || map->width < 3 || map->height < 3) {
+        return DG_STATUS_OK;
+    }
+
+    memset(&state, 0, sizeof(state));
+    state.map = map;
+    cell_count = (size_t)map->width * (size_t)map->height;
+
+    status = dg_build_room_coverage_mask(map, &state.room_mask);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    state.candidate_mask = (unsigned char *)calloc(cell_count, sizeof(unsigned char));
+    if (mode == DG_CORRIDOR_ROUGHEN_ORGANIC) {
+        state.random_field = (unsigned char *)calloc(cell_count, sizeof(unsigned char));
+    }
+    if (state.candidate_mask == NULL ||
+        (mode == DG_CORRIDOR_ROUGHEN_ORGANIC && state.random_field == NULL)) {
+        dg_roughen_state_destroy(&state);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    status = dg_roughen_collect_initial_candidates(&state);
+    for (depth = 0; status == DG_STATUS_OK && depth < max_depth; ++depth) {
+        status = dg_apply_corridor_roughen_pass(&state, strength, mode, rng);
+        if (status != DG_STATUS_OK || state.carved.count == 0) {
             break;
         }
+
+        if (depth + 1 < max_depth) {
+            status = dg_roughen_advance_frontier(&state);
+        }
     }
 
-    return DG_STATUS_OK;
+    dg_roughen_state_destroy(&state);
+    return status;
 }
 
 static dg_status_t dg_scale_map_tiles(dg_map_t *map, int factor)
@@ -115,6 +115,7 @@ static dg_status_t dg_copy_room_type_definitions_to_snapshot(
             source_definitions[i].template_required_opening_matches;
         definitions[i].prefer_template_entrance_room =
             source_definitions[i].prefer_template_entrance_room;
+        definitions[i].template_variant_step = source_definitions[i].template_variant_step;
         definitions[i].constraints.area_min = source_definitions[i].constraints.area_min;
         definitions[i].constraints.area_max = source_definitions[i].constraints.area_max;
         definitions[i].constraints.degree_min = source_definitions[i].constraints.degree_min;
@@ -204,6 +204,13 @@ static dg_status_t dg_validate_room_type_definition(const dg_room_type_definitio
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
+    /* A shared variant cannot satisfy a per-room opening requirement. */
+    if (definition->template_variant_step < 0 ||
+        (definition->template_variant_step > 0 &&
+         definition->template_required_opening_matches > 0)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
     if (!dg_nonnegative_range_is_valid(
             definition->constraints.area_min,
             definition->constraints.area_max
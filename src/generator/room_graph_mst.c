@@ -2,6 +2,7 @@
 
 #include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct dg_room_graph_edge {
     int a;
@@ -66,9 +67,7 @@ static dg_status_t dg_room_graph_connect_rooms(
     dg_map_t *map,
     dg_rng_t *rng,
     int room_a,
-    int room_b,
-    unsigned char *connected,
-    size_t room_count
+    int room_b
 )
 {
     const dg_room_metadata_t *a;
@@ -77,24 +76,15 @@ static dg_status_t dg_room_graph_connect_rooms(
     dg_point_t cb;
     int corridor_length;
     int horizontal_first;
-    size_t index_ab;
-    size_t index_ba;
 
-    if (map == NULL || rng == NULL || connected == NULL ||
-        room_a < 0 || room_b < 0 || room_a == room_b) {
+    if (map == NULL || rng == NULL || room_a < 0 || room_b < 0 || room_a == room_b) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    if ((size_t)room_a >= room_count || (size_t)room_b >= room_count) {
+    if ((size_t)room_a >= map->metadata.room_count || (size_t)room_b >= map->metadata.room_count) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    index_ab = (size_t)room_a * room_count + (size_t)room_b;
-    index_ba = (size_t)room_b * room_count + (size_t)room_a;
-    if (connected[index_ab] != 0u || connected[index_ba] != 0u) {
-        return DG_STATUS_OK;
-    }
-
     a = &map->metadata.rooms[room_a];
     b = &map->metadata.rooms[room_b];
     ca = dg_room_graph_center(a);
@@ -114,48 +104,104 @@ static dg_status_t dg_room_graph_connect_rooms(
         return DG_STATUS_ALLOCATION_FAILED;
     }
 
-    connected[index_ab] = 1u;
-    connected[index_ba] = 1u;
     return DG_STATUS_OK;
 }
 
-static int dg_room_graph_edge_cmp(const void *left, const void *right)
+static int dg_room_graph_edge_field(const dg_room_graph_edge_t *edge, int field)
 {
-    const dg_room_graph_edge_t *a;
-    const dg_room_graph_edge_t *b;
-
-    a = (const dg_room_graph_edge_t *)left;
-    b = (const dg_room_graph_edge_t *)right;
-    if (a->weight < b->weight) {
-        return -1;
+    switch (field) {
+    case 0:
+        return edge->b;
+    case 1:
+        return edge->a;
+    default:
+        return edge->weight;
     }
-    if (a->weight > b->weight) {
-        return 1;
-    }
-    if (a->a < b->a) {
-        return -1;
+}
+
+/*
+ * Stable LSD radix sort of edges by (weight, a, b), all of which are
+ * non-negative. Byte passes run least-significant key first and are skipped
+ * when every edge shares the same digit. `scratch` must hold `edge_count`
+ * edges; the sorted result always ends up back in `edges`.
+ */
+static void dg_room_graph_radix_sort_edges(
+    dg_room_graph_edge_t *edges,
+    dg_room_graph_edge_t *scratch,
+    size_t edge_count
+)
+{
+    dg_room_graph_edge_t *src;
+    dg_room_graph_edge_t *dst;
+    int field;
+
+    if (edges == NULL || scratch == NULL || edge_count < 2u) {
+        return;
+    }
+
+    src = edges;
+    dst = scratch;
+    for (field = 0; field < 3; ++field) {
+        unsigned int max_value;
+        unsigned int shift;
+        size_t i;
+
+        max_value = 0u;
+        for (i = 0; i < edge_count; ++i) {
+            unsigned int value = (unsigned int)dg_room_graph_edge_field(&src[i], field);
+            if (value > max_value) {
+                max_value = value;
+            }
+        }
+
+        for (shift = 0u; shift < 32u && (max_value >> shift) != 0u; shift += 8u) {
+            size_t counts[256];
+            size_t offset;
+            unsigned int digit;
+            dg_room_graph_edge_t *tmp;
+
+            memset(counts, 0, sizeof(counts));
+            for (i = 0; i < edge_count; ++i) {
+                digit = ((unsigned int)dg_room_graph_edge_field(&src[i], field) >> shift) & 0xFFu;
+                counts[digit] += 1u;
+            }
+
+            digit = ((unsigned int)dg_room_graph_edge_field(&src[0], field) >> shift) & 0xFFu;
+            if (counts[digit] == edge_count) {
+                continue;
+            }
+
+            offset = 0u;
+            for (digit = 0u; digit < 256u; ++digit) {
+                size_t count = counts[digit];
+                counts[digit] = offset;
+                offset += count;
+            }
+
+            for (i = 0; i < edge_count; ++i) {
+                digit = ((unsigned int)dg_room_graph_edge_field(&src[i], field) >> shift) & 0xFFu;
+                dst[counts[digit]++] = src[i];
+            }
+
+            tmp = src;
+            src = dst;
+            dst = tmp;
+        }
     }
-    if (a->a > b->a) {
-        return 1;
+
+    if (src != edges) {
+        memcpy(edges, src, edge_count * sizeof(*edges));
     }
-    return a->b - b->b;
 }
 
 static int dg_room_graph_find_root(dg_room_graph_union_find_t *set, int index)
 {
-    int root;
-
-    root = index;
-    while (set[root].parent != root) {
-        root = set[root].parent;
-    }
     while (set[index].parent != index) {
-        int next = set[index].parent;
-        set[index].parent = root;
-        index = next;
+        set[index].parent = set[set[index].parent].parent;
+        index = set[index].parent;
     }
 
-    return root;
+    return index;
 }
 
 static int dg_room_graph_union_sets(
@@ -185,24 +231,10 @@ static int dg_room_graph_union_sets(
     return 1;
 }
 
-static int dg_room_graph_has_edge(
-    const dg_room_graph_edge_t *edges,
-    size_t edge_count,
-    int a,
-    int b
-)
-{
-    size_t i;
-
-    for (i = 0; i < edge_count; ++i) {
-        if (edges[i].a == a && edges[i].b == b) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
+/*
+ * Collects each room's nearest neighbors as candidate edges and returns them
+ * sorted by (weight, a, b) with duplicate pairs removed.
+ */
 static dg_status_t dg_room_graph_build_candidate_edges(
     const dg_map_t *map,
     int neighbor_candidates,
@@ -213,7 +245,11 @@ static dg_status_t dg_room_graph_build_candidate_edges(
     size_t room_count;
     size_t max_edges;
     dg_room_graph_edge_t *edges;
+    dg_room_graph_edge_t *scratch;
+    dg_point_t *centers;
     size_t edge_count;
+    size_t unique_count;
+    int keep_count;
     size_t i;
 
     if (map == NULL || out_edges == NULL || out_edge_count == NULL || neighbor_candidates < 1) {
@@ -227,33 +263,39 @@ static dg_status_t dg_room_graph_build_candidate_edges(
         return DG_STATUS_OK;
     }
 
-    max_edges = room_count * (size_t)neighbor_candidates;
-    if (max_edges < room_count - 1u) {
-        max_edges = room_count - 1u;
+    keep_count = dg_clamp_int(neighbor_candidates, 1, 8);
+    if (room_count > SIZE_MAX / ((size_t)keep_count * sizeof(*edges))) {
+        return DG_STATUS_ALLOCATION_FAILED;
     }
+    max_edges = room_count * (size_t)keep_count;
 
-    edges = (dg_room_graph_edge_t *)calloc(max_edges, sizeof(*edges));
-    if (edges == NULL) {
+    edges = (dg_room_graph_edge_t *)malloc(max_edges * sizeof(*edges));
+    scratch = (dg_room_graph_edge_t *)malloc(max_edges * sizeof(*scratch));
+    centers = (dg_point_t *)malloc(room_count * sizeof(*centers));
+    if (edges == NULL || scratch == NULL || centers == NULL) {
+        free(edges);
+        free(scratch);
+        free(centers);
         return DG_STATUS_ALLOCATION_FAILED;
     }
-    edge_count = 0u;
 
+    for (i = 0; i < room_count; ++i) {
+        centers[i] = dg_room_graph_center(&map->metadata.rooms[i]);
+    }
+
+    edge_count = 0u;
     for (i = 0; i < room_count; ++i) {
         int nearest_ids[8];
         int nearest_dist[8];
-        int keep_count;
         size_t j;
         int k;
 
-        keep_count = dg_clamp_int(neighbor_candidates, 1, 8);
         for (k = 0; k < keep_count; ++k) {
             nearest_ids[k] = -1;
             nearest_dist[k] = INT_MAX;
         }
 
         for (j = 0; j < room_count; ++j) {
-            dg_point_t ci;
-            dg_point_t cj;
             int dx;
             int dy;
             int dist;
@@ -262,11 +304,12 @@ static dg_status_t dg_room_graph_build_candidate_edges(
                 continue;
             }
 
-            ci = dg_room_graph_center(&map->metadata.rooms[i]);
-            cj = dg_room_graph_center(&map->metadata.rooms[j]);
-            dx = ci.x - cj.x;
-            dy = ci.y - cj.y;
+            dx = centers[i].x - centers[j].x;
+            dy = centers[i].y - centers[j].y;
             dist = dx * dx + dy * dy;
+            if (dist >= nearest_dist[keep_count - 1]) {
+                continue;
+            }
 
             for (k = 0; k < keep_count; ++k) {
                 if (dist < nearest_dist[k]) {
@@ -298,28 +341,6 @@ static dg_status_t dg_room_graph_build_candidate_edges(
                 b = tmp;
             }
 
-            if (dg_room_graph_has_edge(edges, edge_count, a, b) != 0) {
-                continue;
-            }
-
-            if (edge_count >= max_edges) {
-                dg_room_graph_edge_t *grown;
-                size_t new_max;
-
-                new_max = max_edges * 2u;
-                if (new_max <= max_edges) {
-                    free(edges);
-                    return DG_STATUS_ALLOCATION_FAILED;
-                }
-                grown = (dg_room_graph_edge_t *)realloc(edges, new_max * sizeof(*edges));
-                if (grown == NULL) {
-                    free(edges);
-                    return DG_STATUS_ALLOCATION_FAILED;
-                }
-                edges = grown;
-                max_edges = new_max;
-            }
-
             edges[edge_count].a = a;
             edges[edge_count].b = b;
             edges[edge_count].weight = nearest_dist[k];
@@ -327,6 +348,25 @@ static dg_status_t dg_room_graph_build_candidate_edges(
             edge_count += 1u;
         }
     }
+    free(centers);
+
+    /*
+     * A pair picked from both ends has the same weight, so after sorting its
+     * copies are adjacent and a single pass drops them.
+     */
+    dg_room_graph_radix_sort_edges(edges, scratch, edge_count);
+    free(scratch);
+
+    unique_count = 0u;
+    for (i = 0; i < edge_count; ++i) {
+        if (unique_count > 0u &&
+            edges[unique_count - 1u].a == edges[i].a &&
+            edges[unique_count - 1u].b == edges[i].b) {
+            continue;
+        }
+        edges[unique_count++] = edges[i];
+    }
+    edge_count = unique_count;
 
     if (edge_count == 0u) {
         for (i = 1u; i < room_count; ++i) {
@@ -359,7 +399,6 @@ dg_status_t dg_generate_room_graph_impl(
     int attempt;
     dg_room_graph_edge_t *edges;
     size_t edge_count;
-    unsigned char *connected;
     dg_room_graph_union_find_t *union_find;
     size_t room_count;
     size_t i;
@@ -451,12 +490,9 @@ dg_status_t dg_generate_room_graph_impl(
         return DG_STATUS_GENERATION_FAILED;
     }
 
-    connected = (unsigned char *)calloc(room_count * room_count, sizeof(*connected));
     union_find = (dg_room_graph_union_find_t *)calloc(room_count, sizeof(*union_find));
-    if (connected == NULL || union_find == NULL) {
+    if (union_find == NULL) {
         free(edges);
-        free(connected);
-        free(union_find);
         return DG_STATUS_ALLOCATION_FAILED;
     }
 
@@ -465,8 +501,6 @@ dg_status_t dg_generate_room_graph_impl(
         union_find[i].rank = 0;
     }
 
-    qsort(edges, edge_count, sizeof(*edges), dg_room_graph_edge_cmp);
-
     mst_edges = 0;
     for (i = 0u; i < edge_count; ++i) {
         int a = edges[i].a;
@@ -475,10 +509,9 @@ dg_status_t dg_generate_room_graph_impl(
             continue;
         }
 
-        status = dg_room_graph_connect_rooms(map, rng, a, b, connected, room_count);
+        status = dg_room_graph_connect_rooms(map, rng, a, b);
         if (status != DG_STATUS_OK) {
             free(edges);
-            free(connected);
             free(union_find);
             return status;
         }
@@ -491,7 +524,6 @@ dg_status_t dg_generate_room_graph_impl(
 
     if ((size_t)mst_edges < room_count - 1u) {
         free(edges);
-        free(connected);
         free(union_find);
         return DG_STATUS_GENERATION_FAILED;
     }
@@ -505,24 +537,16 @@ dg_status_t dg_generate_room_graph_impl(
             continue;
         }
 
-        status = dg_room_graph_connect_rooms(
-            map,
-            rng,
-            edges[i].a,
-            edges[i].b,
-            connected,
-            room_count
-        );
+        /* Candidate pairs are unique, so no pair is ever carved twice. */
+        status = dg_room_graph_connect_rooms(map, rng, edges[i].a, edges[i].b);
         if (status != DG_STATUS_OK) {
             free(edges);
-            free(connected);
             free(union_find);
             return status;
         }
     }
 
     free(edges);
-    free(connected);
     free(union_find);
     return DG_STATUS_OK;
 }
@@ -28,6 +28,8 @@ static void dg_clear_room_type_assignment_diagnostics(dg_map_t *map)
     map->metadata.diagnostics.room_type_min_miss_count = 0;
     map->metadata.diagnostics.room_type_max_excess_count = 0;
     map->metadata.diagnostics.room_type_target_miss_count = 0;
+    map->metadata.diagnostics.room_type_min_shortfall = 0;
+    map->metadata.diagnostics.room_type_short_type_id = DG_ROOM_TYPE_UNASSIGNED;
 }
 
 static dg_status_t dg_populate_room_type_assignment_diagnostics(
@@ -134,31 +136,6 @@ static dg_status_t dg_populate_room_type_assignment_diagnostics(
     return DG_STATUS_OK;
 }
 
-static bool dg_corridor_endpoints_are_valid(const dg_map_t *map, const dg_corridor_metadata_t *corridor)
-{
-    if (map == NULL || corridor == NULL) {
-        return false;
-    }
-
-    if (corridor->from_room_id < 0 || corridor->to_room_id < 0) {
-        return false;
-    }
-
-    if ((size_t)corridor->from_room_id >= map->metadata.room_count) {
-        return false;
-    }
-
-    if ((size_t)corridor->to_room_id >= map->metadata.room_count) {
-        return false;
-    }
-
-    if (corridor->from_room_id == corridor->to_room_id) {
-        return false;
-    }
-
-    return true;
-}
-
 static bool dg_value_in_constraint_range(size_t value, int min_value, int max_value)
 {
     if (min_value >= 0 && value < (size_t)min_value) {
@@ -204,27 +181,7 @@ static bool dg_compute_room_border_distance(
     return true;
 }
 
-static size_t dg_room_degree_from_corridors(const dg_map_t *map, size_t room_index)
-{
-    size_t i;
-    size_t degree;
-
-    degree = 0;
-    for (i = 0; i < map->metadata.corridor_count; ++i) {
-        const dg_corridor_metadata_t *corridor = &map->metadata.corridors[i];
-
-        if (!dg_corridor_endpoints_are_valid(map, corridor)) {
-            continue;
-        }
-
-        if ((size_t)corridor->from_room_id == room_index || (size_t)corridor->to_room_id == room_index) {
-            degree += 1;
-        }
-    }
-
-    return degree;
-}
-
+/* Reads degrees from the CSR room graph, which the caller has already built. */
 static dg_status_t dg_compute_room_features(const dg_map_t *map, dg_room_feature_t **out_features)
 {
     size_t room_count;
@@ -241,6 +198,10 @@ static dg_status_t dg_compute_room_features(const dg_map_t *map, dg_room_feature
         return DG_STATUS_OK;
     }
 
+    if (map->metadata.room_adjacency == NULL || map->metadata.room_adjacency_count != room_count) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
     features = (dg_room_feature_t *)calloc(room_count, sizeof(dg_room_feature_t));
     if (features == NULL) {
         return DG_STATUS_ALLOCATION_FAILED;
@@ -261,12 +222,7 @@ static dg_status_t dg_compute_room_features(const dg_map_t *map, dg_room_feature
 
         features[i].area = (size_t)bounds->width * (size_t)bounds->height;
         features[i].graph_depth = SIZE_MAX;
-
-        if (map->metadata.room_adjacency != NULL && map->metadata.room_adjacency_count == room_count) {
-            features[i].degree = map->metadata.room_adjacency[i].count;
-        } else {
-            features[i].degree = dg_room_degree_from_corridors(map, i);
-        }
+        features[i].degree = map->metadata.room_adjacency[i].count;
 
         if (!dg_compute_room_border_distance(map, bounds, &features[i].border_distance)) {
             free(features);
@@ -296,6 +252,10 @@ static dg_status_t dg_populate_graph_depths(
         return DG_STATUS_OK;
     }
 
+    if (map->metadata.room_adjacency == NULL || map->metadata.room_adjacency_count != room_count) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
     queue = (size_t *)malloc(room_count * sizeof(size_t));
     if (queue == NULL) {
         return DG_STATUS_ALLOCATION_FAILED;
@@ -309,63 +269,33 @@ static dg_status_t dg_populate_graph_depths(
     while (head < tail) {
         size_t current = queue[head++];
         size_t current_depth = features[current].graph_depth;
+        const dg_room_adjacency_span_t *span = &map->metadata.room_adjacency[current];
+        size_t n;
 
-        if (map->metadata.room_adjacency != NULL &&
-            map->metadata.room_neighbors != NULL &&
-            map->metadata.room_adjacency_count == room_count) {
-            const dg_room_adjacency_span_t *span = &map->metadata.room_adjacency[current];
-            size_t n;
+        if (span->start_index > map->metadata.room_neighbor_count ||
+            span->count > map->metadata.room_neighbor_count ||
+            span->count > map->metadata.room_neighbor_count - span->start_index) {
+            free(queue);
+            return DG_STATUS_GENERATION_FAILED;
+        }
+
+        for (n = 0; n < span->count; ++n) {
+            const dg_room_neighbor_t *neighbor =
+                &map->metadata.room_neighbors[span->start_index + n];
+            size_t next_room;
 
-            if (span->start_index > map->metadata.room_neighbor_count ||
-                span->count > map->metadata.room_neighbor_count ||
-                span->count > map->metadata.room_neighbor_count - span->start_index) {
+            if (neighbor->room_id < 0 || (size_t)neighbor->room_id >= room_count) {
                 free(queue);
                 return DG_STATUS_GENERATION_FAILED;
             }
 
-            for (n = 0; n < span->count; ++n) {
-                const dg_room_neighbor_t *neighbor = &map->metadata.room_neighbors[span->start_index + n];
-                size_t next_room;
-
-                if (neighbor->room_id < 0 || (size_t)neighbor->room_id >= room_count) {
-                    free(queue);
-                    return DG_STATUS_GENERATION_FAILED;
-                }
-
-                next_room = (size_t)neighbor->room_id;
-                if (features[next_room].graph_depth != SIZE_MAX) {
-                    continue;
-                }
-
-                features[next_room].graph_depth = current_depth + 1;
-                queue[tail++] = next_room;
+            next_room = (size_t)neighbor->room_id;
+            if (features[next_room].graph_depth != SIZE_MAX) {
+                continue;
             }
-        } else {
-            size_t c;
-
-            for (c = 0; c < map->metadata.corridor_count; ++c) {
-                const dg_corridor_metadata_t *corridor = &map->metadata.corridors[c];
-                size_t next_room;
-
-                if (!dg_corridor_endpoints_are_valid(map, corridor)) {
-                    continue;
-                }
-
-                if ((size_t)corridor->from_room_id == current) {
-                    next_room = (size_t)corridor->to_room_id;
-                } else if ((size_t)corridor->to_room_id == current) {
-                    next_room = (size_t)corridor->from_room_id;
-                } else {
-                    continue;
-                }
-
-                if (features[next_room].graph_depth != SIZE_MAX) {
-                    continue;
-                }
 
-                features[next_room].graph_depth = current_depth + 1;
-                queue[tail++] = next_room;
-            }
+            features[next_room].graph_depth = current_depth + 1;
+            queue[tail++] = next_room;
         }
     }
 
@@ -470,65 +400,176 @@ static size_t dg_find_default_type_enabled_index(
     return SIZE_MAX;
 }
 
-static bool dg_choose_best_room_for_type(
-    dg_rng_t *rng,
+/*
+ * Candidate rooms for one type during the minimum-count pass, held in a max
+ * tournament tree over the type's eligible rooms in room order. Besides the
+ * subtree maximum, each inner node caches how many rooms of its right child
+ * tie the running maximum when scanned after its left child. That is the
+ * number of RNG draws the reservoir tie-break below spends there, so a pick
+ * reproduces the draws of a full in-order scan in O(log^2 n) plus the size
+ * of the winning tie group. Rooms are removed by setting their leaf to
+ * DG_CANDIDATE_REMOVED; scores never reach it since weights and biases are
+ * bounded.
+ */
+#define DG_CANDIDATE_REMOVED INT64_MIN
+
+typedef struct dg_room_candidate_tree {
+    size_t leaf_base;
+    int64_t *max_scores;
+    size_t *max_counts;
+    size_t *right_ties;
+    const size_t *rooms;
+    size_t room_count;
+} dg_room_candidate_tree_t;
+
+/* Rooms under `node` whose score equals the running maximum when reached. */
+static size_t dg_candidate_tree_count_ties(
+    const dg_room_candidate_tree_t *tree,
+    size_t node,
+    int64_t running_max
+)
+{
+    size_t ties;
+
+    ties = 0;
+    while (tree->max_scores[node] != DG_CANDIDATE_REMOVED &&
+           tree->max_scores[node] >= running_max) {
+        if (node >= tree->leaf_base) {
+            return ties + ((tree->max_scores[node] == running_max) ? 1u : 0u);
+        }
+
+        if (running_max > tree->max_scores[node * 2u]) {
+            node = node * 2u + 1u;
+        } else {
+            ties += tree->right_ties[node];
+            node = node * 2u;
+        }
+    }
+
+    return ties;
+}
+
+static void dg_candidate_tree_pull(dg_room_candidate_tree_t *tree, size_t node)
+{
+    int64_t left = tree->max_scores[node * 2u];
+    int64_t right = tree->max_scores[node * 2u + 1u];
+
+    tree->max_scores[node] = (left > right) ? left : right;
+    tree->max_counts[node] = ((left >= right) ? tree->max_counts[node * 2u] : 0u) +
+                             ((right >= left) ? tree->max_counts[node * 2u + 1u] : 0u);
+    tree->right_ties[node] = dg_candidate_tree_count_ties(tree, node * 2u + 1u, left);
+}
+
+static void dg_candidate_tree_build(
+    dg_room_candidate_tree_t *tree,
     const dg_room_feature_t *features,
     const dg_room_type_definition_t *type_definition,
-    const bool *eligibility_matrix,
+    const size_t *rooms,
     size_t room_count,
-    size_t enabled_type_count,
-    size_t enabled_type_index,
     const size_t *room_assignments,
-    const size_t *eligible_type_counts_by_room,
-    size_t *out_room_index
+    const size_t *eligible_type_counts_by_room
 )
 {
-    size_t room_index;
-    bool found;
-    int64_t best_score;
-    size_t tie_count;
+    size_t leaf_base;
+    size_t i;
 
-    if (out_room_index == NULL) {
-        return false;
+    leaf_base = 1;
+    while (leaf_base < room_count) {
+        leaf_base *= 2u;
     }
 
-    found = false;
-    best_score = INT64_MIN;
-    tie_count = 0;
-
-    for (room_index = 0; room_index < room_count; ++room_index) {
-        int64_t score;
+    tree->leaf_base = leaf_base;
+    tree->rooms = rooms;
+    tree->room_count = room_count;
+    for (i = 0; i < leaf_base; ++i) {
+        int64_t score = DG_CANDIDATE_REMOVED;
 
-        if (room_assignments[room_index] != SIZE_MAX) {
-            continue;
+        /* Rooms taken by earlier types are dropped here rather than tracked. */
+        if (i < room_count && room_assignments[rooms[i]] == SIZE_MAX) {
+            score = dg_room_type_base_score(&features[rooms[i]], type_definition);
+            if (eligible_type_counts_by_room[rooms[i]] > 0) {
+                score += 100000LL / (int64_t)eligible_type_counts_by_room[rooms[i]];
+            }
         }
+        tree->max_scores[leaf_base + i] = score;
+        tree->max_counts[leaf_base + i] = 1u;
+    }
 
-        if (!eligibility_matrix[room_index * enabled_type_count + enabled_type_index]) {
-            continue;
-        }
+    for (i = leaf_base - 1u; i > 0; --i) {
+        dg_candidate_tree_pull(tree, i);
+    }
+}
 
-        score = dg_room_type_base_score(&features[room_index], type_definition);
-        if (eligible_type_counts_by_room[room_index] > 0) {
-            score += 100000LL / (int64_t)eligible_type_counts_by_room[room_index];
-        }
+static void dg_candidate_tree_remove(dg_room_candidate_tree_t *tree, size_t position)
+{
+    size_t node = tree->leaf_base + position;
 
-        if (!found || score > best_score) {
-            found = true;
-            best_score = score;
-            *out_room_index = room_index;
-            tie_count = 1;
-            continue;
+    tree->max_scores[node] = DG_CANDIDATE_REMOVED;
+    for (node /= 2u; node > 0; node /= 2u) {
+        dg_candidate_tree_pull(tree, node);
+    }
+}
+
+/* Position of the `rank`-th (0-based, in room order) room holding the top score. */
+static size_t dg_candidate_tree_find_best(const dg_room_candidate_tree_t *tree, size_t rank)
+{
+    int64_t best_score = tree->max_scores[1];
+    size_t node = 1;
+
+    while (node < tree->leaf_base) {
+        node *= 2u;
+        if (tree->max_scores[node] == best_score) {
+            if (rank < tree->max_counts[node]) {
+                continue;
+            }
+            rank -= tree->max_counts[node];
         }
+        node += 1u;
+    }
 
-        if (score == best_score) {
-            tie_count += 1;
-            if (rng != NULL && (((uint64_t)dg_rng_next_u32(rng)) % (uint64_t)tie_count == 0u)) {
-                *out_room_index = room_index;
+    return node - tree->leaf_base;
+}
+
+/*
+ * Picks the best remaining room exactly as a scan in room order would: the
+ * first room with the top score, replaced by the k-th such room when a draw
+ * modulo k is zero, after the draws spent on earlier running-maximum ties.
+ */
+static bool dg_choose_best_room_for_type(
+    dg_rng_t *rng,
+    dg_room_candidate_tree_t *tree,
+    size_t *out_room_index
+)
+{
+    size_t tie_group_size;
+    size_t skipped_draws;
+    size_t selected_rank;
+    size_t position;
+    size_t k;
+
+    if (out_room_index == NULL || tree->max_scores[1] == DG_CANDIDATE_REMOVED) {
+        return false;
+    }
+
+    tie_group_size = tree->max_counts[1];
+    selected_rank = 0;
+    if (rng != NULL) {
+        skipped_draws = dg_candidate_tree_count_ties(tree, 1, DG_CANDIDATE_REMOVED) -
+                        (tie_group_size - 1u);
+        for (k = 0; k < skipped_draws; ++k) {
+            (void)dg_rng_next_u32(rng);
+        }
+        for (k = 1; k < tie_group_size; ++k) {
+            if (((uint64_t)dg_rng_next_u32(rng)) % (uint64_t)(k + 1u) == 0u) {
+                selected_rank = k;
             }
         }
     }
 
-    return found;
+    position = dg_candidate_tree_find_best(tree, selected_rank);
+    *out_room_index = tree->rooms[position];
+    dg_candidate_tree_remove(tree, position);
+    return true;
 }
 
 static size_t dg_choose_best_type_for_room(
@@ -537,12 +578,12 @@ static size_t dg_choose_best_type_for_room(
     size_t room_index,
     const dg_room_type_assignment_config_t *config,
     const size_t *enabled_type_indices,
-    size_t enabled_type_count,
-    const bool *eligibility_matrix,
+    const size_t *eligible_types,
+    size_t eligible_type_count,
     const size_t *assigned_counts_by_enabled_type
 )
 {
-    size_t enabled_type_index;
+    size_t e;
     size_t selected_enabled_type_index;
     bool found;
     int64_t best_score;
@@ -553,14 +594,11 @@ static size_t dg_choose_best_type_for_room(
     tie_count = 0;
     selected_enabled_type_index = SIZE_MAX;
 
-    for (enabled_type_index = 0; enabled_type_index < enabled_type_count; ++enabled_type_index) {
+    for (e = 0; e < eligible_type_count; ++e) {
+        size_t enabled_type_index = eligible_types[e];
         const dg_room_type_definition_t *type_definition;
         int64_t score;
 
-        if (!eligibility_matrix[room_index * enabled_type_count + enabled_type_index]) {
-            continue;
-        }
-
         type_definition = &config->definitions[enabled_type_indices[enabled_type_index]];
         if (!dg_type_has_capacity(type_definition, assigned_counts_by_enabled_type[enabled_type_index])) {
             continue;
@@ -648,17 +686,16 @@ static void dg_sort_enabled_types_by_minimum_slack(
     }
 }
 
+/* Coverage checks for strict mode; minimum counts are checked by dg_match_room_type_minimums. */
 static dg_status_t dg_validate_strict_assignment_feasibility(
     const dg_room_type_assignment_config_t *config,
     const size_t *enabled_type_indices,
     size_t enabled_type_count,
-    const size_t *eligible_counts_by_enabled_type,
     const size_t *eligible_type_counts_by_room,
     size_t room_count
 )
 {
     size_t i;
-    size_t total_minimum;
     bool has_unbounded_max;
     size_t total_maximum;
 
@@ -670,23 +707,13 @@ static dg_status_t dg_validate_strict_assignment_feasibility(
         return DG_STATUS_GENERATION_FAILED;
     }
 
-    total_minimum = 0;
     has_unbounded_max = false;
     total_maximum = 0;
 
     for (i = 0; i < enabled_type_count; ++i) {
         const dg_room_type_definition_t *type_definition;
-        size_t eligible_count;
 
         type_definition = &config->definitions[enabled_type_indices[i]];
-        eligible_count = eligible_counts_by_enabled_type[i];
-
-        if ((size_t)type_definition->min_count > eligible_count) {
-            return DG_STATUS_GENERATION_FAILED;
-        }
-
-        total_minimum += (size_t)type_definition->min_count;
-
         if (type_definition->max_count == -1) {
             has_unbounded_max = true;
         } else {
@@ -694,10 +721,6 @@ static dg_status_t dg_validate_strict_assignment_feasibility(
         }
     }
 
-    if (total_minimum > room_count) {
-        return DG_STATUS_GENERATION_FAILED;
-    }
-
     if (config->policy.allow_untyped_rooms == 0) {
         for (i = 0; i < room_count; ++i) {
             if (eligible_type_counts_by_room[i] == 0) {
@@ -713,6 +736,239 @@ static dg_status_t dg_validate_strict_assignment_feasibility(
     return DG_STATUS_OK;
 }
 
+/*
+ * Buffers for one assignment run. Eligibility is kept sparse in both
+ * directions: `eligible_types` lists each room's eligible enabled types
+ * (CSR by room), `type_rooms` each enabled type's eligible rooms (CSR by
+ * type), both in ascending order.
+ */
+typedef struct dg_room_type_assignment_workspace {
+    dg_room_feature_t *features;
+    size_t *enabled_type_indices;
+    size_t *eligible_counts_by_enabled_type;
+    size_t *eligible_type_counts_by_room;
+    size_t *eligible_type_offsets;
+    size_t *eligible_types;
+    size_t *type_room_offsets;
+    size_t *type_rooms;
+    size_t *assigned_counts_by_enabled_type;
+    size_t *room_assignments;
+    size_t *ordered_enabled_indices;
+    int64_t *candidate_max_scores;
+    size_t *candidate_max_counts;
+    size_t *candidate_right_ties;
+    size_t *minimum_counts;
+    size_t *matched_type_by_room;
+    size_t *matched_counts;
+    size_t *match_levels;
+    size_t *match_arcs;
+    size_t *match_queue;
+} dg_room_type_assignment_workspace_t;
+
+static void dg_release_room_type_assignment_workspace(
+    dg_room_type_assignment_workspace_t *workspace
+)
+{
+    free(workspace->match_queue);
+    free(workspace->match_arcs);
+    free(workspace->match_levels);
+    free(workspace->matched_counts);
+    free(workspace->matched_type_by_room);
+    free(workspace->minimum_counts);
+    free(workspace->candidate_right_ties);
+    free(workspace->candidate_max_counts);
+    free(workspace->candidate_max_scores);
+    free(workspace->ordered_enabled_indices);
+    free(workspace->room_assignments);
+    free(workspace->assigned_counts_by_enabled_type);
+    free(workspace->type_rooms);
+    free(workspace->type_room_offsets);
+    free(workspace->eligible_types);
+    free(workspace->eligible_type_offsets);
+    free(workspace->eligible_type_counts_by_room);
+    free(workspace->eligible_counts_by_enabled_type);
+    free(workspace->enabled_type_indices);
+    free(workspace->features);
+    *workspace = (dg_room_type_assignment_workspace_t){0};
+}
+
+static dg_status_t dg_build_room_type_eligibility(
+    const dg_room_type_assignment_config_t *config,
+    size_t room_count,
+    size_t enabled_type_count,
+    dg_room_type_assignment_workspace_t *ws
+)
+{
+    size_t i;
+    size_t t;
+    size_t total;
+    size_t largest;
+    size_t leaf_base;
+    size_t *write_cursor;
+
+    for (i = 0; i < room_count; ++i) {
+        for (t = 0; t < enabled_type_count; ++t) {
+            const dg_room_type_definition_t *type_definition =
+                &config->definitions[ws->enabled_type_indices[t]];
+
+            if (dg_room_matches_type_constraints(&ws->features[i], type_definition)) {
+                ws->eligible_counts_by_enabled_type[t] += 1;
+                ws->eligible_type_counts_by_room[i] += 1;
+            }
+        }
+    }
+
+    total = 0;
+    for (i = 0; i < room_count; ++i) {
+        ws->eligible_type_offsets[i] = total;
+        total += ws->eligible_type_counts_by_room[i];
+    }
+    ws->eligible_type_offsets[room_count] = total;
+
+    largest = 0;
+    ws->type_room_offsets[0] = 0;
+    for (t = 0; t < enabled_type_count; ++t) {
+        ws->type_room_offsets[t + 1u] =
+            ws->type_room_offsets[t] + ws->eligible_counts_by_enabled_type[t];
+        if (ws->eligible_counts_by_enabled_type[t] > largest) {
+            largest = ws->eligible_counts_by_enabled_type[t];
+        }
+    }
+
+    leaf_base = 1;
+    while (leaf_base < largest) {
+        leaf_base *= 2u;
+    }
+
+    ws->eligible_types = (size_t *)malloc((total > 0 ? total : 1u) * sizeof(size_t));
+    ws->type_rooms = (size_t *)malloc((total > 0 ? total : 1u) * sizeof(size_t));
+    ws->candidate_max_scores = (int64_t *)malloc(leaf_base * 2u * sizeof(int64_t));
+    ws->candidate_max_counts = (size_t *)malloc(leaf_base * 2u * sizeof(size_t));
+    ws->candidate_right_ties = (size_t *)malloc(leaf_base * 2u * sizeof(size_t));
+    write_cursor = (size_t *)malloc(enabled_type_count * sizeof(size_t));
+    if (ws->eligible_types == NULL || ws->type_rooms == NULL || ws->candidate_max_scores == NULL ||
+        ws->candidate_max_counts == NULL || ws->candidate_right_ties == NULL ||
+        write_cursor == NULL) {
+        free(write_cursor);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    /* Second pass fills both lists; rooms go out in order, so each type's list is sorted. */
+    memcpy(write_cursor, ws->type_room_offsets, enabled_type_count * sizeof(size_t));
+    for (i = 0; i < room_count; ++i) {
+        size_t out = ws->eligible_type_offsets[i];
+
+        for (t = 0; t < enabled_type_count; ++t) {
+            const dg_room_type_definition_t *type_definition =
+                &config->definitions[ws->enabled_type_indices[t]];
+
+            if (dg_room_matches_type_constraints(&ws->features[i], type_definition)) {
+                ws->eligible_types[out++] = t;
+                ws->type_rooms[write_cursor[t]++] = i;
+            }
+        }
+    }
+
+    free(write_cursor);
+    return DG_STATUS_OK;
+}
+
+/*
+ * Exact check for the min_count quotas: a maximum matching of rooms to
+ * types where type t may take up to minimum_counts[t] of its eligible
+ * rooms (Hopcroft-Karp with capacitated types, i.e. Dinic on the unit
+ * network). Every minimum can be met at once iff the matching saturates all
+ * types. `matched_type_by_room` and `matched_counts` may start from any
+ * partial matching, such as the greedy picks, and are augmented in place;
+ * the return value is the number of rooms still missing.
+ */
+#define DG_MATCH_UNREACHED SIZE_MAX
+
+static bool dg_match_augment_from_type(dg_room_type_assignment_workspace_t *ws, size_t type_index)
+{
+    const size_t *rooms = ws->type_rooms + ws->type_room_offsets[type_index];
+    size_t room_total = ws->eligible_counts_by_enabled_type[type_index];
+
+    for (; ws->match_arcs[type_index] < room_total; ws->match_arcs[type_index] += 1u) {
+        size_t room_index = rooms[ws->match_arcs[type_index]];
+        size_t holder = ws->matched_type_by_room[room_index];
+
+        if (holder == SIZE_MAX ||
+            (ws->match_levels[holder] == ws->match_levels[type_index] + 1u &&
+             dg_match_augment_from_type(ws, holder))) {
+            ws->matched_type_by_room[room_index] = type_index;
+            return true;
+        }
+    }
+
+    ws->match_levels[type_index] = DG_MATCH_UNREACHED;
+    return false;
+}
+
+static size_t dg_match_room_type_minimums(
+    dg_room_type_assignment_workspace_t *ws,
+    size_t enabled_type_count
+)
+{
+    size_t t;
+    size_t missing;
+
+    for (;;) {
+        size_t head;
+        size_t tail;
+        bool reaches_free_room;
+
+        /* Layer types by alternating distance from the ones still short. */
+        head = 0;
+        tail = 0;
+        for (t = 0; t < enabled_type_count; ++t) {
+            ws->match_arcs[t] = 0;
+            if (ws->matched_counts[t] < ws->minimum_counts[t]) {
+                ws->match_levels[t] = 0;
+                ws->match_queue[tail++] = t;
+            } else {
+                ws->match_levels[t] = DG_MATCH_UNREACHED;
+            }
+        }
+
+        reaches_free_room = false;
+        while (head < tail) {
+            size_t type_index = ws->match_queue[head++];
+            const size_t *rooms = ws->type_rooms + ws->type_room_offsets[type_index];
+            size_t n;
+
+            for (n = 0; n < ws->eligible_counts_by_enabled_type[type_index]; ++n) {
+                size_t holder = ws->matched_type_by_room[rooms[n]];
+
+                if (holder == SIZE_MAX) {
+                    reaches_free_room = true;
+                } else if (ws->match_levels[holder] == DG_MATCH_UNREACHED) {
+                    ws->match_levels[holder] = ws->match_levels[type_index] + 1u;
+                    ws->match_queue[tail++] = holder;
+                }
+            }
+        }
+
+        if (!reaches_free_room) {
+            break;
+        }
+
+        for (t = 0; t < enabled_type_count; ++t) {
+            while (ws->match_levels[t] == 0 &&
+                   ws->matched_counts[t] < ws->minimum_counts[t] &&
+                   dg_match_augment_from_type(ws, t)) {
+                ws->matched_counts[t] += 1u;
+            }
+        }
+    }
+
+    missing = 0;
+    for (t = 0; t < enabled_type_count; ++t) {
+        missing += ws->minimum_counts[t] - ws->matched_counts[t];
+    }
+    return missing;
+}
+
 dg_status_t dg_apply_room_type_assignment(
     const dg_generate_request_t *request,
     dg_map_t *map,
@@ -722,14 +978,11 @@ dg_status_t dg_apply_room_type_assignment(
     size_t room_count;
     size_t i;
     size_t enabled_type_count;
-    size_t *enabled_type_indices;
-    bool *eligibility_matrix;
-    size_t *eligible_counts_by_enabled_type;
-    size_t *eligible_type_counts_by_room;
-    size_t *assigned_counts_by_enabled_type;
-    size_t *room_assignments;
-    size_t *ordered_enabled_indices;
-    dg_room_feature_t *features;
+    size_t total_minimum;
+    size_t min_shortfall;
+    uint32_t short_type_id;
+    dg_room_type_assignment_workspace_t ws;
+    dg_room_candidate_tree_t candidates;
     dg_status_t status;
 
     if (request == NULL || map == NULL || map->tiles == NULL) {
@@ -751,16 +1004,27 @@ dg_status_t dg_apply_room_type_assignment(
         return dg_populate_room_type_assignment_diagnostics(request, map);
     }
 
-    features = NULL;
-    status = dg_compute_room_features(map, &features);
+    /* dg_populate_runtime_metadata normally leaves the CSR graph in place. */
+    if (map->metadata.room_adjacency == NULL || map->metadata.room_adjacency_count != room_count) {
+        size_t leaf_room_count;
+        size_t corridor_total_length;
+
+        status = dg_build_room_graph_metadata(map, &leaf_room_count, &corridor_total_length);
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+    }
+
+    ws = (dg_room_type_assignment_workspace_t){0};
+    status = dg_compute_room_features(map, &ws.features);
     if (status != DG_STATUS_OK) {
-        free(features);
+        dg_release_room_type_assignment_workspace(&ws);
         return status;
     }
 
-    status = dg_populate_graph_depths(map, features, room_count);
+    status = dg_populate_graph_depths(map, ws.features, room_count);
     if (status != DG_STATUS_OK) {
-        free(features);
+        dg_release_room_type_assignment_workspace(&ws);
         return status;
     }
 
@@ -772,30 +1036,33 @@ dg_status_t dg_apply_room_type_assignment(
     }
 
     if (enabled_type_count == 0) {
-        free(features);
+        dg_release_room_type_assignment_workspace(&ws);
         return DG_STATUS_OK;
     }
 
-    enabled_type_indices = (size_t *)malloc(enabled_type_count * sizeof(size_t));
-    eligibility_matrix = (bool *)calloc(room_count * enabled_type_count, sizeof(bool));
-    eligible_counts_by_enabled_type = (size_t *)calloc(enabled_type_count, sizeof(size_t));
-    eligible_type_counts_by_room = (size_t *)calloc(room_count, sizeof(size_t));
-    assigned_counts_by_enabled_type = (size_t *)calloc(enabled_type_count, sizeof(size_t));
-    room_assignments = (size_t *)malloc(room_count * sizeof(size_t));
-    ordered_enabled_indices = (size_t *)malloc(enabled_type_count * sizeof(size_t));
-
-    if (enabled_type_indices == NULL || eligibility_matrix == NULL ||
-        eligible_counts_by_enabled_type == NULL || eligible_type_counts_by_room == NULL ||
-        assigned_counts_by_enabled_type == NULL || room_assignments == NULL ||
-        ordered_enabled_indices == NULL) {
-        free(ordered_enabled_indices);
-        free(room_assignments);
-        free(assigned_counts_by_enabled_type);
-        free(eligible_type_counts_by_room);
-        free(eligible_counts_by_enabled_type);
-        free(eligibility_matrix);
-        free(enabled_type_indices);
-        free(features);
+    ws.enabled_type_indices = (size_t *)malloc(enabled_type_count * sizeof(size_t));
+    ws.eligible_counts_by_enabled_type = (size_t *)calloc(enabled_type_count, sizeof(size_t));
+    ws.eligible_type_counts_by_room = (size_t *)calloc(room_count, sizeof(size_t));
+    ws.eligible_type_offsets = (size_t *)malloc((room_count + 1u) * sizeof(size_t));
+    ws.type_room_offsets = (size_t *)malloc((enabled_type_count + 1u) * sizeof(size_t));
+    ws.assigned_counts_by_enabled_type = (size_t *)calloc(enabled_type_count, sizeof(size_t));
+    ws.room_assignments = (size_t *)malloc(room_count * sizeof(size_t));
+    ws.ordered_enabled_indices = (size_t *)malloc(enabled_type_count * sizeof(size_t));
+    ws.minimum_counts = (size_t *)malloc(enabled_type_count * sizeof(size_t));
+    ws.matched_type_by_room = (size_t *)malloc(room_count * sizeof(size_t));
+    ws.matched_counts = (size_t *)calloc(enabled_type_count, sizeof(size_t));
+    ws.match_levels = (size_t *)malloc(enabled_type_count * sizeof(size_t));
+    ws.match_arcs = (size_t *)malloc(enabled_type_count * sizeof(size_t));
+    ws.match_queue = (size_t *)malloc(enabled_type_count * sizeof(size_t));
+
+    if (ws.enabled_type_indices == NULL || ws.eligible_counts_by_enabled_type == NULL ||
+        ws.eligible_type_counts_by_room == NULL || ws.eligible_type_offsets == NULL ||
+        ws.type_room_offsets == NULL || ws.assigned_counts_by_enabled_type == NULL ||
+        ws.room_assignments == NULL || ws.ordered_enabled_indices == NULL ||
+        ws.minimum_counts == NULL || ws.matched_type_by_room == NULL ||
+        ws.matched_counts == NULL || ws.match_levels == NULL || ws.match_arcs == NULL ||
+        ws.match_queue == NULL) {
+        dg_release_room_type_assignment_workspace(&ws);
         return DG_STATUS_ALLOCATION_FAILED;
     }
 
@@ -805,127 +1072,167 @@ dg_status_t dg_apply_room_type_assignment(
         write_index = 0;
         for (i = 0; i < request->room_types.definition_count; ++i) {
             if (request->room_types.definitions[i].enabled == 1) {
-                enabled_type_indices[write_index++] = i;
+                ws.enabled_type_indices[write_index++] = i;
             }
         }
     }
 
-    for (i = 0; i < room_count; ++i) {
-        room_assignments[i] = SIZE_MAX;
+    total_minimum = 0;
+    for (i = 0; i < enabled_type_count; ++i) {
+        ws.minimum_counts[i] =
+            (size_t)request->room_types.definitions[ws.enabled_type_indices[i]].min_count;
+        total_minimum += ws.minimum_counts[i];
     }
 
     for (i = 0; i < room_count; ++i) {
-        size_t enabled_type_index;
-
-        for (enabled_type_index = 0; enabled_type_index < enabled_type_count; ++enabled_type_index) {
-            size_t definition_index = enabled_type_indices[enabled_type_index];
-            const dg_room_type_definition_t *type_definition =
-                &request->room_types.definitions[definition_index];
-            bool eligible = dg_room_matches_type_constraints(&features[i], type_definition);
-
-            eligibility_matrix[i * enabled_type_count + enabled_type_index] = eligible;
-            if (eligible) {
-                eligible_counts_by_enabled_type[enabled_type_index] += 1;
-                eligible_type_counts_by_room[i] += 1;
-            }
-        }
+        ws.room_assignments[i] = SIZE_MAX;
+        ws.matched_type_by_room[i] = SIZE_MAX;
+    }
+
+    status = dg_build_room_type_eligibility(
+        &request->room_types,
+        room_count,
+        enabled_type_count,
+        &ws
+    );
+    if (status != DG_STATUS_OK) {
+        dg_release_room_type_assignment_workspace(&ws);
+        return status;
     }
 
     status = dg_validate_strict_assignment_feasibility(
         &request->room_types,
-        enabled_type_indices,
+        ws.enabled_type_indices,
         enabled_type_count,
-        eligible_counts_by_enabled_type,
-        eligible_type_counts_by_room,
+        ws.eligible_type_counts_by_room,
         room_count
     );
     if (status != DG_STATUS_OK) {
-        free(ordered_enabled_indices);
-        free(room_assignments);
-        free(assigned_counts_by_enabled_type);
-        free(eligible_type_counts_by_room);
-        free(eligible_counts_by_enabled_type);
-        free(eligibility_matrix);
-        free(enabled_type_indices);
-        free(features);
+        dg_release_room_type_assignment_workspace(&ws);
         return status;
     }
 
+    /* Settle whether the minimums fit together before any scoring. */
+    min_shortfall = 0;
+    short_type_id = DG_ROOM_TYPE_UNASSIGNED;
+    if (total_minimum > 0) {
+        min_shortfall = dg_match_room_type_minimums(&ws, enabled_type_count);
+        for (i = 0; i < enabled_type_count && min_shortfall > 0; ++i) {
+            if (ws.matched_counts[i] < ws.minimum_counts[i]) {
+                short_type_id = request->room_types.definitions[ws.enabled_type_indices[i]].type_id;
+                break;
+            }
+        }
+    }
+
+    if (min_shortfall > 0 && request->room_types.policy.strict_mode == 1) {
+        dg_release_room_type_assignment_workspace(&ws);
+        return DG_STATUS_GENERATION_FAILED;
+    }
+
     dg_sort_enabled_types_by_minimum_slack(
-        ordered_enabled_indices,
+        ws.ordered_enabled_indices,
         &request->room_types,
-        enabled_type_indices,
-        eligible_counts_by_enabled_type,
+        ws.enabled_type_indices,
+        ws.eligible_counts_by_enabled_type,
         enabled_type_count
     );
 
+    candidates = (dg_room_candidate_tree_t){0};
+    candidates.max_scores = ws.candidate_max_scores;
+    candidates.max_counts = ws.candidate_max_counts;
+    candidates.right_ties = ws.candidate_right_ties;
     for (i = 0; i < enabled_type_count; ++i) {
-        size_t enabled_type_index = ordered_enabled_indices[i];
-        size_t definition_index = enabled_type_indices[enabled_type_index];
+        size_t enabled_type_index = ws.ordered_enabled_indices[i];
+        size_t definition_index = ws.enabled_type_indices[enabled_type_index];
         const dg_room_type_definition_t *type_definition =
             &request->room_types.definitions[definition_index];
 
-        while (assigned_counts_by_enabled_type[enabled_type_index] < (size_t)type_definition->min_count) {
+        if (type_definition->min_count <= 0) {
+            continue;
+        }
+
+        dg_candidate_tree_build(
+            &candidates,
+            ws.features,
+            type_definition,
+            ws.type_rooms + ws.type_room_offsets[enabled_type_index],
+            ws.eligible_counts_by_enabled_type[enabled_type_index],
+            ws.room_assignments,
+            ws.eligible_type_counts_by_room
+        );
+
+        while (ws.assigned_counts_by_enabled_type[enabled_type_index] <
+               (size_t)type_definition->min_count) {
             size_t room_index;
-            bool found;
-
-            found = dg_choose_best_room_for_type(
-                rng,
-                features,
-                type_definition,
-                eligibility_matrix,
-                room_count,
-                enabled_type_count,
-                enabled_type_index,
-                room_assignments,
-                eligible_type_counts_by_room,
-                &room_index
-            );
 
-            if (!found) {
-                if (request->room_types.policy.strict_mode == 1) {
-                    free(ordered_enabled_indices);
-                    free(room_assignments);
-                    free(assigned_counts_by_enabled_type);
-                    free(eligible_type_counts_by_room);
-                    free(eligible_counts_by_enabled_type);
-                    free(eligibility_matrix);
-                    free(enabled_type_indices);
-                    free(features);
-                    return DG_STATUS_GENERATION_FAILED;
-                }
+            if (!dg_choose_best_room_for_type(rng, &candidates, &room_index)) {
                 break;
             }
 
-            room_assignments[room_index] = enabled_type_index;
-            assigned_counts_by_enabled_type[enabled_type_index] += 1;
+            ws.room_assignments[room_index] = enabled_type_index;
+            ws.assigned_counts_by_enabled_type[enabled_type_index] += 1;
+        }
+    }
+
+    /*
+     * Greedy picks can strand a later type even though the minimums fit.
+     * Strict mode then augments the picks to a full matching, which moves
+     * as few rooms as the augmenting paths need, instead of failing.
+     */
+    if (request->room_types.policy.strict_mode == 1 && total_minimum > 0) {
+        bool short_after_greedy = false;
+
+        for (i = 0; i < enabled_type_count; ++i) {
+            if (ws.assigned_counts_by_enabled_type[i] < ws.minimum_counts[i]) {
+                short_after_greedy = true;
+            }
+        }
+
+        if (short_after_greedy) {
+            memcpy(ws.matched_type_by_room, ws.room_assignments, room_count * sizeof(size_t));
+            memcpy(
+                ws.matched_counts,
+                ws.assigned_counts_by_enabled_type,
+                enabled_type_count * sizeof(size_t)
+            );
+            if (dg_match_room_type_minimums(&ws, enabled_type_count) != 0) {
+                dg_release_room_type_assignment_workspace(&ws);
+                return DG_STATUS_GENERATION_FAILED;
+            }
+            memcpy(ws.room_assignments, ws.matched_type_by_room, room_count * sizeof(size_t));
+            memcpy(
+                ws.assigned_counts_by_enabled_type,
+                ws.matched_counts,
+                enabled_type_count * sizeof(size_t)
+            );
         }
     }
 
     for (i = 0; i < room_count; ++i) {
         size_t selected_enabled_type_index;
 
-        if (room_assignments[i] != SIZE_MAX) {
+        if (ws.room_assignments[i] != SIZE_MAX) {
             continue;
         }
 
         selected_enabled_type_index = dg_choose_best_type_for_room(
             rng,
-            features,
+            ws.features,
             i,
             &request->room_types,
-            enabled_type_indices,
-            enabled_type_count,
-            eligibility_matrix,
-            assigned_counts_by_enabled_type
+            ws.enabled_type_indices,
+            ws.eligible_types + ws.eligible_type_offsets[i],
+            ws.eligible_type_counts_by_room[i],
+            ws.assigned_counts_by_enabled_type
         );
 
         if (selected_enabled_type_index == SIZE_MAX) {
             continue;
         }
 
-        room_assignments[i] = selected_enabled_type_index;
-        assigned_counts_by_enabled_type[selected_enabled_type_index] += 1;
+        ws.room_assignments[i] = selected_enabled_type_index;
+        ws.assigned_counts_by_enabled_type[selected_enabled_type_index] += 1;
     }
 
     if (request->room_types.policy.allow_untyped_rooms == 0) {
@@ -933,30 +1240,23 @@ dg_status_t dg_apply_room_type_assignment(
 
         default_enabled_type_index = dg_find_default_type_enabled_index(
             &request->room_types,
-            enabled_type_indices,
+            ws.enabled_type_indices,
             enabled_type_count
         );
 
         for (i = 0; i < room_count; ++i) {
-            if (room_assignments[i] != SIZE_MAX) {
+            if (ws.room_assignments[i] != SIZE_MAX) {
                 continue;
             }
 
             if (request->room_types.policy.strict_mode == 1 ||
                 default_enabled_type_index == SIZE_MAX) {
-                free(ordered_enabled_indices);
-                free(room_assignments);
-                free(assigned_counts_by_enabled_type);
-                free(eligible_type_counts_by_room);
-                free(eligible_counts_by_enabled_type);
-                free(eligibility_matrix);
-                free(enabled_type_indices);
-                free(features);
+                dg_release_room_type_assignment_workspace(&ws);
                 return DG_STATUS_GENERATION_FAILED;
             }
 
-            room_assignments[i] = default_enabled_type_index;
-            assigned_counts_by_enabled_type[default_enabled_type_index] += 1;
+            ws.room_assignments[i] = default_enabled_type_index;
+            ws.assigned_counts_by_enabled_type[default_enabled_type_index] += 1;
         }
     }
 
@@ -964,64 +1264,48 @@ dg_status_t dg_apply_room_type_assignment(
         size_t enabled_type_index;
 
         for (enabled_type_index = 0; enabled_type_index < enabled_type_count; ++enabled_type_index) {
-            size_t definition_index = enabled_type_indices[enabled_type_index];
+            size_t definition_index = ws.enabled_type_indices[enabled_type_index];
             const dg_room_type_definition_t *type_definition =
                 &request->room_types.definitions[definition_index];
+            size_t assigned_count = ws.assigned_counts_by_enabled_type[enabled_type_index];
 
-            if (assigned_counts_by_enabled_type[enabled_type_index] < (size_t)type_definition->min_count) {
-                free(ordered_enabled_indices);
-                free(room_assignments);
-                free(assigned_counts_by_enabled_type);
-                free(eligible_type_counts_by_room);
-                free(eligible_counts_by_enabled_type);
-                free(eligibility_matrix);
-                free(enabled_type_indices);
-                free(features);
-                return DG_STATUS_GENERATION_FAILED;
-            }
-
-            if (type_definition->max_count != -1 &&
-                assigned_counts_by_enabled_type[enabled_type_index] > (size_t)type_definition->max_count) {
-                free(ordered_enabled_indices);
-                free(room_assignments);
-                free(assigned_counts_by_enabled_type);
-                free(eligible_type_counts_by_room);
-                free(eligible_counts_by_enabled_type);
-                free(eligibility_matrix);
-                free(enabled_type_indices);
-                free(features);
+            if (assigned_count < (size_t)type_definition->min_count ||
+                (type_definition->max_count != -1 &&
+                 assigned_count > (size_t)type_definition->max_count)) {
+                dg_release_room_type_assignment_workspace(&ws);
                 return DG_STATUS_GENERATION_FAILED;
             }
         }
     }
 
     for (i = 0; i < room_count; ++i) {
-        if (room_assignments[i] == SIZE_MAX) {
+        if (ws.room_assignments[i] == SIZE_MAX) {
             map->metadata.rooms[i].type_id = DG_ROOM_TYPE_UNASSIGNED;
         } else {
-            size_t definition_index = enabled_type_indices[room_assignments[i]];
+            size_t definition_index = ws.enabled_type_indices[ws.room_assignments[i]];
             map->metadata.rooms[i].type_id = request->room_types.definitions[definition_index].type_id;
         }
     }
 
-    free(ordered_enabled_indices);
-    free(room_assignments);
-    free(assigned_counts_by_enabled_type);
-    free(eligible_type_counts_by_room);
-    free(eligible_counts_by_enabled_type);
-    free(eligibility_matrix);
-    free(enabled_type_indices);
-    free(features);
-    return dg_populate_room_type_assignment_diagnostics(request, map);
+    dg_release_room_type_assignment_workspace(&ws);
+    status = dg_populate_room_type_assignment_diagnostics(request, map);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    map->metadata.diagnostics.room_type_min_shortfall = min_shortfall;
+    map->metadata.diagnostics.room_type_short_type_id = short_type_id;
+    return DG_STATUS_OK;
 }
 
 typedef struct dg_room_template_cache_entry {
     int has_template;
-    int loaded;
-    dg_map_t map;
+    dg_cached_template_t *cached;
+    const dg_map_t *map;
 } dg_room_template_cache_entry_t;
 
-static int dg_room_template_application_depth = 0;
+/* Per thread, so concurrent dg_generate calls do not trip the nesting guard. */
+static _Thread_local int dg_room_template_application_depth = 0;
 
 static size_t dg_find_room_type_definition_index_by_type_id(
     const dg_generate_request_t *request,
@@ -1289,25 +1573,45 @@ static bool dg_point_in_rect_local(const dg_rect_t *rect, int x, int y)
            y < rect->y + rect->height;
 }
 
-static bool dg_point_in_any_room_local(const dg_map_t *map, int x, int y)
+/*
+ * Marks every host cell covered by some room's bounds. Built once per
+ * template pass and shared by every room's entrance scan; stamping only
+ * rewrites tiles, so the mask stays valid throughout.
+ */
+static dg_status_t dg_build_room_cell_mask(const dg_map_t *map, unsigned char **out_mask)
 {
+    unsigned char *mask;
     size_t i;
 
-    if (map == NULL || map->metadata.rooms == NULL) {
-        return false;
+    *out_mask = NULL;
+    mask = (unsigned char *)calloc((size_t)map->width * (size_t)map->height, sizeof(*mask));
+    if (mask == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
     }
 
     for (i = 0; i < map->metadata.room_count; ++i) {
-        if (dg_point_in_rect_local(&map->metadata.rooms[i].bounds, x, y)) {
-            return true;
+        const dg_rect_t *bounds = &map->metadata.rooms[i].bounds;
+        int begin_x = dg_max_int(bounds->x, 0);
+        int end_x = dg_min_int(bounds->x + bounds->width, map->width);
+        int begin_y = dg_max_int(bounds->y, 0);
+        int end_y = dg_min_int(bounds->y + bounds->height, map->height);
+        int y;
+
+        if (begin_x >= end_x) {
+            continue;
+        }
+        for (y = begin_y; y < end_y; ++y) {
+            memset(&mask[dg_tile_index(map, begin_x, y)], 1, (size_t)(end_x - begin_x));
         }
     }
 
-    return false;
+    *out_mask = mask;
+    return DG_STATUS_OK;
 }
 
 static bool dg_room_boundary_opens_to_corridor(
     const dg_map_t *map,
+    const unsigned char *room_cells,
     const dg_rect_t *room,
     int room_x,
     int room_y,
@@ -1329,7 +1633,7 @@ static bool dg_room_boundary_opens_to_corridor(
     }
 
     if (dg_point_in_rect_local(room, outside_x, outside_y) ||
-        dg_point_in_any_room_local(map, outside_x, outside_y)) {
+        room_cells[dg_tile_index(map, outside_x, outside_y)] != 0u) {
         return false;
     }
 
@@ -1338,6 +1642,7 @@ static bool dg_room_boundary_opens_to_corridor(
 
 static dg_status_t dg_collect_room_entrance_openings(
     const dg_map_t *map,
+    const unsigned char *room_cells,
     const dg_rect_t *room,
     dg_edge_opening_spec_t **out_openings,
     size_t *out_opening_count
@@ -1349,7 +1654,8 @@ static dg_status_t dg_collect_room_entrance_openings(
     int local_coord;
     int run_start;
 
-    if (map == NULL || room == NULL || out_openings == NULL || out_opening_count == NULL) {
+    if (map == NULL || room_cells == NULL || room == NULL ||
+        out_openings == NULL || out_opening_count == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
@@ -1370,7 +1676,7 @@ static dg_status_t dg_collect_room_entrance_openings(
     for (local_coord = 0; local_coord < room->width; ++local_coord) {
         int x = room->x + local_coord;
         int y = room->y;
-        bool open = dg_room_boundary_opens_to_corridor(map, room, x, y, x, y - 1);
+        bool open = dg_room_boundary_opens_to_corridor(map, room_cells, room, x, y, x, y - 1);
 
         if (open && run_start < 0) {
             run_start = local_coord;
@@ -1395,7 +1701,7 @@ static dg_status_t dg_collect_room_entrance_openings(
     for (local_coord = 0; local_coord < room->width; ++local_coord) {
         int x = room->x + local_coord;
         int y = room->y + room->height - 1;
-        bool open = dg_room_boundary_opens_to_corridor(map, room, x, y, x, y + 1);
+        bool open = dg_room_boundary_opens_to_corridor(map, room_cells, room, x, y, x, y + 1);
 
         if (open && run_start < 0) {
             run_start = local_coord;
@@ -1420,7 +1726,7 @@ static dg_status_t dg_collect_room_entrance_openings(
     for (local_coord = 0; local_coord < room->height; ++local_coord) {
         int x = room->x;
         int y = room->y + local_coord;
-        bool open = dg_room_boundary_opens_to_corridor(map, room, x, y, x - 1, y);
+        bool open = dg_room_boundary_opens_to_corridor(map, room_cells, room, x, y, x - 1, y);
 
         if (open && run_start < 0) {
             run_start = local_coord;
@@ -1445,7 +1751,7 @@ static dg_status_t dg_collect_room_entrance_openings(
     for (local_coord = 0; local_coord < room->height; ++local_coord) {
         int x = room->x + room->width - 1;
         int y = room->y + local_coord;
-        bool open = dg_room_boundary_opens_to_corridor(map, room, x, y, x + 1, y);
+        bool open = dg_room_boundary_opens_to_corridor(map, room_cells, room, x, y, x + 1, y);
 
         if (open && run_start < 0) {
             run_start = local_coord;
@@ -1760,11 +2066,63 @@ static void dg_carve_low_cost_path(
     }
 }
 
-static bool dg_walkable_path_exists(
-    const dg_map_t *map,
-    dg_point_t start,
-    dg_point_t goal
+/*
+ * Walkable components of a template block, kept current while entrance
+ * paths are carved into it: cells are joined by union-find, so each
+ * connectivity check is two finds instead of a BFS over the block.
+ * `has_base` is set on roots of components holding a tile that was walkable
+ * before the opening patches.
+ */
+typedef struct dg_walkable_components {
+    dg_map_t *map;
+    size_t *parent;
+    unsigned char *walkable;
+    unsigned char *has_base;
+} dg_walkable_components_t;
+
+static void dg_release_walkable_components(dg_walkable_components_t *components)
+{
+    free(components->has_base);
+    free(components->walkable);
+    free(components->parent);
+    *components = (dg_walkable_components_t){0};
+}
+
+static size_t dg_walkable_components_find(dg_walkable_components_t *components, size_t index)
+{
+    size_t *parent = components->parent;
+
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+static void dg_walkable_components_union(
+    dg_walkable_components_t *components,
+    size_t a,
+    size_t b
 )
+{
+    size_t root_a = dg_walkable_components_find(components, a);
+    size_t root_b = dg_walkable_components_find(components, b);
+
+    if (root_a == root_b) {
+        return;
+    }
+    if (root_b < root_a) {
+        size_t swap = root_a;
+
+        root_a = root_b;
+        root_b = swap;
+    }
+    components->parent[root_b] = root_a;
+    components->has_base[root_a] |= components->has_base[root_b];
+}
+
+/* Admits a cell that has just become walkable and joins it to its neighbours. */
+static void dg_walkable_components_add(dg_walkable_components_t *components, int x, int y)
 {
     static const int directions[4][2] = {
         {1, 0},
@@ -1772,166 +2130,138 @@ static bool dg_walkable_path_exists(
         {0, 1},
         {0, -1}
     };
-    size_t cell_count;
-    unsigned char *visited;
-    size_t *queue;
-    size_t head;
-    size_t tail;
-    size_t goal_index;
-    int width;
+    const dg_map_t *map = components->map;
+    size_t index = dg_tile_index(map, x, y);
+    int d;
 
-    if (map == NULL || map->tiles == NULL) {
-        return false;
-    }
-    if (!dg_map_in_bounds(map, start.x, start.y) || !dg_map_in_bounds(map, goal.x, goal.y)) {
-        return false;
-    }
-    if (!dg_is_walkable_tile(dg_map_get_tile(map, start.x, start.y)) ||
-        !dg_is_walkable_tile(dg_map_get_tile(map, goal.x, goal.y))) {
-        return false;
-    }
-    if (start.x == goal.x && start.y == goal.y) {
-        return true;
-    }
+    components->walkable[index] = 1u;
+    for (d = 0; d < 4; ++d) {
+        int nx = x + directions[d][0];
+        int ny = y + directions[d][1];
 
-    cell_count = (size_t)map->width * (size_t)map->height;
-    visited = (unsigned char *)calloc(cell_count, sizeof(*visited));
-    queue = (size_t *)malloc(cell_count * sizeof(*queue));
-    if (visited == NULL || queue == NULL) {
-        free(queue);
-        free(visited);
-        return false;
+        if (dg_map_in_bounds(map, nx, ny) &&
+            components->walkable[dg_tile_index(map, nx, ny)] != 0u) {
+            dg_walkable_components_union(components, index, dg_tile_index(map, nx, ny));
+        }
     }
+}
 
-    width = map->width;
-    goal_index = dg_tile_index(map, goal.x, goal.y);
-    head = 0u;
-    tail = 0u;
-    queue[tail++] = dg_tile_index(map, start.x, start.y);
-    visited[queue[0]] = 1u;
-
-    while (head < tail) {
-        size_t index = queue[head++];
-        int x = (int)(index % (size_t)width);
-        int y = (int)(index / (size_t)width);
-        int d;
-
-        for (d = 0; d < 4; ++d) {
-            int nx = x + directions[d][0];
-            int ny = y + directions[d][1];
-            size_t nindex;
-
-            if (!dg_map_in_bounds(map, nx, ny)) {
-                continue;
-            }
-            if (!dg_is_walkable_tile(dg_map_get_tile(map, nx, ny))) {
-                continue;
-            }
+static dg_status_t dg_init_walkable_components(
+    dg_walkable_components_t *components,
+    dg_map_t *map,
+    const dg_tile_t *base_tiles
+)
+{
+    size_t cell_count;
+    size_t i;
+    int x;
+    int y;
 
-            nindex = dg_tile_index(map, nx, ny);
-            if (visited[nindex] != 0u) {
-                continue;
-            }
+    *components = (dg_walkable_components_t){0};
+    cell_count = (size_t)map->width * (size_t)map->height;
+    components->map = map;
+    components->parent = (size_t *)malloc(cell_count * sizeof(*components->parent));
+    components->walkable = (unsigned char *)calloc(cell_count, sizeof(*components->walkable));
+    components->has_base = (unsigned char *)malloc(cell_count * sizeof(*components->has_base));
+    if (components->parent == NULL || components->walkable == NULL ||
+        components->has_base == NULL) {
+        dg_release_walkable_components(components);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
 
-            if (nindex == goal_index) {
-                free(queue);
-                free(visited);
-                return true;
+    for (i = 0; i < cell_count; ++i) {
+        components->parent[i] = i;
+        components->has_base[i] = dg_is_walkable_tile(base_tiles[i]) ? 1u : 0u;
+    }
+    for (y = 0; y < map->height; ++y) {
+        for (x = 0; x < map->width; ++x) {
+            if (dg_is_walkable_tile(dg_map_get_tile(map, x, y))) {
+                dg_walkable_components_add(components, x, y);
             }
-
-            visited[nindex] = 1u;
-            queue[tail++] = nindex;
         }
     }
 
-    free(queue);
-    free(visited);
-    return false;
+    return DG_STATUS_OK;
 }
 
-static bool dg_walkable_reaches_base_tiles(
-    const dg_map_t *map,
-    dg_point_t start,
-    const dg_tile_t *base_tiles,
-    const unsigned char *exclude_mask
+static bool dg_walkable_components_is_walkable(
+    const dg_walkable_components_t *components,
+    dg_point_t point
 )
 {
-    static const int directions[4][2] = {
-        {1, 0},
-        {-1, 0},
-        {0, 1},
-        {0, -1}
-    };
-    size_t cell_count;
-    unsigned char *visited;
-    size_t *queue;
-    size_t head;
-    size_t tail;
-    int width;
+    return dg_map_in_bounds(components->map, point.x, point.y) &&
+           components->walkable[dg_tile_index(components->map, point.x, point.y)] != 0u;
+}
 
-    if (map == NULL || map->tiles == NULL || base_tiles == NULL) {
-        return false;
-    }
-    if (!dg_map_in_bounds(map, start.x, start.y)) {
-        return false;
-    }
-    if (!dg_is_walkable_tile(dg_map_get_tile(map, start.x, start.y))) {
+static bool dg_walkable_components_connected(
+    dg_walkable_components_t *components,
+    dg_point_t a,
+    dg_point_t b
+)
+{
+    if (!dg_walkable_components_is_walkable(components, a) ||
+        !dg_walkable_components_is_walkable(components, b)) {
         return false;
     }
+    return dg_walkable_components_find(components, dg_tile_index(components->map, a.x, a.y)) ==
+           dg_walkable_components_find(components, dg_tile_index(components->map, b.x, b.y));
+}
 
-    cell_count = (size_t)map->width * (size_t)map->height;
-    visited = (unsigned char *)calloc(cell_count, sizeof(*visited));
-    queue = (size_t *)malloc(cell_count * sizeof(*queue));
-    if (visited == NULL || queue == NULL) {
-        free(queue);
-        free(visited);
+static bool dg_walkable_components_reach_base(
+    dg_walkable_components_t *components,
+    dg_point_t start
+)
+{
+    if (!dg_walkable_components_is_walkable(components, start)) {
         return false;
     }
+    return components->has_base[dg_walkable_components_find(
+               components,
+               dg_tile_index(components->map, start.x, start.y)
+           )] != 0u;
+}
 
-    width = map->width;
-    head = 0u;
-    tail = 0u;
-    queue[tail++] = dg_tile_index(map, start.x, start.y);
-    visited[queue[0]] = 1u;
-
-    while (head < tail) {
-        size_t index = queue[head++];
-        int x = (int)(index % (size_t)width);
-        int y = (int)(index / (size_t)width);
-        int d;
+/* Admits the cells of a straight segment that carving made walkable. */
+static void dg_walkable_components_refresh_segment(
+    dg_walkable_components_t *components,
+    int x0,
+    int y0,
+    int x1,
+    int y1
+)
+{
+    const dg_map_t *map = components->map;
+    int x_step = (x1 > x0) ? 1 : ((x1 < x0) ? -1 : 0);
+    int y_step = (y1 > y0) ? 1 : ((y1 < y0) ? -1 : 0);
+    int x = x0;
+    int y = y0;
 
-        if (dg_is_walkable_tile(base_tiles[index]) &&
-            (exclude_mask == NULL || exclude_mask[index] == 0u)) {
-            free(queue);
-            free(visited);
-            return true;
+    while (true) {
+        if (dg_map_in_bounds(map, x, y) &&
+            components->walkable[dg_tile_index(map, x, y)] == 0u &&
+            dg_is_walkable_tile(dg_map_get_tile(map, x, y))) {
+            dg_walkable_components_add(components, x, y);
         }
-
-        for (d = 0; d < 4; ++d) {
-            int nx = x + directions[d][0];
-            int ny = y + directions[d][1];
-            size_t nindex;
-
-            if (!dg_map_in_bounds(map, nx, ny)) {
-                continue;
-            }
-            if (!dg_is_walkable_tile(dg_map_get_tile(map, nx, ny))) {
-                continue;
-            }
-
-            nindex = dg_tile_index(map, nx, ny);
-            if (visited[nindex] != 0u) {
-                continue;
-            }
-
-            visited[nindex] = 1u;
-            queue[tail++] = nindex;
+        if (x == x1 && y == y1) {
+            break;
         }
+        x += x_step;
+        y += y_step;
     }
+}
 
-    free(queue);
-    free(visited);
-    return false;
+/* dg_carve_low_cost_path, then admits whichever of the two L routes it carved. */
+static void dg_walkable_components_carve(
+    dg_walkable_components_t *components,
+    dg_point_t from,
+    dg_point_t to
+)
+{
+    dg_carve_low_cost_path(components->map, from, to);
+    dg_walkable_components_refresh_segment(components, from.x, from.y, to.x, from.y);
+    dg_walkable_components_refresh_segment(components, to.x, from.y, to.x, to.y);
+    dg_walkable_components_refresh_segment(components, from.x, from.y, from.x, to.y);
+    dg_walkable_components_refresh_segment(components, from.x, to.y, to.x, to.y);
 }
 
 static bool dg_find_nearest_walkable_in_tiles(
@@ -2315,7 +2645,9 @@ static dg_status_t dg_enforce_template_opening_connectivity(
     size_t cell_count;
     dg_tile_t *base_tiles;
     dg_point_t *anchors;
+    dg_walkable_components_t components;
     size_t i;
+    dg_status_t status;
 
     if (map == NULL || map->tiles == NULL || openings == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
@@ -2355,20 +2687,23 @@ static dg_status_t dg_enforce_template_opening_connectivity(
         dg_apply_edge_opening_patch_and_anchor(map, &openings[i], &anchors[i]);
     }
 
+    /* One component analysis answers every check below, updated as paths are carved. */
+    status = dg_init_walkable_components(&components, map, base_tiles);
+    if (status != DG_STATUS_OK) {
+        free(anchors);
+        free(base_tiles);
+        return status;
+    }
+
     for (i = 1u; i < opening_count; ++i) {
-        if (!dg_walkable_path_exists(map, anchors[0], anchors[i])) {
-            dg_carve_low_cost_path(map, anchors[0], anchors[i]);
+        if (!dg_walkable_components_connected(&components, anchors[0], anchors[i])) {
+            dg_walkable_components_carve(&components, anchors[0], anchors[i]);
         }
     }
 
     for (i = 0u; i < opening_count; ++i) {
         dg_point_t target;
-        if (dg_walkable_reaches_base_tiles(
-                map,
-                anchors[i],
-                base_tiles,
-                NULL
-            )) {
+        if (dg_walkable_components_reach_base(&components, anchors[i])) {
             continue;
         }
         if (dg_find_nearest_walkable_in_tiles(
@@ -2378,12 +2713,13 @@ static dg_status_t dg_enforce_template_opening_connectivity(
                 NULL,
                 &target
             )) {
-            if (!dg_walkable_path_exists(map, anchors[i], target)) {
-                dg_carve_low_cost_path(map, anchors[i], target);
+            if (!dg_walkable_components_connected(&components, anchors[i], target)) {
+                dg_walkable_components_carve(&components, anchors[i], target);
             }
         }
     }
 
+    dg_release_walkable_components(&components);
     free(anchors);
     free(base_tiles);
     return DG_STATUS_OK;
@@ -2638,14 +2974,30 @@ static int dg_resample_coordinate_centered(int dst_index, int dst_span, int src_
     return source_index;
 }
 
+/*
+ * Stamps `template_map` into `room`, resampling with centered nearest
+ * neighbour. The template must already hold only floor and wall tiles (see
+ * dg_normalize_template_tiles), so tiles are copied verbatim: source columns
+ * come from a per-room lookup table, a destination row whose source row
+ * matches the previous one is a row copy, and 1:1 rows are a straight
+ * memcpy.
+ */
 static dg_status_t dg_apply_template_to_room(
     dg_map_t *map,
     const dg_rect_t *room,
     const dg_map_t *template_map
 )
 {
+    int *source_columns;
+    int begin_x;
+    int end_x;
+    int begin_y;
+    int end_y;
+    int span;
+    int previous_source_y;
     int local_x;
     int local_y;
+    bool identity_columns;
 
     if (map == NULL || map->tiles == NULL || room == NULL ||
         template_map == NULL || template_map->tiles == NULL) {
@@ -2657,91 +3009,738 @@ static dg_status_t dg_apply_template_to_room(
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    for (local_y = 0; local_y < room->height; ++local_y) {
-        for (local_x = 0; local_x < room->width; ++local_x) {
-            int world_x;
-            int world_y;
-            int source_x;
-            int source_y;
-            dg_tile_t source_tile;
+    /* Clip to the map once instead of testing every tile. */
+    begin_x = dg_max_int(0, -room->x);
+    end_x = dg_min_int(room->width, map->width - room->x);
+    begin_y = dg_max_int(0, -room->y);
+    end_y = dg_min_int(room->height, map->height - room->y);
+    if (begin_x >= end_x || begin_y >= end_y) {
+        return DG_STATUS_OK;
+    }
+    span = end_x - begin_x;
+
+    identity_columns = template_map->width == room->width;
+    source_columns = NULL;
+    if (!identity_columns) {
+        source_columns = (int *)malloc((size_t)span * sizeof(*source_columns));
+        if (source_columns == NULL) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+        for (local_x = begin_x; local_x < end_x; ++local_x) {
+            source_columns[local_x - begin_x] =
+                dg_resample_coordinate_centered(local_x, room->width, template_map->width);
+        }
+    }
+
+    previous_source_y = -1;
+    for (local_y = begin_y; local_y < end_y; ++local_y) {
+        int source_y;
+        dg_tile_t *destination;
+        const dg_tile_t *source;
 
-            world_x = room->x + local_x;
-            world_y = room->y + local_y;
-            if (!dg_map_in_bounds(map, world_x, world_y)) {
-                continue;
+        source_y = dg_resample_coordinate_centered(local_y, room->height, template_map->height);
+        destination = &map->tiles[dg_tile_index(map, room->x + begin_x, room->y + local_y)];
+        source = &template_map->tiles[(size_t)source_y * (size_t)template_map->width];
+
+        if (source_y == previous_source_y) {
+            memcpy(destination, destination - map->width, (size_t)span * sizeof(*destination));
+        } else if (identity_columns) {
+            memcpy(destination, source + begin_x, (size_t)span * sizeof(*destination));
+        } else {
+            for (local_x = 0; local_x < span; ++local_x) {
+                destination[local_x] = source[source_columns[local_x]];
             }
-            source_x = dg_resample_coordinate_centered(local_x, room->width, template_map->width);
-            source_y = dg_resample_coordinate_centered(local_y, room->height, template_map->height);
-            source_tile = template_map->tiles[dg_tile_index(template_map, source_x, source_y)];
-            map->tiles[dg_tile_index(map, world_x, world_y)] =
-                dg_is_walkable_tile(source_tile) ? DG_TILE_FLOOR : DG_TILE_WALL;
         }
+        previous_source_y = source_y;
     }
 
+    free(source_columns);
     return DG_STATUS_OK;
 }
 
-dg_status_t dg_apply_room_type_templates(
-    const dg_generate_request_t *request,
-    dg_map_t *map
-)
+/* Collapses a generated template to the floor/wall tiles stamping writes. */
+static void dg_normalize_template_tiles(dg_map_t *template_map)
 {
-    dg_room_template_cache_entry_t *cache_entries;
-    size_t cache_count;
-    size_t untyped_cache_index;
+    size_t cell_count;
     size_t i;
-    dg_status_t status;
-    bool has_any_templates;
-    bool has_untyped_template;
 
-    if (request == NULL || map == NULL || map->tiles == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
+    cell_count = (size_t)template_map->width * (size_t)template_map->height;
+    for (i = 0; i < cell_count; ++i) {
+        template_map->tiles[i] =
+            dg_is_walkable_tile(template_map->tiles[i]) ? DG_TILE_FLOOR : DG_TILE_WALL;
     }
+}
 
-    if (map->metadata.generation_class != DG_MAP_GENERATION_CLASS_ROOM_LIKE ||
-        map->metadata.rooms == NULL ||
-        map->metadata.room_count == 0) {
-        return DG_STATUS_OK;
-    }
+/* One templated room: inputs gathered up front, then a generated or fitted block. */
+typedef struct dg_room_template_job {
+    const dg_room_metadata_t *room;
+    const dg_room_template_cache_entry_t *entry;
+    const dg_map_edge_opening_query_t *opening_query;
+    int required_opening_matches;
+    int variant_step;
+    int variant_width;
+    int variant_height;
+    dg_edge_opening_spec_t *room_openings;
+    size_t room_opening_count;
+    const dg_map_t *variant;
+    dg_map_t generated;
+    dg_status_t status;
+} dg_room_template_job_t;
 
-    if (request->room_types.definition_count > 0u &&
-        request->room_types.definitions == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
-    }
+typedef struct dg_room_template_batch {
+    dg_room_template_job_t **pending;
+} dg_room_template_batch_t;
 
-    has_untyped_template = request->room_types.policy.untyped_template_map_path[0] != '\0';
-    has_any_templates = false;
-    for (i = 0; i < request->room_types.definition_count; ++i) {
-        if (request->room_types.definitions[i].template_map_path[0] != '\0') {
-            has_any_templates = true;
-        }
-    }
-    if (!has_any_templates && has_untyped_template) {
-        has_any_templates = true;
-    }
-    if (!has_any_templates) {
-        return DG_STATUS_OK;
-    }
+/* A size variant this generation needs that its cache entry does not hold yet. */
+typedef struct dg_room_template_variant_job {
+    dg_cached_template_t *cached;
+    const dg_map_t *template_map;
+    int width;
+    int height;
+    dg_map_t generated;
+    const dg_map_t *variant;
+    dg_status_t status;
+} dg_room_template_variant_job_t;
+
+/*
+ * Runs the nested template generation for one room, then the opening query
+ * and connectivity passes. Reads only the job and its read-only template,
+ * so jobs can run on any thread.
+ */
+static dg_status_t dg_generate_room_template_instance(dg_room_template_job_t *job)
+{
+    const dg_room_metadata_t *room = job->room;
+    const dg_map_t *template_map = job->entry->map;
+    dg_generate_request_t template_request;
+    dg_process_method_t *process_methods;
+    dg_edge_opening_spec_t *edge_openings;
+    dg_edge_opening_spec_t *connectivity_openings;
+    size_t connectivity_opening_count;
+    dg_map_t generated_template;
+    int template_width;
+    int template_height;
+    int template_scale_factor;
+    int attempt_width;
+    int attempt_height;
+    int attempt_index;
+    size_t opening_match_count;
+    int use_room_like_entrance_rooms;
+    dg_status_t status;
 
-    if (dg_room_template_application_depth > 0) {
-        return DG_STATUS_GENERATION_FAILED;
+    status = dg_compute_template_generation_dimensions(
+        &template_map->metadata.generation_request,
+        room->bounds.width,
+        room->bounds.height,
+        &template_width,
+        &template_height
+    );
+    if (status != DG_STATUS_OK) {
+        return status;
     }
-    dg_room_template_application_depth += 1;
-    cache_entries = NULL;
-    status = DG_STATUS_OK;
-    cache_count = request->room_types.definition_count + (has_untyped_template ? 1u : 0u);
-    untyped_cache_index = request->room_types.definition_count;
 
-    if (cache_count > (SIZE_MAX / sizeof(*cache_entries))) {
-        status = DG_STATUS_ALLOCATION_FAILED;
-        goto cleanup;
-    }
-    cache_entries = (dg_room_template_cache_entry_t *)calloc(
-        cache_count,
-        sizeof(*cache_entries)
+    status = dg_compute_template_process_scale_factor(
+        &template_map->metadata.generation_request,
+        &template_scale_factor
     );
-    if (cache_entries == NULL) {
-        status = DG_STATUS_ALLOCATION_FAILED;
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    template_request = (dg_generate_request_t){0};
+    process_methods = NULL;
+    edge_openings = NULL;
+    generated_template = (dg_map_t){0};
+
+    for (attempt_index = 0; attempt_index < 4; ++attempt_index) {
+        attempt_width = template_width + attempt_index;
+        attempt_height = template_height + attempt_index;
+        if (attempt_width > room->bounds.width) {
+            attempt_width = room->bounds.width;
+        }
+        if (attempt_height > room->bounds.height) {
+            attempt_height = room->bounds.height;
+        }
+        if (template_scale_factor > 1) {
+            int max_attempt_width = dg_max_int(1, room->bounds.width - 1);
+            int max_attempt_height = dg_max_int(1, room->bounds.height - 1);
+            if (attempt_width > max_attempt_width) {
+                attempt_width = max_attempt_width;
+            }
+            if (attempt_height > max_attempt_height) {
+                attempt_height = max_attempt_height;
+            }
+        }
+
+        status = dg_build_template_request_from_snapshot(
+            &template_map->metadata.generation_request,
+            attempt_width,
+            attempt_height,
+            template_map->metadata.seed ^
+                ((uint64_t)(room->id + 1) * UINT64_C(11400714819323198485)) ^
+                ((uint64_t)(attempt_index + 1) * UINT64_C(14029467366897019727)),
+            &template_request,
+            &process_methods,
+            &edge_openings
+        );
+        if (status != DG_STATUS_OK) {
+            break;
+        }
+
+        if (job->room_opening_count > 0u) {
+            dg_edge_opening_spec_t *scaled_room_openings;
+
+            scaled_room_openings = NULL;
+            status = dg_scale_runtime_edge_openings_to_dimensions(
+                job->room_openings,
+                job->room_opening_count,
+                room->bounds.width,
+                room->bounds.height,
+                template_request.width,
+                template_request.height,
+                &scaled_room_openings
+            );
+            if (status != DG_STATUS_OK) {
+                dg_release_template_request_buffers(process_methods, edge_openings);
+                process_methods = NULL;
+                edge_openings = NULL;
+                break;
+            }
+
+            free(edge_openings);
+            edge_openings = scaled_room_openings;
+            template_request.edge_openings.openings = edge_openings;
+            template_request.edge_openings.opening_count = job->room_opening_count;
+        }
+
+        status = dg_generate_internal_allow_small(&template_request, &generated_template);
+        if (status == DG_STATUS_OK) {
+            break;
+        }
+
+        dg_release_template_request_buffers(process_methods, edge_openings);
+        process_methods = NULL;
+        edge_openings = NULL;
+        dg_map_destroy(&generated_template);
+        generated_template = (dg_map_t){0};
+
+        if (status != DG_STATUS_GENERATION_FAILED || attempt_index + 1 >= 4) {
+            break;
+        }
+    }
+
+    if (status != DG_STATUS_OK) {
+        dg_release_template_request_buffers(process_methods, edge_openings);
+        return status;
+    }
+
+    if (job->required_opening_matches > 0 && job->opening_query != NULL) {
+        opening_match_count = dg_map_query_edge_openings(
+            &generated_template,
+            job->opening_query,
+            NULL,
+            0u
+        );
+        if (opening_match_count < (size_t)job->required_opening_matches) {
+            dg_release_template_request_buffers(process_methods, edge_openings);
+            dg_map_destroy(&generated_template);
+            return DG_STATUS_GENERATION_FAILED;
+        }
+    }
+
+    connectivity_openings = NULL;
+    connectivity_opening_count = 0u;
+    if (job->room_opening_count > 0u) {
+        status = dg_scale_runtime_edge_openings_to_dimensions(
+            job->room_openings,
+            job->room_opening_count,
+            room->bounds.width,
+            room->bounds.height,
+            generated_template.width,
+            generated_template.height,
+            &connectivity_openings
+        );
+        if (status != DG_STATUS_OK) {
+            dg_release_template_request_buffers(process_methods, edge_openings);
+            dg_map_destroy(&generated_template);
+            return status;
+        }
+        connectivity_opening_count = job->room_opening_count;
+    } else if (template_request.edge_openings.opening_count > 0u &&
+               template_request.edge_openings.openings != NULL) {
+        status = dg_scale_runtime_edge_openings_to_dimensions(
+            template_request.edge_openings.openings,
+            template_request.edge_openings.opening_count,
+            template_request.width,
+            template_request.height,
+            generated_template.width,
+            generated_template.height,
+            &connectivity_openings
+        );
+        if (status != DG_STATUS_OK) {
+            dg_release_template_request_buffers(process_methods, edge_openings);
+            dg_map_destroy(&generated_template);
+            return status;
+        }
+        connectivity_opening_count = template_request.edge_openings.opening_count;
+    }
+
+    use_room_like_entrance_rooms = 0;
+    if (generated_template.metadata.generation_class == DG_MAP_GENERATION_CLASS_ROOM_LIKE) {
+        use_room_like_entrance_rooms = 1;
+    }
+    /*
+     * Rooms-and-mazes template generation handles entrance room placement
+     * during generation, before random room placement, so no post-pass
+     * room painting should happen here.
+     */
+    if (generated_template.metadata.algorithm_id == (int)DG_ALGORITHM_ROOMS_AND_MAZES) {
+        use_room_like_entrance_rooms = 0;
+        connectivity_opening_count = 0u;
+    }
+    if (connectivity_opening_count > 0u && connectivity_openings != NULL) {
+        status = dg_enforce_template_opening_connectivity(
+            &generated_template,
+            connectivity_openings,
+            connectivity_opening_count,
+            use_room_like_entrance_rooms
+        );
+        if (status != DG_STATUS_OK) {
+            free(connectivity_openings);
+            dg_release_template_request_buffers(process_methods, edge_openings);
+            dg_map_destroy(&generated_template);
+            return status;
+        }
+    }
+    free(connectivity_openings);
+    dg_release_template_request_buffers(process_methods, edge_openings);
+
+    dg_normalize_template_tiles(&generated_template);
+    job->generated = generated_template;
+    return DG_STATUS_OK;
+}
+
+/*
+ * Fits a prepared size variant to a room with entrances: a copy of the
+ * variant at its own size gets the room's openings patched in and connected,
+ * the same pass a freshly generated block goes through. Stamping then
+ * resamples it to the room.
+ */
+static dg_status_t dg_fit_room_template_variant(dg_room_template_job_t *job)
+{
+    const dg_map_t *variant = job->variant;
+    dg_edge_opening_spec_t *openings;
+    dg_map_t fitted;
+    dg_status_t status;
+
+    fitted = (dg_map_t){0};
+    status = dg_map_init(&fitted, variant->width, variant->height, DG_TILE_VOID);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+    memcpy(
+        fitted.tiles,
+        variant->tiles,
+        (size_t)variant->width * (size_t)variant->height * sizeof(*fitted.tiles)
+    );
+    fitted.metadata.algorithm_id = variant->metadata.algorithm_id;
+    fitted.metadata.generation_class = variant->metadata.generation_class;
+
+    openings = NULL;
+    status = dg_scale_runtime_edge_openings_to_dimensions(
+        job->room_openings,
+        job->room_opening_count,
+        job->room->bounds.width,
+        job->room->bounds.height,
+        fitted.width,
+        fitted.height,
+        &openings
+    );
+    if (status == DG_STATUS_OK) {
+        status = dg_enforce_template_opening_connectivity(
+            &fitted,
+            openings,
+            job->room_opening_count,
+            (fitted.metadata.generation_class == DG_MAP_GENERATION_CLASS_ROOM_LIKE) ? 1 : 0
+        );
+    }
+    free(openings);
+    if (status != DG_STATUS_OK) {
+        dg_map_destroy(&fitted);
+        return status;
+    }
+
+    dg_normalize_template_tiles(&fitted);
+    job->generated = fitted;
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_generate_room_template_variant(
+    const dg_map_t *template_map,
+    int width,
+    int height,
+    dg_map_t *out_map
+)
+{
+    dg_room_metadata_t room;
+    dg_room_template_cache_entry_t entry;
+    dg_room_template_job_t job;
+    dg_status_t status;
+
+    if (template_map == NULL || out_map == NULL || width <= 0 || height <= 0) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dg_validate_loaded_room_template(template_map);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    /* Rooms-and-mazes blocks place their entrances during generation. */
+    if (template_map->metadata.generation_request.algorithm_id ==
+        (int)DG_ALGORITHM_ROOMS_AND_MAZES) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    /* Variants are shared by every room, so they are seeded as room id -1. */
+    room = (dg_room_metadata_t){0};
+    room.id = -1;
+    room.bounds = (dg_rect_t){0, 0, width, height};
+    entry = (dg_room_template_cache_entry_t){0};
+    entry.has_template = 1;
+    entry.map = template_map;
+    job = (dg_room_template_job_t){0};
+    job.room = &room;
+    job.entry = &entry;
+
+    status = dg_generate_room_template_instance(&job);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    *out_map = job.generated;
+    return DG_STATUS_OK;
+}
+
+int dg_template_variant_bucket_size(int size, int step)
+{
+    int bucket = ((size + step / 2) / step) * step;
+
+    return (bucket < step) ? step : bucket;
+}
+
+static void dg_generate_room_template_variant_range(void *context, size_t begin, size_t end)
+{
+    dg_room_template_variant_job_t *variant_jobs = (dg_room_template_variant_job_t *)context;
+    size_t i;
+
+    for (i = begin; i < end; ++i) {
+        dg_room_template_variant_job_t *variant_job = &variant_jobs[i];
+
+        variant_job->status = dg_generate_room_template_variant(
+            variant_job->template_map,
+            variant_job->width,
+            variant_job->height,
+            &variant_job->generated
+        );
+    }
+}
+
+/*
+ * Points every job whose room type has a variant step at the variant for its
+ * bucket. Buckets the cache lacks are generated once each across worker
+ * threads and published; a block the entry has no room for stays in
+ * `variant_jobs` for the caller to free. A variant only depends on the
+ * template and its bucket, so the map never depends on what was cached.
+ */
+static dg_status_t dg_resolve_room_template_variants(
+    dg_room_template_job_t *jobs,
+    size_t job_count,
+    dg_room_template_variant_job_t **out_variant_jobs,
+    size_t *out_variant_job_count
+)
+{
+    dg_room_template_variant_job_t *variant_jobs;
+    size_t variant_job_count;
+    size_t i;
+    size_t j;
+
+    *out_variant_jobs = NULL;
+    *out_variant_job_count = 0u;
+    variant_jobs = NULL;
+    variant_job_count = 0u;
+    for (i = 0; i < job_count; ++i) {
+        dg_room_template_job_t *job = &jobs[i];
+
+        if (job->entry == NULL || job->variant_step <= 0) {
+            continue;
+        }
+
+        job->variant_width =
+            dg_template_variant_bucket_size(job->room->bounds.width, job->variant_step);
+        job->variant_height =
+            dg_template_variant_bucket_size(job->room->bounds.height, job->variant_step);
+        job->variant = dg_template_cache_find_variant(
+            job->entry->cached,
+            job->variant_width,
+            job->variant_height
+        );
+        if (job->variant != NULL) {
+            continue;
+        }
+
+        for (j = 0; j < variant_job_count; ++j) {
+            if (variant_jobs[j].cached == job->entry->cached &&
+                variant_jobs[j].width == job->variant_width &&
+                variant_jobs[j].height == job->variant_height) {
+                break;
+            }
+        }
+        if (j < variant_job_count) {
+            continue;
+        }
+        if (variant_jobs == NULL) {
+            variant_jobs = (dg_room_template_variant_job_t *)calloc(
+                job_count,
+                sizeof(*variant_jobs)
+            );
+            if (variant_jobs == NULL) {
+                return DG_STATUS_ALLOCATION_FAILED;
+            }
+            *out_variant_jobs = variant_jobs;
+        }
+        variant_jobs[variant_job_count].cached = job->entry->cached;
+        variant_jobs[variant_job_count].template_map = job->entry->map;
+        variant_jobs[variant_job_count].width = job->variant_width;
+        variant_jobs[variant_job_count].height = job->variant_height;
+        variant_job_count += 1u;
+        *out_variant_job_count = variant_job_count;
+    }
+
+    dg_parallel_for(variant_job_count, 1u, dg_generate_room_template_variant_range, variant_jobs);
+    for (j = 0; j < variant_job_count; ++j) {
+        dg_room_template_variant_job_t *variant_job = &variant_jobs[j];
+
+        if (variant_job->status != DG_STATUS_OK) {
+            return variant_job->status;
+        }
+        variant_job->variant = dg_template_cache_publish_variant(
+            variant_job->cached,
+            variant_job->width,
+            variant_job->height,
+            &variant_job->generated
+        );
+        if (variant_job->variant == NULL) {
+            variant_job->variant = &variant_job->generated;
+        }
+    }
+
+    for (i = 0; i < job_count; ++i) {
+        dg_room_template_job_t *job = &jobs[i];
+
+        if (job->entry == NULL || job->variant_step <= 0 || job->variant != NULL) {
+            continue;
+        }
+        for (j = 0; j < variant_job_count; ++j) {
+            if (variant_jobs[j].cached == job->entry->cached &&
+                variant_jobs[j].width == job->variant_width &&
+                variant_jobs[j].height == job->variant_height) {
+                job->variant = variant_jobs[j].variant;
+                break;
+            }
+        }
+    }
+
+    return DG_STATUS_OK;
+}
+
+static void dg_generate_room_template_range(void *context, size_t begin, size_t end)
+{
+    dg_room_template_batch_t *batch = (dg_room_template_batch_t *)context;
+    size_t i;
+
+    for (i = begin; i < end; ++i) {
+        dg_room_template_job_t *job = batch->pending[i];
+
+        job->status = (job->variant != NULL)
+                          ? dg_fit_room_template_variant(job)
+                          : dg_generate_room_template_instance(job);
+    }
+}
+
+/*
+ * Entrance openings are read from the host map, which stamping rewrites
+ * inside each room. Outside tiles that belong to any room are ignored, so
+ * openings only depend on earlier stamps when two templated rooms overlap.
+ */
+static bool dg_templated_rooms_overlap(const dg_map_t *map, const dg_room_template_job_t *jobs)
+{
+    size_t i;
+    size_t j;
+
+    for (i = 0; i < map->metadata.room_count; ++i) {
+        const dg_rect_t *a = &map->metadata.rooms[i].bounds;
+
+        if (jobs[i].entry == NULL) {
+            continue;
+        }
+        for (j = i + 1u; j < map->metadata.room_count; ++j) {
+            const dg_rect_t *b = &map->metadata.rooms[j].bounds;
+
+            if (jobs[j].entry == NULL) {
+                continue;
+            }
+            if (a->x < b->x + b->width && b->x < a->x + a->width &&
+                a->y < b->y + b->height && b->y < a->y + a->height) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * Collects openings for rooms [begin, end), generates their blocks across
+ * worker threads, then checks and stamps them in room order so the map and
+ * the first reported error match a sequential pass.
+ */
+static dg_status_t dg_apply_room_template_batch(
+    dg_map_t *map,
+    const unsigned char *room_cells,
+    dg_room_template_job_t *jobs,
+    dg_room_template_job_t **pending,
+    size_t begin,
+    size_t end
+)
+{
+    dg_room_template_batch_t batch;
+    size_t pending_count;
+    size_t i;
+    dg_status_t status;
+
+    pending_count = 0u;
+    for (i = begin; i < end; ++i) {
+        dg_room_template_job_t *job = &jobs[i];
+
+        if (job->entry == NULL) {
+            continue;
+        }
+
+        status = dg_collect_room_entrance_openings(
+            map,
+            room_cells,
+            &job->room->bounds,
+            &job->room_openings,
+            &job->room_opening_count
+        );
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+
+        /* A variant replaces the nested generation; rooms with entrances get a fitted copy. */
+        if (job->variant == NULL || job->room_opening_count > 0u) {
+            pending[pending_count++] = job;
+        }
+    }
+
+    batch.pending = pending;
+    dg_parallel_for(pending_count, 1u, dg_generate_room_template_range, &batch);
+
+    for (i = begin; i < end; ++i) {
+        dg_room_template_job_t *job = &jobs[i];
+
+        if (job->entry == NULL) {
+            continue;
+        }
+
+        if (job->variant != NULL && job->room_opening_count == 0u) {
+            status = dg_apply_template_to_room(map, &job->room->bounds, job->variant);
+        } else {
+            if (job->status != DG_STATUS_OK) {
+                return job->status;
+            }
+            status = dg_apply_template_to_room(map, &job->room->bounds, &job->generated);
+            dg_map_destroy(&job->generated);
+        }
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+    }
+
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_apply_room_type_templates(
+    const dg_generate_request_t *request,
+    dg_map_t *map
+)
+{
+    dg_room_template_cache_entry_t *cache_entries;
+    dg_room_template_job_t *jobs;
+    dg_room_template_job_t **pending;
+    dg_room_template_variant_job_t *variant_jobs;
+    unsigned char *room_cells;
+    size_t variant_job_count;
+    size_t cache_count;
+    size_t untyped_cache_index;
+    size_t batch_size;
+    size_t i;
+    dg_status_t status;
+    bool has_any_templates;
+    bool has_untyped_template;
+
+    if (request == NULL || map == NULL || map->tiles == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (map->metadata.generation_class != DG_MAP_GENERATION_CLASS_ROOM_LIKE ||
+        map->metadata.rooms == NULL ||
+        map->metadata.room_count == 0) {
+        return DG_STATUS_OK;
+    }
+
+    if (request->room_types.definition_count > 0u &&
+        request->room_types.definitions == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    has_untyped_template = request->room_types.policy.untyped_template_map_path[0] != '\0';
+    has_any_templates = false;
+    for (i = 0; i < request->room_types.definition_count; ++i) {
+        if (request->room_types.definitions[i].template_map_path[0] != '\0') {
+            has_any_templates = true;
+        }
+    }
+    if (!has_any_templates && has_untyped_template) {
+        has_any_templates = true;
+    }
+    if (!has_any_templates) {
+        return DG_STATUS_OK;
+    }
+
+    if (dg_room_template_application_depth > 0) {
+        return DG_STATUS_GENERATION_FAILED;
+    }
+    dg_room_template_application_depth += 1;
+    cache_entries = NULL;
+    jobs = NULL;
+    pending = NULL;
+    variant_jobs = NULL;
+    variant_job_count = 0u;
+    room_cells = NULL;
+    status = DG_STATUS_OK;
+    cache_count = request->room_types.definition_count + (has_untyped_template ? 1u : 0u);
+    untyped_cache_index = request->room_types.definition_count;
+
+    if (cache_count > (SIZE_MAX / sizeof(*cache_entries))) {
+        status = DG_STATUS_ALLOCATION_FAILED;
+        goto cleanup;
+    }
+    cache_entries = (dg_room_template_cache_entry_t *)calloc(
+        cache_count,
+        sizeof(*cache_entries)
+    );
+    if (cache_entries == NULL) {
+        status = DG_STATUS_ALLOCATION_FAILED;
         goto cleanup;
     }
 
@@ -2754,14 +3753,16 @@ dg_status_t dg_apply_room_type_templates(
         }
 
         entry->has_template = 1;
-        entry->map = (dg_map_t){0};
-        status = dg_map_load_file(definition->template_map_path, &entry->map);
+        status = dg_template_cache_acquire(
+            definition->template_map_path,
+            &entry->cached,
+            &entry->map
+        );
         if (status != DG_STATUS_OK) {
             goto cleanup;
         }
-        entry->loaded = 1;
 
-        status = dg_validate_loaded_room_template(&entry->map);
+        status = dg_validate_loaded_room_template(entry->map);
         if (status != DG_STATUS_OK) {
             goto cleanup;
         }
@@ -2770,281 +3771,95 @@ dg_status_t dg_apply_room_type_templates(
     if (has_untyped_template) {
         dg_room_template_cache_entry_t *entry = &cache_entries[untyped_cache_index];
         entry->has_template = 1;
-        entry->map = (dg_map_t){0};
-        status = dg_map_load_file(request->room_types.policy.untyped_template_map_path, &entry->map);
+        status = dg_template_cache_acquire(
+            request->room_types.policy.untyped_template_map_path,
+            &entry->cached,
+            &entry->map
+        );
         if (status != DG_STATUS_OK) {
             goto cleanup;
         }
-        entry->loaded = 1;
 
-        status = dg_validate_loaded_room_template(&entry->map);
+        status = dg_validate_loaded_room_template(entry->map);
         if (status != DG_STATUS_OK) {
             goto cleanup;
         }
     }
 
+    if (map->metadata.room_count > (SIZE_MAX / sizeof(*jobs))) {
+        status = DG_STATUS_ALLOCATION_FAILED;
+        goto cleanup;
+    }
+    jobs = (dg_room_template_job_t *)calloc(map->metadata.room_count, sizeof(*jobs));
+    pending = (dg_room_template_job_t **)calloc(map->metadata.room_count, sizeof(*pending));
+    if (jobs == NULL || pending == NULL) {
+        status = DG_STATUS_ALLOCATION_FAILED;
+        goto cleanup;
+    }
+
     for (i = 0; i < map->metadata.room_count; ++i) {
         const dg_room_metadata_t *room = &map->metadata.rooms[i];
-        const dg_map_edge_opening_query_t *opening_query;
-        int required_opening_matches;
-        size_t definition_index;
+        dg_room_template_job_t *job = &jobs[i];
         dg_room_template_cache_entry_t *entry;
-        dg_generate_request_t template_request;
-        dg_process_method_t *process_methods;
-        dg_edge_opening_spec_t *edge_openings;
-        dg_edge_opening_spec_t *room_openings;
-        dg_edge_opening_spec_t *connectivity_openings;
-        size_t room_opening_count;
-        size_t connectivity_opening_count;
-        dg_map_t generated_template;
-        int template_width;
-        int template_height;
-        int template_scale_factor;
-        int attempt_width;
-        int attempt_height;
-        int attempt_index;
-        size_t opening_match_count;
-        int use_room_like_entrance_rooms;
 
+        *job = (dg_room_template_job_t){0};
+        job->room = room;
         if (room->type_id == DG_ROOM_TYPE_UNASSIGNED) {
             if (!has_untyped_template) {
                 continue;
             }
             entry = &cache_entries[untyped_cache_index];
-            if (entry->has_template == 0 || entry->loaded == 0) {
+            if (entry->has_template == 0 || entry->cached == NULL) {
                 continue;
             }
-            opening_query = NULL;
-            required_opening_matches = 0;
         } else {
             const dg_room_type_definition_t *definition;
+            size_t definition_index;
+
             definition_index = dg_find_room_type_definition_index_by_type_id(request, room->type_id);
             if (definition_index == SIZE_MAX) {
                 continue;
             }
 
             entry = &cache_entries[definition_index];
-            if (entry->has_template == 0 || entry->loaded == 0) {
+            if (entry->has_template == 0 || entry->cached == NULL) {
                 continue;
             }
 
             definition = &request->room_types.definitions[definition_index];
-            opening_query = &definition->template_opening_query;
-            required_opening_matches = definition->template_required_opening_matches;
-        }
-
-        room_openings = NULL;
-        room_opening_count = 0u;
-        status = dg_collect_room_entrance_openings(
-            map,
-            &room->bounds,
-            &room_openings,
-            &room_opening_count
-        );
-        if (status != DG_STATUS_OK) {
-            goto cleanup;
-        }
-
-        status = dg_compute_template_generation_dimensions(
-            &entry->map.metadata.generation_request,
-            room->bounds.width,
-            room->bounds.height,
-            &template_width,
-            &template_height
-        );
-        if (status != DG_STATUS_OK) {
-            free(room_openings);
-            goto cleanup;
-        }
-
-        status = dg_compute_template_process_scale_factor(
-            &entry->map.metadata.generation_request,
-            &template_scale_factor
-        );
-        if (status != DG_STATUS_OK) {
-            free(room_openings);
-            goto cleanup;
-        }
-
-        template_request = (dg_generate_request_t){0};
-        process_methods = NULL;
-        edge_openings = NULL;
-        generated_template = (dg_map_t){0};
-
-        for (attempt_index = 0; attempt_index < 4; ++attempt_index) {
-            attempt_width = template_width + attempt_index;
-            attempt_height = template_height + attempt_index;
-            if (attempt_width > room->bounds.width) {
-                attempt_width = room->bounds.width;
-            }
-            if (attempt_height > room->bounds.height) {
-                attempt_height = room->bounds.height;
-            }
-            if (template_scale_factor > 1) {
-                int max_attempt_width = dg_max_int(1, room->bounds.width - 1);
-                int max_attempt_height = dg_max_int(1, room->bounds.height - 1);
-                if (attempt_width > max_attempt_width) {
-                    attempt_width = max_attempt_width;
-                }
-                if (attempt_height > max_attempt_height) {
-                    attempt_height = max_attempt_height;
-                }
-            }
-
-            status = dg_build_template_request_from_snapshot(
-                &entry->map.metadata.generation_request,
-                attempt_width,
-                attempt_height,
-                entry->map.metadata.seed ^
-                    ((uint64_t)(room->id + 1) * UINT64_C(11400714819323198485)) ^
-                    ((uint64_t)(attempt_index + 1) * UINT64_C(14029467366897019727)),
-                &template_request,
-                &process_methods,
-                &edge_openings
-            );
-            if (status != DG_STATUS_OK) {
-                break;
-            }
-
-            if (room_opening_count > 0u) {
-                dg_edge_opening_spec_t *scaled_room_openings;
-
-                scaled_room_openings = NULL;
-                status = dg_scale_runtime_edge_openings_to_dimensions(
-                    room_openings,
-                    room_opening_count,
-                    room->bounds.width,
-                    room->bounds.height,
-                    template_request.width,
-                    template_request.height,
-                    &scaled_room_openings
-                );
-                if (status != DG_STATUS_OK) {
-                    dg_release_template_request_buffers(process_methods, edge_openings);
-                    process_methods = NULL;
-                    edge_openings = NULL;
-                    break;
-                }
-
-                free(edge_openings);
-                edge_openings = scaled_room_openings;
-                template_request.edge_openings.openings = edge_openings;
-                template_request.edge_openings.opening_count = room_opening_count;
-            }
-
-            status = dg_generate_internal_allow_small(&template_request, &generated_template);
-            if (status == DG_STATUS_OK) {
-                break;
-            }
-
-            dg_release_template_request_buffers(process_methods, edge_openings);
-            process_methods = NULL;
-            edge_openings = NULL;
-            dg_map_destroy(&generated_template);
-            generated_template = (dg_map_t){0};
-
-            if (status != DG_STATUS_GENERATION_FAILED || attempt_index + 1 >= 4) {
-                break;
-            }
+            job->opening_query = &definition->template_opening_query;
+            job->required_opening_matches = definition->template_required_opening_matches;
+            job->variant_step = definition->template_variant_step;
         }
+        job->entry = entry;
+    }
 
-        if (status != DG_STATUS_OK) {
-            dg_release_template_request_buffers(process_methods, edge_openings);
-            free(room_openings);
-            goto cleanup;
-        }
+    status = dg_resolve_room_template_variants(
+        jobs,
+        map->metadata.room_count,
+        &variant_jobs,
+        &variant_job_count
+    );
+    if (status != DG_STATUS_OK) {
+        goto cleanup;
+    }
 
-        if (required_opening_matches > 0 && opening_query != NULL) {
-            opening_match_count = dg_map_query_edge_openings(
-                &generated_template,
-                opening_query,
-                NULL,
-                0u
-            );
-            if (opening_match_count < (size_t)required_opening_matches) {
-                dg_release_template_request_buffers(process_methods, edge_openings);
-                dg_map_destroy(&generated_template);
-                free(room_openings);
-                status = DG_STATUS_GENERATION_FAILED;
-                goto cleanup;
-            }
-        }
+    status = dg_build_room_cell_mask(map, &room_cells);
+    if (status != DG_STATUS_OK) {
+        goto cleanup;
+    }
 
-        connectivity_openings = NULL;
-        connectivity_opening_count = 0u;
-        if (room_opening_count > 0u) {
-            status = dg_scale_runtime_edge_openings_to_dimensions(
-                room_openings,
-                room_opening_count,
-                room->bounds.width,
-                room->bounds.height,
-                generated_template.width,
-                generated_template.height,
-                &connectivity_openings
-            );
-            if (status != DG_STATUS_OK) {
-                dg_release_template_request_buffers(process_methods, edge_openings);
-                dg_map_destroy(&generated_template);
-                free(room_openings);
-                goto cleanup;
-            }
-            connectivity_opening_count = room_opening_count;
-        } else if (template_request.edge_openings.opening_count > 0u &&
-                   template_request.edge_openings.openings != NULL) {
-            status = dg_scale_runtime_edge_openings_to_dimensions(
-                template_request.edge_openings.openings,
-                template_request.edge_openings.opening_count,
-                template_request.width,
-                template_request.height,
-                generated_template.width,
-                generated_template.height,
-                &connectivity_openings
-            );
-            if (status != DG_STATUS_OK) {
-                dg_release_template_request_buffers(process_methods, edge_openings);
-                dg_map_destroy(&generated_template);
-                free(room_openings);
-                goto cleanup;
-            }
-            connectivity_opening_count = template_request.edge_openings.opening_count;
-        }
+    /* Overlapping rooms fall back to one room per batch, as before. */
+    batch_size = dg_templated_rooms_overlap(map, jobs) ? 1u : map->metadata.room_count;
+    for (i = 0; i < map->metadata.room_count; i += batch_size) {
+        size_t end = i + batch_size;
 
-        use_room_like_entrance_rooms = 0;
-        if (generated_template.metadata.generation_class == DG_MAP_GENERATION_CLASS_ROOM_LIKE) {
-            use_room_like_entrance_rooms = 1;
-        }
-        /*
-         * Rooms-and-mazes template generation handles entrance room placement
-         * during generation, before random room placement, so no post-pass
-         * room painting should happen here.
-         */
-        if (generated_template.metadata.algorithm_id == (int)DG_ALGORITHM_ROOMS_AND_MAZES) {
-            use_room_like_entrance_rooms = 0;
-            connectivity_opening_count = 0u;
-        }
-        if (connectivity_opening_count > 0u && connectivity_openings != NULL) {
-            status = dg_enforce_template_opening_connectivity(
-                &generated_template,
-                connectivity_openings,
-                connectivity_opening_count,
-                use_room_like_entrance_rooms
-            );
-            if (status != DG_STATUS_OK) {
-                free(connectivity_openings);
-                dg_release_template_request_buffers(process_methods, edge_openings);
-                dg_map_destroy(&generated_template);
-                free(room_openings);
-                goto cleanup;
-            }
+        if (end > map->metadata.room_count) {
+            end = map->metadata.room_count;
         }
-        free(connectivity_openings);
-
-        status = dg_apply_template_to_room(map, &room->bounds, &generated_template);
-        dg_release_template_request_buffers(process_methods, edge_openings);
-        dg_map_destroy(&generated_template);
-        free(room_openings);
+        status = dg_apply_room_template_batch(map, room_cells, jobs, pending, i, end);
         if (status != DG_STATUS_OK) {
-            goto cleanup;
+            break;
         }
     }
 
@@ -3052,12 +3867,24 @@ cleanup:
     if (dg_room_template_application_depth > 0) {
         dg_room_template_application_depth -= 1;
     }
+    if (jobs != NULL) {
+        for (i = 0; i < map->metadata.room_count; ++i) {
+            free(jobs[i].room_openings);
+            dg_map_destroy(&jobs[i].generated);
+        }
+        free(jobs);
+    }
+    free(pending);
+    if (variant_jobs != NULL) {
+        for (i = 0; i < variant_job_count; ++i) {
+            dg_map_destroy(&variant_jobs[i].generated);
+        }
+        free(variant_jobs);
+    }
+    free(room_cells);
     if (cache_entries != NULL) {
         for (i = 0; i < cache_count; ++i) {
-            if (cache_entries[i].loaded) {
-                dg_map_destroy(&cache_entries[i].map);
-                cache_entries[i].loaded = 0;
-            }
+            dg_template_cache_release(cache_entries[i].cached);
         }
         free(cache_entries);
     }
@@ -670,155 +670,246 @@ static dg_status_t dg_place_random_rooms(
     return DG_STATUS_OK;
 }
 
-static bool dg_can_carve_maze_step(
-    const dg_map_t *map,
-    const int *regions,
-    int x,
-    int y,
-    int dir_x,
-    int dir_y
-)
+/*
+ * Maze carving works on two tile bitboards (one bit per tile, rows padded to
+ * whole 64-bit words):
+ *   blocked: tiles a maze step may never carve into. Seeded with every tile
+ *            that is not an unclaimed wall plus the 3x3 neighborhood of every
+ *            walkable tile (the room-exclusion mask), and extended with the
+ *            neighborhood of each maze region once it is finished.
+ *   region:  tiles carved by the region currently being grown. They may touch
+ *            a new step diagonally but not orthogonally.
+ * This reproduces the neighbor probing rules of the original carver exactly,
+ * so layouts for a given seed are unchanged.
+ */
+typedef struct dg_maze_bitboard {
+    int width;
+    int height;
+    size_t words_per_row;
+    uint64_t *blocked;
+    uint64_t *region;
+    int region_min_y;
+    int region_max_y;
+} dg_maze_bitboard_t;
+
+static bool dg_maze_bitboard_test(const dg_maze_bitboard_t *board, const uint64_t *bits, int x, int y)
 {
-    static const int directions[4][2] = {
-        {1, 0},
-        {-1, 0},
-        {0, 1},
-        {0, -1}
-    };
-    static const int diagonal_directions[4][2] = {
-        {1, 1},
-        {1, -1},
-        {-1, 1},
-        {-1, -1}
-    };
-    int mid_x;
-    int mid_y;
-    int dst_x;
-    int dst_y;
-    size_t source_index;
-    size_t mid_index;
-    size_t dst_index;
-    int source_region;
-    int d;
+    size_t word_index;
 
-    mid_x = x + dir_x;
-    mid_y = y + dir_y;
-    dst_x = x + dir_x * 2;
-    dst_y = y + dir_y * 2;
-
-    if (!dg_grid_in_bounds(map, mid_x, mid_y) || !dg_grid_in_bounds(map, dst_x, dst_y)) {
+    if (x < 0 || y < 0 || x >= board->width || y >= board->height) {
         return false;
     }
 
-    if (dg_map_get_tile(map, mid_x, mid_y) != DG_TILE_WALL) {
-        return false;
-    }
-    if (dg_map_get_tile(map, dst_x, dst_y) != DG_TILE_WALL) {
-        return false;
-    }
+    word_index = (size_t)y * board->words_per_row + ((size_t)x >> 6);
+    return ((bits[word_index] >> ((unsigned int)x & 63u)) & 1u) != 0u;
+}
 
-    source_index = dg_tile_index(map, x, y);
-    mid_index = dg_tile_index(map, mid_x, mid_y);
-    dst_index = dg_tile_index(map, dst_x, dst_y);
-    source_region = regions[source_index];
-    if (regions[mid_index] != -1 || regions[dst_index] != -1) {
-        return false;
+static void dg_maze_bitboard_set(const dg_maze_bitboard_t *board, uint64_t *bits, int x, int y)
+{
+    size_t word_index;
+
+    word_index = (size_t)y * board->words_per_row + ((size_t)x >> 6);
+    bits[word_index] |= (uint64_t)1u << ((unsigned int)x & 63u);
+}
+
+static void dg_maze_bitboard_destroy(dg_maze_bitboard_t *board)
+{
+    if (board == NULL) {
+        return;
     }
 
-    /*
-     * Keep a one-wall buffer from existing walkable space.
-     * Mid can touch the source and the new destination.
-     * Destination can only touch the new mid cell.
-     */
-    for (d = 0; d < 4; ++d) {
-        int nx = mid_x + directions[d][0];
-        int ny = mid_y + directions[d][1];
+    free(board->blocked);
+    free(board->region);
+    board->blocked = NULL;
+    board->region = NULL;
+}
 
-        if (!dg_grid_in_bounds(map, nx, ny)) {
-            continue;
-        }
+/*
+ * ORs the 3x3 dilation of `source` rows [min_y, max_y] into `blocked`.
+ */
+static void dg_maze_bitboard_dilate_into_blocked(
+    dg_maze_bitboard_t *board,
+    const uint64_t *source,
+    int min_y,
+    int max_y
+)
+{
+    size_t words_per_row;
+    int y;
 
-        if ((nx == x && ny == y) || (nx == dst_x && ny == dst_y)) {
-            continue;
-        }
+    words_per_row = board->words_per_row;
+    for (y = min_y; y <= max_y; ++y) {
+        const uint64_t *row = source + (size_t)y * words_per_row;
+        size_t w;
 
-        if (dg_is_walkable_tile(dg_map_get_tile(map, nx, ny))) {
-            return false;
+        for (w = 0; w < words_per_row; ++w) {
+            uint64_t spread;
+            int dy;
+
+            if (row[w] == 0u) {
+                continue;
+            }
+
+            spread = row[w] | (row[w] << 1) | (row[w] >> 1);
+            for (dy = -1; dy <= 1; ++dy) {
+                int ny = y + dy;
+                uint64_t *target;
+
+                if (ny < 0 || ny >= board->height) {
+                    continue;
+                }
+
+                target = board->blocked + (size_t)ny * words_per_row;
+                target[w] |= spread;
+                if ((row[w] >> 63) != 0u && w + 1u < words_per_row) {
+                    target[w + 1u] |= 1u;
+                }
+                if ((row[w] & 1u) != 0u && w > 0u) {
+                    target[w - 1u] |= (uint64_t)1u << 63;
+                }
+            }
         }
     }
+}
 
-    for (d = 0; d < 4; ++d) {
-        int nx = dst_x + directions[d][0];
-        int ny = dst_y + directions[d][1];
+static dg_status_t dg_maze_bitboard_init(
+    dg_maze_bitboard_t *board,
+    const dg_map_t *map,
+    const int *regions
+)
+{
+    size_t word_count;
+    uint64_t *walkable;
+    int x;
+    int y;
 
-        if (!dg_grid_in_bounds(map, nx, ny)) {
-            continue;
-        }
+    board->width = map->width;
+    board->height = map->height;
+    board->words_per_row = ((size_t)map->width + 63u) / 64u;
+    board->blocked = NULL;
+    board->region = NULL;
+    board->region_min_y = map->height;
+    board->region_max_y = -1;
 
-        if (nx == mid_x && ny == mid_y) {
-            continue;
-        }
+    if (board->words_per_row > SIZE_MAX / (size_t)map->height ||
+        board->words_per_row * (size_t)map->height > SIZE_MAX / sizeof(uint64_t)) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+    word_count = board->words_per_row * (size_t)map->height;
 
-        if (dg_is_walkable_tile(dg_map_get_tile(map, nx, ny))) {
-            return false;
-        }
+    board->blocked = (uint64_t *)calloc(word_count, sizeof(uint64_t));
+    board->region = (uint64_t *)calloc(word_count, sizeof(uint64_t));
+    walkable = (uint64_t *)calloc(word_count, sizeof(uint64_t));
+    if (board->blocked == NULL || board->region == NULL || walkable == NULL) {
+        free(walkable);
+        dg_maze_bitboard_destroy(board);
+        return DG_STATUS_ALLOCATION_FAILED;
     }
 
-    /*
-     * Also block diagonal touching against foreign walkable regions
-     * (rooms or other maze regions). Same-region diagonals are allowed
-     * so corridors can still make turns.
-     */
-    for (d = 0; d < 4; ++d) {
-        int nx = mid_x + diagonal_directions[d][0];
-        int ny = mid_y + diagonal_directions[d][1];
-        size_t nindex;
-        int neighbor_region;
+    for (y = 0; y < map->height; ++y) {
+        for (x = 0; x < map->width; ++x) {
+            size_t index = dg_tile_index(map, x, y);
+            dg_tile_t tile = map->tiles[index];
 
-        if (!dg_grid_in_bounds(map, nx, ny)) {
-            continue;
+            if (tile != DG_TILE_WALL || regions[index] != -1) {
+                dg_maze_bitboard_set(board, board->blocked, x, y);
+            }
+            if (dg_is_walkable_tile(tile)) {
+                dg_maze_bitboard_set(board, walkable, x, y);
+            }
         }
+    }
 
-        if (!dg_is_walkable_tile(dg_map_get_tile(map, nx, ny))) {
-            continue;
-        }
+    dg_maze_bitboard_dilate_into_blocked(board, walkable, 0, map->height - 1);
+    free(walkable);
+    return DG_STATUS_OK;
+}
 
-        nindex = dg_tile_index(map, nx, ny);
-        neighbor_region = regions[nindex];
-        if (source_region > 0 && neighbor_region == source_region) {
-            continue;
-        }
-        return false;
+static void dg_maze_bitboard_mark_carved(dg_maze_bitboard_t *board, int x, int y)
+{
+    dg_maze_bitboard_set(board, board->blocked, x, y);
+    dg_maze_bitboard_set(board, board->region, x, y);
+    if (y < board->region_min_y) {
+        board->region_min_y = y;
+    }
+    if (y > board->region_max_y) {
+        board->region_max_y = y;
     }
+}
 
-    for (d = 0; d < 4; ++d) {
-        int nx = dst_x + diagonal_directions[d][0];
-        int ny = dst_y + diagonal_directions[d][1];
-        size_t nindex;
-        int neighbor_region;
+/*
+ * Seals the finished region: its neighborhood becomes blocked for every later
+ * region and the region layer is cleared for the next one.
+ */
+static void dg_maze_bitboard_finish_region(dg_maze_bitboard_t *board)
+{
+    size_t row_words;
 
-        if (!dg_grid_in_bounds(map, nx, ny)) {
-            continue;
-        }
+    if (board->region_max_y < board->region_min_y) {
+        return;
+    }
 
-        if (!dg_is_walkable_tile(dg_map_get_tile(map, nx, ny))) {
-            continue;
-        }
+    dg_maze_bitboard_dilate_into_blocked(
+        board,
+        board->region,
+        board->region_min_y,
+        board->region_max_y
+    );
 
-        nindex = dg_tile_index(map, nx, ny);
-        neighbor_region = regions[nindex];
-        if (source_region > 0 && neighbor_region == source_region) {
-            continue;
-        }
+    row_words = (size_t)(board->region_max_y - board->region_min_y + 1) * board->words_per_row;
+    memset(
+        board->region + (size_t)board->region_min_y * board->words_per_row,
+        0,
+        row_words * sizeof(uint64_t)
+    );
+    board->region_min_y = board->height;
+    board->region_max_y = -1;
+}
+
+static bool dg_can_carve_maze_step(
+    const dg_maze_bitboard_t *board,
+    int x,
+    int y,
+    int dir_x,
+    int dir_y
+)
+{
+    int mid_x;
+    int mid_y;
+    int dst_x;
+    int dst_y;
+
+    mid_x = x + dir_x;
+    mid_y = y + dir_y;
+    dst_x = x + dir_x * 2;
+    dst_y = y + dir_y * 2;
+
+    if (dst_x < 0 || dst_y < 0 || dst_x >= board->width || dst_y >= board->height) {
         return false;
     }
 
-    return true;
+    /*
+     * Mid and destination must be unclaimed walls with a one-wall buffer
+     * from rooms and earlier maze regions.
+     */
+    if (dg_maze_bitboard_test(board, board->blocked, mid_x, mid_y) ||
+        dg_maze_bitboard_test(board, board->blocked, dst_x, dst_y)) {
+        return false;
+    }
+
+    /*
+     * The region being carved may touch the new cells diagonally (so the
+     * corridor can turn) but only the source may touch them orthogonally.
+     */
+    return !dg_maze_bitboard_test(board, board->region, mid_x + dir_y, mid_y + dir_x) &&
+           !dg_maze_bitboard_test(board, board->region, mid_x - dir_y, mid_y - dir_x) &&
+           !dg_maze_bitboard_test(board, board->region, dst_x + dir_y, dst_y + dir_x) &&
+           !dg_maze_bitboard_test(board, board->region, dst_x - dir_y, dst_y - dir_x) &&
+           !dg_maze_bitboard_test(board, board->region, dst_x + dir_x, dst_y + dir_y);
 }
 
 static bool dg_can_start_maze_region(
-    const dg_map_t *map,
-    const int *regions,
+    const dg_maze_bitboard_t *board,
     int start_x,
     int start_y
 )
@@ -827,8 +918,7 @@ static bool dg_can_start_maze_region(
 
     for (d = 0; d < 4; ++d) {
         if (dg_can_carve_maze_step(
-                map,
-                regions,
+                board,
                 start_x,
                 start_y,
                 DG_CARDINAL_DIRECTIONS[d][0],
@@ -841,9 +931,11 @@ static bool dg_can_start_maze_region(
     return false;
 }
 
-static dg_status_t dg_carve_maze_region(
+static void dg_carve_maze_region(
     dg_map_t *map,
     int *regions,
+    dg_maze_bitboard_t *board,
+    dg_maze_cell_t *stack,
     int start_x,
     int start_y,
     int region_id,
@@ -851,24 +943,13 @@ static dg_status_t dg_carve_maze_region(
     dg_rng_t *rng
 )
 {
-    size_t cell_capacity;
-    dg_maze_cell_t *stack;
     size_t stack_count;
     size_t start_index;
 
-    if (map == NULL || map->tiles == NULL || regions == NULL || rng == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
-    }
-
-    cell_capacity = (size_t)map->width * (size_t)map->height;
-    stack = (dg_maze_cell_t *)malloc(cell_capacity * sizeof(dg_maze_cell_t));
-    if (stack == NULL) {
-        return DG_STATUS_ALLOCATION_FAILED;
-    }
-
     start_index = dg_tile_index(map, start_x, start_y);
-    (void)dg_map_set_tile(map, start_x, start_y, DG_TILE_FLOOR);
+    map->tiles[start_index] = DG_TILE_FLOOR;
     regions[start_index] = region_id;
+    dg_maze_bitboard_mark_carved(board, start_x, start_y);
 
     stack_count = 0;
     stack[stack_count++] = (dg_maze_cell_t){start_x, start_y, -1};
@@ -892,8 +973,7 @@ static dg_status_t dg_carve_maze_region(
         valid_count = 0;
         for (d = 0; d < 4; ++d) {
             if (dg_can_carve_maze_step(
-                    map,
-                    regions,
+                    board,
                     cell.x,
                     cell.y,
                     DG_CARDINAL_DIRECTIONS[d][0],
@@ -940,16 +1020,17 @@ static dg_status_t dg_carve_maze_region(
         mid_index = dg_tile_index(map, mid_x, mid_y);
         dst_index = dg_tile_index(map, dst_x, dst_y);
 
-        (void)dg_map_set_tile(map, mid_x, mid_y, DG_TILE_FLOOR);
-        (void)dg_map_set_tile(map, dst_x, dst_y, DG_TILE_FLOOR);
+        map->tiles[mid_index] = DG_TILE_FLOOR;
+        map->tiles[dst_index] = DG_TILE_FLOOR;
         regions[mid_index] = region_id;
         regions[dst_index] = region_id;
+        dg_maze_bitboard_mark_carved(board, mid_x, mid_y);
+        dg_maze_bitboard_mark_carved(board, dst_x, dst_y);
 
         stack[stack_count++] = (dg_maze_cell_t){dst_x, dst_y, dir_choice};
     }
 
-    free(stack);
-    return DG_STATUS_OK;
+    dg_maze_bitboard_finish_region(board);
 }
 
 static dg_status_t dg_generate_maze_regions(
@@ -963,6 +1044,10 @@ static dg_status_t dg_generate_maze_regions(
     int *out_next_region_id
 )
 {
+    dg_maze_bitboard_t board;
+    dg_maze_cell_t *stack;
+    size_t cell_count;
+    dg_status_t status;
     int y;
     int x;
 
@@ -978,36 +1063,54 @@ static dg_status_t dg_generate_maze_regions(
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
+    /*
+     * Every push carves two fresh tiles, so one cell per tile is a safe
+     * upper bound for the DFS stack shared by all regions.
+     */
+    cell_count = (size_t)map->width * (size_t)map->height;
+    if (cell_count > SIZE_MAX / sizeof(dg_maze_cell_t)) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+    stack = (dg_maze_cell_t *)malloc(cell_count * sizeof(dg_maze_cell_t));
+    if (stack == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    status = dg_maze_bitboard_init(&board, map, regions);
+    if (status != DG_STATUS_OK) {
+        free(stack);
+        return status;
+    }
+
     for (y = start_y; y < map->height; y += 2) {
         for (x = start_x; x < map->width; x += 2) {
             size_t index = dg_tile_index(map, x, y);
-            dg_status_t status;
 
             if (map->tiles[index] != DG_TILE_WALL || regions[index] != -1) {
                 continue;
             }
 
-            if (!dg_can_start_maze_region(map, regions, x, y)) {
+            if (!dg_can_start_maze_region(&board, x, y)) {
                 continue;
             }
 
-            status = dg_carve_maze_region(
+            dg_carve_maze_region(
                 map,
                 regions,
+                &board,
+                stack,
                 x,
                 y,
                 next_region_id,
                 wiggle_percent,
                 rng
             );
-            if (status != DG_STATUS_OK) {
-                return status;
-            }
-
             next_region_id += 1;
         }
     }
 
+    dg_maze_bitboard_destroy(&board);
+    free(stack);
     *out_next_region_id = next_region_id;
     return DG_STATUS_OK;
 }
@@ -1,5 +1,4 @@
-#include "dungeoneer/io.h"
-#include "dungeoneer/generator.h"
+#include "io_internal.h"
 
 #include <limits.h>
 #include <stdio.h>
@@ -7,8 +6,15 @@
 #include <string.h>
 
 static const unsigned char DG_CONFIG_MAGIC[4] = {'D', 'G', 'C', 'F'};
+/* Tags the room-type variant steps that trail newer configs. */
+static const unsigned char DG_CONFIG_VARIANT_STEP_TAG[4] = {'D', 'G', 'V', 'S'};
 
-static bool dg_mul_size_would_overflow(size_t a, size_t b, size_t *out)
+/* Smallest encoded size of each snapshot list record. */
+#define DG_SNAPSHOT_EDGE_OPENING_RECORD_SIZE 16u
+#define DG_SNAPSHOT_PROCESS_METHOD_MIN_RECORD_SIZE 8u
+#define DG_SNAPSHOT_ROOM_TYPE_RECORD_SIZE (26u * 4u + DG_ROOM_TEMPLATE_PATH_MAX)
+
+bool dg_mul_size_would_overflow(size_t a, size_t b, size_t *out)
 {
     if (out == NULL) {
         return true;
@@ -55,7 +61,7 @@ static bool dg_i32_to_int_checked(int32_t value, int *out_value)
     return true;
 }
 
-static bool dg_map_is_empty(const dg_map_t *map)
+bool dg_map_is_empty(const dg_map_t *map)
 {
     if (map == NULL) {
         return false;
@@ -75,9 +81,9 @@ static bool dg_map_is_empty(const dg_map_t *map)
            map->metadata.generation_request.room_types.definitions == NULL;
 }
 
-static dg_status_t dg_write_exact(FILE *file, const void *data, size_t byte_count)
+dg_status_t dg_write_exact(dg_io_writer_t *writer, const void *data, size_t byte_count)
 {
-    if (file == NULL || (byte_count > 0 && data == NULL)) {
+    if (writer == NULL || (byte_count > 0 && data == NULL)) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
@@ -85,16 +91,56 @@ static dg_status_t dg_write_exact(FILE *file, const void *data, size_t byte_coun
         return DG_STATUS_OK;
     }
 
-    if (fwrite(data, 1, byte_count, file) != byte_count) {
-        return DG_STATUS_IO_ERROR;
+    if (writer->file != NULL) {
+        if (fwrite(data, 1, byte_count, writer->file) != byte_count) {
+            return DG_STATUS_IO_ERROR;
+        }
+        return DG_STATUS_OK;
+    }
+
+    if (byte_count > SIZE_MAX - writer->size) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    if (writer->fixed) {
+        if (writer->data != NULL && writer->size <= writer->capacity &&
+            byte_count <= writer->capacity - writer->size) {
+            memcpy(writer->data + writer->size, data, byte_count);
+        }
+        writer->size += byte_count;
+        return DG_STATUS_OK;
+    }
+
+    if (writer->size + byte_count > writer->capacity) {
+        size_t new_capacity;
+        unsigned char *grown;
+
+        new_capacity = (writer->capacity == 0) ? 256u : writer->capacity;
+        while (new_capacity < writer->size + byte_count) {
+            if (new_capacity > SIZE_MAX / 2u) {
+                new_capacity = writer->size + byte_count;
+                break;
+            }
+            new_capacity *= 2u;
+        }
+
+        grown = (unsigned char *)realloc(writer->data, new_capacity);
+        if (grown == NULL) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+
+        writer->data = grown;
+        writer->capacity = new_capacity;
     }
 
+    memcpy(writer->data + writer->size, data, byte_count);
+    writer->size += byte_count;
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_read_exact(FILE *file, void *data, size_t byte_count)
+dg_status_t dg_read_exact(dg_io_reader_t *reader, void *data, size_t byte_count)
 {
-    if (file == NULL || (byte_count > 0 && data == NULL)) {
+    if (reader == NULL || (byte_count > 0 && data == NULL)) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
@@ -102,14 +148,16 @@ static dg_status_t dg_read_exact(FILE *file, void *data, size_t byte_count)
         return DG_STATUS_OK;
     }
 
-    if (fread(data, 1, byte_count, file) != byte_count) {
+    if (reader->data == NULL || byte_count > reader->size - reader->offset) {
         return DG_STATUS_IO_ERROR;
     }
 
+    memcpy(data, reader->data + reader->offset, byte_count);
+    reader->offset += byte_count;
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_write_u32(FILE *file, uint32_t value)
+dg_status_t dg_write_u32(dg_io_writer_t *writer, uint32_t value)
 {
     unsigned char bytes[4];
 
@@ -117,15 +165,15 @@ static dg_status_t dg_write_u32(FILE *file, uint32_t value)
     bytes[1] = (unsigned char)((value >> 8) & 0xFFu);
     bytes[2] = (unsigned char)((value >> 16) & 0xFFu);
     bytes[3] = (unsigned char)((value >> 24) & 0xFFu);
-    return dg_write_exact(file, bytes, sizeof(bytes));
+    return dg_write_exact(writer, bytes, sizeof(bytes));
 }
 
-static dg_status_t dg_write_i32(FILE *file, int32_t value)
+dg_status_t dg_write_i32(dg_io_writer_t *writer, int32_t value)
 {
-    return dg_write_u32(file, (uint32_t)value);
+    return dg_write_u32(writer, (uint32_t)value);
 }
 
-static dg_status_t dg_write_u64(FILE *file, uint64_t value)
+dg_status_t dg_write_u64(dg_io_writer_t *writer, uint64_t value)
 {
     unsigned char bytes[8];
 
@@ -137,15 +185,15 @@ static dg_status_t dg_write_u64(FILE *file, uint64_t value)
     bytes[5] = (unsigned char)((value >> 40) & 0xFFu);
     bytes[6] = (unsigned char)((value >> 48) & 0xFFu);
     bytes[7] = (unsigned char)((value >> 56) & 0xFFu);
-    return dg_write_exact(file, bytes, sizeof(bytes));
+    return dg_write_exact(writer, bytes, sizeof(bytes));
 }
 
-static dg_status_t dg_write_size(FILE *file, size_t value)
+dg_status_t dg_write_size(dg_io_writer_t *writer, size_t value)
 {
-    return dg_write_u64(file, (uint64_t)value);
+    return dg_write_u64(writer, (uint64_t)value);
 }
 
-static dg_status_t dg_read_u32(FILE *file, uint32_t *out_value)
+dg_status_t dg_read_u32(dg_io_reader_t *reader, uint32_t *out_value)
 {
     unsigned char bytes[4];
     dg_status_t status;
@@ -154,7 +202,7 @@ static dg_status_t dg_read_u32(FILE *file, uint32_t *out_value)
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dg_read_exact(file, bytes, sizeof(bytes));
+    status = dg_read_exact(reader, bytes, sizeof(bytes));
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -166,7 +214,7 @@ static dg_status_t dg_read_u32(FILE *file, uint32_t *out_value)
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_read_i32(FILE *file, int32_t *out_value)
+dg_status_t dg_read_i32(dg_io_reader_t *reader, int32_t *out_value)
 {
     uint32_t raw;
     dg_status_t status;
@@ -175,7 +223,7 @@ static dg_status_t dg_read_i32(FILE *file, int32_t *out_value)
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dg_read_u32(file, &raw);
+    status = dg_read_u32(reader, &raw);
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -184,7 +232,7 @@ static dg_status_t dg_read_i32(FILE *file, int32_t *out_value)
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_read_u64(FILE *file, uint64_t *out_value)
+dg_status_t dg_read_u64(dg_io_reader_t *reader, uint64_t *out_value)
 {
     unsigned char bytes[8];
     dg_status_t status;
@@ -193,7 +241,7 @@ static dg_status_t dg_read_u64(FILE *file, uint64_t *out_value)
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dg_read_exact(file, bytes, sizeof(bytes));
+    status = dg_read_exact(reader, bytes, sizeof(bytes));
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -209,7 +257,7 @@ static dg_status_t dg_read_u64(FILE *file, uint64_t *out_value)
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_read_size(FILE *file, size_t *out_value)
+dg_status_t dg_read_size(dg_io_reader_t *reader, size_t *out_value)
 {
     uint64_t raw;
     dg_status_t status;
@@ -218,7 +266,7 @@ static dg_status_t dg_read_size(FILE *file, size_t *out_value)
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dg_read_u64(file, &raw);
+    status = dg_read_u64(reader, &raw);
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -464,6 +512,11 @@ static bool dg_snapshot_room_type_config_is_valid(
             definition->prefer_template_entrance_room != 1) {
             return false;
         }
+        if (definition->template_variant_step < 0 ||
+            (definition->template_variant_step > 0 &&
+             definition->template_required_opening_matches > 0)) {
+            return false;
+        }
 
         if (!dg_nonnegative_range_is_valid(
                 definition->constraints.area_min,
@@ -620,7 +673,7 @@ static bool dg_snapshot_algorithm_params_are_valid(const dg_generation_request_s
     }
 }
 
-static bool dg_snapshot_is_valid(const dg_generation_request_snapshot_t *snapshot)
+bool dg_snapshot_is_valid(const dg_generation_request_snapshot_t *snapshot)
 {
     if (snapshot == NULL) {
         return false;
@@ -644,7 +697,7 @@ static bool dg_snapshot_is_valid(const dg_generation_request_snapshot_t *snapsho
            dg_snapshot_room_type_config_is_valid(&snapshot->room_types);
 }
 
-static dg_status_t dg_allocate_array(void **out_ptr, size_t count, size_t element_size)
+dg_status_t dg_allocate_array(void **out_ptr, size_t count, size_t element_size)
 {
     size_t byte_count;
     void *allocated;
@@ -671,7 +724,7 @@ static dg_status_t dg_allocate_array(void **out_ptr, size_t count, size_t elemen
     return DG_STATUS_OK;
 }
 
-static void dg_snapshot_clear(dg_generation_request_snapshot_t *snapshot)
+void dg_snapshot_clear(dg_generation_request_snapshot_t *snapshot)
 {
     if (snapshot == NULL) {
         return;
@@ -684,244 +737,244 @@ static void dg_snapshot_clear(dg_generation_request_snapshot_t *snapshot)
 }
 
 static dg_status_t dg_write_snapshot_algorithm_params(
-    FILE *file,
+    dg_io_writer_t *writer,
     const dg_generation_request_snapshot_t *snapshot
 )
 {
     dg_status_t status;
 
-    if (file == NULL || snapshot == NULL) {
+    if (writer == NULL || snapshot == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
     switch ((dg_algorithm_t)snapshot->algorithm_id) {
     case DG_ALGORITHM_BSP_TREE:
-        status = dg_write_i32(file, (int32_t)snapshot->params.bsp.min_rooms);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.bsp.min_rooms);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.bsp.max_rooms);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.bsp.max_rooms);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.bsp.room_min_size);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.bsp.room_min_size);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        return dg_write_i32(file, (int32_t)snapshot->params.bsp.room_max_size);
+        return dg_write_i32(writer, (int32_t)snapshot->params.bsp.room_max_size);
     case DG_ALGORITHM_DRUNKARDS_WALK:
-        return dg_write_i32(file, (int32_t)snapshot->params.drunkards_walk.wiggle_percent);
+        return dg_write_i32(writer, (int32_t)snapshot->params.drunkards_walk.wiggle_percent);
     case DG_ALGORITHM_CELLULAR_AUTOMATA:
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.cellular_automata.initial_wall_percent
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.cellular_automata.simulation_steps
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
-        return dg_write_i32(file, (int32_t)snapshot->params.cellular_automata.wall_threshold);
+        return dg_write_i32(writer, (int32_t)snapshot->params.cellular_automata.wall_threshold);
     case DG_ALGORITHM_VALUE_NOISE:
-        status = dg_write_i32(file, (int32_t)snapshot->params.value_noise.feature_size);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.value_noise.feature_size);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.value_noise.octaves);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.value_noise.octaves);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.value_noise.persistence_percent);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.value_noise.persistence_percent);
         if (status != DG_STATUS_OK) {
             return status;
         }
         return dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.value_noise.floor_threshold_percent
         );
     case DG_ALGORITHM_ROOMS_AND_MAZES:
-        status = dg_write_i32(file, (int32_t)snapshot->params.rooms_and_mazes.min_rooms);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.rooms_and_mazes.min_rooms);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.rooms_and_mazes.max_rooms);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.rooms_and_mazes.max_rooms);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.rooms_and_mazes.room_min_size);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.rooms_and_mazes.room_min_size);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.rooms_and_mazes.room_max_size);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.rooms_and_mazes.room_max_size);
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.rooms_and_mazes.maze_wiggle_percent
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.rooms_and_mazes.min_room_connections
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.rooms_and_mazes.max_room_connections
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.rooms_and_mazes.ensure_full_connectivity
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
         return dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.rooms_and_mazes.dead_end_prune_steps
         );
     case DG_ALGORITHM_ROOM_GRAPH:
-        status = dg_write_i32(file, (int32_t)snapshot->params.room_graph.min_rooms);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.room_graph.min_rooms);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.room_graph.max_rooms);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.room_graph.max_rooms);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.room_graph.room_min_size);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.room_graph.room_min_size);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.room_graph.room_max_size);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.room_graph.room_max_size);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.room_graph.neighbor_candidates);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.room_graph.neighbor_candidates);
         if (status != DG_STATUS_OK) {
             return status;
         }
         return dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.room_graph.extra_connection_chance_percent
         );
     case DG_ALGORITHM_WORM_CAVES:
-        status = dg_write_i32(file, (int32_t)snapshot->params.worm_caves.worm_count);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.worm_caves.worm_count);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.worm_caves.wiggle_percent);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.worm_caves.wiggle_percent);
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.worm_caves.branch_chance_percent
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.worm_caves.target_floor_percent
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.worm_caves.brush_radius);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.worm_caves.brush_radius);
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.worm_caves.max_steps_per_worm
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
-        return dg_write_i32(file, (int32_t)snapshot->params.worm_caves.ensure_connected);
+        return dg_write_i32(writer, (int32_t)snapshot->params.worm_caves.ensure_connected);
     case DG_ALGORITHM_SIMPLEX_NOISE:
-        status = dg_write_i32(file, (int32_t)snapshot->params.simplex_noise.feature_size);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.simplex_noise.feature_size);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)snapshot->params.simplex_noise.octaves);
+        status = dg_write_i32(writer, (int32_t)snapshot->params.simplex_noise.octaves);
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.simplex_noise.persistence_percent
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_i32(
-            file,
+            writer,
             (int32_t)snapshot->params.simplex_noise.floor_threshold_percent
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
-        return dg_write_i32(file, (int32_t)snapshot->params.simplex_noise.ensure_connected);
+        return dg_write_i32(writer, (int32_t)snapshot->params.simplex_noise.ensure_connected);
     default:
         return DG_STATUS_INVALID_ARGUMENT;
     }
 }
 
-static dg_status_t dg_write_snapshot(FILE *file, const dg_generation_request_snapshot_t *snapshot)
+dg_status_t dg_write_snapshot(dg_io_writer_t *writer, const dg_generation_request_snapshot_t *snapshot)
 {
     dg_status_t status;
     size_t i;
 
-    if (file == NULL || snapshot == NULL) {
+    if (writer == NULL || snapshot == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dg_write_exact(file, DG_CONFIG_MAGIC, sizeof(DG_CONFIG_MAGIC));
+    status = dg_write_exact(writer, DG_CONFIG_MAGIC, sizeof(DG_CONFIG_MAGIC));
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_i32(file, (int32_t)snapshot->width);
+    status = dg_write_i32(writer, (int32_t)snapshot->width);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_i32(file, (int32_t)snapshot->height);
+    status = dg_write_i32(writer, (int32_t)snapshot->height);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_u64(file, snapshot->seed);
+    status = dg_write_u64(writer, snapshot->seed);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_i32(file, (int32_t)snapshot->algorithm_id);
+    status = dg_write_i32(writer, (int32_t)snapshot->algorithm_id);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_snapshot_algorithm_params(file, snapshot);
+    status = dg_write_snapshot_algorithm_params(writer, snapshot);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_size(file, snapshot->edge_openings.opening_count);
+    status = dg_write_size(writer, snapshot->edge_openings.opening_count);
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -929,30 +982,30 @@ static dg_status_t dg_write_snapshot(FILE *file, const dg_generation_request_sna
     for (i = 0; i < snapshot->edge_openings.opening_count; ++i) {
         const dg_snapshot_edge_opening_spec_t *opening = &snapshot->edge_openings.openings[i];
 
-        status = dg_write_i32(file, (int32_t)opening->side);
+        status = dg_write_i32(writer, (int32_t)opening->side);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)opening->start);
+        status = dg_write_i32(writer, (int32_t)opening->start);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)opening->end);
+        status = dg_write_i32(writer, (int32_t)opening->end);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)opening->role);
+        status = dg_write_i32(writer, (int32_t)opening->role);
         if (status != DG_STATUS_OK) {
             return status;
         }
     }
 
-    status = dg_write_i32(file, (int32_t)snapshot->process.enabled);
+    status = dg_write_i32(writer, (int32_t)snapshot->process.enabled);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_size(file, snapshot->process.method_count);
+    status = dg_write_size(writer, snapshot->process.method_count);
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -960,36 +1013,36 @@ static dg_status_t dg_write_snapshot(FILE *file, const dg_generation_request_sna
     for (i = 0; i < snapshot->process.method_count; ++i) {
         const dg_snapshot_process_method_t *method = &snapshot->process.methods[i];
 
-        status = dg_write_i32(file, (int32_t)method->type);
+        status = dg_write_i32(writer, (int32_t)method->type);
         if (status != DG_STATUS_OK) {
             return status;
         }
 
         switch ((dg_process_method_type_t)method->type) {
         case DG_PROCESS_METHOD_SCALE:
-            status = dg_write_i32(file, (int32_t)method->params.scale.factor);
+            status = dg_write_i32(writer, (int32_t)method->params.scale.factor);
             break;
         case DG_PROCESS_METHOD_PATH_SMOOTH:
-            status = dg_write_i32(file, (int32_t)method->params.path_smooth.strength);
+            status = dg_write_i32(writer, (int32_t)method->params.path_smooth.strength);
             if (status != DG_STATUS_OK) {
                 return status;
             }
-            status = dg_write_i32(file, (int32_t)method->params.path_smooth.inner_enabled);
+            status = dg_write_i32(writer, (int32_t)method->params.path_smooth.inner_enabled);
             if (status != DG_STATUS_OK) {
                 return status;
             }
-            status = dg_write_i32(file, (int32_t)method->params.path_smooth.outer_enabled);
+            status = dg_write_i32(writer, (int32_t)method->params.path_smooth.outer_enabled);
             break;
         case DG_PROCESS_METHOD_CORRIDOR_ROUGHEN:
-            status = dg_write_i32(file, (int32_t)method->params.corridor_roughen.strength);
+            status = dg_write_i32(writer, (int32_t)method->params.corridor_roughen.strength);
             if (status != DG_STATUS_OK) {
                 return status;
             }
-            status = dg_write_i32(file, (int32_t)method->params.corridor_roughen.max_depth);
+            status = dg_write_i32(writer, (int32_t)method->params.corridor_roughen.max_depth);
             if (status != DG_STATUS_OK) {
                 return status;
             }
-            status = dg_write_i32(file, (int32_t)method->params.corridor_roughen.mode);
+            status = dg_write_i32(writer, (int32_t)method->params.corridor_roughen.mode);
             break;
         default:
             return DG_STATUS_INVALID_ARGUMENT;
@@ -1000,28 +1053,28 @@ static dg_status_t dg_write_snapshot(FILE *file, const dg_generation_request_sna
         }
     }
 
-    status = dg_write_size(file, snapshot->room_types.definition_count);
+    status = dg_write_size(writer, snapshot->room_types.definition_count);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_i32(file, (int32_t)snapshot->room_types.policy.strict_mode);
+    status = dg_write_i32(writer, (int32_t)snapshot->room_types.policy.strict_mode);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_i32(file, (int32_t)snapshot->room_types.policy.allow_untyped_rooms);
+    status = dg_write_i32(writer, (int32_t)snapshot->room_types.policy.allow_untyped_rooms);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_write_u32(file, snapshot->room_types.policy.default_type_id);
+    status = dg_write_u32(writer, snapshot->room_types.policy.default_type_id);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
     status = dg_write_exact(
-        file,
+        writer,
         snapshot->room_types.policy.untyped_template_map_path,
         sizeof(snapshot->room_types.policy.untyped_template_map_path)
     );
@@ -1032,115 +1085,139 @@ static dg_status_t dg_write_snapshot(FILE *file, const dg_generation_request_sna
     for (i = 0; i < snapshot->room_types.definition_count; ++i) {
         const dg_snapshot_room_type_definition_t *definition = &snapshot->room_types.definitions[i];
 
-        status = dg_write_u32(file, definition->type_id);
+        status = dg_write_u32(writer, definition->type_id);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->enabled);
+        status = dg_write_i32(writer, (int32_t)definition->enabled);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->min_count);
+        status = dg_write_i32(writer, (int32_t)definition->min_count);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->max_count);
+        status = dg_write_i32(writer, (int32_t)definition->max_count);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->target_count);
+        status = dg_write_i32(writer, (int32_t)definition->target_count);
         if (status != DG_STATUS_OK) {
             return status;
         }
         status = dg_write_exact(
-            file,
+            writer,
             definition->template_map_path,
             sizeof(definition->template_map_path)
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_u32(file, definition->template_opening_query.side_mask);
+        status = dg_write_u32(writer, definition->template_opening_query.side_mask);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_u32(file, definition->template_opening_query.role_mask);
+        status = dg_write_u32(writer, definition->template_opening_query.role_mask);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->template_opening_query.edge_coord_min);
+        status = dg_write_i32(writer, (int32_t)definition->template_opening_query.edge_coord_min);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->template_opening_query.edge_coord_max);
+        status = dg_write_i32(writer, (int32_t)definition->template_opening_query.edge_coord_max);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->template_opening_query.min_length);
+        status = dg_write_i32(writer, (int32_t)definition->template_opening_query.min_length);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->template_opening_query.max_length);
+        status = dg_write_i32(writer, (int32_t)definition->template_opening_query.max_length);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->template_opening_query.require_component);
+        status = dg_write_i32(writer, (int32_t)definition->template_opening_query.require_component);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->template_required_opening_matches);
+        status = dg_write_i32(writer, (int32_t)definition->template_required_opening_matches);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->prefer_template_entrance_room);
+        status = dg_write_i32(writer, (int32_t)definition->prefer_template_entrance_room);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.area_min);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.area_min);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.area_max);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.area_max);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.degree_min);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.degree_min);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.degree_max);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.degree_max);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.border_distance_min);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.border_distance_min);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.border_distance_max);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.border_distance_max);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.graph_depth_min);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.graph_depth_min);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->constraints.graph_depth_max);
+        status = dg_write_i32(writer, (int32_t)definition->constraints.graph_depth_max);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->preferences.weight);
+        status = dg_write_i32(writer, (int32_t)definition->preferences.weight);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->preferences.larger_room_bias);
+        status = dg_write_i32(writer, (int32_t)definition->preferences.larger_room_bias);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->preferences.higher_degree_bias);
+        status = dg_write_i32(writer, (int32_t)definition->preferences.higher_degree_bias);
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+        status = dg_write_i32(writer, (int32_t)definition->preferences.border_distance_bias);
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+    }
+
+    /*
+     * Variant steps trail the definitions behind a tag, so configs saved
+     * before them still load and stray bytes are not mistaken for steps.
+     */
+    if (snapshot->room_types.definition_count > 0u) {
+        status = dg_write_exact(
+            writer,
+            DG_CONFIG_VARIANT_STEP_TAG,
+            sizeof(DG_CONFIG_VARIANT_STEP_TAG)
+        );
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_write_i32(file, (int32_t)definition->preferences.border_distance_bias);
+    }
+    for (i = 0; i < snapshot->room_types.definition_count; ++i) {
+        status = dg_write_i32(
+            writer,
+            (int32_t)snapshot->room_types.definitions[i].template_variant_step
+        );
         if (status != DG_STATUS_OK) {
             return status;
         }
@@ -1150,61 +1227,61 @@ static dg_status_t dg_write_snapshot(FILE *file, const dg_generation_request_sna
 }
 
 static dg_status_t dg_read_snapshot_algorithm_params(
-    FILE *file,
+    dg_io_reader_t *reader,
     dg_generation_request_snapshot_t *snapshot
 )
 {
     int32_t value;
     dg_status_t status;
 
-    if (file == NULL || snapshot == NULL) {
+    if (reader == NULL || snapshot == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
     switch ((dg_algorithm_t)snapshot->algorithm_id) {
     case DG_ALGORITHM_BSP_TREE:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value, &snapshot->params.bsp.min_rooms)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value, &snapshot->params.bsp.max_rooms)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.bsp.room_min_size)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.bsp.room_max_size)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
         return DG_STATUS_OK;
     case DG_ALGORITHM_DRUNKARDS_WALK:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.drunkards_walk.wiggle_percent)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
         return DG_STATUS_OK;
     case DG_ALGORITHM_CELLULAR_AUTOMATA:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.cellular_automata.initial_wall_percent
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.cellular_automata.simulation_steps
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.cellular_automata.wall_threshold
@@ -1213,24 +1290,24 @@ static dg_status_t dg_read_snapshot_algorithm_params(
         }
         return DG_STATUS_OK;
     case DG_ALGORITHM_VALUE_NOISE:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.value_noise.feature_size)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.value_noise.octaves)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.value_noise.persistence_percent
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.value_noise.floor_threshold_percent
@@ -1239,63 +1316,63 @@ static dg_status_t dg_read_snapshot_algorithm_params(
         }
         return DG_STATUS_OK;
     case DG_ALGORITHM_ROOMS_AND_MAZES:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.min_rooms
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.max_rooms
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.room_min_size
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.room_max_size
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.maze_wiggle_percent
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.min_room_connections
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.max_room_connections
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.ensure_full_connectivity
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.rooms_and_mazes.dead_end_prune_steps
@@ -1304,32 +1381,32 @@ static dg_status_t dg_read_snapshot_algorithm_params(
         }
         return DG_STATUS_OK;
     case DG_ALGORITHM_ROOM_GRAPH:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.room_graph.min_rooms)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.room_graph.max_rooms)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.room_graph.room_min_size)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.room_graph.room_max_size)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.room_graph.neighbor_candidates)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.room_graph.extra_connection_chance_percent
@@ -1338,43 +1415,43 @@ static dg_status_t dg_read_snapshot_algorithm_params(
         }
         return DG_STATUS_OK;
     case DG_ALGORITHM_WORM_CAVES:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.worm_caves.worm_count)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.worm_caves.wiggle_percent)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.worm_caves.branch_chance_percent
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.worm_caves.target_floor_percent
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.worm_caves.brush_radius)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.worm_caves.max_steps_per_worm
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.worm_caves.ensure_connected
@@ -1383,31 +1460,31 @@ static dg_status_t dg_read_snapshot_algorithm_params(
         }
         return DG_STATUS_OK;
     case DG_ALGORITHM_SIMPLEX_NOISE:
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.simplex_noise.feature_size)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value, &snapshot->params.simplex_noise.octaves)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.simplex_noise.persistence_percent
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.simplex_noise.floor_threshold_percent
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value);
+        status = dg_read_i32(reader, &value);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value,
                 &snapshot->params.simplex_noise.ensure_connected
@@ -1420,21 +1497,42 @@ static dg_status_t dg_read_snapshot_algorithm_params(
     }
 }
 
-static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t *snapshot)
+/*
+ * Rejects a list count whose records cannot fit in the bytes left, so corrupt
+ * counts fail before anything is allocated.
+ */
+static dg_status_t dg_reader_check_records(
+    const dg_io_reader_t *reader,
+    size_t count,
+    size_t min_record_size
+)
+{
+    size_t byte_count;
+
+    if (dg_mul_size_would_overflow(count, min_record_size, &byte_count) ||
+        byte_count > reader->size - reader->offset) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_read_snapshot(dg_io_reader_t *reader, dg_generation_request_snapshot_t *snapshot)
 {
     unsigned char magic[sizeof(DG_CONFIG_MAGIC)];
     int32_t value_i32;
+    bool has_variant_steps;
     dg_status_t status;
     size_t i;
 
-    if (file == NULL || snapshot == NULL) {
+    if (reader == NULL || snapshot == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
     *snapshot = (dg_generation_request_snapshot_t){0};
     snapshot->present = 1;
 
-    status = dg_read_exact(file, magic, sizeof(magic));
+    status = dg_read_exact(reader, magic, sizeof(magic));
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -1443,32 +1541,37 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
         return DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
-    status = dg_read_i32(file, &value_i32);
+    status = dg_read_i32(reader, &value_i32);
     if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &snapshot->width)) {
         return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
-    status = dg_read_i32(file, &value_i32);
+    status = dg_read_i32(reader, &value_i32);
     if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &snapshot->height)) {
         return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
-    status = dg_read_u64(file, &snapshot->seed);
+    status = dg_read_u64(reader, &snapshot->seed);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_read_i32(file, &value_i32);
+    status = dg_read_i32(reader, &value_i32);
     if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &snapshot->algorithm_id)) {
         return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
-    status = dg_read_snapshot_algorithm_params(file, snapshot);
+    status = dg_read_snapshot_algorithm_params(reader, snapshot);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_read_size(file, &snapshot->edge_openings.opening_count);
+    status = dg_read_size(reader, &snapshot->edge_openings.opening_count);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    status = dg_reader_check_records(reader, snapshot->edge_openings.opening_count, DG_SNAPSHOT_EDGE_OPENING_RECORD_SIZE);
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -1485,31 +1588,36 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
     for (i = 0; i < snapshot->edge_openings.opening_count; ++i) {
         dg_snapshot_edge_opening_spec_t *opening = &snapshot->edge_openings.openings[i];
 
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &opening->side)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &opening->start)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &opening->end)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &opening->role)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
     }
 
-    status = dg_read_i32(file, &value_i32);
+    status = dg_read_i32(reader, &value_i32);
     if (status != DG_STATUS_OK ||
         !dg_i32_to_int_checked(value_i32, &snapshot->process.enabled)) {
         return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
-    status = dg_read_size(file, &snapshot->process.method_count);
+    status = dg_read_size(reader, &snapshot->process.method_count);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    status = dg_reader_check_records(reader, snapshot->process.method_count, DG_SNAPSHOT_PROCESS_METHOD_MIN_RECORD_SIZE);
     if (status != DG_STATUS_OK) {
         return status;
     }
@@ -1526,33 +1634,33 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
     for (i = 0; i < snapshot->process.method_count; ++i) {
         dg_snapshot_process_method_t *method = &snapshot->process.methods[i];
 
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &method->type)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
 
         switch ((dg_process_method_type_t)method->type) {
         case DG_PROCESS_METHOD_SCALE:
-            status = dg_read_i32(file, &value_i32);
+            status = dg_read_i32(reader, &value_i32);
             if (status != DG_STATUS_OK ||
                 !dg_i32_to_int_checked(value_i32, &method->params.scale.factor)) {
                 return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
             }
             break;
         case DG_PROCESS_METHOD_PATH_SMOOTH:
-            status = dg_read_i32(file, &value_i32);
+            status = dg_read_i32(reader, &value_i32);
             if (status != DG_STATUS_OK ||
                 !dg_i32_to_int_checked(value_i32, &method->params.path_smooth.strength)) {
                 return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
             }
-            status = dg_read_i32(file, &value_i32);
+            status = dg_read_i32(reader, &value_i32);
             if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                     value_i32,
                     &method->params.path_smooth.inner_enabled
                 )) {
                 return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
             }
-            status = dg_read_i32(file, &value_i32);
+            status = dg_read_i32(reader, &value_i32);
             if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                     value_i32,
                     &method->params.path_smooth.outer_enabled
@@ -1561,21 +1669,21 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
             }
             break;
         case DG_PROCESS_METHOD_CORRIDOR_ROUGHEN:
-            status = dg_read_i32(file, &value_i32);
+            status = dg_read_i32(reader, &value_i32);
             if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                     value_i32,
                     &method->params.corridor_roughen.strength
                 )) {
                 return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
             }
-            status = dg_read_i32(file, &value_i32);
+            status = dg_read_i32(reader, &value_i32);
             if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                     value_i32,
                     &method->params.corridor_roughen.max_depth
                 )) {
                 return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
             }
-            status = dg_read_i32(file, &value_i32);
+            status = dg_read_i32(reader, &value_i32);
             if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                     value_i32,
                     &method->params.corridor_roughen.mode
@@ -1588,18 +1696,18 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
         }
     }
 
-    status = dg_read_size(file, &snapshot->room_types.definition_count);
+    status = dg_read_size(reader, &snapshot->room_types.definition_count);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    status = dg_read_i32(file, &value_i32);
+    status = dg_read_i32(reader, &value_i32);
     if (status != DG_STATUS_OK ||
         !dg_i32_to_int_checked(value_i32, &snapshot->room_types.policy.strict_mode)) {
         return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
-    status = dg_read_i32(file, &value_i32);
+    status = dg_read_i32(reader, &value_i32);
     if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
             value_i32,
             &snapshot->room_types.policy.allow_untyped_rooms
@@ -1607,13 +1715,13 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
         return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
-    status = dg_read_u32(file, &snapshot->room_types.policy.default_type_id);
+    status = dg_read_u32(reader, &snapshot->room_types.policy.default_type_id);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
     status = dg_read_exact(
-        file,
+        reader,
         snapshot->room_types.policy.untyped_template_map_path,
         sizeof(snapshot->room_types.policy.untyped_template_map_path)
     );
@@ -1621,6 +1729,11 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
         return status;
     }
 
+    status = dg_reader_check_records(reader, snapshot->room_types.definition_count, DG_SNAPSHOT_ROOM_TYPE_RECORD_SIZE);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
     status = dg_allocate_array(
         (void **)&snapshot->room_types.definitions,
         snapshot->room_types.definition_count,
@@ -1633,167 +1746,167 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
     for (i = 0; i < snapshot->room_types.definition_count; ++i) {
         dg_snapshot_room_type_definition_t *definition = &snapshot->room_types.definitions[i];
 
-        status = dg_read_u32(file, &definition->type_id);
+        status = dg_read_u32(reader, &definition->type_id);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &definition->enabled)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &definition->min_count)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &definition->max_count)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(value_i32, &definition->target_count)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
         status = dg_read_exact(
-            file,
+            reader,
             definition->template_map_path,
             sizeof(definition->template_map_path)
         );
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_read_u32(file, &definition->template_opening_query.side_mask);
+        status = dg_read_u32(reader, &definition->template_opening_query.side_mask);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_read_u32(file, &definition->template_opening_query.role_mask);
+        status = dg_read_u32(reader, &definition->template_opening_query.role_mask);
         if (status != DG_STATUS_OK) {
             return status;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->template_opening_query.edge_coord_min
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->template_opening_query.edge_coord_max
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->template_opening_query.min_length
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->template_opening_query.max_length
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->template_opening_query.require_component
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->template_required_opening_matches
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->prefer_template_entrance_room
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.area_min
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.area_max
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.degree_min
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.degree_max
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.border_distance_min
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.border_distance_max
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.graph_depth_min
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->constraints.graph_depth_max
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK ||
             !dg_i32_to_int_checked(value_i32, &definition->preferences.weight)) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->preferences.larger_room_bias
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->preferences.higher_degree_bias
             )) {
             return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
         }
-        status = dg_read_i32(file, &value_i32);
+        status = dg_read_i32(reader, &value_i32);
         if (status != DG_STATUS_OK || !dg_i32_to_int_checked(
                 value_i32,
                 &definition->preferences.border_distance_bias
@@ -1802,13 +1915,91 @@ static dg_status_t dg_read_snapshot(FILE *file, dg_generation_request_snapshot_t
         }
     }
 
-    if (!dg_snapshot_is_valid(snapshot)) {
+    /* Older configs end here; their room types keep one block per room. */
+    has_variant_steps = false;
+    if (snapshot->room_types.definition_count > 0u && reader->offset < reader->size) {
+        status = dg_read_exact(reader, magic, sizeof(magic));
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+        if (memcmp(magic, DG_CONFIG_VARIANT_STEP_TAG, sizeof(DG_CONFIG_VARIANT_STEP_TAG)) != 0) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+        has_variant_steps = true;
+    }
+    for (i = 0; i < snapshot->room_types.definition_count; ++i) {
+        dg_snapshot_room_type_definition_t *definition = &snapshot->room_types.definitions[i];
+
+        definition->template_variant_step = 0;
+        if (!has_variant_steps) {
+            continue;
+        }
+        status = dg_read_i32(reader, &value_i32);
+        if (status != DG_STATUS_OK ||
+            !dg_i32_to_int_checked(value_i32, &definition->template_variant_step)) {
+            return (status != DG_STATUS_OK) ? status : DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+    }
+
+    if (reader->offset != reader->size || !dg_snapshot_is_valid(snapshot)) {
         return DG_STATUS_UNSUPPORTED_FORMAT;
     }
 
     return DG_STATUS_OK;
 }
 
+dg_status_t dg_read_file_contents(const char *path, unsigned char **out_data, size_t *out_size)
+{
+    FILE *file;
+    long end_offset;
+    unsigned char *data;
+    size_t size;
+
+    if (path == NULL || out_data == NULL || out_size == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    *out_data = NULL;
+    *out_size = 0;
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0) {
+        (void)fclose(file);
+        return DG_STATUS_IO_ERROR;
+    }
+    end_offset = ftell(file);
+    if (end_offset < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        (void)fclose(file);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    size = (size_t)end_offset;
+    data = (unsigned char *)malloc(size > 0 ? size : 1u);
+    if (data == NULL) {
+        (void)fclose(file);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    if (size > 0 && fread(data, 1, size, file) != size) {
+        free(data);
+        (void)fclose(file);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    if (fclose(file) != 0) {
+        free(data);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    *out_data = data;
+    *out_size = size;
+    return DG_STATUS_OK;
+}
+
 static dg_status_t dg_validate_map_for_save(const dg_map_t *map)
 {
     if (map == NULL || map->tiles == NULL) {
@@ -2035,6 +2226,8 @@ static dg_status_t dg_build_request_from_snapshot(
             snapshot->room_types.definitions[i].template_required_opening_matches;
         room_type_definitions[i].prefer_template_entrance_room =
             snapshot->room_types.definitions[i].prefer_template_entrance_room;
+        room_type_definitions[i].template_variant_step =
+            snapshot->room_types.definitions[i].template_variant_step;
 
         room_type_definitions[i].constraints.area_min =
             snapshot->room_types.definitions[i].constraints.area_min;
@@ -2084,89 +2277,208 @@ static dg_status_t dg_build_request_from_snapshot(
     return DG_STATUS_OK;
 }
 
-dg_status_t dg_map_save_file(const dg_map_t *map, const char *path)
+/* Builds the request a snapshot describes and generates it; clears the snapshot. */
+static dg_status_t dg_generate_from_snapshot(
+    dg_generation_request_snapshot_t *snapshot,
+    dg_map_t *out_map
+)
 {
-    FILE *file;
+    dg_generate_request_t request;
+    dg_process_method_t *process_methods;
+    dg_room_type_definition_t *room_type_definitions;
+    dg_edge_opening_spec_t *edge_openings;
     dg_status_t status;
 
-    if (path == NULL) {
+    process_methods = NULL;
+    room_type_definitions = NULL;
+    edge_openings = NULL;
+    status = dg_build_request_from_snapshot(
+        snapshot,
+        &request,
+        &process_methods,
+        &room_type_definitions,
+        &edge_openings
+    );
+    dg_snapshot_clear(snapshot);
+    if (status != DG_STATUS_OK) {
+        free(process_methods);
+        free(room_type_definitions);
+        free(edge_openings);
+        return status;
+    }
+
+    status = dg_generate(&request, out_map);
+    free(process_methods);
+    free(room_type_definitions);
+    free(edge_openings);
+    return status;
+}
+
+dg_status_t dg_map_save_config_to_buffer(
+    const dg_map_t *map,
+    void *buffer,
+    size_t buffer_capacity,
+    size_t *out_size
+)
+{
+    dg_io_writer_t writer;
+    dg_status_t status;
+
+    if (out_size == NULL || (buffer == NULL && buffer_capacity > 0)) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
+    *out_size = 0;
 
     status = dg_validate_map_for_save(map);
     if (status != DG_STATUS_OK) {
         return status;
     }
 
-    file = fopen(path, "wb");
-    if (file == NULL) {
-        return DG_STATUS_IO_ERROR;
+    writer = (dg_io_writer_t){0};
+    writer.data = (unsigned char *)buffer;
+    writer.capacity = buffer_capacity;
+    writer.fixed = true;
+    status = dg_write_snapshot(&writer, &map->metadata.generation_request);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    *out_size = writer.size;
+    return (writer.size > buffer_capacity) ? DG_STATUS_BUFFER_TOO_SMALL : DG_STATUS_OK;
+}
+
+dg_status_t dg_map_save_config_to_allocated_buffer(
+    const dg_map_t *map,
+    void **out_buffer,
+    size_t *out_size
+)
+{
+    dg_io_writer_t writer;
+    dg_status_t status;
+
+    if (out_buffer == NULL || out_size == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
     }
+    *out_buffer = NULL;
+    *out_size = 0;
 
-    status = dg_write_snapshot(file, &map->metadata.generation_request);
+    status = dg_validate_map_for_save(map);
     if (status != DG_STATUS_OK) {
-        (void)fclose(file);
         return status;
     }
 
-    if (fclose(file) != 0) {
-        return DG_STATUS_IO_ERROR;
+    writer = (dg_io_writer_t){0};
+    status = dg_write_snapshot(&writer, &map->metadata.generation_request);
+    if (status != DG_STATUS_OK) {
+        free(writer.data);
+        return status;
     }
 
+    *out_buffer = writer.data;
+    *out_size = writer.size;
     return DG_STATUS_OK;
 }
 
-dg_status_t dg_map_load_file(const char *path, dg_map_t *out_map)
+void dg_buffer_free(void *buffer)
 {
-    FILE *file;
+    free(buffer);
+}
+
+dg_status_t dg_map_load_config_from_buffer(const void *data, size_t size, dg_map_t *out_map)
+{
+    dg_io_reader_t reader;
     dg_generation_request_snapshot_t snapshot;
-    dg_generate_request_t request;
-    dg_process_method_t *process_methods;
-    dg_room_type_definition_t *room_type_definitions;
-    dg_edge_opening_spec_t *edge_openings;
     dg_status_t status;
 
-    if (path == NULL || out_map == NULL || !dg_map_is_empty(out_map)) {
+    if (data == NULL || out_map == NULL || !dg_map_is_empty(out_map)) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    file = fopen(path, "rb");
+    reader = (dg_io_reader_t){0};
+    reader.data = (const unsigned char *)data;
+    reader.size = size;
+
+    snapshot = (dg_generation_request_snapshot_t){0};
+    status = dg_read_snapshot(&reader, &snapshot);
+    if (status != DG_STATUS_OK) {
+        dg_snapshot_clear(&snapshot);
+        /* Running off the end of a buffer means it was truncated, not unreadable. */
+        return (status == DG_STATUS_IO_ERROR) ? DG_STATUS_UNSUPPORTED_FORMAT : status;
+    }
+
+    return dg_generate_from_snapshot(&snapshot, out_map);
+}
+
+dg_status_t dg_map_save_file(const dg_map_t *map, const char *path)
+{
+    void *data;
+    size_t size;
+    FILE *file;
+    dg_status_t status;
+
+    if (path == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dg_map_save_config_to_allocated_buffer(map, &data, &size);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    file = fopen(path, "wb");
     if (file == NULL) {
+        free(data);
         return DG_STATUS_IO_ERROR;
     }
 
-    snapshot = (dg_generation_request_snapshot_t){0};
-    status = dg_read_snapshot(file, &snapshot);
-    if (fclose(file) != 0 && status == DG_STATUS_OK) {
-        dg_snapshot_clear(&snapshot);
+    if (fwrite(data, 1, size, file) != size) {
+        (void)fclose(file);
+        free(data);
         return DG_STATUS_IO_ERROR;
     }
-    if (status != DG_STATUS_OK) {
-        dg_snapshot_clear(&snapshot);
+
+    free(data);
+    if (fclose(file) != 0) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_load_map_from_memory(const unsigned char *data, size_t size, dg_map_t *out_map)
+{
+    dg_status_t status;
+
+    /* Baked maps already hold their tiles, so they skip regeneration. */
+    if (size >= sizeof(DG_BAKED_MAGIC) &&
+        memcmp(data, DG_BAKED_MAGIC, sizeof(DG_BAKED_MAGIC)) == 0) {
+        status = dg_unbake_map(data, size, out_map);
+        if (status != DG_STATUS_OK) {
+            dg_map_destroy(out_map);
+        }
         return status;
     }
 
-    process_methods = NULL;
-    room_type_definitions = NULL;
-    edge_openings = NULL;
-    status = dg_build_request_from_snapshot(
-        &snapshot,
-        &request,
-        &process_methods,
-        &room_type_definitions,
-        &edge_openings
-    );
-    dg_snapshot_clear(&snapshot);
+    return dg_map_load_config_from_buffer(data, size, out_map);
+}
+
+dg_status_t dg_map_load_file(const char *path, dg_map_t *out_map)
+{
+    unsigned char *data;
+    size_t size;
+    dg_status_t status;
+
+    if (path == NULL || out_map == NULL || !dg_map_is_empty(out_map)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    /* One read up front; both formats are then parsed from memory. */
+    status = dg_read_file_contents(path, &data, &size);
     if (status != DG_STATUS_OK) {
-        free(process_methods);
-        free(room_type_definitions);
-        free(edge_openings);
         return status;
     }
 
-    status = dg_generate(&request, out_map);
-    free(process_methods);
-    free(room_type_definitions);
-    free(edge_openings);
+    status = dg_load_map_from_memory(data, size, out_map);
+    free(data);
     return status;
 }
@@ -0,0 +1,1962 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "io_internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Baked map layout (all integers little-endian):
+ *
+ *   header   magic "DGBK", u32 version, u32 section count, u32 reserved,
+ *            u64 payload size, u64 payload checksum, i32 width, i32 height
+ *   table    per section: u32 id, u32 encoding, u64 offset, u64 size
+ *   sections tiles (2-bit packed or row run-length), summary scalars,
+ *            then one array section per metadata list (u64 count followed
+ *            by fixed-size records), and the generation request snapshot in
+ *            DGCF form
+ *
+ * The payload is everything after the header; its checksum is 64-bit FNV-1a.
+ * Offsets are absolute so sections can be located without parsing earlier
+ * ones.
+ *
+ * Native-layout files store tiles and metadata lists as raw in-memory arrays
+ * at 16-byte aligned offsets, so they can be mapped and used in place. They
+ * carry a layout probe section (byte order plus struct sizes) and are only
+ * readable by builds whose probe matches.
+ */
+const unsigned char DG_BAKED_MAGIC[4] = {'D', 'G', 'B', 'K'};
+
+#define DG_BAKED_VERSION 2u
+#define DG_BAKED_HEADER_SIZE 40u
+#define DG_BAKED_SECTION_ENTRY_SIZE 24u
+
+#define DG_BAKED_ENCODING_PORTABLE 0u
+#define DG_BAKED_TILE_ENCODING_PACKED2 1u
+#define DG_BAKED_ENCODING_NATIVE 2u
+#define DG_BAKED_TILE_ENCODING_RLE 3u
+
+#define DG_BAKED_NATIVE_ALIGNMENT 16u
+#define DG_BAKED_NATIVE_LAYOUT_FIELDS 12u
+
+typedef enum dg_baked_section_id {
+    DG_BAKED_SECTION_TILES = 1,
+    DG_BAKED_SECTION_SUMMARY = 2,
+    DG_BAKED_SECTION_ROOMS = 3,
+    DG_BAKED_SECTION_CORRIDORS = 4,
+    DG_BAKED_SECTION_ROOM_ENTRANCES = 5,
+    DG_BAKED_SECTION_EDGE_OPENINGS = 6,
+    DG_BAKED_SECTION_ROOM_ADJACENCY = 7,
+    DG_BAKED_SECTION_ROOM_NEIGHBORS = 8,
+    DG_BAKED_SECTION_PROCESS_STEPS = 9,
+    DG_BAKED_SECTION_ROOM_TYPE_QUOTAS = 10,
+    DG_BAKED_SECTION_SNAPSHOT = 11,
+    DG_BAKED_SECTION_NATIVE_LAYOUT = 12
+} dg_baked_section_id_t;
+
+#define DG_BAKED_SECTION_COUNT 12u
+
+/* Sections that must be native for a view to point into the mapping. */
+#define DG_BAKED_ZERO_COPY_SECTIONS                                   \
+    ((1u << DG_BAKED_SECTION_TILES) | (1u << DG_BAKED_SECTION_ROOMS) | \
+     (1u << DG_BAKED_SECTION_CORRIDORS) |                             \
+     (1u << DG_BAKED_SECTION_ROOM_ENTRANCES) |                        \
+     (1u << DG_BAKED_SECTION_EDGE_OPENINGS) |                         \
+     (1u << DG_BAKED_SECTION_ROOM_ADJACENCY) |                        \
+     (1u << DG_BAKED_SECTION_ROOM_NEIGHBORS) |                        \
+     (1u << DG_BAKED_SECTION_PROCESS_STEPS) |                         \
+     (1u << DG_BAKED_SECTION_ROOM_TYPE_QUOTAS))
+
+/* Fixed record sizes of the array sections. */
+#define DG_BAKED_ROOM_RECORD_SIZE 32u
+#define DG_BAKED_CORRIDOR_RECORD_SIZE 16u
+#define DG_BAKED_ROOM_ENTRANCE_RECORD_SIZE 28u
+#define DG_BAKED_EDGE_OPENING_RECORD_SIZE 56u
+#define DG_BAKED_ROOM_ADJACENCY_RECORD_SIZE 16u
+#define DG_BAKED_ROOM_NEIGHBOR_RECORD_SIZE 8u
+#define DG_BAKED_PROCESS_STEP_RECORD_SIZE 60u
+#define DG_BAKED_ROOM_TYPE_QUOTA_RECORD_SIZE 40u
+
+typedef struct dg_baked_section {
+    uint32_t id;
+    uint32_t encoding;
+    uint64_t offset;
+    uint64_t size;
+} dg_baked_section_t;
+
+/* A parsed header and section table, with known sections indexed by id. */
+typedef struct dg_baked_file {
+    const unsigned char *data;
+    size_t size;
+    int width;
+    int height;
+    size_t cell_count;
+    uint32_t present_sections;
+    uint32_t native_sections;
+    dg_baked_section_t sections[DG_BAKED_SECTION_COUNT + 1u];
+} dg_baked_file_t;
+
+/* Where a native array section lives in map metadata. */
+typedef struct dg_baked_native_slot {
+    void **items;
+    size_t *count;
+    size_t *capacity;
+    size_t element_size;
+} dg_baked_native_slot_t;
+
+static uint64_t dg_baked_checksum(const unsigned char *data, size_t size)
+{
+    uint64_t hash = 1469598103934665603ull;
+    size_t i;
+
+    for (i = 0; i < size; ++i) {
+        hash ^= (uint64_t)data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static void dg_baked_store_u32(unsigned char *bytes, uint32_t value)
+{
+    bytes[0] = (unsigned char)(value & 0xFFu);
+    bytes[1] = (unsigned char)((value >> 8) & 0xFFu);
+    bytes[2] = (unsigned char)((value >> 16) & 0xFFu);
+    bytes[3] = (unsigned char)((value >> 24) & 0xFFu);
+}
+
+static void dg_baked_store_u64(unsigned char *bytes, uint64_t value)
+{
+    dg_baked_store_u32(bytes, (uint32_t)(value & 0xFFFFFFFFu));
+    dg_baked_store_u32(bytes + 4, (uint32_t)(value >> 32));
+}
+
+static uint32_t dg_baked_load_u32(const unsigned char *bytes)
+{
+    return ((uint32_t)bytes[0]) |
+           (((uint32_t)bytes[1]) << 8) |
+           (((uint32_t)bytes[2]) << 16) |
+           (((uint32_t)bytes[3]) << 24);
+}
+
+static uint64_t dg_baked_load_u64(const unsigned char *bytes)
+{
+    return ((uint64_t)dg_baked_load_u32(bytes)) |
+           (((uint64_t)dg_baked_load_u32(bytes + 4)) << 32);
+}
+
+static dg_status_t dg_baked_write_point(dg_io_writer_t *writer, const dg_point_t *point)
+{
+    dg_status_t status;
+
+    status = dg_write_i32(writer, (int32_t)point->x);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+    return dg_write_i32(writer, (int32_t)point->y);
+}
+
+static dg_status_t dg_baked_read_int(dg_io_reader_t *reader, int *out_value)
+{
+    int32_t value;
+    dg_status_t status;
+
+    status = dg_read_i32(reader, &value);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    *out_value = (int)value;
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_baked_read_point(dg_io_reader_t *reader, dg_point_t *out_point)
+{
+    dg_status_t status;
+
+    status = dg_baked_read_int(reader, &out_point->x);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+    return dg_baked_read_int(reader, &out_point->y);
+}
+
+static dg_status_t dg_baked_write_tiles(dg_io_writer_t *writer, const dg_map_t *map)
+{
+    unsigned char packed[256];
+    size_t cell_count;
+    size_t used;
+    size_t i;
+    dg_status_t status;
+
+    cell_count = (size_t)map->width * (size_t)map->height;
+    memset(packed, 0, sizeof(packed));
+    used = 0;
+
+    for (i = 0; i < cell_count; ++i) {
+        packed[used] |= (unsigned char)(((unsigned int)map->tiles[i] & 0x3u) << ((i & 3u) * 2u));
+        if ((i & 3u) == 3u) {
+            used += 1;
+            if (used == sizeof(packed)) {
+                status = dg_write_exact(writer, packed, used);
+                if (status != DG_STATUS_OK) {
+                    return status;
+                }
+                memset(packed, 0, sizeof(packed));
+                used = 0;
+            }
+        }
+    }
+
+    if ((cell_count & 3u) != 0u) {
+        used += 1;
+    }
+
+    return dg_write_exact(writer, packed, used);
+}
+
+static dg_status_t dg_baked_write_summary(dg_io_writer_t *writer, const dg_map_metadata_t *metadata)
+{
+    const uint64_t counters[] = {
+        (uint64_t)metadata->walkable_tile_count,
+        (uint64_t)metadata->wall_tile_count,
+        (uint64_t)metadata->special_room_count,
+        (uint64_t)metadata->entrance_room_count,
+        (uint64_t)metadata->exit_room_count,
+        (uint64_t)metadata->boss_room_count,
+        (uint64_t)metadata->treasure_room_count,
+        (uint64_t)metadata->shop_room_count,
+        (uint64_t)metadata->leaf_room_count,
+        (uint64_t)metadata->corridor_total_length,
+        (uint64_t)metadata->connected_component_count,
+        (uint64_t)metadata->largest_component_size,
+        (uint64_t)metadata->generation_attempts,
+        (uint64_t)metadata->diagnostics.typed_room_count,
+        (uint64_t)metadata->diagnostics.untyped_room_count,
+        (uint64_t)metadata->diagnostics.room_type_min_miss_count,
+        (uint64_t)metadata->diagnostics.room_type_max_excess_count,
+        (uint64_t)metadata->diagnostics.room_type_target_miss_count,
+        (uint64_t)metadata->diagnostics.room_type_min_shortfall
+    };
+    const int32_t values[] = {
+        (int32_t)metadata->algorithm_id,
+        (int32_t)metadata->generation_class,
+        (int32_t)metadata->primary_entrance_opening_id,
+        (int32_t)metadata->primary_exit_opening_id,
+        (int32_t)metadata->entrance_exit_distance,
+        metadata->connected_floor ? 1 : 0
+    };
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_u64(writer, metadata->seed);
+    for (i = 0; status == DG_STATUS_OK && i < sizeof(values) / sizeof(values[0]); ++i) {
+        status = dg_write_i32(writer, values[i]);
+    }
+    for (i = 0; status == DG_STATUS_OK && i < sizeof(counters) / sizeof(counters[0]); ++i) {
+        status = dg_write_u64(writer, counters[i]);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, metadata->diagnostics.room_type_short_type_id);
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_summary(dg_io_reader_t *reader, dg_map_metadata_t *metadata)
+{
+    size_t *counters[19];
+    int values[6];
+    dg_status_t status;
+    size_t i;
+
+    counters[0] = &metadata->walkable_tile_count;
+    counters[1] = &metadata->wall_tile_count;
+    counters[2] = &metadata->special_room_count;
+    counters[3] = &metadata->entrance_room_count;
+    counters[4] = &metadata->exit_room_count;
+    counters[5] = &metadata->boss_room_count;
+    counters[6] = &metadata->treasure_room_count;
+    counters[7] = &metadata->shop_room_count;
+    counters[8] = &metadata->leaf_room_count;
+    counters[9] = &metadata->corridor_total_length;
+    counters[10] = &metadata->connected_component_count;
+    counters[11] = &metadata->largest_component_size;
+    counters[12] = &metadata->generation_attempts;
+    counters[13] = &metadata->diagnostics.typed_room_count;
+    counters[14] = &metadata->diagnostics.untyped_room_count;
+    counters[15] = &metadata->diagnostics.room_type_min_miss_count;
+    counters[16] = &metadata->diagnostics.room_type_max_excess_count;
+    counters[17] = &metadata->diagnostics.room_type_target_miss_count;
+    counters[18] = &metadata->diagnostics.room_type_min_shortfall;
+
+    status = dg_read_u64(reader, &metadata->seed);
+    for (i = 0; status == DG_STATUS_OK && i < sizeof(values) / sizeof(values[0]); ++i) {
+        status = dg_baked_read_int(reader, &values[i]);
+    }
+    for (i = 0; status == DG_STATUS_OK && i < sizeof(counters) / sizeof(counters[0]); ++i) {
+        status = dg_read_size(reader, counters[i]);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_read_u32(reader, &metadata->diagnostics.room_type_short_type_id);
+    }
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    if (values[1] < (int)DG_MAP_GENERATION_CLASS_UNKNOWN ||
+        values[1] > (int)DG_MAP_GENERATION_CLASS_CAVE_LIKE ||
+        (values[5] != 0 && values[5] != 1)) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    metadata->algorithm_id = values[0];
+    metadata->generation_class = (dg_map_generation_class_t)values[1];
+    metadata->primary_entrance_opening_id = values[2];
+    metadata->primary_exit_opening_id = values[3];
+    metadata->entrance_exit_distance = values[4];
+    metadata->connected_floor = values[5] != 0;
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_baked_write_rooms(dg_io_writer_t *writer, const dg_map_metadata_t *metadata)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, metadata->room_count);
+    for (i = 0; status == DG_STATUS_OK && i < metadata->room_count; ++i) {
+        const dg_room_metadata_t *room = &metadata->rooms[i];
+
+        status = dg_write_i32(writer, (int32_t)room->id);
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)room->bounds.x);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)room->bounds.y);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)room->bounds.width);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)room->bounds.height);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u32(writer, room->flags);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)room->role);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u32(writer, room->type_id);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_rooms(dg_io_reader_t *reader, dg_map_metadata_t *metadata)
+{
+    dg_status_t status;
+    size_t i;
+
+    for (i = 0; i < metadata->room_count; ++i) {
+        dg_room_metadata_t *room = &metadata->rooms[i];
+        int role;
+
+        status = dg_baked_read_int(reader, &room->id);
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &room->bounds.x);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &room->bounds.y);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &room->bounds.width);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &room->bounds.height);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_u32(reader, &room->flags);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &role);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_u32(reader, &room->type_id);
+        }
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+
+        if (role < (int)DG_ROOM_ROLE_NONE || role > (int)DG_ROOM_ROLE_SHOP) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+        room->role = (dg_room_role_t)role;
+    }
+
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_baked_write_corridors(dg_io_writer_t *writer, const dg_map_metadata_t *metadata)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, metadata->corridor_count);
+    for (i = 0; status == DG_STATUS_OK && i < metadata->corridor_count; ++i) {
+        const dg_corridor_metadata_t *corridor = &metadata->corridors[i];
+
+        status = dg_write_i32(writer, (int32_t)corridor->from_room_id);
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)corridor->to_room_id);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)corridor->width);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)corridor->length);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_corridors(dg_io_reader_t *reader, dg_map_metadata_t *metadata)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = DG_STATUS_OK;
+    for (i = 0; status == DG_STATUS_OK && i < metadata->corridor_count; ++i) {
+        dg_corridor_metadata_t *corridor = &metadata->corridors[i];
+
+        status = dg_baked_read_int(reader, &corridor->from_room_id);
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &corridor->to_room_id);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &corridor->width);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &corridor->length);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_write_room_entrances(
+    dg_io_writer_t *writer,
+    const dg_map_metadata_t *metadata
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, metadata->room_entrance_count);
+    for (i = 0; status == DG_STATUS_OK && i < metadata->room_entrance_count; ++i) {
+        const dg_room_entrance_metadata_t *entrance = &metadata->room_entrances[i];
+
+        status = dg_write_i32(writer, (int32_t)entrance->room_id);
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_write_point(writer, &entrance->room_tile);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_write_point(writer, &entrance->corridor_tile);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)entrance->normal_x);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)entrance->normal_y);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_room_entrances(dg_io_reader_t *reader, dg_map_metadata_t *metadata)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = DG_STATUS_OK;
+    for (i = 0; status == DG_STATUS_OK && i < metadata->room_entrance_count; ++i) {
+        dg_room_entrance_metadata_t *entrance = &metadata->room_entrances[i];
+
+        status = dg_baked_read_int(reader, &entrance->room_id);
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_point(reader, &entrance->room_tile);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_point(reader, &entrance->corridor_tile);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &entrance->normal_x);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &entrance->normal_y);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_write_edge_openings(
+    dg_io_writer_t *writer,
+    const dg_map_metadata_t *metadata
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, metadata->edge_opening_count);
+    for (i = 0; status == DG_STATUS_OK && i < metadata->edge_opening_count; ++i) {
+        const dg_map_edge_opening_t *opening = &metadata->edge_openings[i];
+        const int32_t values[] = {
+            (int32_t)opening->id,
+            (int32_t)opening->side,
+            (int32_t)opening->start,
+            (int32_t)opening->end,
+            (int32_t)opening->length,
+            (int32_t)opening->edge_tile.x,
+            (int32_t)opening->edge_tile.y,
+            (int32_t)opening->inward_tile.x,
+            (int32_t)opening->inward_tile.y,
+            (int32_t)opening->normal_x,
+            (int32_t)opening->normal_y
+        };
+        size_t v;
+
+        for (v = 0; status == DG_STATUS_OK && v < sizeof(values) / sizeof(values[0]); ++v) {
+            status = dg_write_i32(writer, values[v]);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_size(writer, opening->component_id);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)opening->role);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_edge_openings(dg_io_reader_t *reader, dg_map_metadata_t *metadata)
+{
+    size_t i;
+
+    for (i = 0; i < metadata->edge_opening_count; ++i) {
+        dg_map_edge_opening_t *opening = &metadata->edge_openings[i];
+        int values[11];
+        int role;
+        size_t v;
+        dg_status_t status;
+
+        status = DG_STATUS_OK;
+        for (v = 0; status == DG_STATUS_OK && v < sizeof(values) / sizeof(values[0]); ++v) {
+            status = dg_baked_read_int(reader, &values[v]);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_size(reader, &opening->component_id);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &role);
+        }
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+
+        if (values[1] < (int)DG_MAP_EDGE_TOP || values[1] > (int)DG_MAP_EDGE_LEFT ||
+            role < (int)DG_MAP_EDGE_OPENING_ROLE_NONE ||
+            role > (int)DG_MAP_EDGE_OPENING_ROLE_EXIT) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        opening->id = values[0];
+        opening->side = (dg_map_edge_side_t)values[1];
+        opening->start = values[2];
+        opening->end = values[3];
+        opening->length = values[4];
+        opening->edge_tile.x = values[5];
+        opening->edge_tile.y = values[6];
+        opening->inward_tile.x = values[7];
+        opening->inward_tile.y = values[8];
+        opening->normal_x = values[9];
+        opening->normal_y = values[10];
+        opening->role = (dg_map_edge_opening_role_t)role;
+    }
+
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_baked_write_room_adjacency(
+    dg_io_writer_t *writer,
+    const dg_map_metadata_t *metadata
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, metadata->room_adjacency_count);
+    for (i = 0; status == DG_STATUS_OK && i < metadata->room_adjacency_count; ++i) {
+        status = dg_write_size(writer, metadata->room_adjacency[i].start_index);
+        if (status == DG_STATUS_OK) {
+            status = dg_write_size(writer, metadata->room_adjacency[i].count);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_write_room_neighbors(
+    dg_io_writer_t *writer,
+    const dg_map_metadata_t *metadata
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, metadata->room_neighbor_count);
+    for (i = 0; status == DG_STATUS_OK && i < metadata->room_neighbor_count; ++i) {
+        status = dg_write_i32(writer, (int32_t)metadata->room_neighbors[i].room_id);
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)metadata->room_neighbors[i].corridor_index);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_room_adjacency(dg_io_reader_t *reader, dg_map_metadata_t *metadata)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = DG_STATUS_OK;
+    for (i = 0; status == DG_STATUS_OK && i < metadata->room_adjacency_count; ++i) {
+        dg_room_adjacency_span_t *span = &metadata->room_adjacency[i];
+
+        status = dg_read_size(reader, &span->start_index);
+        if (status == DG_STATUS_OK) {
+            status = dg_read_size(reader, &span->count);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_room_neighbors(dg_io_reader_t *reader, dg_map_metadata_t *metadata)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = DG_STATUS_OK;
+    for (i = 0; status == DG_STATUS_OK && i < metadata->room_neighbor_count; ++i) {
+        status = dg_baked_read_int(reader, &metadata->room_neighbors[i].room_id);
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &metadata->room_neighbors[i].corridor_index);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_write_process_steps(
+    dg_io_writer_t *writer,
+    const dg_generation_diagnostics_t *diagnostics
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, diagnostics->process_step_count);
+    for (i = 0; status == DG_STATUS_OK && i < diagnostics->process_step_count; ++i) {
+        const dg_process_step_diagnostics_t *step = &diagnostics->process_steps[i];
+
+        status = dg_write_i32(writer, (int32_t)step->method_type);
+        if (status == DG_STATUS_OK) {
+            status = dg_write_size(writer, step->walkable_before);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_size(writer, step->walkable_after);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u64(writer, (uint64_t)step->walkable_delta);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_size(writer, step->components_before);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_size(writer, step->components_after);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u64(writer, (uint64_t)step->components_delta);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)step->connected_before);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)step->connected_after);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_process_steps(
+    dg_io_reader_t *reader,
+    dg_generation_diagnostics_t *diagnostics
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = DG_STATUS_OK;
+    for (i = 0; status == DG_STATUS_OK && i < diagnostics->process_step_count; ++i) {
+        dg_process_step_diagnostics_t *step = &diagnostics->process_steps[i];
+        uint64_t walkable_delta;
+        uint64_t components_delta;
+
+        walkable_delta = 0;
+        components_delta = 0;
+        status = dg_baked_read_int(reader, &step->method_type);
+        if (status == DG_STATUS_OK) {
+            status = dg_read_size(reader, &step->walkable_before);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_size(reader, &step->walkable_after);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_u64(reader, &walkable_delta);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_size(reader, &step->components_before);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_size(reader, &step->components_after);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_u64(reader, &components_delta);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &step->connected_before);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &step->connected_after);
+        }
+
+        step->walkable_delta = (int64_t)walkable_delta;
+        step->components_delta = (int64_t)components_delta;
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_write_room_type_quotas(
+    dg_io_writer_t *writer,
+    const dg_generation_diagnostics_t *diagnostics
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = dg_write_size(writer, diagnostics->room_type_count);
+    for (i = 0; status == DG_STATUS_OK && i < diagnostics->room_type_count; ++i) {
+        const dg_room_type_quota_diagnostics_t *quota = &diagnostics->room_type_quotas[i];
+        const int32_t values[] = {
+            (int32_t)quota->enabled,
+            (int32_t)quota->min_count,
+            (int32_t)quota->max_count,
+            (int32_t)quota->target_count
+        };
+        size_t v;
+
+        status = dg_write_u32(writer, quota->type_id);
+        for (v = 0; status == DG_STATUS_OK && v < sizeof(values) / sizeof(values[0]); ++v) {
+            status = dg_write_i32(writer, values[v]);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_size(writer, quota->assigned_count);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)quota->min_satisfied);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)quota->max_satisfied);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_i32(writer, (int32_t)quota->target_satisfied);
+        }
+    }
+
+    return status;
+}
+
+static dg_status_t dg_baked_read_room_type_quotas(
+    dg_io_reader_t *reader,
+    dg_generation_diagnostics_t *diagnostics
+)
+{
+    dg_status_t status;
+    size_t i;
+
+    status = DG_STATUS_OK;
+    for (i = 0; status == DG_STATUS_OK && i < diagnostics->room_type_count; ++i) {
+        dg_room_type_quota_diagnostics_t *quota = &diagnostics->room_type_quotas[i];
+
+        status = dg_read_u32(reader, &quota->type_id);
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &quota->enabled);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &quota->min_count);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &quota->max_count);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &quota->target_count);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_read_size(reader, &quota->assigned_count);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &quota->min_satisfied);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &quota->max_satisfied);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_int(reader, &quota->target_satisfied);
+        }
+    }
+
+    return status;
+}
+
+static void dg_baked_native_layout(uint32_t layout[DG_BAKED_NATIVE_LAYOUT_FIELDS])
+{
+    layout[0] = 0x01020304u;
+    layout[1] = (uint32_t)sizeof(size_t);
+    layout[2] = (uint32_t)sizeof(int);
+    layout[3] = (uint32_t)sizeof(dg_tile_t);
+    layout[4] = (uint32_t)sizeof(dg_room_metadata_t);
+    layout[5] = (uint32_t)sizeof(dg_corridor_metadata_t);
+    layout[6] = (uint32_t)sizeof(dg_room_entrance_metadata_t);
+    layout[7] = (uint32_t)sizeof(dg_map_edge_opening_t);
+    layout[8] = (uint32_t)sizeof(dg_room_adjacency_span_t);
+    layout[9] = (uint32_t)sizeof(dg_room_neighbor_t);
+    layout[10] = (uint32_t)sizeof(dg_process_step_diagnostics_t);
+    layout[11] = (uint32_t)sizeof(dg_room_type_quota_diagnostics_t);
+}
+
+/* Maps an array section id to the metadata list it stores. */
+static bool dg_baked_native_slot(
+    dg_map_metadata_t *metadata,
+    uint32_t id,
+    dg_baked_native_slot_t *out_slot
+)
+{
+    *out_slot = (dg_baked_native_slot_t){0};
+
+    switch ((dg_baked_section_id_t)id) {
+    case DG_BAKED_SECTION_ROOMS:
+        out_slot->items = (void **)&metadata->rooms;
+        out_slot->count = &metadata->room_count;
+        out_slot->capacity = &metadata->room_capacity;
+        out_slot->element_size = sizeof(dg_room_metadata_t);
+        return true;
+    case DG_BAKED_SECTION_CORRIDORS:
+        out_slot->items = (void **)&metadata->corridors;
+        out_slot->count = &metadata->corridor_count;
+        out_slot->capacity = &metadata->corridor_capacity;
+        out_slot->element_size = sizeof(dg_corridor_metadata_t);
+        return true;
+    case DG_BAKED_SECTION_ROOM_ENTRANCES:
+        out_slot->items = (void **)&metadata->room_entrances;
+        out_slot->count = &metadata->room_entrance_count;
+        out_slot->capacity = &metadata->room_entrance_capacity;
+        out_slot->element_size = sizeof(dg_room_entrance_metadata_t);
+        return true;
+    case DG_BAKED_SECTION_EDGE_OPENINGS:
+        out_slot->items = (void **)&metadata->edge_openings;
+        out_slot->count = &metadata->edge_opening_count;
+        out_slot->capacity = &metadata->edge_opening_capacity;
+        out_slot->element_size = sizeof(dg_map_edge_opening_t);
+        return true;
+    case DG_BAKED_SECTION_ROOM_ADJACENCY:
+        out_slot->items = (void **)&metadata->room_adjacency;
+        out_slot->count = &metadata->room_adjacency_count;
+        out_slot->element_size = sizeof(dg_room_adjacency_span_t);
+        return true;
+    case DG_BAKED_SECTION_ROOM_NEIGHBORS:
+        out_slot->items = (void **)&metadata->room_neighbors;
+        out_slot->count = &metadata->room_neighbor_count;
+        out_slot->element_size = sizeof(dg_room_neighbor_t);
+        return true;
+    case DG_BAKED_SECTION_PROCESS_STEPS:
+        out_slot->items = (void **)&metadata->diagnostics.process_steps;
+        out_slot->count = &metadata->diagnostics.process_step_count;
+        out_slot->element_size = sizeof(dg_process_step_diagnostics_t);
+        return true;
+    case DG_BAKED_SECTION_ROOM_TYPE_QUOTAS:
+        out_slot->items = (void **)&metadata->diagnostics.room_type_quotas;
+        out_slot->count = &metadata->diagnostics.room_type_count;
+        out_slot->element_size = sizeof(dg_room_type_quota_diagnostics_t);
+        return true;
+    default:
+        return false;
+    }
+}
+
+static uint32_t dg_baked_section_encoding(
+    uint32_t id,
+    const dg_baked_save_options_t *options
+)
+{
+    dg_baked_layout_t layout = options->layout;
+
+    if (id == (uint32_t)DG_BAKED_SECTION_NATIVE_LAYOUT) {
+        return DG_BAKED_ENCODING_NATIVE;
+    }
+    if (id == (uint32_t)DG_BAKED_SECTION_TILES) {
+        if (layout == DG_BAKED_LAYOUT_NATIVE) {
+            return DG_BAKED_ENCODING_NATIVE;
+        }
+        return (options->tile_encoding == DG_BAKED_TILES_PACKED) ? DG_BAKED_TILE_ENCODING_PACKED2
+                                                                 : DG_BAKED_TILE_ENCODING_RLE;
+    }
+    if (layout == DG_BAKED_LAYOUT_NATIVE &&
+        id >= (uint32_t)DG_BAKED_SECTION_ROOMS &&
+        id <= (uint32_t)DG_BAKED_SECTION_ROOM_TYPE_QUOTAS) {
+        return DG_BAKED_ENCODING_NATIVE;
+    }
+    return DG_BAKED_ENCODING_PORTABLE;
+}
+
+/* Tiles may use either portable tile encoding; other sections have exactly one. */
+static bool dg_baked_is_portable_encoding(uint32_t id, uint32_t encoding)
+{
+    if (id == (uint32_t)DG_BAKED_SECTION_TILES) {
+        return encoding == DG_BAKED_TILE_ENCODING_PACKED2 ||
+               encoding == DG_BAKED_TILE_ENCODING_RLE;
+    }
+    return id != (uint32_t)DG_BAKED_SECTION_NATIVE_LAYOUT &&
+           encoding == DG_BAKED_ENCODING_PORTABLE;
+}
+
+/* Native sections are raw in-memory arrays: tiles, metadata lists, or the layout probe. */
+static dg_status_t dg_baked_write_native(dg_io_writer_t *writer, const dg_map_t *map, uint32_t id)
+{
+    uint32_t layout[DG_BAKED_NATIVE_LAYOUT_FIELDS];
+    dg_map_metadata_t metadata;
+    dg_baked_native_slot_t slot;
+
+    if (id == (uint32_t)DG_BAKED_SECTION_TILES) {
+        return dg_write_exact(
+            writer,
+            map->tiles,
+            (size_t)map->width * (size_t)map->height * sizeof(dg_tile_t)
+        );
+    }
+
+    if (id == (uint32_t)DG_BAKED_SECTION_NATIVE_LAYOUT) {
+        dg_baked_native_layout(layout);
+        return dg_write_exact(writer, layout, sizeof(layout));
+    }
+
+    /* Resolve the slot on a shallow copy so the source map stays const. */
+    metadata = map->metadata;
+    if (!dg_baked_native_slot(&metadata, id, &slot)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    if (*slot.count == 0) {
+        return DG_STATUS_OK;
+    }
+    return dg_write_exact(writer, *slot.items, *slot.count * slot.element_size);
+}
+
+static dg_status_t dg_baked_write_section(
+    dg_io_writer_t *writer,
+    const dg_map_t *map,
+    dg_baked_section_id_t id,
+    uint32_t encoding
+)
+{
+    const dg_map_metadata_t *metadata = &map->metadata;
+
+    if (encoding == DG_BAKED_ENCODING_NATIVE) {
+        return dg_baked_write_native(writer, map, (uint32_t)id);
+    }
+
+    switch (id) {
+    case DG_BAKED_SECTION_TILES:
+        if (encoding == DG_BAKED_TILE_ENCODING_RLE) {
+            return dg_write_tile_runs(writer, map->tiles, map->width, map->height);
+        }
+        return dg_baked_write_tiles(writer, map);
+    case DG_BAKED_SECTION_SUMMARY:
+        return dg_baked_write_summary(writer, metadata);
+    case DG_BAKED_SECTION_ROOMS:
+        return dg_baked_write_rooms(writer, metadata);
+    case DG_BAKED_SECTION_CORRIDORS:
+        return dg_baked_write_corridors(writer, metadata);
+    case DG_BAKED_SECTION_ROOM_ENTRANCES:
+        return dg_baked_write_room_entrances(writer, metadata);
+    case DG_BAKED_SECTION_EDGE_OPENINGS:
+        return dg_baked_write_edge_openings(writer, metadata);
+    case DG_BAKED_SECTION_ROOM_ADJACENCY:
+        return dg_baked_write_room_adjacency(writer, metadata);
+    case DG_BAKED_SECTION_ROOM_NEIGHBORS:
+        return dg_baked_write_room_neighbors(writer, metadata);
+    case DG_BAKED_SECTION_PROCESS_STEPS:
+        return dg_baked_write_process_steps(writer, &metadata->diagnostics);
+    case DG_BAKED_SECTION_ROOM_TYPE_QUOTAS:
+        return dg_baked_write_room_type_quotas(writer, &metadata->diagnostics);
+    case DG_BAKED_SECTION_SNAPSHOT:
+        if (metadata->generation_request.present != 1) {
+            return DG_STATUS_OK;
+        }
+        return dg_write_snapshot(writer, &metadata->generation_request);
+    default:
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+}
+
+static dg_status_t dg_baked_write_alignment(dg_io_writer_t *writer)
+{
+    static const unsigned char zeros[DG_BAKED_NATIVE_ALIGNMENT] = {0};
+    size_t remainder;
+
+    remainder = writer->size % DG_BAKED_NATIVE_ALIGNMENT;
+    if (remainder == 0) {
+        return DG_STATUS_OK;
+    }
+    return dg_write_exact(writer, zeros, DG_BAKED_NATIVE_ALIGNMENT - remainder);
+}
+
+static dg_status_t dg_validate_map_for_bake(const dg_map_t *map)
+{
+    const dg_map_metadata_t *metadata;
+
+    if (map == NULL || map->tiles == NULL || map->width <= 0 || map->height <= 0) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    metadata = &map->metadata;
+    if ((metadata->room_count > 0 && metadata->rooms == NULL) ||
+        (metadata->corridor_count > 0 && metadata->corridors == NULL) ||
+        (metadata->room_entrance_count > 0 && metadata->room_entrances == NULL) ||
+        (metadata->edge_opening_count > 0 && metadata->edge_openings == NULL) ||
+        (metadata->room_adjacency_count > 0 && metadata->room_adjacency == NULL) ||
+        (metadata->room_neighbor_count > 0 && metadata->room_neighbors == NULL) ||
+        (metadata->diagnostics.process_step_count > 0 &&
+         metadata->diagnostics.process_steps == NULL) ||
+        (metadata->diagnostics.room_type_count > 0 &&
+         metadata->diagnostics.room_type_quotas == NULL)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (metadata->generation_request.present == 1 &&
+        !dg_snapshot_is_valid(&metadata->generation_request)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_bake_map(
+    const dg_map_t *map,
+    const dg_baked_save_options_t *options,
+    dg_io_writer_t *writer
+)
+{
+    unsigned char zeros[DG_BAKED_SECTION_ENTRY_SIZE];
+    uint32_t section_count;
+    size_t table_offset;
+    uint32_t i;
+    dg_status_t status;
+
+    status = dg_validate_map_for_bake(map);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+    if ((options->layout != DG_BAKED_LAYOUT_PORTABLE &&
+         options->layout != DG_BAKED_LAYOUT_NATIVE) ||
+        (options->tile_encoding != DG_BAKED_TILES_RLE &&
+         options->tile_encoding != DG_BAKED_TILES_PACKED)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    /* Portable files stop before the native layout probe. */
+    section_count = (options->layout == DG_BAKED_LAYOUT_NATIVE)
+                        ? DG_BAKED_SECTION_COUNT
+                        : (uint32_t)DG_BAKED_SECTION_SNAPSHOT;
+
+    memset(zeros, 0, sizeof(zeros));
+    status = dg_write_exact(writer, DG_BAKED_MAGIC, sizeof(DG_BAKED_MAGIC));
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, DG_BAKED_VERSION);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, section_count);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, 0u);
+    }
+    /* Payload size and checksum are patched in once every section exists. */
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u64(writer, 0u);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u64(writer, 0u);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_i32(writer, (int32_t)map->width);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_i32(writer, (int32_t)map->height);
+    }
+
+    table_offset = writer->size;
+    for (i = 0; status == DG_STATUS_OK && i < section_count; ++i) {
+        status = dg_write_exact(writer, zeros, sizeof(zeros));
+    }
+
+    for (i = 0; status == DG_STATUS_OK && i < section_count; ++i) {
+        uint32_t id = i + 1u;
+        uint32_t encoding = dg_baked_section_encoding(id, options);
+        size_t section_start;
+        unsigned char *entry;
+
+        if (encoding == DG_BAKED_ENCODING_NATIVE) {
+            status = dg_baked_write_alignment(writer);
+            if (status != DG_STATUS_OK) {
+                break;
+            }
+        }
+
+        section_start = writer->size;
+        status = dg_baked_write_section(writer, map, (dg_baked_section_id_t)id, encoding);
+        if (status != DG_STATUS_OK) {
+            break;
+        }
+
+        entry = writer->data + table_offset + (size_t)i * DG_BAKED_SECTION_ENTRY_SIZE;
+        dg_baked_store_u32(entry, id);
+        dg_baked_store_u32(entry + 4, encoding);
+        dg_baked_store_u64(entry + 8, (uint64_t)section_start);
+        dg_baked_store_u64(entry + 16, (uint64_t)(writer->size - section_start));
+    }
+
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    dg_baked_store_u64(writer->data + 16, (uint64_t)(writer->size - DG_BAKED_HEADER_SIZE));
+    dg_baked_store_u64(
+        writer->data + 24,
+        dg_baked_checksum(writer->data + DG_BAKED_HEADER_SIZE, writer->size - DG_BAKED_HEADER_SIZE)
+    );
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_baked_read_tiles(
+    const unsigned char *bytes,
+    uint64_t byte_count,
+    dg_map_t *map
+)
+{
+    size_t cell_count;
+    size_t i;
+
+    cell_count = (size_t)map->width * (size_t)map->height;
+    if (byte_count != (uint64_t)(cell_count / 4u + ((cell_count & 3u) != 0u ? 1u : 0u))) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    for (i = 0; i < cell_count; ++i) {
+        map->tiles[i] = (dg_tile_t)((bytes[i >> 2] >> ((i & 3u) * 2u)) & 0x3u);
+    }
+
+    return DG_STATUS_OK;
+}
+
+static bool dg_baked_tiles_in_range(const dg_tile_t *tiles, size_t cell_count)
+{
+    size_t i;
+
+    for (i = 0; i < cell_count; ++i) {
+        if ((int)tiles[i] < (int)DG_TILE_VOID || (int)tiles[i] > (int)DG_TILE_DOOR) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Copies a native array section into freshly allocated metadata storage. */
+static dg_status_t dg_baked_copy_native_section(
+    const unsigned char *data,
+    const dg_baked_section_t *section,
+    dg_map_t *map
+)
+{
+    dg_baked_native_slot_t slot;
+    size_t cell_count;
+    dg_status_t status;
+
+    if (section->id == (uint32_t)DG_BAKED_SECTION_NATIVE_LAYOUT) {
+        return DG_STATUS_OK;
+    }
+
+    if (section->id == (uint32_t)DG_BAKED_SECTION_TILES) {
+        cell_count = (size_t)map->width * (size_t)map->height;
+        memcpy(map->tiles, data + section->offset, cell_count * sizeof(dg_tile_t));
+        return dg_baked_tiles_in_range(map->tiles, cell_count) ? DG_STATUS_OK
+                                                               : DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    if (!dg_baked_native_slot(&map->metadata, section->id, &slot)) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    *slot.count = (size_t)section->size / slot.element_size;
+    status = dg_allocate_array(slot.items, *slot.count, slot.element_size);
+    if (status != DG_STATUS_OK) {
+        *slot.count = 0;
+        return status;
+    }
+    if (*slot.count > 0) {
+        memcpy(*slot.items, data + section->offset, (size_t)section->size);
+    }
+    if (slot.capacity != NULL) {
+        *slot.capacity = *slot.count;
+    }
+    return DG_STATUS_OK;
+}
+
+/*
+ * Opens an array section: reads its count, checks the records exactly fill
+ * the section, and allocates the destination array.
+ */
+static dg_status_t dg_baked_open_array(
+    dg_io_reader_t *reader,
+    size_t record_size,
+    size_t element_size,
+    void **out_items,
+    size_t *out_count
+)
+{
+    size_t payload;
+    dg_status_t status;
+
+    status = dg_read_size(reader, out_count);
+    if (status != DG_STATUS_OK) {
+        return (status == DG_STATUS_IO_ERROR) ? DG_STATUS_UNSUPPORTED_FORMAT : status;
+    }
+
+    if (dg_mul_size_would_overflow(*out_count, record_size, &payload) ||
+        payload != reader->size - reader->offset) {
+        *out_count = 0;
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    status = dg_allocate_array(out_items, *out_count, element_size);
+    if (status != DG_STATUS_OK) {
+        *out_count = 0;
+    }
+    return status;
+}
+
+static dg_status_t dg_baked_read_section(
+    const unsigned char *data,
+    const dg_baked_section_t *section,
+    dg_map_t *map
+)
+{
+    dg_map_metadata_t *metadata = &map->metadata;
+    dg_io_reader_t reader;
+    dg_status_t status;
+
+    if (section->encoding == DG_BAKED_ENCODING_NATIVE) {
+        return dg_baked_copy_native_section(data, section, map);
+    }
+
+    reader = (dg_io_reader_t){0};
+    reader.data = data + section->offset;
+    reader.size = (size_t)section->size;
+
+    switch ((dg_baked_section_id_t)section->id) {
+    case DG_BAKED_SECTION_TILES:
+        if (section->encoding == DG_BAKED_TILE_ENCODING_RLE) {
+            return dg_read_tile_runs(reader.data, reader.size, map->tiles, map->width, map->height);
+        }
+        return dg_baked_read_tiles(reader.data, section->size, map);
+    case DG_BAKED_SECTION_SUMMARY:
+        status = dg_baked_read_summary(&reader, metadata);
+        break;
+    case DG_BAKED_SECTION_ROOMS:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_ROOM_RECORD_SIZE,
+            sizeof(dg_room_metadata_t),
+            (void **)&metadata->rooms,
+            &metadata->room_count
+        );
+        metadata->room_capacity = metadata->room_count;
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_rooms(&reader, metadata);
+        }
+        break;
+    case DG_BAKED_SECTION_CORRIDORS:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_CORRIDOR_RECORD_SIZE,
+            sizeof(dg_corridor_metadata_t),
+            (void **)&metadata->corridors,
+            &metadata->corridor_count
+        );
+        metadata->corridor_capacity = metadata->corridor_count;
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_corridors(&reader, metadata);
+        }
+        break;
+    case DG_BAKED_SECTION_ROOM_ENTRANCES:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_ROOM_ENTRANCE_RECORD_SIZE,
+            sizeof(dg_room_entrance_metadata_t),
+            (void **)&metadata->room_entrances,
+            &metadata->room_entrance_count
+        );
+        metadata->room_entrance_capacity = metadata->room_entrance_count;
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_room_entrances(&reader, metadata);
+        }
+        break;
+    case DG_BAKED_SECTION_EDGE_OPENINGS:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_EDGE_OPENING_RECORD_SIZE,
+            sizeof(dg_map_edge_opening_t),
+            (void **)&metadata->edge_openings,
+            &metadata->edge_opening_count
+        );
+        metadata->edge_opening_capacity = metadata->edge_opening_count;
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_edge_openings(&reader, metadata);
+        }
+        break;
+    case DG_BAKED_SECTION_ROOM_ADJACENCY:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_ROOM_ADJACENCY_RECORD_SIZE,
+            sizeof(dg_room_adjacency_span_t),
+            (void **)&metadata->room_adjacency,
+            &metadata->room_adjacency_count
+        );
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_room_adjacency(&reader, metadata);
+        }
+        break;
+    case DG_BAKED_SECTION_ROOM_NEIGHBORS:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_ROOM_NEIGHBOR_RECORD_SIZE,
+            sizeof(dg_room_neighbor_t),
+            (void **)&metadata->room_neighbors,
+            &metadata->room_neighbor_count
+        );
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_room_neighbors(&reader, metadata);
+        }
+        break;
+    case DG_BAKED_SECTION_PROCESS_STEPS:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_PROCESS_STEP_RECORD_SIZE,
+            sizeof(dg_process_step_diagnostics_t),
+            (void **)&metadata->diagnostics.process_steps,
+            &metadata->diagnostics.process_step_count
+        );
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_process_steps(&reader, &metadata->diagnostics);
+        }
+        break;
+    case DG_BAKED_SECTION_ROOM_TYPE_QUOTAS:
+        status = dg_baked_open_array(
+            &reader,
+            DG_BAKED_ROOM_TYPE_QUOTA_RECORD_SIZE,
+            sizeof(dg_room_type_quota_diagnostics_t),
+            (void **)&metadata->diagnostics.room_type_quotas,
+            &metadata->diagnostics.room_type_count
+        );
+        if (status == DG_STATUS_OK) {
+            status = dg_baked_read_room_type_quotas(&reader, &metadata->diagnostics);
+        }
+        break;
+    case DG_BAKED_SECTION_SNAPSHOT:
+        if (reader.size == 0) {
+            return DG_STATUS_OK;
+        }
+        status = dg_read_snapshot(&reader, &metadata->generation_request);
+        break;
+    default:
+        return DG_STATUS_OK;
+    }
+
+    if (status == DG_STATUS_IO_ERROR) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+    if (status == DG_STATUS_OK && reader.offset != reader.size) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+    return status;
+}
+
+static bool dg_baked_id_in_range(int id, size_t count)
+{
+    return id >= 0 && (size_t)id < count;
+}
+
+/*
+ * Cross-references must name existing records: corridor endpoints, entrance
+ * and neighbor rooms, and neighbor corridors. Adjacency spans must tile the
+ * neighbor list in room order, as dg_build_room_graph_metadata lays it out.
+ */
+static dg_status_t dg_baked_validate_room_graph(const dg_map_metadata_t *metadata)
+{
+    size_t running_index;
+    size_t i;
+
+    for (i = 0; i < metadata->corridor_count; ++i) {
+        const dg_corridor_metadata_t *corridor = &metadata->corridors[i];
+
+        if (!dg_baked_id_in_range(corridor->from_room_id, metadata->room_count) ||
+            !dg_baked_id_in_range(corridor->to_room_id, metadata->room_count)) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+    }
+
+    for (i = 0; i < metadata->room_entrance_count; ++i) {
+        if (!dg_baked_id_in_range(metadata->room_entrances[i].room_id, metadata->room_count)) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+    }
+
+    for (i = 0; i < metadata->room_neighbor_count; ++i) {
+        const dg_room_neighbor_t *neighbor = &metadata->room_neighbors[i];
+
+        if (!dg_baked_id_in_range(neighbor->room_id, metadata->room_count) ||
+            !dg_baked_id_in_range(neighbor->corridor_index, metadata->corridor_count)) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+    }
+
+    if (metadata->room_adjacency_count > 0 &&
+        metadata->room_adjacency_count != metadata->room_count) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    running_index = 0;
+    for (i = 0; i < metadata->room_adjacency_count; ++i) {
+        const dg_room_adjacency_span_t *span = &metadata->room_adjacency[i];
+
+        if (span->start_index != running_index ||
+            span->count > metadata->room_neighbor_count - running_index) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+        running_index += span->count;
+    }
+
+    return DG_STATUS_OK;
+}
+
+/* Checks that a native section is aligned and holds a whole number of elements. */
+static bool dg_baked_native_section_is_valid(
+    const dg_baked_file_t *file,
+    const dg_baked_section_t *section
+)
+{
+    dg_map_metadata_t scratch;
+    dg_baked_native_slot_t slot;
+    uint32_t layout[DG_BAKED_NATIVE_LAYOUT_FIELDS];
+
+    if ((section->offset % DG_BAKED_NATIVE_ALIGNMENT) != 0u) {
+        return false;
+    }
+
+    switch ((dg_baked_section_id_t)section->id) {
+    case DG_BAKED_SECTION_TILES:
+        return section->size / sizeof(dg_tile_t) == (uint64_t)file->cell_count &&
+               section->size % sizeof(dg_tile_t) == 0u;
+    case DG_BAKED_SECTION_NATIVE_LAYOUT:
+        dg_baked_native_layout(layout);
+        return section->size == sizeof(layout) &&
+               memcmp(file->data + section->offset, layout, sizeof(layout)) == 0;
+    default:
+        return dg_baked_native_slot(&scratch, section->id, &slot) &&
+               section->size % slot.element_size == 0u;
+    }
+}
+
+/*
+ * Validates the header and section table and indexes the known sections by
+ * id. Native sections are only accepted when the file's layout probe matches
+ * this build.
+ */
+static dg_status_t dg_baked_parse(
+    const unsigned char *data,
+    size_t size,
+    bool verify_checksum,
+    dg_baked_file_t *out_file
+)
+{
+    uint32_t section_count;
+    int32_t width;
+    int32_t height;
+    uint32_t i;
+
+    *out_file = (dg_baked_file_t){0};
+    if (size < DG_BAKED_HEADER_SIZE || memcmp(data, DG_BAKED_MAGIC, sizeof(DG_BAKED_MAGIC)) != 0) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    if (dg_baked_load_u32(data + 4) != DG_BAKED_VERSION ||
+        dg_baked_load_u64(data + 16) != (uint64_t)(size - DG_BAKED_HEADER_SIZE)) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+    if (verify_checksum &&
+        dg_baked_load_u64(data + 24) !=
+            dg_baked_checksum(data + DG_BAKED_HEADER_SIZE, size - DG_BAKED_HEADER_SIZE)) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    section_count = dg_baked_load_u32(data + 8);
+    width = (int32_t)dg_baked_load_u32(data + 32);
+    height = (int32_t)dg_baked_load_u32(data + 36);
+    if (width <= 0 || height <= 0 ||
+        dg_mul_size_would_overflow((size_t)width, (size_t)height, &out_file->cell_count) ||
+        (uint64_t)section_count >
+            (uint64_t)(size - DG_BAKED_HEADER_SIZE) / DG_BAKED_SECTION_ENTRY_SIZE) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    out_file->data = data;
+    out_file->size = size;
+    out_file->width = (int)width;
+    out_file->height = (int)height;
+
+    for (i = 0; i < section_count; ++i) {
+        const unsigned char *entry;
+        dg_baked_section_t section;
+        uint32_t bit;
+
+        entry = data + DG_BAKED_HEADER_SIZE + (size_t)i * DG_BAKED_SECTION_ENTRY_SIZE;
+        section.id = dg_baked_load_u32(entry);
+        section.encoding = dg_baked_load_u32(entry + 4);
+        section.offset = dg_baked_load_u64(entry + 8);
+        section.size = dg_baked_load_u64(entry + 16);
+
+        if (section.offset > (uint64_t)size || section.size > (uint64_t)size - section.offset) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        /* Unknown sections are skipped so newer writers stay readable. */
+        if (section.id < 1u || section.id > DG_BAKED_SECTION_COUNT) {
+            continue;
+        }
+
+        bit = 1u << section.id;
+        if ((out_file->present_sections & bit) != 0u) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        if (section.encoding == DG_BAKED_ENCODING_NATIVE) {
+            out_file->native_sections |= bit;
+        } else if (!dg_baked_is_portable_encoding(section.id, section.encoding)) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        out_file->present_sections |= bit;
+        out_file->sections[section.id] = section;
+    }
+
+    /* Every section except the optional snapshot and layout probe must be present. */
+    for (i = 1u; i <= DG_BAKED_SECTION_COUNT; ++i) {
+        if (i != (uint32_t)DG_BAKED_SECTION_SNAPSHOT &&
+            i != (uint32_t)DG_BAKED_SECTION_NATIVE_LAYOUT &&
+            (out_file->present_sections & (1u << i)) == 0u) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+    }
+
+    if (out_file->native_sections != 0u) {
+        if ((out_file->native_sections & (1u << DG_BAKED_SECTION_NATIVE_LAYOUT)) == 0u) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+        for (i = 1u; i <= DG_BAKED_SECTION_COUNT; ++i) {
+            if ((out_file->native_sections & (1u << i)) != 0u &&
+                !dg_baked_native_section_is_valid(out_file, &out_file->sections[i])) {
+                return DG_STATUS_UNSUPPORTED_FORMAT;
+            }
+        }
+    }
+
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_unbake_map(const unsigned char *data, size_t size, dg_map_t *out_map)
+{
+    dg_baked_file_t file;
+    uint32_t id;
+    dg_status_t status;
+
+    status = dg_baked_parse(data, size, true, &file);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    status = dg_allocate_array((void **)&out_map->tiles, file.cell_count, sizeof(dg_tile_t));
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+    out_map->width = file.width;
+    out_map->height = file.height;
+
+    for (id = 1u; id <= DG_BAKED_SECTION_COUNT; ++id) {
+        if ((file.present_sections & (1u << id)) == 0u) {
+            continue;
+        }
+
+        status = dg_baked_read_section(data, &file.sections[id], out_map);
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+    }
+
+    return dg_baked_validate_room_graph(&out_map->metadata);
+}
+
+/*
+ * Points the view's tiles and metadata lists straight into the mapping.
+ * Only the summary scalars and the generation request snapshot are decoded.
+ */
+static dg_status_t dg_baked_attach_native(const dg_baked_file_t *file, dg_map_t *map)
+{
+    uint32_t id;
+    dg_status_t status;
+
+    map->width = file->width;
+    map->height = file->height;
+
+    for (id = 1u; id <= DG_BAKED_SECTION_COUNT; ++id) {
+        const dg_baked_section_t *section = &file->sections[id];
+        void *items = (void *)(file->data + section->offset);
+        dg_baked_native_slot_t slot;
+
+        if ((file->present_sections & (1u << id)) == 0u ||
+            id == (uint32_t)DG_BAKED_SECTION_NATIVE_LAYOUT) {
+            continue;
+        }
+
+        if (id == (uint32_t)DG_BAKED_SECTION_TILES) {
+            map->tiles = (dg_tile_t *)items;
+            continue;
+        }
+
+        if (section->encoding != DG_BAKED_ENCODING_NATIVE) {
+            status = dg_baked_read_section(file->data, section, map);
+            if (status != DG_STATUS_OK) {
+                return status;
+            }
+            continue;
+        }
+
+        if (!dg_baked_native_slot(&map->metadata, id, &slot)) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+        *slot.count = (size_t)section->size / slot.element_size;
+        *slot.items = (*slot.count > 0) ? items : NULL;
+        if (slot.capacity != NULL) {
+            *slot.capacity = *slot.count;
+        }
+    }
+
+    return dg_baked_validate_room_graph(&map->metadata);
+}
+
+static dg_status_t dg_baked_map_file(const char *path, dg_map_view_t *view)
+{
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+    LARGE_INTEGER file_size;
+    void *data;
+
+    file = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    if (!GetFileSizeEx(file, &file_size) ||
+        (unsigned long long)file_size.QuadPart > (unsigned long long)SIZE_MAX) {
+        (void)CloseHandle(file);
+        return DG_STATUS_IO_ERROR;
+    }
+    if (file_size.QuadPart < (LONGLONG)DG_BAKED_HEADER_SIZE) {
+        (void)CloseHandle(file);
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    /* The mapping keeps its own reference to the file. */
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    (void)CloseHandle(file);
+    if (mapping == NULL) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        (void)CloseHandle(mapping);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    view->mapping = data;
+    view->mapping_size = (size_t)file_size.QuadPart;
+    view->mapping_handle = mapping;
+    return DG_STATUS_OK;
+#else
+    struct stat info;
+    void *data;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    if (fstat(fd, &info) != 0 || (uintmax_t)info.st_size > (uintmax_t)SIZE_MAX) {
+        (void)close(fd);
+        return DG_STATUS_IO_ERROR;
+    }
+    if (info.st_size < (off_t)DG_BAKED_HEADER_SIZE) {
+        (void)close(fd);
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    /* The mapping keeps its own reference to the file. */
+    data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (data == MAP_FAILED) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    view->mapping = data;
+    view->mapping_size = (size_t)info.st_size;
+    return DG_STATUS_OK;
+#endif
+}
+
+static void dg_baked_unmap_file(dg_map_view_t *view)
+{
+    if (view->mapping == NULL) {
+        return;
+    }
+
+#if defined(_WIN32)
+    (void)UnmapViewOfFile(view->mapping);
+    (void)CloseHandle((HANDLE)view->mapping_handle);
+#else
+    (void)munmap(view->mapping, view->mapping_size);
+#endif
+
+    view->mapping = NULL;
+    view->mapping_size = 0;
+    view->mapping_handle = NULL;
+}
+
+void dg_default_baked_save_options(dg_baked_save_options_t *options)
+{
+    if (options == NULL) {
+        return;
+    }
+
+    options->layout = DG_BAKED_LAYOUT_PORTABLE;
+    options->tile_encoding = DG_BAKED_TILES_RLE;
+}
+
+dg_status_t dg_map_save_baked_file(const dg_map_t *map, const char *path)
+{
+    dg_baked_save_options_t options;
+
+    dg_default_baked_save_options(&options);
+    return dg_map_save_baked_file_with_options(map, path, &options);
+}
+
+dg_status_t dg_map_save_baked_file_with_options(
+    const dg_map_t *map,
+    const char *path,
+    const dg_baked_save_options_t *options
+)
+{
+    dg_io_writer_t writer;
+    FILE *file;
+    dg_status_t status;
+
+    if (path == NULL || options == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    writer = (dg_io_writer_t){0};
+    status = dg_bake_map(map, options, &writer);
+    if (status != DG_STATUS_OK) {
+        free(writer.data);
+        return status;
+    }
+
+    file = fopen(path, "wb");
+    if (file == NULL) {
+        free(writer.data);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    if (fwrite(writer.data, 1, writer.size, file) != writer.size) {
+        (void)fclose(file);
+        free(writer.data);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    free(writer.data);
+    if (fclose(file) != 0) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_map_load_baked_file(const char *path, dg_map_t *out_map)
+{
+    unsigned char *data;
+    size_t size;
+    dg_status_t status;
+
+    if (path == NULL || out_map == NULL || !dg_map_is_empty(out_map)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dg_read_file_contents(path, &data, &size);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    status = dg_unbake_map(data, size, out_map);
+    free(data);
+    if (status != DG_STATUS_OK) {
+        dg_map_destroy(out_map);
+    }
+    return status;
+}
+
+dg_status_t dg_map_view_open(const char *path, dg_map_view_t *out_view)
+{
+    dg_baked_file_t file;
+    dg_status_t status;
+
+    if (path == NULL || out_view == NULL || out_view->mapping != NULL ||
+        !dg_map_is_empty(&out_view->map)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dg_baked_map_file(path, out_view);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    status = dg_baked_parse(
+        (const unsigned char *)out_view->mapping,
+        out_view->mapping_size,
+        false,
+        &file
+    );
+    if (status == DG_STATUS_OK &&
+        (file.native_sections & DG_BAKED_ZERO_COPY_SECTIONS) == DG_BAKED_ZERO_COPY_SECTIONS) {
+        status = dg_baked_attach_native(&file, &out_view->map);
+    } else if (status == DG_STATUS_OK) {
+        /* Portable files need decoding, so the view holds its own copy instead. */
+        out_view->owns_map = true;
+        status = dg_unbake_map(file.data, file.size, &out_view->map);
+        dg_baked_unmap_file(out_view);
+    }
+
+    if (status != DG_STATUS_OK) {
+        dg_map_view_close(out_view);
+    }
+    return status;
+}
+
+dg_status_t dg_map_view_verify(const dg_map_view_t *view)
+{
+    const unsigned char *data;
+
+    if (view == NULL || view->map.tiles == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    /* Decoded views were checksummed when they were opened. */
+    if (view->owns_map) {
+        return DG_STATUS_OK;
+    }
+
+    data = (const unsigned char *)view->mapping;
+    if (dg_baked_load_u64(data + 24) !=
+            dg_baked_checksum(data + DG_BAKED_HEADER_SIZE, view->mapping_size - DG_BAKED_HEADER_SIZE) ||
+        !dg_baked_tiles_in_range(
+            view->map.tiles,
+            (size_t)view->map.width * (size_t)view->map.height
+        )) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    return DG_STATUS_OK;
+}
+
+void dg_map_view_close(dg_map_view_t *view)
+{
+    if (view == NULL) {
+        return;
+    }
+
+    if (view->owns_map) {
+        dg_map_destroy(&view->map);
+    } else {
+        dg_snapshot_clear(&view->map.metadata.generation_request);
+    }
+    dg_baked_unmap_file(view);
+    memset(view, 0, sizeof(*view));
+}
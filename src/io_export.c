@@ -1,30 +1,11 @@
-#include "dungeoneer/io.h"
-#include "dungeoneer/generator.h"
+#include "io_internal.h"
 
 #include <limits.h>
 #include <png.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-static bool dg_mul_size_would_overflow(size_t a, size_t b, size_t *out)
-{
-    if (out == NULL) {
-        return true;
-    }
-
-    if (a == 0 || b == 0) {
-        *out = 0;
-        return false;
-    }
-
-    if (a > (SIZE_MAX / b)) {
-        return true;
-    }
-
-    *out = a * b;
-    return false;
-}
+#include <zlib.h>
 
 typedef struct dg_export_tile_legend_entry {
     dg_tile_t tile;
@@ -106,25 +87,212 @@ static void dg_export_base_tile_to_rgba(dg_tile_t tile, unsigned char rgba[4])
     rgba[3] = 255u;
 }
 
+/*
+ * Walks the map one row at a time and reports which typed room owns each
+ * floor tile of the current row. Rooms are activated by their top edge and
+ * scanned in room order, so the first room covering a tile wins, exactly as
+ * a full per-tile overlay would resolve it, but with O(width + rooms) memory.
+ */
+typedef struct dg_export_row_cursor {
+    const dg_map_t *map;
+    size_t *rooms_by_top;
+    size_t room_total;
+    size_t next_room;
+    size_t *active_rooms;
+    size_t active_count;
+    int *row_room;
+} dg_export_row_cursor_t;
+
+static bool dg_export_clamped_room_bounds(
+    const dg_map_t *map,
+    const dg_room_metadata_t *room,
+    int *out_x0,
+    int *out_y0,
+    int *out_x1,
+    int *out_y1
+)
+{
+    int x0 = room->bounds.x;
+    int y0 = room->bounds.y;
+    int x1 = room->bounds.x + room->bounds.width;
+    int y1 = room->bounds.y + room->bounds.height;
+
+    if (x0 < 0) {
+        x0 = 0;
+    }
+    if (y0 < 0) {
+        y0 = 0;
+    }
+    if (x1 > map->width) {
+        x1 = map->width;
+    }
+    if (y1 > map->height) {
+        y1 = map->height;
+    }
+
+    *out_x0 = x0;
+    *out_y0 = y0;
+    *out_x1 = x1;
+    *out_y1 = y1;
+    return x0 < x1 && y0 < y1;
+}
+
+static int dg_export_room_top(const dg_map_t *map, size_t room_index)
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+
+    (void)dg_export_clamped_room_bounds(map, &map->metadata.rooms[room_index], &x0, &y0, &x1, &y1);
+    return y0;
+}
+
+static void dg_export_row_cursor_destroy(dg_export_row_cursor_t *cursor)
+{
+    free(cursor->rooms_by_top);
+    free(cursor->active_rooms);
+    free(cursor->row_room);
+    memset(cursor, 0, sizeof(*cursor));
+}
+
+static dg_status_t dg_export_row_cursor_init(dg_export_row_cursor_t *cursor, const dg_map_t *map)
+{
+    size_t room_count;
+    size_t i;
+
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->map = map;
+
+    cursor->row_room = (int *)malloc((size_t)map->width * sizeof(*cursor->row_room));
+    if (cursor->row_room == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    if (map->metadata.generation_class != DG_MAP_GENERATION_CLASS_ROOM_LIKE ||
+        map->metadata.room_count == 0 || map->metadata.rooms == NULL) {
+        return DG_STATUS_OK;
+    }
+
+    room_count = map->metadata.room_count;
+    if (room_count > (SIZE_MAX / sizeof(size_t))) {
+        dg_export_row_cursor_destroy(cursor);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+    cursor->rooms_by_top = (size_t *)malloc(room_count * sizeof(size_t));
+    cursor->active_rooms = (size_t *)malloc(room_count * sizeof(size_t));
+    if (cursor->rooms_by_top == NULL || cursor->active_rooms == NULL) {
+        dg_export_row_cursor_destroy(cursor);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    for (i = 0; i < room_count; ++i) {
+        const dg_room_metadata_t *room = &map->metadata.rooms[i];
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+
+        if (room->type_id == DG_ROOM_TYPE_UNASSIGNED ||
+            !dg_export_clamped_room_bounds(map, room, &x0, &y0, &x1, &y1)) {
+            continue;
+        }
+        cursor->rooms_by_top[cursor->room_total] = i;
+        cursor->room_total += 1u;
+    }
+
+    /* Stable insertion sort by top edge keeps room order within a row. */
+    for (i = 1; i < cursor->room_total; ++i) {
+        size_t room_index = cursor->rooms_by_top[i];
+        int top = dg_export_room_top(map, room_index);
+        size_t j = i;
+
+        while (j > 0 && dg_export_room_top(map, cursor->rooms_by_top[j - 1u]) > top) {
+            cursor->rooms_by_top[j] = cursor->rooms_by_top[j - 1u];
+            j -= 1u;
+        }
+        cursor->rooms_by_top[j] = room_index;
+    }
+
+    return DG_STATUS_OK;
+}
+
+/* Fills `row_room` for row `y`; rows must be visited top to bottom. */
+static void dg_export_row_cursor_advance(dg_export_row_cursor_t *cursor, int y)
+{
+    const dg_map_t *map = cursor->map;
+    const dg_tile_t *tiles = map->tiles + (size_t)y * (size_t)map->width;
+    size_t kept;
+    size_t i;
+    int x;
+
+    for (x = 0; x < map->width; ++x) {
+        cursor->row_room[x] = -1;
+    }
+
+    while (cursor->next_room < cursor->room_total &&
+           dg_export_room_top(map, cursor->rooms_by_top[cursor->next_room]) <= y) {
+        size_t room_index = cursor->rooms_by_top[cursor->next_room];
+        size_t j = cursor->active_count;
+
+        while (j > 0 && cursor->active_rooms[j - 1u] > room_index) {
+            cursor->active_rooms[j] = cursor->active_rooms[j - 1u];
+            j -= 1u;
+        }
+        cursor->active_rooms[j] = room_index;
+        cursor->active_count += 1u;
+        cursor->next_room += 1u;
+    }
+
+    kept = 0;
+    for (i = 0; i < cursor->active_count; ++i) {
+        size_t room_index = cursor->active_rooms[i];
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+
+        (void)dg_export_clamped_room_bounds(
+            map,
+            &map->metadata.rooms[room_index],
+            &x0,
+            &y0,
+            &x1,
+            &y1
+        );
+        if (y >= y1) {
+            continue;
+        }
+        cursor->active_rooms[kept] = room_index;
+        kept += 1u;
+
+        for (x = x0; x < x1; ++x) {
+            if (tiles[x] == DG_TILE_FLOOR && cursor->row_room[x] < 0) {
+                cursor->row_room[x] = (int)room_index;
+            }
+        }
+    }
+    cursor->active_count = kept;
+}
+
 static dg_status_t dg_export_build_room_type_overlay(
     const dg_map_t *map,
-    int **out_room_index_by_tile,
     dg_export_room_type_palette_entry_t **out_palette_entries,
     size_t *out_palette_count
 )
 {
-    size_t cell_count;
-    int *room_index_by_tile;
+    dg_export_row_cursor_t cursor;
     dg_export_room_type_palette_entry_t *palette_entries;
     size_t palette_count;
+    dg_status_t status;
     size_t i;
+    int y;
+    int x;
 
-    if (map == NULL || out_room_index_by_tile == NULL || out_palette_entries == NULL ||
-        out_palette_count == NULL) {
+    if (map == NULL || out_palette_entries == NULL || out_palette_count == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    *out_room_index_by_tile = NULL;
     *out_palette_entries = NULL;
     *out_palette_count = 0u;
 
@@ -137,35 +305,18 @@ static dg_status_t dg_export_build_room_type_overlay(
         return DG_STATUS_OK;
     }
 
-    if (dg_mul_size_would_overflow((size_t)map->width, (size_t)map->height, &cell_count)) {
-        return DG_STATUS_INVALID_ARGUMENT;
-    }
-
-    room_index_by_tile = (int *)malloc(cell_count * sizeof(*room_index_by_tile));
-    if (room_index_by_tile == NULL) {
+    if (map->metadata.room_count > (SIZE_MAX / sizeof(*palette_entries))) {
         return DG_STATUS_ALLOCATION_FAILED;
     }
-    for (i = 0; i < cell_count; ++i) {
-        room_index_by_tile[i] = -1;
+    palette_entries = (dg_export_room_type_palette_entry_t *)calloc(
+        map->metadata.room_count,
+        sizeof(*palette_entries)
+    );
+    if (palette_entries == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
     }
 
-    palette_entries = NULL;
     palette_count = 0u;
-    if (map->metadata.room_count > 0) {
-        if (map->metadata.room_count > (SIZE_MAX / sizeof(*palette_entries))) {
-            free(room_index_by_tile);
-            return DG_STATUS_ALLOCATION_FAILED;
-        }
-        palette_entries = (dg_export_room_type_palette_entry_t *)calloc(
-            map->metadata.room_count,
-            sizeof(*palette_entries)
-        );
-        if (palette_entries == NULL) {
-            free(room_index_by_tile);
-            return DG_STATUS_ALLOCATION_FAILED;
-        }
-    }
-
     for (i = 0; i < map->metadata.room_count; ++i) {
         const dg_room_metadata_t *room = &map->metadata.rooms[i];
         size_t entry_index;
@@ -188,71 +339,6 @@ static dg_status_t dg_export_build_room_type_overlay(
         palette_entries[entry_index].room_count += 1u;
     }
 
-    for (i = 0; i < map->metadata.room_count; ++i) {
-        const dg_room_metadata_t *room = &map->metadata.rooms[i];
-        int x0;
-        int y0;
-        int x1;
-        int y1;
-        int x;
-        int y;
-
-        if (room->type_id == DG_ROOM_TYPE_UNASSIGNED) {
-            continue;
-        }
-
-        x0 = room->bounds.x;
-        y0 = room->bounds.y;
-        x1 = room->bounds.x + room->bounds.width;
-        y1 = room->bounds.y + room->bounds.height;
-        if (x0 < 0) {
-            x0 = 0;
-        }
-        if (y0 < 0) {
-            y0 = 0;
-        }
-        if (x1 > map->width) {
-            x1 = map->width;
-        }
-        if (y1 > map->height) {
-            y1 = map->height;
-        }
-        if (x0 >= x1 || y0 >= y1) {
-            continue;
-        }
-
-        for (y = y0; y < y1; ++y) {
-            for (x = x0; x < x1; ++x) {
-                size_t tile_index = (size_t)y * (size_t)map->width + (size_t)x;
-                if (map->tiles[tile_index] != DG_TILE_FLOOR) {
-                    continue;
-                }
-                if (room_index_by_tile[tile_index] < 0) {
-                    room_index_by_tile[tile_index] = (int)i;
-                }
-            }
-        }
-    }
-
-    for (i = 0; i < cell_count; ++i) {
-        int room_index = room_index_by_tile[i];
-        size_t entry_index;
-        uint32_t type_id;
-        if (room_index < 0 || (size_t)room_index >= map->metadata.room_count) {
-            continue;
-        }
-
-        type_id = map->metadata.rooms[room_index].type_id;
-        if (type_id == DG_ROOM_TYPE_UNASSIGNED) {
-            continue;
-        }
-
-        entry_index = dg_export_find_room_type_palette_entry(palette_entries, palette_count, type_id);
-        if (entry_index != SIZE_MAX) {
-            palette_entries[entry_index].tile_count += 1u;
-        }
-    }
-
     if (palette_count > 1u) {
         size_t left;
         for (left = 0; left + 1u < palette_count; ++left) {
@@ -269,10 +355,35 @@ static dg_status_t dg_export_build_room_type_overlay(
 
     if (palette_count == 0u) {
         free(palette_entries);
-        palette_entries = NULL;
+        return DG_STATUS_OK;
+    }
+
+    status = dg_export_row_cursor_init(&cursor, map);
+    if (status != DG_STATUS_OK) {
+        free(palette_entries);
+        return status;
+    }
+
+    for (y = 0; y < map->height; ++y) {
+        dg_export_row_cursor_advance(&cursor, y);
+        for (x = 0; x < map->width; ++x) {
+            size_t entry_index;
+
+            if (cursor.row_room[x] < 0) {
+                continue;
+            }
+            entry_index = dg_export_find_room_type_palette_entry(
+                palette_entries,
+                palette_count,
+                map->metadata.rooms[cursor.row_room[x]].type_id
+            );
+            if (entry_index != SIZE_MAX) {
+                palette_entries[entry_index].tile_count += 1u;
+            }
+        }
     }
+    dg_export_row_cursor_destroy(&cursor);
 
-    *out_room_index_by_tile = room_index_by_tile;
     *out_palette_entries = palette_entries;
     *out_palette_count = palette_count;
     return DG_STATUS_OK;
@@ -281,7 +392,7 @@ static dg_status_t dg_export_build_room_type_overlay(
 static void dg_export_tile_to_rgba(
     const dg_map_t *map,
     size_t tile_index,
-    const int *room_index_by_tile,
+    int room_index,
     unsigned char rgba[4]
 )
 {
@@ -292,176 +403,357 @@ static void dg_export_tile_to_rgba(
     }
 
     tile = map->tiles[tile_index];
-    if (tile == DG_TILE_FLOOR && room_index_by_tile != NULL) {
-        int room_index = room_index_by_tile[tile_index];
-        if (room_index >= 0 && (size_t)room_index < map->metadata.room_count) {
-            uint32_t room_type_id = map->metadata.rooms[room_index].type_id;
-            if (room_type_id != DG_ROOM_TYPE_UNASSIGNED) {
-                dg_export_color_for_room_type(room_type_id, rgba);
-                return;
-            }
+    if (tile == DG_TILE_FLOOR && room_index >= 0 && (size_t)room_index < map->metadata.room_count) {
+        uint32_t room_type_id = map->metadata.rooms[room_index].type_id;
+        if (room_type_id != DG_ROOM_TYPE_UNASSIGNED) {
+            dg_export_color_for_room_type(room_type_id, rgba);
+            return;
         }
     }
 
     dg_export_base_tile_to_rgba(tile, rgba);
 }
 
-static dg_status_t dg_export_build_png_pixels(
+/*
+ * Palette layout for indexed PNGs: tile legend entries keep their tile value
+ * as index, then a fallback color, then one entry per room type.
+ */
+#define DG_EXPORT_PALETTE_FALLBACK_INDEX 4u
+#define DG_EXPORT_PALETTE_ROOM_TYPE_BASE 5u
+#define DG_EXPORT_PALETTE_MAX 256u
+
+typedef struct dg_export_png_image {
+    int color_type;
+    size_t bytes_per_pixel;
+    int pixels_per_tile;
+    png_color palette[DG_EXPORT_PALETTE_MAX];
+    png_byte palette_alpha[DG_EXPORT_PALETTE_MAX];
+    int palette_count;
+    unsigned char *room_palette_index;
+} dg_export_png_image_t;
+
+static void dg_export_set_palette_entry(
+    dg_export_png_image_t *image,
+    size_t index,
+    const unsigned char rgba[4]
+)
+{
+    image->palette[index].red = rgba[0];
+    image->palette[index].green = rgba[1];
+    image->palette[index].blue = rgba[2];
+    image->palette_alpha[index] = rgba[3];
+}
+
+/*
+ * Chooses the PNG color type. Indexed output needs every color to fit in one
+ * 8-bit palette; maps with more room types than that fall back to RGBA.
+ */
+static dg_status_t dg_export_prepare_png_image(
     const dg_map_t *map,
-    const int *room_index_by_tile,
-    unsigned char **out_pixels,
-    size_t *out_size
+    const dg_export_room_type_palette_entry_t *palette_entries,
+    size_t palette_count,
+    const dg_export_options_t *options,
+    dg_export_png_image_t *image
 )
 {
-    size_t row_bytes;
-    size_t pixel_size;
-    unsigned char *pixels;
-    int y;
+    static const unsigned char fallback_rgba[4] = {255u, 0u, 255u, 255u};
+    size_t i;
+
+    memset(image, 0, sizeof(*image));
+    image->color_type = PNG_COLOR_TYPE_RGBA;
+    image->bytes_per_pixel = 4u;
+    image->pixels_per_tile = options->png_pixels_per_tile;
+
+    if (options->png_color_mode != DG_PNG_COLOR_MODE_INDEXED ||
+        palette_count > DG_EXPORT_PALETTE_MAX - DG_EXPORT_PALETTE_ROOM_TYPE_BASE) {
+        return DG_STATUS_OK;
+    }
+
+    for (i = 0; i < sizeof(DG_EXPORT_TILE_LEGEND) / sizeof(DG_EXPORT_TILE_LEGEND[0]); ++i) {
+        dg_export_set_palette_entry(
+            image,
+            (size_t)DG_EXPORT_TILE_LEGEND[i].tile,
+            DG_EXPORT_TILE_LEGEND[i].rgba
+        );
+    }
+    dg_export_set_palette_entry(image, DG_EXPORT_PALETTE_FALLBACK_INDEX, fallback_rgba);
+    for (i = 0; i < palette_count; ++i) {
+        dg_export_set_palette_entry(
+            image,
+            DG_EXPORT_PALETTE_ROOM_TYPE_BASE + i,
+            palette_entries[i].rgba
+        );
+    }
+
+    /* Index 0 doubles as "no room type" since it is the void tile. */
+    if (map->metadata.room_count > 0 && palette_count > 0) {
+        image->room_palette_index = (unsigned char *)calloc(
+            map->metadata.room_count,
+            sizeof(*image->room_palette_index)
+        );
+        if (image->room_palette_index == NULL) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+
+        for (i = 0; i < map->metadata.room_count; ++i) {
+            size_t entry_index = dg_export_find_room_type_palette_entry(
+                palette_entries,
+                palette_count,
+                map->metadata.rooms[i].type_id
+            );
+            if (entry_index != SIZE_MAX) {
+                image->room_palette_index[i] =
+                    (unsigned char)(DG_EXPORT_PALETTE_ROOM_TYPE_BASE + entry_index);
+            }
+        }
+    }
+
+    image->color_type = PNG_COLOR_TYPE_PALETTE;
+    image->bytes_per_pixel = 1u;
+    image->palette_count = (int)(DG_EXPORT_PALETTE_ROOM_TYPE_BASE + palette_count);
+    return DG_STATUS_OK;
+}
+
+static unsigned char dg_export_tile_to_palette_index(
+    const dg_map_t *map,
+    size_t tile_index,
+    int room_index,
+    const unsigned char *room_palette_index
+)
+{
+    dg_tile_t tile = map->tiles[tile_index];
+
+    if (tile == DG_TILE_FLOOR && room_index >= 0 && room_palette_index != NULL &&
+        (size_t)room_index < map->metadata.room_count &&
+        room_palette_index[room_index] != 0u) {
+        return room_palette_index[room_index];
+    }
+
+    if ((int)tile < (int)DG_TILE_VOID || (int)tile > (int)DG_TILE_DOOR) {
+        return (unsigned char)DG_EXPORT_PALETTE_FALLBACK_INDEX;
+    }
+    return (unsigned char)tile;
+}
+
+/* Encodes tile row `y` into one scanline, repeating each tile horizontally. */
+static void dg_export_build_png_row(
+    const dg_map_t *map,
+    const dg_export_png_image_t *image,
+    const dg_export_row_cursor_t *cursor,
+    int y,
+    unsigned char *row
+)
+{
+    size_t pixel_bytes = image->bytes_per_pixel;
+    size_t scale = (size_t)image->pixels_per_tile;
     int x;
 
-    if (map == NULL || out_pixels == NULL || out_size == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
+    for (x = 0; x < map->width; ++x) {
+        size_t tile_index = (size_t)y * (size_t)map->width + (size_t)x;
+        unsigned char *pixel = row + (size_t)x * scale * pixel_bytes;
+        size_t repeat;
+
+        if (image->color_type == PNG_COLOR_TYPE_PALETTE) {
+            pixel[0] = dg_export_tile_to_palette_index(
+                map,
+                tile_index,
+                cursor->row_room[x],
+                image->room_palette_index
+            );
+        } else {
+            dg_export_tile_to_rgba(map, tile_index, cursor->row_room[x], pixel);
+        }
+
+        for (repeat = 1; repeat < scale; ++repeat) {
+            memcpy(pixel + repeat * pixel_bytes, pixel, pixel_bytes);
+        }
     }
+}
 
-    *out_pixels = NULL;
-    *out_size = 0u;
-    if (map->width <= 0 || map->height <= 0 || map->tiles == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
+static int dg_export_zlib_strategy(dg_png_compression_strategy_t strategy)
+{
+    switch (strategy) {
+    case DG_PNG_COMPRESSION_STRATEGY_FILTERED:
+        return Z_FILTERED;
+    case DG_PNG_COMPRESSION_STRATEGY_HUFFMAN_ONLY:
+        return Z_HUFFMAN_ONLY;
+    case DG_PNG_COMPRESSION_STRATEGY_RLE:
+        return Z_RLE;
+    case DG_PNG_COMPRESSION_STRATEGY_FIXED:
+        return Z_FIXED;
+    case DG_PNG_COMPRESSION_STRATEGY_STANDARD:
+    case DG_PNG_COMPRESSION_STRATEGY_AUTO:
+    default:
+        return Z_DEFAULT_STRATEGY;
     }
+}
 
-    if (dg_mul_size_would_overflow((size_t)map->width, 4u, &row_bytes) ||
-        dg_mul_size_would_overflow((size_t)map->height, row_bytes, &pixel_size)) {
-        return DG_STATUS_INVALID_ARGUMENT;
+typedef struct dg_export_png_stream {
+    const dg_map_t *map;
+    const dg_export_png_image_t *image;
+    const dg_export_options_t *options;
+    dg_export_row_cursor_t *cursor;
+    unsigned char *row;
+} dg_export_png_stream_t;
+
+static void dg_export_png_write_data(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+    dg_io_writer_t *writer = (dg_io_writer_t *)png_get_io_ptr(png_ptr);
+
+    if (dg_write_exact(writer, data, (size_t)length) != DG_STATUS_OK) {
+        png_error(png_ptr, "dungeoneer: PNG sink write failed");
     }
+}
 
-    pixels = (unsigned char *)malloc(pixel_size);
-    if (pixels == NULL) {
-        return DG_STATUS_ALLOCATION_FAILED;
+static void dg_export_png_flush(png_structp png_ptr)
+{
+    (void)png_ptr;
+}
+
+static void dg_export_stream_png_rows(
+    png_structp png_ptr,
+    png_infop info_ptr,
+    dg_export_png_stream_t *stream
+)
+{
+    const dg_map_t *map = stream->map;
+    int y;
+    int repeat;
+
+    png_set_IHDR(
+        png_ptr,
+        info_ptr,
+        (png_uint_32)map->width * (png_uint_32)stream->image->pixels_per_tile,
+        (png_uint_32)map->height * (png_uint_32)stream->image->pixels_per_tile,
+        8,
+        stream->image->color_type,
+        PNG_INTERLACE_NONE,
+        PNG_COMPRESSION_TYPE_BASE,
+        PNG_FILTER_TYPE_BASE
+    );
+    if (stream->image->color_type == PNG_COLOR_TYPE_PALETTE) {
+        png_set_PLTE(png_ptr, info_ptr, stream->image->palette, stream->image->palette_count);
+        /* Only the void entry is translucent, and tRNS covers a prefix. */
+        png_set_tRNS(png_ptr, info_ptr, stream->image->palette_alpha, 1, NULL);
     }
+    png_write_info(png_ptr, info_ptr);
 
     for (y = 0; y < map->height; ++y) {
-        for (x = 0; x < map->width; ++x) {
-            size_t tile_index = (size_t)y * (size_t)map->width + (size_t)x;
-            size_t pixel_offset = tile_index * 4u;
-            unsigned char rgba[4];
-
-            dg_export_tile_to_rgba(map, tile_index, room_index_by_tile, rgba);
-            pixels[pixel_offset + 0u] = rgba[0];
-            pixels[pixel_offset + 1u] = rgba[1];
-            pixels[pixel_offset + 2u] = rgba[2];
-            pixels[pixel_offset + 3u] = rgba[3];
+        dg_export_row_cursor_advance(stream->cursor, y);
+        dg_export_build_png_row(map, stream->image, stream->cursor, y, stream->row);
+        for (repeat = 0; repeat < stream->image->pixels_per_tile; ++repeat) {
+            png_write_row(png_ptr, stream->row);
         }
     }
 
-    *out_pixels = pixels;
-    *out_size = pixel_size;
+    png_write_end(png_ptr, info_ptr);
+}
+
+/* Kept separate so no caller locals are live across the libpng longjmp. */
+static dg_status_t dg_export_encode_png(
+    png_structp png_ptr,
+    png_infop info_ptr,
+    dg_io_writer_t *writer,
+    dg_export_png_stream_t *stream
+)
+{
+    if (setjmp(png_jmpbuf(png_ptr)) != 0) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    png_set_write_fn(png_ptr, writer, dg_export_png_write_data, dg_export_png_flush);
+    if (stream->options->png_compression_level != DG_PNG_COMPRESSION_LEVEL_DEFAULT) {
+        png_set_compression_level(png_ptr, stream->options->png_compression_level);
+    }
+    if (stream->options->png_compression_strategy != DG_PNG_COMPRESSION_STRATEGY_AUTO) {
+        png_set_compression_strategy(
+            png_ptr,
+            dg_export_zlib_strategy(stream->options->png_compression_strategy)
+        );
+    }
+    dg_export_stream_png_rows(png_ptr, info_ptr, stream);
     return DG_STATUS_OK;
 }
 
-static dg_status_t dg_export_write_png_file(
+/*
+ * Streams the PNG one scanline at a time, so memory stays proportional to
+ * the image width rather than its area.
+ */
+static dg_status_t dg_export_write_png(
+    dg_io_writer_t *writer,
     const dg_map_t *map,
-    const char *png_path,
-    const int *room_index_by_tile
+    const dg_export_room_type_palette_entry_t *palette_entries,
+    size_t palette_count,
+    const dg_export_options_t *options
 )
 {
-    FILE *file;
     png_structp png_ptr;
     png_infop info_ptr;
-    png_bytep *rows;
-    unsigned char *pixels;
+    dg_export_png_image_t image;
+    dg_export_row_cursor_t cursor;
+    dg_export_png_stream_t stream;
+    unsigned char *row;
+    size_t row_pixels;
     size_t row_bytes;
-    size_t pixel_size;
     dg_status_t status;
-    int y;
 
-    if (map == NULL || png_path == NULL) {
+    if (writer == NULL || map == NULL || options == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
     if (map->width <= 0 || map->height <= 0 || map->tiles == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
-    if (map->width > INT32_MAX || map->height > INT32_MAX) {
+    if (map->width > INT32_MAX / options->png_pixels_per_tile ||
+        map->height > INT32_MAX / options->png_pixels_per_tile) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    row_pixels = (size_t)map->width * (size_t)options->png_pixels_per_tile;
+    if (dg_mul_size_would_overflow(row_pixels, 4u, &row_bytes)) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    status = dg_export_build_png_pixels(map, room_index_by_tile, &pixels, &pixel_size);
+    status = dg_export_prepare_png_image(map, palette_entries, palette_count, options, &image);
     if (status != DG_STATUS_OK) {
+        free(image.room_palette_index);
         return status;
     }
+    row_bytes = row_pixels * image.bytes_per_pixel;
 
-    if (dg_mul_size_would_overflow((size_t)map->width, 4u, &row_bytes)) {
-        free(pixels);
-        return DG_STATUS_INVALID_ARGUMENT;
-    }
-    {
-        size_t expected_size;
-        if (dg_mul_size_would_overflow((size_t)map->height, row_bytes, &expected_size) ||
-            expected_size != pixel_size) {
-            free(pixels);
-            return DG_STATUS_INVALID_ARGUMENT;
-        }
+    status = dg_export_row_cursor_init(&cursor, map);
+    if (status != DG_STATUS_OK) {
+        free(image.room_palette_index);
+        return status;
     }
 
-    rows = (png_bytep *)malloc((size_t)map->height * sizeof(*rows));
-    if (rows == NULL) {
-        free(pixels);
+    row = (unsigned char *)malloc(row_bytes);
+    if (row == NULL) {
+        dg_export_row_cursor_destroy(&cursor);
+        free(image.room_palette_index);
         return DG_STATUS_ALLOCATION_FAILED;
     }
-    for (y = 0; y < map->height; ++y) {
-        rows[y] = (png_bytep)(pixels + ((size_t)y * row_bytes));
-    }
-
-    file = fopen(png_path, "wb");
-    if (file == NULL) {
-        free(rows);
-        free(pixels);
-        return DG_STATUS_IO_ERROR;
-    }
 
     png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (png_ptr == NULL) {
-        (void)fclose(file);
-        free(rows);
-        free(pixels);
-        return DG_STATUS_IO_ERROR;
-    }
-
-    info_ptr = png_create_info_struct(png_ptr);
+    info_ptr = (png_ptr != NULL) ? png_create_info_struct(png_ptr) : NULL;
     if (info_ptr == NULL) {
         png_destroy_write_struct(&png_ptr, NULL);
-        (void)fclose(file);
-        free(rows);
-        free(pixels);
+        free(row);
+        dg_export_row_cursor_destroy(&cursor);
+        free(image.room_palette_index);
         return DG_STATUS_IO_ERROR;
     }
 
-    status = DG_STATUS_OK;
-    if (setjmp(png_jmpbuf(png_ptr)) != 0) {
-        status = DG_STATUS_IO_ERROR;
-    } else {
-        png_init_io(png_ptr, file);
-        png_set_IHDR(
-            png_ptr,
-            info_ptr,
-            (png_uint_32)map->width,
-            (png_uint_32)map->height,
-            8,
-            PNG_COLOR_TYPE_RGBA,
-            PNG_INTERLACE_NONE,
-            PNG_COMPRESSION_TYPE_BASE,
-            PNG_FILTER_TYPE_BASE
-        );
-        png_set_rows(png_ptr, info_ptr, rows);
-        png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
-    }
+    stream.map = map;
+    stream.image = &image;
+    stream.options = options;
+    stream.cursor = &cursor;
+    stream.row = row;
+    status = dg_export_encode_png(png_ptr, info_ptr, writer, &stream);
 
     png_destroy_write_struct(&png_ptr, &info_ptr);
-    free(rows);
-    free(pixels);
-    if (fclose(file) != 0 && status == DG_STATUS_OK) {
-        return DG_STATUS_IO_ERROR;
-    }
-
+    free(row);
+    dg_export_row_cursor_destroy(&cursor);
+    free(image.room_palette_index);
     return status;
 }
 
@@ -550,515 +842,598 @@ static const char *dg_export_edge_opening_role_name(dg_map_edge_opening_role_t r
     }
 }
 
-static dg_status_t dg_export_json_write_escaped(FILE *file, const char *value)
+/*
+ * Buffered JSON emitter. Output is staged in a fixed block and handed to the
+ * sink in large writes; integers are formatted by hand instead of through
+ * printf. Separators and indentation are derived from the nesting state, so
+ * pretty and compact output share one code path. The first failure sticks
+ * in `status` and later calls become no-ops.
+ */
+#define DG_EXPORT_JSON_BUFFER_SIZE 4096u
+#define DG_EXPORT_JSON_MAX_DEPTH 8
+
+typedef struct dg_export_json {
+    dg_io_writer_t *sink;
+    char buffer[DG_EXPORT_JSON_BUFFER_SIZE];
+    size_t used;
+    dg_status_t status;
+    bool compact;
+    int depth;
+    bool has_items[DG_EXPORT_JSON_MAX_DEPTH];
+} dg_export_json_t;
+
+static void dg_export_json_init(dg_export_json_t *json, dg_io_writer_t *sink, bool compact)
 {
-    const unsigned char *cursor;
+    json->sink = sink;
+    json->used = 0u;
+    json->status = DG_STATUS_OK;
+    json->compact = compact;
+    json->depth = 0;
+    json->has_items[0] = false;
+}
 
-    if (file == NULL || value == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
+static void dg_export_json_flush(dg_export_json_t *json)
+{
+    if (json->status == DG_STATUS_OK && json->used > 0u) {
+        json->status = dg_write_exact(json->sink, json->buffer, json->used);
     }
+    json->used = 0u;
+}
 
-    if (fputc('\"', file) == EOF) {
-        return DG_STATUS_IO_ERROR;
+static void dg_export_json_raw(dg_export_json_t *json, const char *data, size_t length)
+{
+    if (json->status != DG_STATUS_OK) {
+        return;
     }
 
-    cursor = (const unsigned char *)value;
-    while (*cursor != '\0') {
-        if (*cursor == '\"' || *cursor == '\\') {
-            if (fputc('\\', file) == EOF || fputc((int)*cursor, file) == EOF) {
-                return DG_STATUS_IO_ERROR;
-            }
-        } else if (*cursor < 0x20u) {
-            if (fprintf(file, "\\u%04x", (unsigned int)*cursor) < 0) {
-                return DG_STATUS_IO_ERROR;
+    if (length > DG_EXPORT_JSON_BUFFER_SIZE - json->used) {
+        dg_export_json_flush(json);
+        if (length > DG_EXPORT_JSON_BUFFER_SIZE) {
+            if (json->status == DG_STATUS_OK) {
+                json->status = dg_write_exact(json->sink, data, length);
             }
-        } else {
-            if (fputc((int)*cursor, file) == EOF) {
-                return DG_STATUS_IO_ERROR;
+            return;
+        }
+    }
+
+    memcpy(json->buffer + json->used, data, length);
+    json->used += length;
+}
+
+static void dg_export_json_char(dg_export_json_t *json, char c)
+{
+    if (json->used == DG_EXPORT_JSON_BUFFER_SIZE) {
+        dg_export_json_flush(json);
+    }
+    if (json->status == DG_STATUS_OK) {
+        json->buffer[json->used] = c;
+        json->used += 1u;
+    }
+}
+
+static void dg_export_json_text(dg_export_json_t *json, const char *text)
+{
+    dg_export_json_raw(json, text, strlen(text));
+}
+
+static void dg_export_json_uint_digits(dg_export_json_t *json, unsigned long long value)
+{
+    char digits[24];
+    size_t start = sizeof(digits);
+
+    do {
+        start -= 1u;
+        digits[start] = (char)('0' + (int)(value % 10u));
+        value /= 10u;
+    } while (value != 0u);
+
+    dg_export_json_raw(json, digits + start, sizeof(digits) - start);
+}
+
+static void dg_export_json_int_digits(dg_export_json_t *json, long long value)
+{
+    if (value < 0) {
+        dg_export_json_char(json, '-');
+        dg_export_json_uint_digits(json, 0ull - (unsigned long long)value);
+        return;
+    }
+    dg_export_json_uint_digits(json, (unsigned long long)value);
+}
+
+static void dg_export_json_escaped(dg_export_json_t *json, const char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char *cursor = (const unsigned char *)value;
+    const unsigned char *run = cursor;
+
+    dg_export_json_char(json, '\"');
+    while (*cursor != '\0') {
+        if (*cursor == '\"' || *cursor == '\\' || *cursor < 0x20u) {
+            char escape[6];
+
+            dg_export_json_raw(json, (const char *)run, (size_t)(cursor - run));
+            if (*cursor < 0x20u) {
+                escape[0] = '\\';
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[*cursor >> 4];
+                escape[5] = hex[*cursor & 0x0fu];
+                dg_export_json_raw(json, escape, sizeof(escape));
+            } else {
+                escape[0] = '\\';
+                escape[1] = (char)*cursor;
+                dg_export_json_raw(json, escape, 2u);
             }
+            run = cursor + 1;
         }
         cursor += 1;
     }
+    dg_export_json_raw(json, (const char *)run, (size_t)(cursor - run));
+    dg_export_json_char(json, '\"');
+}
 
-    if (fputc('\"', file) == EOF) {
-        return DG_STATUS_IO_ERROR;
+static void dg_export_json_newline(dg_export_json_t *json)
+{
+    static const char spaces[] = "                ";
+    size_t indent;
+
+    if (json->compact) {
+        return;
     }
 
-    return DG_STATUS_OK;
+    dg_export_json_char(json, '\n');
+    indent = (size_t)json->depth * 2u;
+    dg_export_json_raw(json, spaces, indent);
 }
 
-static dg_status_t dg_export_write_json_generation_request(
-    FILE *file,
-    const dg_generation_request_snapshot_t *snapshot
+/* Emits the separator, indentation and key (if any) for the next value. */
+static void dg_export_json_item(dg_export_json_t *json, const char *key)
+{
+    if (json->has_items[json->depth]) {
+        dg_export_json_char(json, ',');
+    }
+    json->has_items[json->depth] = true;
+    dg_export_json_newline(json);
+
+    if (key != NULL) {
+        dg_export_json_escaped(json, key);
+        dg_export_json_raw(json, ": ", json->compact ? 1u : 2u);
+    }
+}
+
+static void dg_export_json_open(dg_export_json_t *json, const char *key, char bracket)
+{
+    if (json->depth > 0 || json->has_items[0]) {
+        dg_export_json_item(json, key);
+    }
+    dg_export_json_char(json, bracket);
+
+    if (json->depth + 1 >= DG_EXPORT_JSON_MAX_DEPTH) {
+        if (json->status == DG_STATUS_OK) {
+            json->status = DG_STATUS_INVALID_ARGUMENT;
+        }
+        return;
+    }
+    json->depth += 1;
+    json->has_items[json->depth] = false;
+}
+
+static void dg_export_json_close(dg_export_json_t *json, char bracket)
+{
+    if (json->depth > 0) {
+        json->depth -= 1;
+    }
+    dg_export_json_newline(json);
+    dg_export_json_char(json, bracket);
+}
+
+static void dg_export_json_begin_object(dg_export_json_t *json, const char *key)
+{
+    dg_export_json_open(json, key, '{');
+}
+
+static void dg_export_json_end_object(dg_export_json_t *json)
+{
+    dg_export_json_close(json, '}');
+}
+
+static void dg_export_json_begin_array(dg_export_json_t *json, const char *key)
+{
+    dg_export_json_open(json, key, '[');
+}
+
+static void dg_export_json_end_array(dg_export_json_t *json)
+{
+    dg_export_json_close(json, ']');
+}
+
+static void dg_export_json_int(dg_export_json_t *json, const char *key, long long value)
+{
+    dg_export_json_item(json, key);
+    dg_export_json_int_digits(json, value);
+}
+
+static void dg_export_json_uint(dg_export_json_t *json, const char *key, unsigned long long value)
+{
+    dg_export_json_item(json, key);
+    dg_export_json_uint_digits(json, value);
+}
+
+static void dg_export_json_string(dg_export_json_t *json, const char *key, const char *value)
+{
+    dg_export_json_item(json, key);
+    dg_export_json_escaped(json, value);
+}
+
+/* `value` is emitted verbatim (true, false, null). */
+static void dg_export_json_literal(dg_export_json_t *json, const char *key, const char *value)
+{
+    dg_export_json_item(json, key);
+    dg_export_json_text(json, value);
+}
+
+/* Colors stay on one line even in pretty mode. */
+static void dg_export_json_rgba(
+    dg_export_json_t *json,
+    const char *key,
+    const unsigned char rgba[4]
 )
 {
     size_t i;
 
-    if (file == NULL || snapshot == NULL) {
-        return DG_STATUS_INVALID_ARGUMENT;
+    dg_export_json_item(json, key);
+    dg_export_json_char(json, '[');
+    for (i = 0; i < 4u; ++i) {
+        if (i > 0u) {
+            dg_export_json_raw(json, ", ", json->compact ? 1u : 2u);
+        }
+        dg_export_json_uint_digits(json, rgba[i]);
     }
+    dg_export_json_char(json, ']');
+}
 
-    if (snapshot->present == 0) {
-        if (fprintf(file, "null") < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
-        return DG_STATUS_OK;
+static dg_status_t dg_export_json_finish(dg_export_json_t *json)
+{
+    if (!json->compact) {
+        dg_export_json_char(json, '\n');
     }
+    dg_export_json_flush(json);
+    return json->status;
+}
 
-    if (fprintf(file, "{\n") < 0 ||
-        fprintf(file, "    \"width\": %d,\n", snapshot->width) < 0 ||
-        fprintf(file, "    \"height\": %d,\n", snapshot->height) < 0 ||
-        fprintf(file, "    \"seed\": %llu,\n", (unsigned long long)snapshot->seed) < 0 ||
-        fprintf(file, "    \"algorithm_id\": %d,\n", snapshot->algorithm_id) < 0 ||
-        fprintf(
-            file,
-            "    \"algorithm\": \"%s\",\n",
-            dg_export_algorithm_name(snapshot->algorithm_id)
-        ) < 0 ||
-        fprintf(file, "    \"params\": {\n") < 0) {
-        return DG_STATUS_IO_ERROR;
+static void dg_export_write_json_generation_request(
+    dg_export_json_t *json,
+    const dg_generation_request_snapshot_t *snapshot
+)
+{
+    size_t i;
+
+    if (snapshot->present == 0) {
+        dg_export_json_literal(json, "generation_request", "null");
+        return;
     }
 
+    dg_export_json_begin_object(json, "generation_request");
+    dg_export_json_int(json, "width", snapshot->width);
+    dg_export_json_int(json, "height", snapshot->height);
+    dg_export_json_uint(json, "seed", (unsigned long long)snapshot->seed);
+    dg_export_json_int(json, "algorithm_id", snapshot->algorithm_id);
+    dg_export_json_string(json, "algorithm", dg_export_algorithm_name(snapshot->algorithm_id));
+
+    dg_export_json_begin_object(json, "params");
     switch ((dg_algorithm_t)snapshot->algorithm_id) {
     case DG_ALGORITHM_BSP_TREE:
-        if (fprintf(file, "      \"min_rooms\": %d,\n", snapshot->params.bsp.min_rooms) < 0 ||
-            fprintf(file, "      \"max_rooms\": %d,\n", snapshot->params.bsp.max_rooms) < 0 ||
-            fprintf(file, "      \"room_min_size\": %d,\n", snapshot->params.bsp.room_min_size) < 0 ||
-            fprintf(file, "      \"room_max_size\": %d\n", snapshot->params.bsp.room_max_size) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(json, "min_rooms", snapshot->params.bsp.min_rooms);
+        dg_export_json_int(json, "max_rooms", snapshot->params.bsp.max_rooms);
+        dg_export_json_int(json, "room_min_size", snapshot->params.bsp.room_min_size);
+        dg_export_json_int(json, "room_max_size", snapshot->params.bsp.room_max_size);
         break;
     case DG_ALGORITHM_DRUNKARDS_WALK:
-        if (fprintf(
-                file,
-                "      \"wiggle_percent\": %d\n",
-                snapshot->params.drunkards_walk.wiggle_percent
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(json, "wiggle_percent", snapshot->params.drunkards_walk.wiggle_percent);
         break;
     case DG_ALGORITHM_CELLULAR_AUTOMATA:
-        if (fprintf(
-                file,
-                "      \"initial_wall_percent\": %d,\n",
-                snapshot->params.cellular_automata.initial_wall_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"simulation_steps\": %d,\n",
-                snapshot->params.cellular_automata.simulation_steps
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"wall_threshold\": %d\n",
-                snapshot->params.cellular_automata.wall_threshold
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(
+            json,
+            "initial_wall_percent",
+            snapshot->params.cellular_automata.initial_wall_percent
+        );
+        dg_export_json_int(
+            json,
+            "simulation_steps",
+            snapshot->params.cellular_automata.simulation_steps
+        );
+        dg_export_json_int(
+            json,
+            "wall_threshold",
+            snapshot->params.cellular_automata.wall_threshold
+        );
         break;
     case DG_ALGORITHM_VALUE_NOISE:
-        if (fprintf(
-                file,
-                "      \"feature_size\": %d,\n",
-                snapshot->params.value_noise.feature_size
-            ) < 0 ||
-            fprintf(file, "      \"octaves\": %d,\n", snapshot->params.value_noise.octaves) < 0 ||
-            fprintf(
-                file,
-                "      \"persistence_percent\": %d,\n",
-                snapshot->params.value_noise.persistence_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"floor_threshold_percent\": %d\n",
-                snapshot->params.value_noise.floor_threshold_percent
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(json, "feature_size", snapshot->params.value_noise.feature_size);
+        dg_export_json_int(json, "octaves", snapshot->params.value_noise.octaves);
+        dg_export_json_int(
+            json,
+            "persistence_percent",
+            snapshot->params.value_noise.persistence_percent
+        );
+        dg_export_json_int(
+            json,
+            "floor_threshold_percent",
+            snapshot->params.value_noise.floor_threshold_percent
+        );
         break;
     case DG_ALGORITHM_ROOMS_AND_MAZES:
-        if (fprintf(
-                file,
-                "      \"min_rooms\": %d,\n",
-                snapshot->params.rooms_and_mazes.min_rooms
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"max_rooms\": %d,\n",
-                snapshot->params.rooms_and_mazes.max_rooms
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"room_min_size\": %d,\n",
-                snapshot->params.rooms_and_mazes.room_min_size
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"room_max_size\": %d,\n",
-                snapshot->params.rooms_and_mazes.room_max_size
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"maze_wiggle_percent\": %d,\n",
-                snapshot->params.rooms_and_mazes.maze_wiggle_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"min_room_connections\": %d,\n",
-                snapshot->params.rooms_and_mazes.min_room_connections
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"max_room_connections\": %d,\n",
-                snapshot->params.rooms_and_mazes.max_room_connections
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"ensure_full_connectivity\": %d,\n",
-                snapshot->params.rooms_and_mazes.ensure_full_connectivity
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"dead_end_prune_steps\": %d\n",
-                snapshot->params.rooms_and_mazes.dead_end_prune_steps
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(json, "min_rooms", snapshot->params.rooms_and_mazes.min_rooms);
+        dg_export_json_int(json, "max_rooms", snapshot->params.rooms_and_mazes.max_rooms);
+        dg_export_json_int(json, "room_min_size", snapshot->params.rooms_and_mazes.room_min_size);
+        dg_export_json_int(json, "room_max_size", snapshot->params.rooms_and_mazes.room_max_size);
+        dg_export_json_int(
+            json,
+            "maze_wiggle_percent",
+            snapshot->params.rooms_and_mazes.maze_wiggle_percent
+        );
+        dg_export_json_int(
+            json,
+            "min_room_connections",
+            snapshot->params.rooms_and_mazes.min_room_connections
+        );
+        dg_export_json_int(
+            json,
+            "max_room_connections",
+            snapshot->params.rooms_and_mazes.max_room_connections
+        );
+        dg_export_json_int(
+            json,
+            "ensure_full_connectivity",
+            snapshot->params.rooms_and_mazes.ensure_full_connectivity
+        );
+        dg_export_json_int(
+            json,
+            "dead_end_prune_steps",
+            snapshot->params.rooms_and_mazes.dead_end_prune_steps
+        );
         break;
     case DG_ALGORITHM_ROOM_GRAPH:
-        if (fprintf(
-                file,
-                "      \"min_rooms\": %d,\n",
-                snapshot->params.room_graph.min_rooms
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"max_rooms\": %d,\n",
-                snapshot->params.room_graph.max_rooms
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"room_min_size\": %d,\n",
-                snapshot->params.room_graph.room_min_size
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"room_max_size\": %d,\n",
-                snapshot->params.room_graph.room_max_size
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"neighbor_candidates\": %d,\n",
-                snapshot->params.room_graph.neighbor_candidates
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"extra_connection_chance_percent\": %d\n",
-                snapshot->params.room_graph.extra_connection_chance_percent
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(json, "min_rooms", snapshot->params.room_graph.min_rooms);
+        dg_export_json_int(json, "max_rooms", snapshot->params.room_graph.max_rooms);
+        dg_export_json_int(json, "room_min_size", snapshot->params.room_graph.room_min_size);
+        dg_export_json_int(json, "room_max_size", snapshot->params.room_graph.room_max_size);
+        dg_export_json_int(
+            json,
+            "neighbor_candidates",
+            snapshot->params.room_graph.neighbor_candidates
+        );
+        dg_export_json_int(
+            json,
+            "extra_connection_chance_percent",
+            snapshot->params.room_graph.extra_connection_chance_percent
+        );
         break;
     case DG_ALGORITHM_WORM_CAVES:
-        if (fprintf(
-                file,
-                "      \"worm_count\": %d,\n",
-                snapshot->params.worm_caves.worm_count
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"wiggle_percent\": %d,\n",
-                snapshot->params.worm_caves.wiggle_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"branch_chance_percent\": %d,\n",
-                snapshot->params.worm_caves.branch_chance_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"target_floor_percent\": %d,\n",
-                snapshot->params.worm_caves.target_floor_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"brush_radius\": %d,\n",
-                snapshot->params.worm_caves.brush_radius
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"max_steps_per_worm\": %d,\n",
-                snapshot->params.worm_caves.max_steps_per_worm
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"ensure_connected\": %d\n",
-                snapshot->params.worm_caves.ensure_connected
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(json, "worm_count", snapshot->params.worm_caves.worm_count);
+        dg_export_json_int(json, "wiggle_percent", snapshot->params.worm_caves.wiggle_percent);
+        dg_export_json_int(
+            json,
+            "branch_chance_percent",
+            snapshot->params.worm_caves.branch_chance_percent
+        );
+        dg_export_json_int(
+            json,
+            "target_floor_percent",
+            snapshot->params.worm_caves.target_floor_percent
+        );
+        dg_export_json_int(json, "brush_radius", snapshot->params.worm_caves.brush_radius);
+        dg_export_json_int(
+            json,
+            "max_steps_per_worm",
+            snapshot->params.worm_caves.max_steps_per_worm
+        );
+        dg_export_json_int(json, "ensure_connected", snapshot->params.worm_caves.ensure_connected);
         break;
     case DG_ALGORITHM_SIMPLEX_NOISE:
-        if (fprintf(
-                file,
-                "      \"feature_size\": %d,\n",
-                snapshot->params.simplex_noise.feature_size
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"octaves\": %d,\n",
-                snapshot->params.simplex_noise.octaves
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"persistence_percent\": %d,\n",
-                snapshot->params.simplex_noise.persistence_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"floor_threshold_percent\": %d,\n",
-                snapshot->params.simplex_noise.floor_threshold_percent
-            ) < 0 ||
-            fprintf(
-                file,
-                "      \"ensure_connected\": %d\n",
-                snapshot->params.simplex_noise.ensure_connected
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
+        dg_export_json_int(json, "feature_size", snapshot->params.simplex_noise.feature_size);
+        dg_export_json_int(json, "octaves", snapshot->params.simplex_noise.octaves);
+        dg_export_json_int(
+            json,
+            "persistence_percent",
+            snapshot->params.simplex_noise.persistence_percent
+        );
+        dg_export_json_int(
+            json,
+            "floor_threshold_percent",
+            snapshot->params.simplex_noise.floor_threshold_percent
+        );
+        dg_export_json_int(
+            json,
+            "ensure_connected",
+            snapshot->params.simplex_noise.ensure_connected
+        );
         break;
     default:
-        return DG_STATUS_IO_ERROR;
-    }
-
-    if (fprintf(file, "    },\n") < 0 ||
-        fprintf(file, "    \"edge_openings\": [\n") < 0) {
-        return DG_STATUS_IO_ERROR;
+        json->status = DG_STATUS_IO_ERROR;
+        return;
     }
+    dg_export_json_end_object(json);
 
+    dg_export_json_begin_array(json, "edge_openings");
     for (i = 0; i < snapshot->edge_openings.opening_count; ++i) {
         const dg_snapshot_edge_opening_spec_t *opening = &snapshot->edge_openings.openings[i];
-        const char *comma = (i + 1u < snapshot->edge_openings.opening_count) ? "," : "";
-
-        if (fprintf(
-                file,
-                "      {\n"
-                "        \"side\": %d,\n"
-                "        \"side_name\": \"%s\",\n"
-                "        \"start\": %d,\n"
-                "        \"end\": %d,\n"
-                "        \"role\": %d,\n"
-                "        \"role_name\": \"%s\"\n"
-                "      }%s\n",
-                opening->side,
-                dg_export_edge_side_name((dg_map_edge_side_t)opening->side),
-                opening->start,
-                opening->end,
-                opening->role,
-                dg_export_edge_opening_role_name((dg_map_edge_opening_role_t)opening->role),
-                comma
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
-    }
 
-    if (fprintf(file, "    ],\n") < 0 ||
-        fprintf(file, "    \"post_process_enabled\": %d,\n", snapshot->process.enabled) < 0 ||
-        fprintf(file, "    \"process\": [\n") < 0) {
-        return DG_STATUS_IO_ERROR;
+        dg_export_json_begin_object(json, NULL);
+        dg_export_json_int(json, "side", opening->side);
+        dg_export_json_string(
+            json,
+            "side_name",
+            dg_export_edge_side_name((dg_map_edge_side_t)opening->side)
+        );
+        dg_export_json_int(json, "start", opening->start);
+        dg_export_json_int(json, "end", opening->end);
+        dg_export_json_int(json, "role", opening->role);
+        dg_export_json_string(
+            json,
+            "role_name",
+            dg_export_edge_opening_role_name((dg_map_edge_opening_role_t)opening->role)
+        );
+        dg_export_json_end_object(json);
     }
+    dg_export_json_end_array(json);
 
+    dg_export_json_int(json, "post_process_enabled", snapshot->process.enabled);
+    dg_export_json_begin_array(json, "process");
     for (i = 0; i < snapshot->process.method_count; ++i) {
         const dg_snapshot_process_method_t *method = &snapshot->process.methods[i];
-        const char *comma = (i + 1u < snapshot->process.method_count) ? "," : "";
-
-        if (fprintf(file, "      {\n") < 0 ||
-            fprintf(file, "        \"type\": %d,\n", method->type) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
 
+        dg_export_json_begin_object(json, NULL);
+        dg_export_json_int(json, "type", method->type);
         switch ((dg_process_method_type_t)method->type) {
         case DG_PROCESS_METHOD_SCALE:
-            if (fprintf(
-                    file,
-                    "        \"type_name\": \"scale\",\n"
-                    "        \"factor\": %d\n",
-                    method->params.scale.factor
-                ) < 0) {
-                return DG_STATUS_IO_ERROR;
-            }
+            dg_export_json_string(json, "type_name", "scale");
+            dg_export_json_int(json, "factor", method->params.scale.factor);
             break;
         case DG_PROCESS_METHOD_PATH_SMOOTH:
-            if (fprintf(
-                    file,
-                    "        \"type_name\": \"path_smooth\",\n"
-                    "        \"strength\": %d,\n"
-                    "        \"inner_enabled\": %d,\n"
-                    "        \"outer_enabled\": %d\n",
-                    method->params.path_smooth.strength,
-                    method->params.path_smooth.inner_enabled,
-                    method->params.path_smooth.outer_enabled
-                ) < 0) {
-                return DG_STATUS_IO_ERROR;
-            }
+            dg_export_json_string(json, "type_name", "path_smooth");
+            dg_export_json_int(json, "strength", method->params.path_smooth.strength);
+            dg_export_json_int(json, "inner_enabled", method->params.path_smooth.inner_enabled);
+            dg_export_json_int(json, "outer_enabled", method->params.path_smooth.outer_enabled);
             break;
         case DG_PROCESS_METHOD_CORRIDOR_ROUGHEN:
-            if (fprintf(
-                    file,
-                    "        \"type_name\": \"corridor_roughen\",\n"
-                    "        \"strength\": %d,\n"
-                    "        \"max_depth\": %d,\n"
-                    "        \"mode\": %d,\n"
-                    "        \"mode_name\": \"%s\"\n",
-                    method->params.corridor_roughen.strength,
-                    method->params.corridor_roughen.max_depth,
-                    method->params.corridor_roughen.mode,
-                    method->params.corridor_roughen.mode == (int)DG_CORRIDOR_ROUGHEN_ORGANIC ?
-                        "organic" :
-                        "uniform"
-                ) < 0) {
-                return DG_STATUS_IO_ERROR;
-            }
+            dg_export_json_string(json, "type_name", "corridor_roughen");
+            dg_export_json_int(json, "strength", method->params.corridor_roughen.strength);
+            dg_export_json_int(json, "max_depth", method->params.corridor_roughen.max_depth);
+            dg_export_json_int(json, "mode", method->params.corridor_roughen.mode);
+            dg_export_json_string(
+                json,
+                "mode_name",
+                method->params.corridor_roughen.mode == (int)DG_CORRIDOR_ROUGHEN_ORGANIC ?
+                    "organic" :
+                    "uniform"
+            );
             break;
         default:
-            return DG_STATUS_IO_ERROR;
-        }
-
-        if (fprintf(file, "      }%s\n", comma) < 0) {
-            return DG_STATUS_IO_ERROR;
+            json->status = DG_STATUS_IO_ERROR;
+            return;
         }
+        dg_export_json_end_object(json);
     }
+    dg_export_json_end_array(json);
 
-    if (fprintf(file, "    ],\n") < 0 ||
-        fprintf(file, "    \"room_types\": {\n") < 0 ||
-        fprintf(
-            file,
-            "      \"policy\": {\n"
-            "        \"strict_mode\": %d,\n"
-            "        \"allow_untyped_rooms\": %d,\n"
-            "        \"default_type_id\": %u,\n"
-            "        \"untyped_template_map_path\": ",
-            snapshot->room_types.policy.strict_mode,
-            snapshot->room_types.policy.allow_untyped_rooms,
-            (unsigned int)snapshot->room_types.policy.default_type_id
-        ) < 0) {
-        return DG_STATUS_IO_ERROR;
-    }
-    if (dg_export_json_write_escaped(
-            file,
-            snapshot->room_types.policy.untyped_template_map_path
-        ) != DG_STATUS_OK) {
-        return DG_STATUS_IO_ERROR;
-    }
-    if (fprintf(file, "\n      },\n") < 0 ||
-        fprintf(file, "      \"definitions\": [\n") < 0) {
-        return DG_STATUS_IO_ERROR;
-    }
+    dg_export_json_begin_object(json, "room_types");
+    dg_export_json_begin_object(json, "policy");
+    dg_export_json_int(json, "strict_mode", snapshot->room_types.policy.strict_mode);
+    dg_export_json_int(
+        json,
+        "allow_untyped_rooms",
+        snapshot->room_types.policy.allow_untyped_rooms
+    );
+    dg_export_json_uint(json, "default_type_id", snapshot->room_types.policy.default_type_id);
+    dg_export_json_string(
+        json,
+        "untyped_template_map_path",
+        snapshot->room_types.policy.untyped_template_map_path
+    );
+    dg_export_json_end_object(json);
 
+    dg_export_json_begin_array(json, "definitions");
     for (i = 0; i < snapshot->room_types.definition_count; ++i) {
         const dg_snapshot_room_type_definition_t *definition = &snapshot->room_types.definitions[i];
-        const char *comma = (i + 1u < snapshot->room_types.definition_count) ? "," : "";
-
-        if (fprintf(
-                file,
-                "        {\n"
-                "          \"type_id\": %u,\n"
-                "          \"enabled\": %d,\n"
-                "          \"min_count\": %d,\n"
-                "          \"max_count\": %d,\n"
-                "          \"target_count\": %d,\n"
-                "          \"template_map_path\": ",
-                (unsigned int)definition->type_id,
-                definition->enabled,
-                definition->min_count,
-                definition->max_count,
-                definition->target_count
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
-        if (dg_export_json_write_escaped(file, definition->template_map_path) != DG_STATUS_OK) {
-            return DG_STATUS_IO_ERROR;
-        }
-        if (fprintf(
-                file,
-                ",\n"
-                "          \"template_opening_query\": {\n"
-                "            \"side_mask\": %u,\n"
-                "            \"role_mask\": %u,\n"
-                "            \"edge_coord_min\": %d,\n"
-                "            \"edge_coord_max\": %d,\n"
-                "            \"min_length\": %d,\n"
-                "            \"max_length\": %d,\n"
-                "            \"require_component\": %d\n"
-                "          },\n"
-                "          \"template_required_opening_matches\": %d,\n"
-                "          \"constraints\": {\n"
-                "            \"area_min\": %d,\n"
-                "            \"area_max\": %d,\n"
-                "            \"degree_min\": %d,\n"
-                "            \"degree_max\": %d,\n"
-                "            \"border_distance_min\": %d,\n"
-                "            \"border_distance_max\": %d,\n"
-                "            \"graph_depth_min\": %d,\n"
-                "            \"graph_depth_max\": %d\n"
-                "          },\n"
-                "          \"preferences\": {\n"
-                "            \"weight\": %d,\n"
-                "            \"larger_room_bias\": %d,\n"
-                "            \"higher_degree_bias\": %d,\n"
-                "            \"border_distance_bias\": %d\n"
-                "          }\n"
-                "        }%s\n",
-                definition->template_opening_query.side_mask,
-                definition->template_opening_query.role_mask,
-                definition->template_opening_query.edge_coord_min,
-                definition->template_opening_query.edge_coord_max,
-                definition->template_opening_query.min_length,
-                definition->template_opening_query.max_length,
-                definition->template_opening_query.require_component,
-                definition->template_required_opening_matches,
-                definition->constraints.area_min,
-                definition->constraints.area_max,
-                definition->constraints.degree_min,
-                definition->constraints.degree_max,
-                definition->constraints.border_distance_min,
-                definition->constraints.border_distance_max,
-                definition->constraints.graph_depth_min,
-                definition->constraints.graph_depth_max,
-                definition->preferences.weight,
-                definition->preferences.larger_room_bias,
-                definition->preferences.higher_degree_bias,
-                definition->preferences.border_distance_bias,
-                comma
-            ) < 0) {
-            return DG_STATUS_IO_ERROR;
-        }
-    }
 
-    if (fprintf(file, "      ]\n") < 0 ||
-        fprintf(file, "    }\n") < 0 ||
-        fprintf(file, "  }") < 0) {
-        return DG_STATUS_IO_ERROR;
+        dg_export_json_begin_object(json, NULL);
+        dg_export_json_uint(json, "type_id", definition->type_id);
+        dg_export_json_int(json, "enabled", definition->enabled);
+        dg_export_json_int(json, "min_count", definition->min_count);
+        dg_export_json_int(json, "max_count", definition->max_count);
+        dg_export_json_int(json, "target_count", definition->target_count);
+        dg_export_json_string(json, "template_map_path", definition->template_map_path);
+
+        dg_export_json_begin_object(json, "template_opening_query");
+        dg_export_json_uint(json, "side_mask", definition->template_opening_query.side_mask);
+        dg_export_json_uint(json, "role_mask", definition->template_opening_query.role_mask);
+        dg_export_json_int(
+            json,
+            "edge_coord_min",
+            definition->template_opening_query.edge_coord_min
+        );
+        dg_export_json_int(
+            json,
+            "edge_coord_max",
+            definition->template_opening_query.edge_coord_max
+        );
+        dg_export_json_int(json, "min_length", definition->template_opening_query.min_length);
+        dg_export_json_int(json, "max_length", definition->template_opening_query.max_length);
+        dg_export_json_int(
+            json,
+            "require_component",
+            definition->template_opening_query.require_component
+        );
+        dg_export_json_end_object(json);
+
+        dg_export_json_int(
+            json,
+            "template_required_opening_matches",
+            definition->template_required_opening_matches
+        );
+        dg_export_json_int(json, "template_variant_step", definition->template_variant_step);
+
+        dg_export_json_begin_object(json, "constraints");
+        dg_export_json_int(json, "area_min", definition->constraints.area_min);
+        dg_export_json_int(json, "area_max", definition->constraints.area_max);
+        dg_export_json_int(json, "degree_min", definition->constraints.degree_min);
+        dg_export_json_int(json, "degree_max", definition->constraints.degree_max);
+        dg_export_json_int(
+            json,
+            "border_distance_min",
+            definition->constraints.border_distance_min
+        );
+        dg_export_json_int(
+            json,
+            "border_distance_max",
+            definition->constraints.border_distance_max
+        );
+        dg_export_json_int(json, "graph_depth_min", definition->constraints.graph_depth_min);
+        dg_export_json_int(json, "graph_depth_max", definition->constraints.graph_depth_max);
+        dg_export_json_end_object(json);
+
+        dg_export_json_begin_object(json, "preferences");
+        dg_export_json_int(json, "weight", definition->preferences.weight);
+        dg_export_json_int(json, "larger_room_bias", definition->preferences.larger_room_bias);
+        dg_export_json_int(
+            json,
+            "higher_degree_bias",
+            definition->preferences.higher_degree_bias
+        );
+        dg_export_json_int(
+            json,
+            "border_distance_bias",
+            definition->preferences.border_distance_bias
+        );
+        dg_export_json_end_object(json);
+
+        dg_export_json_end_object(json);
     }
+    dg_export_json_end_array(json);
+    dg_export_json_end_object(json);
 
-    return DG_STATUS_OK;
+    dg_export_json_end_object(json);
 }
 
-static dg_status_t dg_export_write_json_file(
+static dg_status_t dg_export_write_json(
+    dg_io_writer_t *writer,
     const dg_map_t *map,
     const char *png_path,
-    const char *json_path,
     const dg_export_room_type_palette_entry_t *palette_entries,
-    size_t palette_count
+    size_t palette_count,
+    const dg_export_options_t *options
 )
 {
-    FILE *file;
-    dg_status_t status;
+    dg_export_json_t json;
     size_t i;
     const dg_generation_request_snapshot_t *snapshot;
+    const dg_map_metadata_t *metadata;
     size_t configured_type_count;
+    uint32_t omit_mask;
 
-    if (map == NULL || png_path == NULL || json_path == NULL) {
+    if (writer == NULL || map == NULL || png_path == NULL || options == NULL) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
     if (map->tiles == NULL || map->width <= 0 || map->height <= 0) {
@@ -1074,411 +1449,436 @@ static dg_status_t dg_export_write_json_file(
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    snapshot = &map->metadata.generation_request;
+    metadata = &map->metadata;
+    snapshot = &metadata->generation_request;
     configured_type_count = snapshot->present == 1 ? snapshot->room_types.definition_count : 0u;
     if (configured_type_count > 0u && snapshot->room_types.definitions == NULL) {
         return DG_STATUS_IO_ERROR;
     }
+    omit_mask = options->json_omit_mask;
 
-    file = fopen(json_path, "wb");
-    if (file == NULL) {
-        return DG_STATUS_IO_ERROR;
-    }
-
-    if (fprintf(
-            file,
-            "{\n"
-            "  \"format\": \"dungeoneer_png_json_v1\",\n"
-            "  \"image\": {\n"
-            "    \"path\": "
-        ) < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
-    }
-
-    status = dg_export_json_write_escaped(file, png_path);
-    if (status != DG_STATUS_OK) {
-        (void)fclose(file);
-        return status;
-    }
+    dg_export_json_init(&json, writer, options->json_compact != 0);
+    dg_export_json_begin_object(&json, NULL);
+    dg_export_json_string(&json, "format", "dungeoneer_png_json_v1");
 
-    if (fprintf(
-            file,
-            ",\n"
-            "    \"width\": %d,\n"
-            "    \"height\": %d,\n"
-            "    \"pixel_format\": \"rgba8\"\n"
-            "  },\n"
-            "  \"legend\": [\n",
-            map->width,
-            map->height
-        ) < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
-    }
+    dg_export_json_begin_object(&json, "image");
+    dg_export_json_string(&json, "path", png_path);
+    dg_export_json_int(&json, "width", map->width);
+    dg_export_json_int(&json, "height", map->height);
+    dg_export_json_string(&json, "pixel_format", "rgba8");
+    dg_export_json_end_object(&json);
 
+    dg_export_json_begin_array(&json, "legend");
     for (i = 0; i < sizeof(DG_EXPORT_TILE_LEGEND) / sizeof(DG_EXPORT_TILE_LEGEND[0]); ++i) {
         const dg_export_tile_legend_entry_t *entry = &DG_EXPORT_TILE_LEGEND[i];
-        const char *comma = (i + 1u < sizeof(DG_EXPORT_TILE_LEGEND) / sizeof(DG_EXPORT_TILE_LEGEND[0]))
-                                ? ","
-                                : "";
-        if (fprintf(
-                file,
-                "    {\n"
-                "      \"tile_id\": %d,\n"
-                "      \"tile_name\": \"%s\",\n"
-                "      \"rgba\": [%u, %u, %u, %u]\n"
-                "    }%s\n",
-                (int)entry->tile,
-                entry->name,
-                (unsigned int)entry->rgba[0],
-                (unsigned int)entry->rgba[1],
-                (unsigned int)entry->rgba[2],
-                (unsigned int)entry->rgba[3],
-                comma
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
-        }
-    }
 
-    if (fprintf(file, "  ],\n  \"room_type_palette\": [\n") < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
+        dg_export_json_begin_object(&json, NULL);
+        dg_export_json_int(&json, "tile_id", (int)entry->tile);
+        dg_export_json_string(&json, "tile_name", entry->name);
+        dg_export_json_rgba(&json, "rgba", entry->rgba);
+        dg_export_json_end_object(&json);
     }
+    dg_export_json_end_array(&json);
+
+    dg_export_json_begin_array(&json, "room_type_palette");
     for (i = 0; i < palette_count; ++i) {
         const dg_export_room_type_palette_entry_t *entry = &palette_entries[i];
-        const char *comma = (i + 1u < palette_count) ? "," : "";
-        if (fprintf(
-                file,
-                "    {\n"
-                "      \"type_id\": %u,\n"
-                "      \"room_count\": %llu,\n"
-                "      \"tile_count\": %llu,\n"
-                "      \"rgba\": [%u, %u, %u, %u]\n"
-                "    }%s\n",
-                (unsigned int)entry->type_id,
-                (unsigned long long)entry->room_count,
-                (unsigned long long)entry->tile_count,
-                (unsigned int)entry->rgba[0],
-                (unsigned int)entry->rgba[1],
-                (unsigned int)entry->rgba[2],
-                (unsigned int)entry->rgba[3],
-                comma
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
-        }
-    }
 
-    if (fprintf(file, "  ],\n  \"configured_room_types\": [\n") < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
+        dg_export_json_begin_object(&json, NULL);
+        dg_export_json_uint(&json, "type_id", entry->type_id);
+        dg_export_json_uint(&json, "room_count", (unsigned long long)entry->room_count);
+        dg_export_json_uint(&json, "tile_count", (unsigned long long)entry->tile_count);
+        dg_export_json_rgba(&json, "rgba", entry->rgba);
+        dg_export_json_end_object(&json);
     }
+    dg_export_json_end_array(&json);
+
+    dg_export_json_begin_array(&json, "configured_room_types");
     for (i = 0; i < configured_type_count; ++i) {
         const dg_snapshot_room_type_definition_t *definition = &snapshot->room_types.definitions[i];
         unsigned char rgba[4];
-        const char *comma = (i + 1u < configured_type_count) ? "," : "";
+
         dg_export_color_for_room_type(definition->type_id, rgba);
-        if (fprintf(
-                file,
-                "    {\n"
-                "      \"type_id\": %u,\n"
-                "      \"enabled\": %d,\n"
-                "      \"min_count\": %d,\n"
-                "      \"max_count\": %d,\n"
-                "      \"target_count\": %d,\n"
-                "      \"template_map_path\": ",
-                (unsigned int)definition->type_id,
-                definition->enabled,
-                definition->min_count,
-                definition->max_count,
-                definition->target_count
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
-        }
-        if (dg_export_json_write_escaped(file, definition->template_map_path) != DG_STATUS_OK) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
-        }
-        if (fprintf(
-                file,
-                ",\n"
-                "      \"template_required_opening_matches\": %d,\n"
-                "      \"rgba\": [%u, %u, %u, %u]\n"
-                "    }%s\n",
-                definition->template_required_opening_matches,
-                (unsigned int)rgba[0],
-                (unsigned int)rgba[1],
-                (unsigned int)rgba[2],
-                (unsigned int)rgba[3],
-                comma
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
+        dg_export_json_begin_object(&json, NULL);
+        dg_export_json_uint(&json, "type_id", definition->type_id);
+        dg_export_json_int(&json, "enabled", definition->enabled);
+        dg_export_json_int(&json, "min_count", definition->min_count);
+        dg_export_json_int(&json, "max_count", definition->max_count);
+        dg_export_json_int(&json, "target_count", definition->target_count);
+        dg_export_json_string(&json, "template_map_path", definition->template_map_path);
+        dg_export_json_int(
+            &json,
+            "template_required_opening_matches",
+            definition->template_required_opening_matches
+        );
+        dg_export_json_int(&json, "template_variant_step", definition->template_variant_step);
+        dg_export_json_rgba(&json, "rgba", rgba);
+        dg_export_json_end_object(&json);
+    }
+    dg_export_json_end_array(&json);
+
+    dg_export_json_begin_object(&json, "metadata");
+    dg_export_json_uint(&json, "seed", (unsigned long long)metadata->seed);
+    dg_export_json_int(&json, "algorithm_id", metadata->algorithm_id);
+    dg_export_json_string(&json, "algorithm", dg_export_algorithm_name(metadata->algorithm_id));
+    dg_export_json_int(&json, "generation_class", (int)metadata->generation_class);
+    dg_export_json_string(
+        &json,
+        "generation_class_name",
+        dg_export_generation_class_name(metadata->generation_class)
+    );
+    dg_export_json_uint(
+        &json,
+        "generation_attempts",
+        (unsigned long long)metadata->generation_attempts
+    );
+    dg_export_json_literal(&json, "connected_floor", metadata->connected_floor ? "true" : "false");
+    dg_export_json_uint(
+        &json,
+        "connected_component_count",
+        (unsigned long long)metadata->connected_component_count
+    );
+    dg_export_json_uint(
+        &json,
+        "largest_component_size",
+        (unsigned long long)metadata->largest_component_size
+    );
+    dg_export_json_uint(
+        &json,
+        "walkable_tile_count",
+        (unsigned long long)metadata->walkable_tile_count
+    );
+    dg_export_json_uint(&json, "wall_tile_count", (unsigned long long)metadata->wall_tile_count);
+    dg_export_json_uint(&json, "room_count", (unsigned long long)metadata->room_count);
+    dg_export_json_uint(
+        &json,
+        "typed_room_count",
+        (unsigned long long)metadata->diagnostics.typed_room_count
+    );
+    dg_export_json_uint(
+        &json,
+        "untyped_room_count",
+        (unsigned long long)metadata->diagnostics.untyped_room_count
+    );
+    dg_export_json_uint(&json, "corridor_count", (unsigned long long)metadata->corridor_count);
+    dg_export_json_uint(
+        &json,
+        "corridor_total_length",
+        (unsigned long long)metadata->corridor_total_length
+    );
+    dg_export_json_int(&json, "entrance_exit_distance", metadata->entrance_exit_distance);
+    dg_export_json_uint(
+        &json,
+        "room_entrance_count",
+        (unsigned long long)metadata->room_entrance_count
+    );
+    dg_export_json_uint(
+        &json,
+        "edge_opening_count",
+        (unsigned long long)metadata->edge_opening_count
+    );
+    dg_export_json_int(&json, "primary_edge_entrance_id", metadata->primary_entrance_opening_id);
+    dg_export_json_int(&json, "primary_edge_exit_id", metadata->primary_exit_opening_id);
+    dg_export_json_end_object(&json);
+
+    if ((omit_mask & DG_EXPORT_JSON_OMIT_ROOMS) == 0u) {
+        dg_export_json_begin_array(&json, "rooms");
+        for (i = 0; i < metadata->room_count; ++i) {
+            const dg_room_metadata_t *room = &metadata->rooms[i];
+
+            dg_export_json_begin_object(&json, NULL);
+            dg_export_json_int(&json, "id", room->id);
+            dg_export_json_int(&json, "x", room->bounds.x);
+            dg_export_json_int(&json, "y", room->bounds.y);
+            dg_export_json_int(&json, "width", room->bounds.width);
+            dg_export_json_int(&json, "height", room->bounds.height);
+            dg_export_json_uint(&json, "flags", (unsigned int)room->flags);
+            dg_export_json_int(&json, "role", (int)room->role);
+            dg_export_json_string(&json, "role_name", dg_export_room_role_name(room->role));
+            dg_export_json_uint(&json, "type_id", room->type_id);
+            dg_export_json_end_object(&json);
         }
+        dg_export_json_end_array(&json);
     }
 
-    if (fprintf(
-            file,
-            "  ],\n"
-            "  \"metadata\": {\n"
-            "    \"seed\": %llu,\n"
-            "    \"algorithm_id\": %d,\n"
-            "    \"algorithm\": \"%s\",\n"
-            "    \"generation_class\": %d,\n"
-            "    \"generation_class_name\": \"%s\",\n"
-            "    \"generation_attempts\": %llu,\n"
-            "    \"connected_floor\": %s,\n"
-            "    \"connected_component_count\": %llu,\n"
-            "    \"largest_component_size\": %llu,\n"
-            "    \"walkable_tile_count\": %llu,\n"
-            "    \"wall_tile_count\": %llu,\n"
-            "    \"room_count\": %llu,\n"
-            "    \"typed_room_count\": %llu,\n"
-            "    \"untyped_room_count\": %llu,\n"
-            "    \"corridor_count\": %llu,\n"
-            "    \"corridor_total_length\": %llu,\n"
-            "    \"entrance_exit_distance\": %d,\n"
-            "    \"room_entrance_count\": %llu,\n"
-            "    \"edge_opening_count\": %llu,\n"
-            "    \"primary_edge_entrance_id\": %d,\n"
-            "    \"primary_edge_exit_id\": %d\n"
-            "  },\n",
-            (unsigned long long)map->metadata.seed,
-            map->metadata.algorithm_id,
-            dg_export_algorithm_name(map->metadata.algorithm_id),
-            (int)map->metadata.generation_class,
-            dg_export_generation_class_name(map->metadata.generation_class),
-            (unsigned long long)map->metadata.generation_attempts,
-            map->metadata.connected_floor ? "true" : "false",
-            (unsigned long long)map->metadata.connected_component_count,
-            (unsigned long long)map->metadata.largest_component_size,
-            (unsigned long long)map->metadata.walkable_tile_count,
-            (unsigned long long)map->metadata.wall_tile_count,
-            (unsigned long long)map->metadata.room_count,
-            (unsigned long long)map->metadata.diagnostics.typed_room_count,
-            (unsigned long long)map->metadata.diagnostics.untyped_room_count,
-            (unsigned long long)map->metadata.corridor_count,
-            (unsigned long long)map->metadata.corridor_total_length,
-            map->metadata.entrance_exit_distance,
-            (unsigned long long)map->metadata.room_entrance_count,
-            (unsigned long long)map->metadata.edge_opening_count,
-            map->metadata.primary_entrance_opening_id,
-            map->metadata.primary_exit_opening_id
-        ) < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
-    }
+    if ((omit_mask & DG_EXPORT_JSON_OMIT_CORRIDORS) == 0u) {
+        dg_export_json_begin_array(&json, "corridors");
+        for (i = 0; i < metadata->corridor_count; ++i) {
+            const dg_corridor_metadata_t *corridor = &metadata->corridors[i];
 
-    if (fprintf(file, "  \"rooms\": [\n") < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
-    }
-    for (i = 0; i < map->metadata.room_count; ++i) {
-        const dg_room_metadata_t *room = &map->metadata.rooms[i];
-        const char *comma = (i + 1u < map->metadata.room_count) ? "," : "";
-        if (fprintf(
-                file,
-                "    {\n"
-                "      \"id\": %d,\n"
-                "      \"x\": %d,\n"
-                "      \"y\": %d,\n"
-                "      \"width\": %d,\n"
-                "      \"height\": %d,\n"
-                "      \"flags\": %u,\n"
-                "      \"role\": %d,\n"
-                "      \"role_name\": \"%s\",\n"
-                "      \"type_id\": %u\n"
-                "    }%s\n",
-                room->id,
-                room->bounds.x,
-                room->bounds.y,
-                room->bounds.width,
-                room->bounds.height,
-                (unsigned int)room->flags,
-                (int)room->role,
-                dg_export_room_role_name(room->role),
-                (unsigned int)room->type_id,
-                comma
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
+            dg_export_json_begin_object(&json, NULL);
+            dg_export_json_int(&json, "from_room_id", corridor->from_room_id);
+            dg_export_json_int(&json, "to_room_id", corridor->to_room_id);
+            dg_export_json_int(&json, "width", corridor->width);
+            dg_export_json_int(&json, "length", corridor->length);
+            dg_export_json_end_object(&json);
+        }
+        dg_export_json_end_array(&json);
+    }
+
+    if ((omit_mask & DG_EXPORT_JSON_OMIT_ROOM_ENTRANCES) == 0u) {
+        dg_export_json_begin_array(&json, "room_entrances");
+        for (i = 0; i < metadata->room_entrance_count; ++i) {
+            const dg_room_entrance_metadata_t *entrance = &metadata->room_entrances[i];
+
+            dg_export_json_begin_object(&json, NULL);
+            dg_export_json_int(&json, "room_id", entrance->room_id);
+            dg_export_json_int(&json, "room_x", entrance->room_tile.x);
+            dg_export_json_int(&json, "room_y", entrance->room_tile.y);
+            dg_export_json_int(&json, "corridor_x", entrance->corridor_tile.x);
+            dg_export_json_int(&json, "corridor_y", entrance->corridor_tile.y);
+            dg_export_json_int(&json, "normal_x", entrance->normal_x);
+            dg_export_json_int(&json, "normal_y", entrance->normal_y);
+            dg_export_json_end_object(&json);
+        }
+        dg_export_json_end_array(&json);
+    }
+
+    if ((omit_mask & DG_EXPORT_JSON_OMIT_EDGE_OPENINGS) == 0u) {
+        dg_export_json_begin_array(&json, "edge_openings");
+        for (i = 0; i < metadata->edge_opening_count; ++i) {
+            const dg_map_edge_opening_t *opening = &metadata->edge_openings[i];
+
+            dg_export_json_begin_object(&json, NULL);
+            dg_export_json_int(&json, "id", opening->id);
+            dg_export_json_int(&json, "side", (int)opening->side);
+            dg_export_json_string(&json, "side_name", dg_export_edge_side_name(opening->side));
+            dg_export_json_int(&json, "start", opening->start);
+            dg_export_json_int(&json, "end", opening->end);
+            dg_export_json_int(&json, "length", opening->length);
+            dg_export_json_int(&json, "edge_x", opening->edge_tile.x);
+            dg_export_json_int(&json, "edge_y", opening->edge_tile.y);
+            dg_export_json_int(&json, "inward_x", opening->inward_tile.x);
+            dg_export_json_int(&json, "inward_y", opening->inward_tile.y);
+            dg_export_json_int(&json, "normal_x", opening->normal_x);
+            dg_export_json_int(&json, "normal_y", opening->normal_y);
+            dg_export_json_uint(&json, "component_id", (unsigned long long)opening->component_id);
+            dg_export_json_int(&json, "role", (int)opening->role);
+            dg_export_json_string(
+                &json,
+                "role_name",
+                dg_export_edge_opening_role_name(opening->role)
+            );
+            dg_export_json_end_object(&json);
         }
+        dg_export_json_end_array(&json);
     }
 
-    if (fprintf(file, "  ],\n  \"corridors\": [\n") < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
-    }
-    for (i = 0; i < map->metadata.corridor_count; ++i) {
-        const dg_corridor_metadata_t *corridor = &map->metadata.corridors[i];
-        const char *comma = (i + 1u < map->metadata.corridor_count) ? "," : "";
-        if (fprintf(
-                file,
-                "    {\n"
-                "      \"from_room_id\": %d,\n"
-                "      \"to_room_id\": %d,\n"
-                "      \"width\": %d,\n"
-                "      \"length\": %d\n"
-                "    }%s\n",
-                corridor->from_room_id,
-                corridor->to_room_id,
-                corridor->width,
-                corridor->length,
-                comma
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
-        }
+    dg_export_write_json_generation_request(&json, snapshot);
+    dg_export_json_end_object(&json);
+    return dg_export_json_finish(&json);
+}
+
+void dg_default_export_options(dg_export_options_t *options)
+{
+    if (options == NULL) {
+        return;
     }
 
-    if (fprintf(file, "  ],\n  \"room_entrances\": [\n") < 0) {
-        (void)fclose(file);
+    options->png_color_mode = DG_PNG_COLOR_MODE_RGBA;
+    options->png_compression_level = DG_PNG_COMPRESSION_LEVEL_DEFAULT;
+    options->png_compression_strategy = DG_PNG_COMPRESSION_STRATEGY_AUTO;
+    options->png_pixels_per_tile = 1;
+    options->json_compact = 0;
+    options->json_omit_mask = 0u;
+}
+
+static bool dg_export_options_are_valid(const dg_export_options_t *options)
+{
+    return options != NULL &&
+           (options->png_color_mode == DG_PNG_COLOR_MODE_RGBA ||
+            options->png_color_mode == DG_PNG_COLOR_MODE_INDEXED) &&
+           options->png_compression_level >= DG_PNG_COMPRESSION_LEVEL_DEFAULT &&
+           options->png_compression_level <= 9 &&
+           (int)options->png_compression_strategy >= (int)DG_PNG_COMPRESSION_STRATEGY_AUTO &&
+           (int)options->png_compression_strategy <= (int)DG_PNG_COMPRESSION_STRATEGY_FIXED &&
+           options->png_pixels_per_tile >= 1 &&
+           (options->json_compact == 0 || options->json_compact == 1) &&
+           (options->json_omit_mask & ~DG_EXPORT_JSON_OMIT_LARGE_ARRAYS) == 0u;
+}
+
+dg_status_t dg_map_export_png_json(
+    const dg_map_t *map,
+    const char *png_path,
+    const char *json_path
+)
+{
+    dg_export_options_t options;
+
+    dg_default_export_options(&options);
+    return dg_map_export_png_json_with_options(map, png_path, json_path, &options);
+}
+
+/* Streams one export pass straight into a file. */
+static dg_status_t dg_export_write_file(
+    const char *path,
+    const dg_map_t *map,
+    const char *png_path,
+    const dg_export_room_type_palette_entry_t *palette_entries,
+    size_t palette_count,
+    const dg_export_options_t *options,
+    bool json
+)
+{
+    dg_io_writer_t writer;
+    dg_status_t status;
+
+    writer = (dg_io_writer_t){0};
+    writer.file = fopen(path, "wb");
+    if (writer.file == NULL) {
         return DG_STATUS_IO_ERROR;
     }
-    for (i = 0; i < map->metadata.room_entrance_count; ++i) {
-        const dg_room_entrance_metadata_t *entrance = &map->metadata.room_entrances[i];
-        const char *comma = (i + 1u < map->metadata.room_entrance_count) ? "," : "";
-        if (fprintf(
-                file,
-                "    {\n"
-                "      \"room_id\": %d,\n"
-                "      \"room_x\": %d,\n"
-                "      \"room_y\": %d,\n"
-                "      \"corridor_x\": %d,\n"
-                "      \"corridor_y\": %d,\n"
-                "      \"normal_x\": %d,\n"
-                "      \"normal_y\": %d\n"
-                "    }%s\n",
-                entrance->room_id,
-                entrance->room_tile.x,
-                entrance->room_tile.y,
-                entrance->corridor_tile.x,
-                entrance->corridor_tile.y,
-                entrance->normal_x,
-                entrance->normal_y,
-                comma
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
-        }
+
+    if (json) {
+        status = dg_export_write_json(
+            &writer,
+            map,
+            png_path,
+            palette_entries,
+            palette_count,
+            options
+        );
+    } else {
+        status = dg_export_write_png(&writer, map, palette_entries, palette_count, options);
     }
 
-    if (fprintf(file, "  ],\n  \"edge_openings\": [\n") < 0) {
-        (void)fclose(file);
+    if (fclose(writer.file) != 0 && status == DG_STATUS_OK) {
         return DG_STATUS_IO_ERROR;
     }
-    for (i = 0; i < map->metadata.edge_opening_count; ++i) {
-        const dg_map_edge_opening_t *opening = &map->metadata.edge_openings[i];
-        const char *comma = (i + 1u < map->metadata.edge_opening_count) ? "," : "";
-        if (fprintf(
-                file,
-                "    {\n"
-                "      \"id\": %d,\n"
-                "      \"side\": %d,\n"
-                "      \"side_name\": \"%s\",\n"
-                "      \"start\": %d,\n"
-                "      \"end\": %d,\n"
-                "      \"length\": %d,\n"
-                "      \"edge_x\": %d,\n"
-                "      \"edge_y\": %d,\n"
-                "      \"inward_x\": %d,\n"
-                "      \"inward_y\": %d,\n"
-                "      \"normal_x\": %d,\n"
-                "      \"normal_y\": %d,\n"
-                "      \"component_id\": %llu,\n"
-                "      \"role\": %d,\n"
-                "      \"role_name\": \"%s\"\n"
-                "    }%s\n",
-                opening->id,
-                (int)opening->side,
-                dg_export_edge_side_name(opening->side),
-                opening->start,
-                opening->end,
-                opening->length,
-                opening->edge_tile.x,
-                opening->edge_tile.y,
-                opening->inward_tile.x,
-                opening->inward_tile.y,
-                opening->normal_x,
-                opening->normal_y,
-                (unsigned long long)opening->component_id,
-                (int)opening->role,
-                dg_export_edge_opening_role_name(opening->role),
-                comma
-            ) < 0) {
-            (void)fclose(file);
-            return DG_STATUS_IO_ERROR;
-        }
+    return status;
+}
+
+dg_status_t dg_map_export_png_json_with_options(
+    const dg_map_t *map,
+    const char *png_path,
+    const char *json_path,
+    const dg_export_options_t *options
+)
+{
+    dg_status_t status;
+    dg_export_room_type_palette_entry_t *palette_entries;
+    size_t palette_count;
+
+    if (map == NULL || png_path == NULL || json_path == NULL ||
+        !dg_export_options_are_valid(options)) {
+        return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    if (fprintf(file, "  ],\n  \"generation_request\": ") < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
+    if (map->tiles == NULL || map->width <= 0 || map->height <= 0) {
+        return DG_STATUS_INVALID_ARGUMENT;
     }
-    status = dg_export_write_json_generation_request(file, &map->metadata.generation_request);
+
+    palette_entries = NULL;
+    palette_count = 0u;
+    status = dg_export_build_room_type_overlay(map, &palette_entries, &palette_count);
     if (status != DG_STATUS_OK) {
-        (void)fclose(file);
         return status;
     }
 
-    if (fprintf(file, "\n}\n") < 0) {
-        (void)fclose(file);
-        return DG_STATUS_IO_ERROR;
-    }
-
-    if (fclose(file) != 0) {
-        return DG_STATUS_IO_ERROR;
+    status = dg_export_write_file(
+        png_path,
+        map,
+        png_path,
+        palette_entries,
+        palette_count,
+        options,
+        false
+    );
+    if (status == DG_STATUS_OK) {
+        status = dg_export_write_file(
+            json_path,
+            map,
+            png_path,
+            palette_entries,
+            palette_count,
+            options,
+            true
+        );
     }
 
-    return DG_STATUS_OK;
+    free(palette_entries);
+    return status;
 }
 
-dg_status_t dg_map_export_png_json(
+dg_status_t dg_map_export_png_json_to_buffers(
     const dg_map_t *map,
-    const char *png_path,
-    const char *json_path
+    const char *png_name,
+    const dg_export_options_t *options,
+    void **out_png,
+    size_t *out_png_size,
+    void **out_json,
+    size_t *out_json_size
 )
 {
-    dg_status_t status;
-    int *room_index_by_tile;
+    dg_io_writer_t png_writer;
+    dg_io_writer_t json_writer;
     dg_export_room_type_palette_entry_t *palette_entries;
     size_t palette_count;
+    dg_status_t status;
 
-    if (map == NULL || png_path == NULL || json_path == NULL) {
+    if ((out_png == NULL) != (out_png_size == NULL) ||
+        (out_json == NULL) != (out_json_size == NULL) ||
+        (out_png == NULL && out_json == NULL)) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
+    if (out_png != NULL) {
+        *out_png = NULL;
+        *out_png_size = 0u;
+    }
+    if (out_json != NULL) {
+        *out_json = NULL;
+        *out_json_size = 0u;
+    }
 
+    if (map == NULL || !dg_export_options_are_valid(options) ||
+        (out_json != NULL && png_name == NULL)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
     if (map->tiles == NULL || map->width <= 0 || map->height <= 0) {
         return DG_STATUS_INVALID_ARGUMENT;
     }
 
-    room_index_by_tile = NULL;
     palette_entries = NULL;
     palette_count = 0u;
-    status = dg_export_build_room_type_overlay(
-        map,
-        &room_index_by_tile,
-        &palette_entries,
-        &palette_count
-    );
+    status = dg_export_build_room_type_overlay(map, &palette_entries, &palette_count);
     if (status != DG_STATUS_OK) {
-        free(room_index_by_tile);
-        free(palette_entries);
         return status;
     }
 
-    status = dg_export_write_png_file(map, png_path, room_index_by_tile);
+    png_writer = (dg_io_writer_t){0};
+    json_writer = (dg_io_writer_t){0};
+    if (out_png != NULL) {
+        status = dg_export_write_png(&png_writer, map, palette_entries, palette_count, options);
+    }
+    if (status == DG_STATUS_OK && out_json != NULL) {
+        status = dg_export_write_json(
+            &json_writer,
+            map,
+            png_name,
+            palette_entries,
+            palette_count,
+            options
+        );
+        if (status == DG_STATUS_OK) {
+            status = dg_write_exact(&json_writer, "", 1u);
+            json_writer.size -= (status == DG_STATUS_OK) ? 1u : 0u;
+        }
+    }
+    free(palette_entries);
+
     if (status != DG_STATUS_OK) {
-        free(room_index_by_tile);
-        free(palette_entries);
+        free(png_writer.data);
+        free(json_writer.data);
         return status;
     }
 
-    status = dg_export_write_json_file(map, png_path, json_path, palette_entries, palette_count);
-    free(room_index_by_tile);
-    free(palette_entries);
-    return status;
+    if (out_png != NULL) {
+        *out_png = png_writer.data;
+        *out_png_size = png_writer.size;
+    }
+    if (out_json != NULL) {
+        *out_json = json_writer.data;
+        *out_json_size = json_writer.size;
+    }
+    return DG_STATUS_OK;
 }
@@ -0,0 +1,120 @@
+#ifndef DUNGEONEER_IO_INTERNAL_H
+#define DUNGEONEER_IO_INTERNAL_H
+
+#include "dungeoneer/generator.h"
+#include "dungeoneer/io.h"
+
+#include <stdio.h>
+
+/*
+ * Little-endian byte sink shared by the on-disk formats.
+ * With `file` set, bytes are streamed to it; otherwise they are appended to
+ * the growable `data` buffer, which the caller frees.
+ * With `fixed` set, `data` is a caller buffer of `capacity` bytes that never
+ * grows: writes past its end are dropped but still counted in `size`, so one
+ * pass reports the space a retry needs.
+ */
+typedef struct dg_io_writer {
+    FILE *file;
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    bool fixed;
+} dg_io_writer_t;
+
+/*
+ * Bounded cursor over an in-memory byte source. Reads advance `offset`;
+ * running past `size` is an IO error.
+ */
+typedef struct dg_io_reader {
+    const unsigned char *data;
+    size_t size;
+    size_t offset;
+} dg_io_reader_t;
+
+extern const unsigned char DG_BAKED_MAGIC[4];
+
+bool dg_mul_size_would_overflow(size_t a, size_t b, size_t *out);
+bool dg_map_is_empty(const dg_map_t *map);
+dg_status_t dg_allocate_array(void **out_ptr, size_t count, size_t element_size);
+
+dg_status_t dg_write_exact(dg_io_writer_t *writer, const void *data, size_t byte_count);
+dg_status_t dg_write_u32(dg_io_writer_t *writer, uint32_t value);
+dg_status_t dg_write_i32(dg_io_writer_t *writer, int32_t value);
+dg_status_t dg_write_u64(dg_io_writer_t *writer, uint64_t value);
+dg_status_t dg_write_size(dg_io_writer_t *writer, size_t value);
+
+dg_status_t dg_read_exact(dg_io_reader_t *reader, void *data, size_t byte_count);
+dg_status_t dg_read_u32(dg_io_reader_t *reader, uint32_t *out_value);
+dg_status_t dg_read_i32(dg_io_reader_t *reader, int32_t *out_value);
+dg_status_t dg_read_u64(dg_io_reader_t *reader, uint64_t *out_value);
+dg_status_t dg_read_size(dg_io_reader_t *reader, size_t *out_value);
+
+/* Reads a whole file into a malloc'd buffer owned by the caller. */
+dg_status_t dg_read_file_contents(const char *path, unsigned char **out_data, size_t *out_size);
+
+bool dg_snapshot_is_valid(const dg_generation_request_snapshot_t *snapshot);
+void dg_snapshot_clear(dg_generation_request_snapshot_t *snapshot);
+dg_status_t dg_write_snapshot(dg_io_writer_t *writer, const dg_generation_request_snapshot_t *snapshot);
+dg_status_t dg_read_snapshot(dg_io_reader_t *reader, dg_generation_request_snapshot_t *snapshot);
+
+/*
+ * Row run-length tile codec (see io_tiles.c). The token stream carries no
+ * dimensions; the reader rejects streams that do not fill exactly
+ * `width * height` tiles.
+ */
+dg_status_t dg_write_tile_runs(
+    dg_io_writer_t *writer,
+    const dg_tile_t *tiles,
+    int width,
+    int height
+);
+dg_status_t dg_read_tile_runs(
+    const unsigned char *data,
+    size_t size,
+    dg_tile_t *tiles,
+    int width,
+    int height
+);
+
+/* Appends a baked map image to `writer`, as dg_map_save_baked_file writes it. */
+dg_status_t dg_bake_map(
+    const dg_map_t *map,
+    const dg_baked_save_options_t *options,
+    dg_io_writer_t *writer
+);
+
+/* Decodes a baked map from memory; on failure `out_map` may be partially filled. */
+dg_status_t dg_unbake_map(const unsigned char *data, size_t size, dg_map_t *out_map);
+
+/*
+ * Loads a config or baked file image, as dg_map_load_file does after reading
+ * the file. `out_map` is left empty on failure.
+ */
+dg_status_t dg_load_map_from_memory(const unsigned char *data, size_t size, dg_map_t *out_map);
+
+/*
+ * Template pack index (see template_pack.c). Entries point into the parsed
+ * pack bytes, are sorted by name and are not NUL-terminated.
+ */
+typedef struct dg_template_pack_entry {
+    const char *name;
+    size_t name_length;
+    const unsigned char *data;
+    size_t size;
+} dg_template_pack_entry_t;
+
+/* Validates a pack image and returns its index; free `out_entries` with free(). */
+dg_status_t dg_template_pack_parse(
+    const unsigned char *data,
+    size_t size,
+    dg_template_pack_entry_t **out_entries,
+    size_t *out_entry_count
+);
+const dg_template_pack_entry_t *dg_template_pack_find(
+    const dg_template_pack_entry_t *entries,
+    size_t entry_count,
+    const char *name
+);
+
+#endif
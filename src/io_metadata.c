@@ -0,0 +1,602 @@
+#include "io_internal.h"
+#include "dungeoneer/metadata_binary.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * DGMD writer and zero-copy reader. Records are emitted field by field
+ * through the little-endian writer, so the output does not depend on host
+ * byte order; the static asserts pin the public structs to that byte layout
+ * so readers on little-endian hosts can cast the buffer directly.
+ */
+static const unsigned char DG_METADATA_BINARY_MAGIC[4] = {'D', 'G', 'M', 'D'};
+
+#define DG_METADATA_BINARY_SECTION_COUNT 7u
+#define DG_METADATA_BINARY_ALIGNMENT 8u
+
+_Static_assert(sizeof(dg_metadata_binary_header_t) == 208u, "DGMD header layout");
+_Static_assert(sizeof(dg_metadata_binary_section_t) == 24u, "DGMD section layout");
+_Static_assert(sizeof(dg_metadata_binary_room_t) == 32u, "DGMD room layout");
+_Static_assert(sizeof(dg_metadata_binary_corridor_t) == 16u, "DGMD corridor layout");
+_Static_assert(sizeof(dg_metadata_binary_room_entrance_t) == 28u, "DGMD entrance layout");
+_Static_assert(sizeof(dg_metadata_binary_edge_opening_t) == 56u, "DGMD edge opening layout");
+_Static_assert(sizeof(dg_metadata_binary_room_adjacency_t) == 8u, "DGMD adjacency layout");
+_Static_assert(sizeof(dg_metadata_binary_room_neighbor_t) == 8u, "DGMD neighbor layout");
+_Static_assert(sizeof(dg_metadata_binary_room_type_quota_t) == 36u, "DGMD quota layout");
+
+static size_t dg_metadata_binary_record_size(uint32_t id)
+{
+    switch ((dg_metadata_binary_section_id_t)id) {
+    case DG_METADATA_BINARY_SECTION_ROOMS:
+        return sizeof(dg_metadata_binary_room_t);
+    case DG_METADATA_BINARY_SECTION_CORRIDORS:
+        return sizeof(dg_metadata_binary_corridor_t);
+    case DG_METADATA_BINARY_SECTION_ROOM_ENTRANCES:
+        return sizeof(dg_metadata_binary_room_entrance_t);
+    case DG_METADATA_BINARY_SECTION_EDGE_OPENINGS:
+        return sizeof(dg_metadata_binary_edge_opening_t);
+    case DG_METADATA_BINARY_SECTION_ROOM_ADJACENCY:
+        return sizeof(dg_metadata_binary_room_adjacency_t);
+    case DG_METADATA_BINARY_SECTION_ROOM_NEIGHBORS:
+        return sizeof(dg_metadata_binary_room_neighbor_t);
+    case DG_METADATA_BINARY_SECTION_ROOM_TYPE_QUOTAS:
+        return sizeof(dg_metadata_binary_room_type_quota_t);
+    default:
+        return 0u;
+    }
+}
+
+static size_t dg_metadata_binary_record_count(const dg_map_metadata_t *metadata, uint32_t id)
+{
+    switch ((dg_metadata_binary_section_id_t)id) {
+    case DG_METADATA_BINARY_SECTION_ROOMS:
+        return metadata->room_count;
+    case DG_METADATA_BINARY_SECTION_CORRIDORS:
+        return metadata->corridor_count;
+    case DG_METADATA_BINARY_SECTION_ROOM_ENTRANCES:
+        return metadata->room_entrance_count;
+    case DG_METADATA_BINARY_SECTION_EDGE_OPENINGS:
+        return metadata->edge_opening_count;
+    case DG_METADATA_BINARY_SECTION_ROOM_ADJACENCY:
+        return metadata->room_adjacency_count;
+    case DG_METADATA_BINARY_SECTION_ROOM_NEIGHBORS:
+        return metadata->room_neighbor_count;
+    case DG_METADATA_BINARY_SECTION_ROOM_TYPE_QUOTAS:
+        return metadata->diagnostics.room_type_count;
+    default:
+        return 0u;
+    }
+}
+
+static bool dg_metadata_binary_map_is_valid(const dg_map_t *map)
+{
+    const dg_map_metadata_t *metadata;
+    size_t i;
+
+    if (map == NULL || map->tiles == NULL || map->width <= 0 || map->height <= 0) {
+        return false;
+    }
+
+    metadata = &map->metadata;
+    if ((metadata->room_count > 0u && metadata->rooms == NULL) ||
+        (metadata->corridor_count > 0u && metadata->corridors == NULL) ||
+        (metadata->room_entrance_count > 0u && metadata->room_entrances == NULL) ||
+        (metadata->edge_opening_count > 0u && metadata->edge_openings == NULL) ||
+        (metadata->room_adjacency_count > 0u && metadata->room_adjacency == NULL) ||
+        (metadata->room_neighbor_count > 0u && metadata->room_neighbors == NULL) ||
+        (metadata->diagnostics.room_type_count > 0u &&
+         metadata->diagnostics.room_type_quotas == NULL)) {
+        return false;
+    }
+
+    /* Spans and quota counts are stored as u32. */
+    for (i = 0; i < metadata->room_adjacency_count; ++i) {
+        if (metadata->room_adjacency[i].start_index > UINT32_MAX ||
+            metadata->room_adjacency[i].count > UINT32_MAX) {
+            return false;
+        }
+    }
+    for (i = 0; i < metadata->diagnostics.room_type_count; ++i) {
+        if (metadata->diagnostics.room_type_quotas[i].assigned_count > UINT32_MAX) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static dg_status_t dg_metadata_binary_write_padding(dg_io_writer_t *writer, size_t offset)
+{
+    static const unsigned char zeros[DG_METADATA_BINARY_ALIGNMENT] = {0};
+    size_t remainder = offset % DG_METADATA_BINARY_ALIGNMENT;
+
+    if (remainder == 0u) {
+        return DG_STATUS_OK;
+    }
+    return dg_write_exact(writer, zeros, DG_METADATA_BINARY_ALIGNMENT - remainder);
+}
+
+static dg_status_t dg_metadata_binary_write_i32s(
+    dg_io_writer_t *writer,
+    const int32_t *values,
+    size_t count
+)
+{
+    dg_status_t status = DG_STATUS_OK;
+    size_t i;
+
+    for (i = 0; status == DG_STATUS_OK && i < count; ++i) {
+        status = dg_write_i32(writer, values[i]);
+    }
+    return status;
+}
+
+static dg_status_t dg_metadata_binary_write_header(
+    dg_io_writer_t *writer,
+    const dg_map_t *map,
+    size_t total_size
+)
+{
+    const dg_map_metadata_t *metadata = &map->metadata;
+    int32_t fields[8];
+    uint64_t counts[16];
+    dg_status_t status;
+    size_t i;
+
+    fields[0] = (int32_t)metadata->algorithm_id;
+    fields[1] = (int32_t)metadata->generation_class;
+    fields[2] = (int32_t)map->width;
+    fields[3] = (int32_t)map->height;
+    fields[4] = (int32_t)metadata->primary_entrance_opening_id;
+    fields[5] = (int32_t)metadata->primary_exit_opening_id;
+    fields[6] = (int32_t)metadata->entrance_exit_distance;
+    fields[7] = metadata->connected_floor ? 1 : 0;
+
+    counts[0] = (uint64_t)metadata->walkable_tile_count;
+    counts[1] = (uint64_t)metadata->wall_tile_count;
+    counts[2] = (uint64_t)metadata->corridor_total_length;
+    counts[3] = (uint64_t)metadata->connected_component_count;
+    counts[4] = (uint64_t)metadata->largest_component_size;
+    counts[5] = (uint64_t)metadata->generation_attempts;
+    counts[6] = (uint64_t)metadata->special_room_count;
+    counts[7] = (uint64_t)metadata->entrance_room_count;
+    counts[8] = (uint64_t)metadata->exit_room_count;
+    counts[9] = (uint64_t)metadata->boss_room_count;
+    counts[10] = (uint64_t)metadata->treasure_room_count;
+    counts[11] = (uint64_t)metadata->shop_room_count;
+    counts[12] = (uint64_t)metadata->leaf_room_count;
+    counts[13] = (uint64_t)metadata->diagnostics.typed_room_count;
+    counts[14] = (uint64_t)metadata->diagnostics.untyped_room_count;
+    counts[15] = (uint64_t)metadata->diagnostics.room_type_min_shortfall;
+
+    status = dg_write_exact(writer, DG_METADATA_BINARY_MAGIC, sizeof(DG_METADATA_BINARY_MAGIC));
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, DG_METADATA_BINARY_VERSION);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, (uint32_t)sizeof(dg_metadata_binary_header_t));
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, DG_METADATA_BINARY_SECTION_COUNT);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u64(writer, (uint64_t)sizeof(dg_metadata_binary_header_t));
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u64(writer, (uint64_t)total_size);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u64(writer, metadata->seed);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_metadata_binary_write_i32s(writer, fields, sizeof(fields) / sizeof(fields[0]));
+    }
+    for (i = 0; status == DG_STATUS_OK && i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        status = dg_write_u64(writer, counts[i]);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, metadata->diagnostics.room_type_short_type_id);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(writer, 0u);
+    }
+    return status;
+}
+
+static dg_status_t dg_metadata_binary_write_records(
+    dg_io_writer_t *writer,
+    const dg_map_metadata_t *metadata,
+    uint32_t id
+)
+{
+    dg_status_t status = DG_STATUS_OK;
+    size_t i;
+
+    switch ((dg_metadata_binary_section_id_t)id) {
+    case DG_METADATA_BINARY_SECTION_ROOMS:
+        for (i = 0; status == DG_STATUS_OK && i < metadata->room_count; ++i) {
+            const dg_room_metadata_t *room = &metadata->rooms[i];
+            int32_t fields[8];
+
+            fields[0] = (int32_t)room->id;
+            fields[1] = (int32_t)room->bounds.x;
+            fields[2] = (int32_t)room->bounds.y;
+            fields[3] = (int32_t)room->bounds.width;
+            fields[4] = (int32_t)room->bounds.height;
+            fields[5] = (int32_t)room->flags;
+            fields[6] = (int32_t)room->role;
+            fields[7] = (int32_t)room->type_id;
+            status = dg_metadata_binary_write_i32s(writer, fields, 8u);
+        }
+        break;
+    case DG_METADATA_BINARY_SECTION_CORRIDORS:
+        for (i = 0; status == DG_STATUS_OK && i < metadata->corridor_count; ++i) {
+            const dg_corridor_metadata_t *corridor = &metadata->corridors[i];
+            int32_t fields[4];
+
+            fields[0] = (int32_t)corridor->from_room_id;
+            fields[1] = (int32_t)corridor->to_room_id;
+            fields[2] = (int32_t)corridor->width;
+            fields[3] = (int32_t)corridor->length;
+            status = dg_metadata_binary_write_i32s(writer, fields, 4u);
+        }
+        break;
+    case DG_METADATA_BINARY_SECTION_ROOM_ENTRANCES:
+        for (i = 0; status == DG_STATUS_OK && i < metadata->room_entrance_count; ++i) {
+            const dg_room_entrance_metadata_t *entrance = &metadata->room_entrances[i];
+            int32_t fields[7];
+
+            fields[0] = (int32_t)entrance->room_id;
+            fields[1] = (int32_t)entrance->room_tile.x;
+            fields[2] = (int32_t)entrance->room_tile.y;
+            fields[3] = (int32_t)entrance->corridor_tile.x;
+            fields[4] = (int32_t)entrance->corridor_tile.y;
+            fields[5] = (int32_t)entrance->normal_x;
+            fields[6] = (int32_t)entrance->normal_y;
+            status = dg_metadata_binary_write_i32s(writer, fields, 7u);
+        }
+        break;
+    case DG_METADATA_BINARY_SECTION_EDGE_OPENINGS:
+        for (i = 0; status == DG_STATUS_OK && i < metadata->edge_opening_count; ++i) {
+            const dg_map_edge_opening_t *opening = &metadata->edge_openings[i];
+            int32_t fields[12];
+
+            fields[0] = (int32_t)opening->id;
+            fields[1] = (int32_t)opening->side;
+            fields[2] = (int32_t)opening->start;
+            fields[3] = (int32_t)opening->end;
+            fields[4] = (int32_t)opening->length;
+            fields[5] = (int32_t)opening->edge_tile.x;
+            fields[6] = (int32_t)opening->edge_tile.y;
+            fields[7] = (int32_t)opening->inward_tile.x;
+            fields[8] = (int32_t)opening->inward_tile.y;
+            fields[9] = (int32_t)opening->normal_x;
+            fields[10] = (int32_t)opening->normal_y;
+            fields[11] = (int32_t)opening->role;
+            status = dg_metadata_binary_write_i32s(writer, fields, 12u);
+            if (status == DG_STATUS_OK) {
+                status = dg_write_u64(
+                    writer,
+                    opening->component_id == DG_MAP_EDGE_COMPONENT_UNKNOWN
+                        ? DG_METADATA_BINARY_COMPONENT_UNKNOWN
+                        : (uint64_t)opening->component_id
+                );
+            }
+        }
+        break;
+    case DG_METADATA_BINARY_SECTION_ROOM_ADJACENCY:
+        for (i = 0; status == DG_STATUS_OK && i < metadata->room_adjacency_count; ++i) {
+            status = dg_write_u32(writer, (uint32_t)metadata->room_adjacency[i].start_index);
+            if (status == DG_STATUS_OK) {
+                status = dg_write_u32(writer, (uint32_t)metadata->room_adjacency[i].count);
+            }
+        }
+        break;
+    case DG_METADATA_BINARY_SECTION_ROOM_NEIGHBORS:
+        for (i = 0; status == DG_STATUS_OK && i < metadata->room_neighbor_count; ++i) {
+            status = dg_write_i32(writer, (int32_t)metadata->room_neighbors[i].room_id);
+            if (status == DG_STATUS_OK) {
+                status = dg_write_i32(writer, (int32_t)metadata->room_neighbors[i].corridor_index);
+            }
+        }
+        break;
+    case DG_METADATA_BINARY_SECTION_ROOM_TYPE_QUOTAS:
+        for (i = 0; status == DG_STATUS_OK && i < metadata->diagnostics.room_type_count; ++i) {
+            const dg_room_type_quota_diagnostics_t *quota =
+                &metadata->diagnostics.room_type_quotas[i];
+            int32_t fields[9];
+
+            fields[0] = (int32_t)quota->type_id;
+            fields[1] = (int32_t)quota->enabled;
+            fields[2] = (int32_t)quota->min_count;
+            fields[3] = (int32_t)quota->max_count;
+            fields[4] = (int32_t)quota->target_count;
+            fields[5] = (int32_t)quota->assigned_count;
+            fields[6] = (int32_t)quota->min_satisfied;
+            fields[7] = (int32_t)quota->max_satisfied;
+            fields[8] = (int32_t)quota->target_satisfied;
+            status = dg_metadata_binary_write_i32s(writer, fields, 9u);
+        }
+        break;
+    default:
+        status = DG_STATUS_INVALID_ARGUMENT;
+        break;
+    }
+
+    return status;
+}
+
+static dg_status_t dg_metadata_binary_write(dg_io_writer_t *writer, const dg_map_t *map)
+{
+    size_t offsets[DG_METADATA_BINARY_SECTION_COUNT];
+    size_t offset;
+    uint32_t id;
+    dg_status_t status;
+
+    if (!dg_metadata_binary_map_is_valid(map)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    /* Lay out every section up front so the table can be written first. */
+    offset = sizeof(dg_metadata_binary_header_t) +
+             DG_METADATA_BINARY_SECTION_COUNT * sizeof(dg_metadata_binary_section_t);
+    for (id = 1u; id <= DG_METADATA_BINARY_SECTION_COUNT; ++id) {
+        size_t bytes;
+
+        offset = (offset + DG_METADATA_BINARY_ALIGNMENT - 1u) &
+                 ~(size_t)(DG_METADATA_BINARY_ALIGNMENT - 1u);
+        offsets[id - 1u] = offset;
+        if (dg_mul_size_would_overflow(
+                dg_metadata_binary_record_count(&map->metadata, id),
+                dg_metadata_binary_record_size(id),
+                &bytes
+            ) ||
+            bytes > SIZE_MAX - offset - DG_METADATA_BINARY_ALIGNMENT) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+        offset += bytes;
+    }
+
+    status = dg_metadata_binary_write_header(writer, map, offset);
+    for (id = 1u; status == DG_STATUS_OK && id <= DG_METADATA_BINARY_SECTION_COUNT; ++id) {
+        status = dg_write_u32(writer, id);
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u32(writer, (uint32_t)dg_metadata_binary_record_size(id));
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u64(writer, (uint64_t)offsets[id - 1u]);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u64(
+                writer,
+                (uint64_t)dg_metadata_binary_record_count(&map->metadata, id)
+            );
+        }
+    }
+
+    offset = sizeof(dg_metadata_binary_header_t) +
+             DG_METADATA_BINARY_SECTION_COUNT * sizeof(dg_metadata_binary_section_t);
+    for (id = 1u; status == DG_STATUS_OK && id <= DG_METADATA_BINARY_SECTION_COUNT; ++id) {
+        status = dg_metadata_binary_write_padding(writer, offset);
+        if (status == DG_STATUS_OK) {
+            status = dg_metadata_binary_write_records(writer, &map->metadata, id);
+        }
+        offset = offsets[id - 1u] +
+                 dg_metadata_binary_record_count(&map->metadata, id) *
+                     dg_metadata_binary_record_size(id);
+    }
+
+    return status;
+}
+
+dg_status_t dg_map_export_metadata_binary_to_buffer(
+    const dg_map_t *map,
+    void **out_data,
+    size_t *out_size
+)
+{
+    dg_io_writer_t writer;
+    dg_status_t status;
+
+    if (out_data == NULL || out_size == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    *out_data = NULL;
+    *out_size = 0u;
+
+    writer = (dg_io_writer_t){0};
+    status = dg_metadata_binary_write(&writer, map);
+    if (status != DG_STATUS_OK) {
+        free(writer.data);
+        return status;
+    }
+
+    *out_data = writer.data;
+    *out_size = writer.size;
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_map_export_metadata_binary(const dg_map_t *map, const char *path)
+{
+    dg_io_writer_t writer;
+    dg_status_t status;
+
+    if (map == NULL || path == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    if (!dg_metadata_binary_map_is_valid(map)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    writer = (dg_io_writer_t){0};
+    writer.file = fopen(path, "wb");
+    if (writer.file == NULL) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    status = dg_metadata_binary_write(&writer, map);
+    if (fclose(writer.file) != 0 && status == DG_STATUS_OK) {
+        return DG_STATUS_IO_ERROR;
+    }
+    return status;
+}
+
+static bool dg_metadata_binary_host_is_little_endian(void)
+{
+    const uint32_t probe = 1u;
+    unsigned char first;
+
+    memcpy(&first, &probe, 1u);
+    return first == 1u;
+}
+
+static bool dg_metadata_binary_id_in_range(int32_t id, size_t count)
+{
+    return id >= 0 && (size_t)id < count;
+}
+
+/* Ids must name existing records and spans must tile the neighbor list. */
+static bool dg_metadata_binary_view_is_consistent(const dg_metadata_binary_view_t *view)
+{
+    size_t running_index;
+    size_t i;
+
+    for (i = 0; i < view->corridor_count; ++i) {
+        if (!dg_metadata_binary_id_in_range(view->corridors[i].from_room_id, view->room_count) ||
+            !dg_metadata_binary_id_in_range(view->corridors[i].to_room_id, view->room_count)) {
+            return false;
+        }
+    }
+    for (i = 0; i < view->room_entrance_count; ++i) {
+        if (!dg_metadata_binary_id_in_range(view->room_entrances[i].room_id, view->room_count)) {
+            return false;
+        }
+    }
+    for (i = 0; i < view->room_neighbor_count; ++i) {
+        const dg_metadata_binary_room_neighbor_t *neighbor = &view->room_neighbors[i];
+
+        if (!dg_metadata_binary_id_in_range(neighbor->room_id, view->room_count) ||
+            !dg_metadata_binary_id_in_range(neighbor->corridor_index, view->corridor_count)) {
+            return false;
+        }
+    }
+
+    if (view->room_adjacency_count > 0u && view->room_adjacency_count != view->room_count) {
+        return false;
+    }
+    running_index = 0u;
+    for (i = 0; i < view->room_adjacency_count; ++i) {
+        const dg_metadata_binary_room_adjacency_t *span = &view->room_adjacency[i];
+
+        if (span->start_index != running_index ||
+            span->count > view->room_neighbor_count - running_index) {
+            return false;
+        }
+        running_index += span->count;
+    }
+    return true;
+}
+
+dg_status_t dg_metadata_binary_view_init(
+    const void *data,
+    size_t size,
+    dg_metadata_binary_view_t *out_view
+)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    const dg_metadata_binary_header_t *header;
+    const dg_metadata_binary_section_t *table;
+    uint32_t i;
+
+    if (out_view == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    memset(out_view, 0, sizeof(*out_view));
+
+    if (data == NULL || ((uintptr_t)data % DG_METADATA_BINARY_ALIGNMENT) != 0u) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    if (!dg_metadata_binary_host_is_little_endian()) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+    if (size < sizeof(dg_metadata_binary_header_t) ||
+        memcmp(bytes, DG_METADATA_BINARY_MAGIC, sizeof(DG_METADATA_BINARY_MAGIC)) != 0) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    header = (const dg_metadata_binary_header_t *)data;
+    if (header->version != DG_METADATA_BINARY_VERSION ||
+        header->header_size < sizeof(dg_metadata_binary_header_t) ||
+        header->total_size > (uint64_t)size ||
+        header->section_table_offset % DG_METADATA_BINARY_ALIGNMENT != 0u ||
+        header->section_table_offset > header->total_size ||
+        (uint64_t)header->section_count >
+            (header->total_size - header->section_table_offset) /
+                sizeof(dg_metadata_binary_section_t)) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    table = (const dg_metadata_binary_section_t *)(bytes + header->section_table_offset);
+    for (i = 0; i < header->section_count; ++i) {
+        const dg_metadata_binary_section_t *section = &table[i];
+        size_t expected_size = dg_metadata_binary_record_size(section->id);
+        const void *records;
+        size_t count;
+
+        if (expected_size == 0u) {
+            continue;
+        }
+        if (section->record_size != expected_size ||
+            section->offset % DG_METADATA_BINARY_ALIGNMENT != 0u ||
+            section->offset > header->total_size ||
+            section->count > (header->total_size - section->offset) / expected_size ||
+            section->count > (uint64_t)SIZE_MAX) {
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        count = (size_t)section->count;
+        records = (count > 0u) ? (const void *)(bytes + section->offset) : NULL;
+        switch ((dg_metadata_binary_section_id_t)section->id) {
+        case DG_METADATA_BINARY_SECTION_ROOMS:
+            out_view->rooms = (const dg_metadata_binary_room_t *)records;
+            out_view->room_count = count;
+            break;
+        case DG_METADATA_BINARY_SECTION_CORRIDORS:
+            out_view->corridors = (const dg_metadata_binary_corridor_t *)records;
+            out_view->corridor_count = count;
+            break;
+        case DG_METADATA_BINARY_SECTION_ROOM_ENTRANCES:
+            out_view->room_entrances = (const dg_metadata_binary_room_entrance_t *)records;
+            out_view->room_entrance_count = count;
+            break;
+        case DG_METADATA_BINARY_SECTION_EDGE_OPENINGS:
+            out_view->edge_openings = (const dg_metadata_binary_edge_opening_t *)records;
+            out_view->edge_opening_count = count;
+            break;
+        case DG_METADATA_BINARY_SECTION_ROOM_ADJACENCY:
+            out_view->room_adjacency = (const dg_metadata_binary_room_adjacency_t *)records;
+            out_view->room_adjacency_count = count;
+            break;
+        case DG_METADATA_BINARY_SECTION_ROOM_NEIGHBORS:
+            out_view->room_neighbors = (const dg_metadata_binary_room_neighbor_t *)records;
+            out_view->room_neighbor_count = count;
+            break;
+        case DG_METADATA_BINARY_SECTION_ROOM_TYPE_QUOTAS:
+            out_view->room_type_quotas = (const dg_metadata_binary_room_type_quota_t *)records;
+            out_view->room_type_quota_count = count;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!dg_metadata_binary_view_is_consistent(out_view)) {
+        memset(out_view, 0, sizeof(*out_view));
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    out_view->header = header;
+    return DG_STATUS_OK;
+}
@@ -0,0 +1,341 @@
+#include "io_internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Row run-length tile codec. Each row is coded on its own as a sequence of
+ * tokens, and no token crosses a row boundary:
+ *
+ *   run      1ttlllll           `tt` tile, `lllll` length - 1; a length
+ *                               field of 31 is followed by a LEB128 varint
+ *                               holding length - 32
+ *   literal  0nnnnnnn + bytes   `nnnnnnn` count - 1 (1..128), then the tiles
+ *                               packed 2 bits each, least significant first
+ *
+ * Standalone streams (dg_map_encode_tiles) prefix the tokens with magic
+ * "DGTL", i32 width and i32 height; baked maps store the bare tokens since
+ * the header already carries the dimensions.
+ */
+static const unsigned char DG_TILE_STREAM_MAGIC[4] = {'D', 'G', 'T', 'L'};
+
+#define DG_TILE_STREAM_HEADER_SIZE 12u
+#define DG_TILE_RUN_FLAG 0x80u
+#define DG_TILE_RUN_SHORT_MAX 31u
+#define DG_TILE_LITERAL_MAX 128u
+/* Shorter repeats are cheaper to leave inside a literal. */
+#define DG_TILE_RUN_MIN 4
+
+/* Tokens are staged here so the writer is called once per few hundred bytes. */
+typedef struct dg_tile_encoder {
+    dg_io_writer_t *writer;
+    unsigned char buffer[512];
+    size_t used;
+    dg_status_t status;
+} dg_tile_encoder_t;
+
+static void dg_tile_encoder_flush(dg_tile_encoder_t *encoder)
+{
+    if (encoder->status == DG_STATUS_OK && encoder->used > 0) {
+        encoder->status = dg_write_exact(encoder->writer, encoder->buffer, encoder->used);
+    }
+    encoder->used = 0;
+}
+
+/* Makes room for one token: a full literal is 33 bytes, a run at most 11. */
+static unsigned char *dg_tile_encoder_reserve(dg_tile_encoder_t *encoder)
+{
+    if (encoder->used + 1u + DG_TILE_LITERAL_MAX / 4u > sizeof(encoder->buffer)) {
+        dg_tile_encoder_flush(encoder);
+    }
+    return encoder->buffer + encoder->used;
+}
+
+static void dg_tile_encoder_literal(
+    dg_tile_encoder_t *encoder,
+    const dg_tile_t *tiles,
+    size_t count
+)
+{
+    unsigned char *out;
+    size_t i;
+
+    out = dg_tile_encoder_reserve(encoder);
+    out[0] = (unsigned char)(count - 1u);
+    memset(out + 1, 0, (count + 3u) / 4u);
+    for (i = 0; i < count; ++i) {
+        out[1u + (i >> 2)] |= (unsigned char)(((unsigned int)tiles[i] & 0x3u) << ((i & 3u) * 2u));
+    }
+    encoder->used += 1u + (count + 3u) / 4u;
+}
+
+static void dg_tile_encoder_run(dg_tile_encoder_t *encoder, dg_tile_t tile, size_t length)
+{
+    unsigned char *out;
+    size_t extra;
+    size_t used;
+
+    out = dg_tile_encoder_reserve(encoder);
+    if (length - 1u < DG_TILE_RUN_SHORT_MAX) {
+        out[0] = (unsigned char)(DG_TILE_RUN_FLAG | ((unsigned int)tile << 5) | (length - 1u));
+        encoder->used += 1u;
+        return;
+    }
+
+    out[0] = (unsigned char)(DG_TILE_RUN_FLAG | ((unsigned int)tile << 5) | DG_TILE_RUN_SHORT_MAX);
+    used = 1u;
+    extra = length - (DG_TILE_RUN_SHORT_MAX + 1u);
+    while (extra >= 0x80u) {
+        out[used++] = (unsigned char)((extra & 0x7Fu) | 0x80u);
+        extra >>= 7;
+    }
+    out[used++] = (unsigned char)extra;
+    encoder->used += used;
+}
+
+static void dg_tile_encoder_row(dg_tile_encoder_t *encoder, const dg_tile_t *row, size_t width)
+{
+    size_t literal_start;
+    size_t x;
+
+    literal_start = 0;
+    x = 0;
+    while (x < width) {
+        size_t run_end = x + 1u;
+
+        while (run_end < width && row[run_end] == row[x]) {
+            run_end += 1u;
+        }
+
+        if (run_end - x < (size_t)DG_TILE_RUN_MIN) {
+            x = run_end;
+            while (x - literal_start >= DG_TILE_LITERAL_MAX) {
+                dg_tile_encoder_literal(encoder, row + literal_start, DG_TILE_LITERAL_MAX);
+                literal_start += DG_TILE_LITERAL_MAX;
+            }
+            continue;
+        }
+
+        if (x > literal_start) {
+            dg_tile_encoder_literal(encoder, row + literal_start, x - literal_start);
+        }
+        dg_tile_encoder_run(encoder, row[x], run_end - x);
+        x = run_end;
+        literal_start = run_end;
+    }
+
+    if (width > literal_start) {
+        dg_tile_encoder_literal(encoder, row + literal_start, width - literal_start);
+    }
+}
+
+dg_status_t dg_write_tile_runs(
+    dg_io_writer_t *writer,
+    const dg_tile_t *tiles,
+    int width,
+    int height
+)
+{
+    dg_tile_encoder_t encoder;
+    int y;
+
+    if (writer == NULL || tiles == NULL || width <= 0 || height <= 0) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    encoder.writer = writer;
+    encoder.used = 0;
+    encoder.status = DG_STATUS_OK;
+    for (y = 0; y < height && encoder.status == DG_STATUS_OK; ++y) {
+        dg_tile_encoder_row(&encoder, tiles + (size_t)y * (size_t)width, (size_t)width);
+    }
+    dg_tile_encoder_flush(&encoder);
+    return encoder.status;
+}
+
+dg_status_t dg_read_tile_runs(
+    const unsigned char *data,
+    size_t size,
+    dg_tile_t *tiles,
+    int width,
+    int height
+)
+{
+    const unsigned char *cursor;
+    const unsigned char *end;
+    size_t row_width;
+    int y;
+
+    if (data == NULL || tiles == NULL || width <= 0 || height <= 0) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    cursor = data;
+    end = data + size;
+    row_width = (size_t)width;
+    for (y = 0; y < height; ++y) {
+        dg_tile_t *out = tiles + (size_t)y * row_width;
+        size_t remaining = row_width;
+
+        while (remaining > 0) {
+            unsigned int token;
+            size_t length;
+            size_t i;
+
+            if (cursor == end) {
+                return DG_STATUS_UNSUPPORTED_FORMAT;
+            }
+            token = *cursor++;
+
+            if ((token & DG_TILE_RUN_FLAG) != 0u) {
+                dg_tile_t tile = (dg_tile_t)((token >> 5) & 0x3u);
+
+                length = (size_t)(token & DG_TILE_RUN_SHORT_MAX) + 1u;
+                if (length == DG_TILE_RUN_SHORT_MAX + 1u) {
+                    size_t extra = 0;
+                    unsigned int shift = 0;
+                    unsigned int byte;
+
+                    /* Any valid extra is below the row width, which fits in 31 bits. */
+                    do {
+                        if (cursor == end || shift > 28u) {
+                            return DG_STATUS_UNSUPPORTED_FORMAT;
+                        }
+                        byte = *cursor++;
+                        extra |= (size_t)(byte & 0x7Fu) << shift;
+                        shift += 7u;
+                    } while ((byte & 0x80u) != 0u);
+                    if (extra > remaining) {
+                        return DG_STATUS_UNSUPPORTED_FORMAT;
+                    }
+                    length += extra;
+                }
+                if (length > remaining) {
+                    return DG_STATUS_UNSUPPORTED_FORMAT;
+                }
+                for (i = 0; i < length; ++i) {
+                    out[i] = tile;
+                }
+            } else {
+                size_t full_bytes;
+
+                length = (size_t)token + 1u;
+                if (length > remaining || (size_t)(end - cursor) < (length + 3u) / 4u) {
+                    return DG_STATUS_UNSUPPORTED_FORMAT;
+                }
+
+                /* Whole bytes first, then the tail of a partial one. */
+                full_bytes = length / 4u;
+                for (i = 0; i < full_bytes; ++i) {
+                    unsigned int byte = cursor[i];
+
+                    out[i * 4u] = (dg_tile_t)(byte & 0x3u);
+                    out[i * 4u + 1u] = (dg_tile_t)((byte >> 2) & 0x3u);
+                    out[i * 4u + 2u] = (dg_tile_t)((byte >> 4) & 0x3u);
+                    out[i * 4u + 3u] = (dg_tile_t)(byte >> 6);
+                }
+                for (i = full_bytes * 4u; i < length; ++i) {
+                    out[i] = (dg_tile_t)((cursor[i >> 2] >> ((i & 3u) * 2u)) & 0x3u);
+                }
+                cursor += (length + 3u) / 4u;
+            }
+
+            out += length;
+            remaining -= length;
+        }
+    }
+
+    return (cursor == end) ? DG_STATUS_OK : DG_STATUS_UNSUPPORTED_FORMAT;
+}
+
+dg_status_t dg_map_encode_tiles(const dg_map_t *map, void **out_data, size_t *out_size)
+{
+    dg_io_writer_t writer;
+    size_t cell_count;
+    size_t i;
+    dg_status_t status;
+
+    if (out_data == NULL || out_size == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    *out_data = NULL;
+    *out_size = 0;
+
+    if (map == NULL || map->tiles == NULL || map->width <= 0 || map->height <= 0) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    cell_count = (size_t)map->width * (size_t)map->height;
+    for (i = 0; i < cell_count; ++i) {
+        if ((int)map->tiles[i] < (int)DG_TILE_VOID || (int)map->tiles[i] > (int)DG_TILE_DOOR) {
+            return DG_STATUS_INVALID_ARGUMENT;
+        }
+    }
+
+    writer = (dg_io_writer_t){0};
+    status = dg_write_exact(&writer, DG_TILE_STREAM_MAGIC, sizeof(DG_TILE_STREAM_MAGIC));
+    if (status == DG_STATUS_OK) {
+        status = dg_write_i32(&writer, (int32_t)map->width);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_i32(&writer, (int32_t)map->height);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_tile_runs(&writer, map->tiles, map->width, map->height);
+    }
+    if (status != DG_STATUS_OK) {
+        free(writer.data);
+        return status;
+    }
+
+    *out_data = writer.data;
+    *out_size = writer.size;
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_map_decode_tiles(const void *data, size_t size, dg_map_t *out_map)
+{
+    dg_io_reader_t reader;
+    unsigned char magic[4];
+    int32_t width;
+    int32_t height;
+    dg_status_t status;
+
+    if (data == NULL || out_map == NULL || !dg_map_is_empty(out_map)) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    reader = (dg_io_reader_t){0};
+    reader.data = (const unsigned char *)data;
+    reader.size = size;
+    if (dg_read_exact(&reader, magic, sizeof(magic)) != DG_STATUS_OK ||
+        memcmp(magic, DG_TILE_STREAM_MAGIC, sizeof(magic)) != 0 ||
+        dg_read_i32(&reader, &width) != DG_STATUS_OK ||
+        dg_read_i32(&reader, &height) != DG_STATUS_OK ||
+        width <= 0 || height <= 0) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    /* Every row takes at least one token byte; reject before allocating. */
+    if (size - DG_TILE_STREAM_HEADER_SIZE < (size_t)height) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    status = dg_map_init(out_map, (int)width, (int)height, DG_TILE_VOID);
+    if (status != DG_STATUS_OK) {
+        return (status == DG_STATUS_INVALID_ARGUMENT) ? DG_STATUS_UNSUPPORTED_FORMAT : status;
+    }
+
+    status = dg_read_tile_runs(
+        reader.data + reader.offset,
+        reader.size - reader.offset,
+        out_map->tiles,
+        out_map->width,
+        out_map->height
+    );
+    if (status != DG_STATUS_OK) {
+        dg_map_destroy(out_map);
+    }
+    return status;
+}
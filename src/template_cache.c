@@ -0,0 +1,984 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "io_internal.h"
+#include "generator/internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(DG_HAVE_PTHREADS)
+#include <pthread.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+/*
+ * Process-wide room template cache. Entries are keyed by path plus a 64-bit
+ * FNV-1a hash and size of the file bytes, so an edited file is reloaded on
+ * its next use. The table owns one reference to each entry and every
+ * acquirer owns another; an entry replaced or invalidated while a
+ * generation still holds it is freed on the last release.
+ *
+ * A path of the form "<pack>#<member>" names a member of a template pack.
+ * Packs are read, indexed and hashed once, then shared the same way as
+ * entries: the table owns one reference and each acquire that is parsing a
+ * member holds another, so member bytes outlive a concurrent invalidate.
+ * Member entries are keyed by the full "<pack>#<member>" path.
+ *
+ * Size variants are blocks keyed by bucket (width, height), kept sorted so
+ * lookups are a binary search. Each is generated on first use (or by
+ * dg_template_cache_prepare_variants) and published once; a variant depends
+ * only on the template and its bucket, so whichever thread publishes first
+ * stores the same tiles. Published variants stay valid while the entry is
+ * held.
+ */
+#define DG_TEMPLATE_CACHE_MAX_VARIANT_SIZES 64u
+#define DG_TEMPLATE_CACHE_MAX_VARIANTS 4096u
+
+typedef struct dg_template_variant {
+    int width;
+    int height;
+    dg_map_t map;
+} dg_template_variant_t;
+
+struct dg_cached_template {
+    char *path;
+    uint64_t hash;
+    size_t size;
+    size_t refcount;
+    dg_map_t map;
+    dg_template_variant_t **variants;
+    size_t variant_count;
+};
+
+typedef struct dg_cached_pack {
+    char *path;
+    unsigned char *data;
+    size_t size;
+    dg_template_pack_entry_t *entries;
+    uint64_t *hashes;
+    size_t entry_count;
+    size_t refcount;
+} dg_cached_pack_t;
+
+static dg_cached_template_t **dg_template_cache_entries = NULL;
+static size_t dg_template_cache_count = 0;
+static size_t dg_template_cache_capacity = 0;
+static size_t dg_template_cache_hits = 0;
+static size_t dg_template_cache_misses = 0;
+static dg_cached_pack_t **dg_template_cache_packs = NULL;
+static size_t dg_template_cache_pack_count = 0;
+static size_t dg_template_cache_pack_capacity = 0;
+
+/* Builds with neither pthreads nor Win32 have no lock and must not share the cache. */
+#if defined(DG_HAVE_PTHREADS)
+static pthread_mutex_t dg_template_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#elif defined(_WIN32)
+static SRWLOCK dg_template_cache_srwlock = SRWLOCK_INIT;
+#endif
+
+static void dg_template_cache_lock(void)
+{
+#if defined(DG_HAVE_PTHREADS)
+    (void)pthread_mutex_lock(&dg_template_cache_mutex);
+#elif defined(_WIN32)
+    AcquireSRWLockExclusive(&dg_template_cache_srwlock);
+#endif
+}
+
+static void dg_template_cache_unlock(void)
+{
+#if defined(DG_HAVE_PTHREADS)
+    (void)pthread_mutex_unlock(&dg_template_cache_mutex);
+#elif defined(_WIN32)
+    ReleaseSRWLockExclusive(&dg_template_cache_srwlock);
+#endif
+}
+
+static uint64_t dg_template_cache_hash(const unsigned char *data, size_t size)
+{
+    uint64_t hash = 1469598103934665603ull;
+    size_t i;
+
+    for (i = 0; i < size; ++i) {
+        hash ^= (uint64_t)data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static void dg_template_cache_free_entry(dg_cached_template_t *entry)
+{
+    size_t i;
+
+    if (entry == NULL) {
+        return;
+    }
+    for (i = 0; i < entry->variant_count; ++i) {
+        dg_map_destroy(&entry->variants[i]->map);
+        free(entry->variants[i]);
+    }
+    free(entry->variants);
+    dg_map_destroy(&entry->map);
+    free(entry->path);
+    free(entry);
+}
+
+/* Returns the entry to free once the lock is dropped, or NULL. */
+static dg_cached_template_t *dg_template_cache_unref_locked(dg_cached_template_t *entry)
+{
+    entry->refcount -= 1u;
+    return (entry->refcount == 0u) ? entry : NULL;
+}
+
+static size_t dg_template_cache_find_locked(const char *path)
+{
+    size_t i;
+
+    for (i = 0; i < dg_template_cache_count; ++i) {
+        if (strcmp(dg_template_cache_entries[i]->path, path) == 0) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+static dg_cached_template_t *dg_template_cache_remove_locked(size_t index)
+{
+    dg_cached_template_t *entry = dg_template_cache_entries[index];
+
+    dg_template_cache_entries[index] = dg_template_cache_entries[dg_template_cache_count - 1u];
+    dg_template_cache_count -= 1u;
+    return dg_template_cache_unref_locked(entry);
+}
+
+static dg_cached_template_t *dg_template_cache_lookup_locked(
+    const char *path,
+    uint64_t hash,
+    size_t size
+)
+{
+    size_t index = dg_template_cache_find_locked(path);
+    dg_cached_template_t *entry;
+
+    if (index == SIZE_MAX) {
+        return NULL;
+    }
+    entry = dg_template_cache_entries[index];
+    if (entry->hash != hash || entry->size != size) {
+        return NULL;
+    }
+    entry->refcount += 1u;
+    return entry;
+}
+
+/*
+ * Publishes a freshly loaded entry, replacing a stale one for the same path.
+ * Returns the entry the table no longer references and nobody holds, if any.
+ */
+static dg_status_t dg_template_cache_insert_locked(
+    dg_cached_template_t *entry,
+    dg_cached_template_t **out_stale
+)
+{
+    size_t index;
+
+    *out_stale = NULL;
+    index = dg_template_cache_find_locked(entry->path);
+    if (index != SIZE_MAX) {
+        *out_stale = dg_template_cache_remove_locked(index);
+    }
+
+    if (dg_template_cache_count == dg_template_cache_capacity) {
+        size_t new_capacity = (dg_template_cache_capacity == 0u)
+                                  ? 16u
+                                  : dg_template_cache_capacity * 2u;
+        dg_cached_template_t **grown;
+
+        if (new_capacity > SIZE_MAX / sizeof(*grown)) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+        grown = (dg_cached_template_t **)realloc(
+            dg_template_cache_entries,
+            new_capacity * sizeof(*grown)
+        );
+        if (grown == NULL) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+        dg_template_cache_entries = grown;
+        dg_template_cache_capacity = new_capacity;
+    }
+
+    dg_template_cache_entries[dg_template_cache_count] = entry;
+    dg_template_cache_count += 1u;
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_template_cache_load_entry(
+    const char *path,
+    const unsigned char *data,
+    size_t size,
+    uint64_t hash,
+    dg_cached_template_t **out_entry
+)
+{
+    dg_cached_template_t *entry;
+    size_t path_length;
+    dg_status_t status;
+
+    *out_entry = NULL;
+    entry = (dg_cached_template_t *)calloc(1u, sizeof(*entry));
+    if (entry == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    path_length = strlen(path);
+    entry->path = (char *)malloc(path_length + 1u);
+    if (entry->path == NULL) {
+        free(entry);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+    memcpy(entry->path, path, path_length + 1u);
+    entry->hash = hash;
+    entry->size = size;
+
+    status = dg_load_map_from_memory(data, size, &entry->map);
+    if (status != DG_STATUS_OK) {
+        dg_template_cache_free_entry(entry);
+        return status;
+    }
+
+    *out_entry = entry;
+    return DG_STATUS_OK;
+}
+
+/* Shared tail of file and pack member acquires, given the template bytes. */
+static dg_status_t dg_template_cache_acquire_bytes(
+    const char *path,
+    const unsigned char *data,
+    size_t size,
+    uint64_t hash,
+    dg_cached_template_t **out_entry,
+    const dg_map_t **out_map
+)
+{
+    dg_cached_template_t *entry;
+    dg_cached_template_t *existing;
+    dg_cached_template_t *stale;
+    dg_status_t status;
+
+    dg_template_cache_lock();
+    existing = dg_template_cache_lookup_locked(path, hash, size);
+    if (existing != NULL) {
+        dg_template_cache_hits += 1u;
+    }
+    dg_template_cache_unlock();
+    if (existing != NULL) {
+        *out_entry = existing;
+        *out_map = &existing->map;
+        return DG_STATUS_OK;
+    }
+
+    /* Load outside the lock; templates can take a while to regenerate. */
+    status = dg_template_cache_load_entry(path, data, size, hash, &entry);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    stale = NULL;
+    dg_template_cache_lock();
+    /* Another thread may have loaded the same bytes in the meantime. */
+    existing = dg_template_cache_lookup_locked(path, hash, size);
+    if (existing == NULL) {
+        entry->refcount = 2u;
+        status = dg_template_cache_insert_locked(entry, &stale);
+        if (status == DG_STATUS_OK) {
+            dg_template_cache_misses += 1u;
+        }
+    } else {
+        dg_template_cache_hits += 1u;
+    }
+    dg_template_cache_unlock();
+
+    dg_template_cache_free_entry(stale);
+    if (existing != NULL || status != DG_STATUS_OK) {
+        dg_template_cache_free_entry(entry);
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+        entry = existing;
+    }
+
+    *out_entry = entry;
+    *out_map = &entry->map;
+    return DG_STATUS_OK;
+}
+
+static void dg_template_cache_free_pack(dg_cached_pack_t *pack)
+{
+    if (pack == NULL) {
+        return;
+    }
+    free(pack->hashes);
+    free(pack->entries);
+    free(pack->data);
+    free(pack->path);
+    free(pack);
+}
+
+/* Returns the pack to free once the lock is dropped, or NULL. */
+static dg_cached_pack_t *dg_template_cache_unref_pack_locked(dg_cached_pack_t *pack)
+{
+    pack->refcount -= 1u;
+    return (pack->refcount == 0u) ? pack : NULL;
+}
+
+static size_t dg_template_cache_find_pack_locked(const char *path)
+{
+    size_t i;
+
+    for (i = 0; i < dg_template_cache_pack_count; ++i) {
+        if (strcmp(dg_template_cache_packs[i]->path, path) == 0) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+static dg_status_t dg_template_cache_insert_pack_locked(dg_cached_pack_t *pack)
+{
+    if (dg_template_cache_pack_count == dg_template_cache_pack_capacity) {
+        size_t new_capacity = (dg_template_cache_pack_capacity == 0u)
+                                  ? 4u
+                                  : dg_template_cache_pack_capacity * 2u;
+        dg_cached_pack_t **grown;
+
+        if (new_capacity > SIZE_MAX / sizeof(*grown)) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+        grown = (dg_cached_pack_t **)realloc(
+            dg_template_cache_packs,
+            new_capacity * sizeof(*grown)
+        );
+        if (grown == NULL) {
+            return DG_STATUS_ALLOCATION_FAILED;
+        }
+        dg_template_cache_packs = grown;
+        dg_template_cache_pack_capacity = new_capacity;
+    }
+
+    dg_template_cache_packs[dg_template_cache_pack_count] = pack;
+    dg_template_cache_pack_count += 1u;
+    return DG_STATUS_OK;
+}
+
+static dg_status_t dg_template_cache_load_pack(const char *path, dg_cached_pack_t **out_pack)
+{
+    dg_cached_pack_t *pack;
+    size_t path_length;
+    size_t i;
+    dg_status_t status;
+
+    *out_pack = NULL;
+    pack = (dg_cached_pack_t *)calloc(1u, sizeof(*pack));
+    if (pack == NULL) {
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+
+    path_length = strlen(path);
+    pack->path = (char *)malloc(path_length + 1u);
+    if (pack->path == NULL) {
+        free(pack);
+        return DG_STATUS_ALLOCATION_FAILED;
+    }
+    memcpy(pack->path, path, path_length + 1u);
+
+    status = dg_read_file_contents(path, &pack->data, &pack->size);
+    if (status == DG_STATUS_OK) {
+        status = dg_template_pack_parse(
+            pack->data,
+            pack->size,
+            &pack->entries,
+            &pack->entry_count
+        );
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_allocate_array(
+            (void **)&pack->hashes,
+            pack->entry_count,
+            sizeof(*pack->hashes)
+        );
+    }
+    if (status != DG_STATUS_OK) {
+        dg_template_cache_free_pack(pack);
+        return status;
+    }
+    for (i = 0; i < pack->entry_count; ++i) {
+        pack->hashes[i] = dg_template_cache_hash(pack->entries[i].data, pack->entries[i].size);
+    }
+
+    *out_pack = pack;
+    return DG_STATUS_OK;
+}
+
+/* Returns a held reference to the pack at `path`, reading it on first use. */
+static dg_status_t dg_template_cache_acquire_pack(const char *path, dg_cached_pack_t **out_pack)
+{
+    dg_cached_pack_t *pack;
+    dg_cached_pack_t *existing;
+    size_t index;
+    dg_status_t status;
+
+    *out_pack = NULL;
+    dg_template_cache_lock();
+    index = dg_template_cache_find_pack_locked(path);
+    existing = (index != SIZE_MAX) ? dg_template_cache_packs[index] : NULL;
+    if (existing != NULL) {
+        existing->refcount += 1u;
+    }
+    dg_template_cache_unlock();
+    if (existing != NULL) {
+        *out_pack = existing;
+        return DG_STATUS_OK;
+    }
+
+    status = dg_template_cache_load_pack(path, &pack);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    dg_template_cache_lock();
+    index = dg_template_cache_find_pack_locked(path);
+    if (index == SIZE_MAX) {
+        pack->refcount = 2u;
+        status = dg_template_cache_insert_pack_locked(pack);
+    } else {
+        existing = dg_template_cache_packs[index];
+        existing->refcount += 1u;
+    }
+    dg_template_cache_unlock();
+
+    if (existing != NULL || status != DG_STATUS_OK) {
+        dg_template_cache_free_pack(pack);
+        if (status != DG_STATUS_OK) {
+            return status;
+        }
+        pack = existing;
+    }
+
+    *out_pack = pack;
+    return DG_STATUS_OK;
+}
+
+static void dg_template_cache_release_pack(dg_cached_pack_t *pack)
+{
+    dg_cached_pack_t *released;
+
+    dg_template_cache_lock();
+    released = dg_template_cache_unref_pack_locked(pack);
+    dg_template_cache_unlock();
+    dg_template_cache_free_pack(released);
+}
+
+static dg_status_t dg_template_cache_acquire_pack_member(
+    const char *path,
+    const char *separator,
+    dg_cached_template_t **out_entry,
+    const dg_map_t **out_map
+)
+{
+    char pack_path[DG_ROOM_TEMPLATE_PATH_MAX];
+    size_t pack_path_length;
+    dg_cached_pack_t *pack;
+    const dg_template_pack_entry_t *member;
+    dg_status_t status;
+
+    pack_path_length = (size_t)(separator - path);
+    if (pack_path_length == 0u || pack_path_length >= sizeof(pack_path) ||
+        separator[1] == '\0') {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    memcpy(pack_path, path, pack_path_length);
+    pack_path[pack_path_length] = '\0';
+
+    status = dg_template_cache_acquire_pack(pack_path, &pack);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    member = dg_template_pack_find(pack->entries, pack->entry_count, separator + 1);
+    if (member == NULL) {
+        status = DG_STATUS_IO_ERROR;
+    } else {
+        status = dg_template_cache_acquire_bytes(
+            path,
+            member->data,
+            member->size,
+            pack->hashes[member - pack->entries],
+            out_entry,
+            out_map
+        );
+    }
+
+    dg_template_cache_release_pack(pack);
+    return status;
+}
+
+dg_status_t dg_template_cache_acquire(
+    const char *path,
+    dg_cached_template_t **out_entry,
+    const dg_map_t **out_map
+)
+{
+    const char *separator;
+    unsigned char *data;
+    size_t size;
+    dg_status_t status;
+
+    if (path == NULL || out_entry == NULL || out_map == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    *out_entry = NULL;
+    *out_map = NULL;
+
+    /* Member names never contain '#', so the last one ends the pack path. */
+    separator = strrchr(path, '#');
+    if (separator != NULL) {
+        return dg_template_cache_acquire_pack_member(path, separator, out_entry, out_map);
+    }
+
+    /* The bytes are always read so edits are noticed; only parsing is cached. */
+    status = dg_read_file_contents(path, &data, &size);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    status = dg_template_cache_acquire_bytes(
+        path,
+        data,
+        size,
+        dg_template_cache_hash(data, size),
+        out_entry,
+        out_map
+    );
+    free(data);
+    return status;
+}
+
+void dg_template_cache_release(dg_cached_template_t *entry)
+{
+    dg_cached_template_t *released;
+
+    if (entry == NULL) {
+        return;
+    }
+
+    dg_template_cache_lock();
+    released = dg_template_cache_unref_locked(entry);
+    dg_template_cache_unlock();
+    dg_template_cache_free_entry(released);
+}
+
+dg_status_t dg_template_cache_preload(const char *path)
+{
+    dg_cached_template_t *entry;
+    const dg_map_t *map;
+    dg_status_t status;
+
+    status = dg_template_cache_acquire(path, &entry, &map);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+    dg_template_cache_release(entry);
+    return DG_STATUS_OK;
+}
+
+/* True for `path` itself and for members of a pack stored at `path`. */
+static bool dg_template_cache_path_matches(const char *entry_path, const char *path)
+{
+    size_t length = strlen(path);
+
+    return strncmp(entry_path, path, length) == 0 &&
+           (entry_path[length] == '\0' || entry_path[length] == '#');
+}
+
+void dg_template_cache_invalidate(const char *path)
+{
+    dg_cached_template_t **released;
+    dg_cached_pack_t **released_packs;
+    size_t released_count;
+    size_t released_pack_count;
+    size_t index;
+    size_t i;
+    bool removed;
+
+    if (path != NULL) {
+        dg_cached_pack_t *pack = NULL;
+
+        dg_template_cache_lock();
+        index = dg_template_cache_find_pack_locked(path);
+        if (index != SIZE_MAX) {
+            pack = dg_template_cache_unref_pack_locked(dg_template_cache_packs[index]);
+            dg_template_cache_packs[index] =
+                dg_template_cache_packs[dg_template_cache_pack_count - 1u];
+            dg_template_cache_pack_count -= 1u;
+        }
+        dg_template_cache_unlock();
+        dg_template_cache_free_pack(pack);
+
+        /* One entry per pass, so nothing is freed while the lock is held. */
+        do {
+            dg_cached_template_t *entry = NULL;
+
+            removed = false;
+            dg_template_cache_lock();
+            for (index = 0; index < dg_template_cache_count; ++index) {
+                if (dg_template_cache_path_matches(dg_template_cache_entries[index]->path, path)) {
+                    entry = dg_template_cache_remove_locked(index);
+                    removed = true;
+                    break;
+                }
+            }
+            dg_template_cache_unlock();
+            dg_template_cache_free_entry(entry);
+        } while (removed);
+        return;
+    }
+
+    /* Hand the whole tables over and free whatever nobody else holds. */
+    dg_template_cache_lock();
+    released = dg_template_cache_entries;
+    released_count = dg_template_cache_count;
+    for (i = 0; i < released_count; ++i) {
+        released[i] = dg_template_cache_unref_locked(released[i]);
+    }
+    released_packs = dg_template_cache_packs;
+    released_pack_count = dg_template_cache_pack_count;
+    for (i = 0; i < released_pack_count; ++i) {
+        released_packs[i] = dg_template_cache_unref_pack_locked(released_packs[i]);
+    }
+    dg_template_cache_entries = NULL;
+    dg_template_cache_count = 0u;
+    dg_template_cache_capacity = 0u;
+    dg_template_cache_packs = NULL;
+    dg_template_cache_pack_count = 0u;
+    dg_template_cache_pack_capacity = 0u;
+    dg_template_cache_hits = 0u;
+    dg_template_cache_misses = 0u;
+    dg_template_cache_unlock();
+
+    for (i = 0; i < released_count; ++i) {
+        dg_template_cache_free_entry(released[i]);
+    }
+    free(released);
+    for (i = 0; i < released_pack_count; ++i) {
+        dg_template_cache_free_pack(released_packs[i]);
+    }
+    free(released_packs);
+}
+
+void dg_default_template_variant_options(dg_template_variant_options_t *options)
+{
+    if (options == NULL) {
+        return;
+    }
+
+    options->min_size = 4;
+    options->max_size = 32;
+    options->step = 4;
+}
+
+/* Index of the first variant not ordered before (width, height). */
+static size_t dg_template_cache_variant_slot_locked(
+    const dg_cached_template_t *entry,
+    int width,
+    int height
+)
+{
+    size_t low = 0u;
+    size_t high = entry->variant_count;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2u;
+        const dg_template_variant_t *variant = entry->variants[mid];
+
+        if (variant->width < width || (variant->width == width && variant->height < height)) {
+            low = mid + 1u;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static const dg_map_t *dg_template_cache_find_variant_locked(
+    const dg_cached_template_t *entry,
+    int width,
+    int height
+)
+{
+    size_t slot = dg_template_cache_variant_slot_locked(entry, width, height);
+
+    if (slot < entry->variant_count && entry->variants[slot]->width == width &&
+        entry->variants[slot]->height == height) {
+        return &entry->variants[slot]->map;
+    }
+    return NULL;
+}
+
+const dg_map_t *dg_template_cache_find_variant(
+    dg_cached_template_t *entry,
+    int width,
+    int height
+)
+{
+    const dg_map_t *found;
+
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    dg_template_cache_lock();
+    found = dg_template_cache_find_variant_locked(entry, width, height);
+    dg_template_cache_unlock();
+    return found;
+}
+
+const dg_map_t *dg_template_cache_publish_variant(
+    dg_cached_template_t *entry,
+    int width,
+    int height,
+    dg_map_t *variant
+)
+{
+    dg_template_variant_t *stored;
+    dg_template_variant_t **grown;
+    const dg_map_t *published;
+    size_t slot;
+
+    if (entry == NULL || variant == NULL || variant->tiles == NULL) {
+        return NULL;
+    }
+
+    stored = (dg_template_variant_t *)malloc(sizeof(*stored));
+    if (stored == NULL) {
+        return NULL;
+    }
+    stored->width = width;
+    stored->height = height;
+    stored->map = *variant;
+
+    dg_template_cache_lock();
+    published = dg_template_cache_find_variant_locked(entry, width, height);
+    if (published == NULL && entry->variant_count < DG_TEMPLATE_CACHE_MAX_VARIANTS) {
+        slot = dg_template_cache_variant_slot_locked(entry, width, height);
+        grown = (dg_template_variant_t **)realloc(
+            entry->variants,
+            (entry->variant_count + 1u) * sizeof(*grown)
+        );
+        if (grown != NULL) {
+            memmove(
+                &grown[slot + 1u],
+                &grown[slot],
+                (entry->variant_count - slot) * sizeof(*grown)
+            );
+            grown[slot] = stored;
+            entry->variants = grown;
+            entry->variant_count += 1u;
+            published = &stored->map;
+            stored = NULL;
+        }
+    }
+    dg_template_cache_unlock();
+
+    if (published == NULL) {
+        /* No room in the entry; the caller keeps its block. */
+        free(stored);
+        return NULL;
+    }
+    if (stored != NULL) {
+        /* Another thread published the same bucket first; the tiles match. */
+        dg_map_destroy(&stored->map);
+        free(stored);
+    }
+    *variant = (dg_map_t){0};
+    return published;
+}
+
+static bool dg_template_cache_variants_full(const dg_cached_template_t *entry)
+{
+    bool full;
+
+    dg_template_cache_lock();
+    full = entry->variant_count >= DG_TEMPLATE_CACHE_MAX_VARIANTS;
+    dg_template_cache_unlock();
+    return full;
+}
+
+typedef struct dg_template_variant_batch {
+    const dg_map_t *template_map;
+    const int *widths;
+    const int *heights;
+    dg_map_t *variants;
+    dg_status_t *statuses;
+} dg_template_variant_batch_t;
+
+static void dg_generate_template_variant_range(void *context, size_t begin, size_t end)
+{
+    dg_template_variant_batch_t *batch = (dg_template_variant_batch_t *)context;
+    size_t i;
+
+    for (i = begin; i < end; ++i) {
+        batch->statuses[i] = dg_generate_room_template_variant(
+            batch->template_map,
+            batch->widths[i],
+            batch->heights[i],
+            &batch->variants[i]
+        );
+    }
+}
+
+dg_status_t dg_template_cache_prepare_variants(
+    const char *path,
+    const dg_template_variant_options_t *options
+)
+{
+    dg_template_variant_batch_t batch;
+    dg_cached_template_t *entry;
+    const dg_map_t *map;
+    int *widths;
+    int *heights;
+    dg_map_t *variants;
+    dg_status_t *statuses;
+    int first_size;
+    int last_size;
+    size_t size_count;
+    size_t missing_count;
+    size_t i;
+    size_t j;
+    dg_status_t status;
+
+    if (path == NULL || options == NULL || options->min_size < 1 ||
+        options->max_size < options->min_size || options->step < 1) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    /* The buckets rooms sized min_size..max_size round to with this step. */
+    first_size = dg_template_variant_bucket_size(options->min_size, options->step);
+    last_size = dg_template_variant_bucket_size(options->max_size, options->step);
+    size_count = (size_t)((last_size - first_size) / options->step) + 1u;
+    if (size_count > DG_TEMPLATE_CACHE_MAX_VARIANT_SIZES) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dg_template_cache_acquire(path, &entry, &map);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    widths = NULL;
+    heights = NULL;
+    variants = NULL;
+    statuses = NULL;
+    status = dg_allocate_array((void **)&widths, size_count * size_count, sizeof(*widths));
+    if (status == DG_STATUS_OK) {
+        status = dg_allocate_array((void **)&heights, size_count * size_count, sizeof(*heights));
+    }
+    if (status != DG_STATUS_OK) {
+        free(widths);
+        dg_template_cache_release(entry);
+        return status;
+    }
+
+    /*
+     * Buckets already published (by generation or an earlier call) are kept.
+     * Buckets past the entry's cap are skipped rather than generated.
+     */
+    missing_count = 0u;
+    dg_template_cache_lock();
+    for (i = 0; i < size_count; ++i) {
+        for (j = 0; j < size_count; ++j) {
+            int width = first_size + (int)i * options->step;
+            int height = first_size + (int)j * options->step;
+
+            if (entry->variant_count + missing_count < DG_TEMPLATE_CACHE_MAX_VARIANTS &&
+                dg_template_cache_find_variant_locked(entry, width, height) == NULL) {
+                widths[missing_count] = width;
+                heights[missing_count] = height;
+                missing_count += 1u;
+            }
+        }
+    }
+    dg_template_cache_unlock();
+
+    status = dg_allocate_array((void **)&variants, missing_count, sizeof(*variants));
+    if (status == DG_STATUS_OK) {
+        status = dg_allocate_array((void **)&statuses, missing_count, sizeof(*statuses));
+    }
+    if (status != DG_STATUS_OK) {
+        free(variants);
+        free(heights);
+        free(widths);
+        dg_template_cache_release(entry);
+        return status;
+    }
+    for (i = 0; i < missing_count; ++i) {
+        variants[i] = (dg_map_t){0};
+    }
+
+    /* Variants are independent, so they generate across worker threads. */
+    batch.template_map = map;
+    batch.widths = widths;
+    batch.heights = heights;
+    batch.variants = variants;
+    batch.statuses = statuses;
+    dg_parallel_for(missing_count, 1u, dg_generate_template_variant_range, &batch);
+    for (i = 0; i < missing_count && status == DG_STATUS_OK; ++i) {
+        status = statuses[i];
+    }
+    for (i = 0; i < missing_count && status == DG_STATUS_OK; ++i) {
+        /* A table filled by a concurrent generation is not an error. */
+        if (dg_template_cache_publish_variant(entry, widths[i], heights[i], &variants[i]) ==
+                NULL &&
+            !dg_template_cache_variants_full(entry)) {
+            status = DG_STATUS_ALLOCATION_FAILED;
+        }
+    }
+
+    for (i = 0; i < missing_count; ++i) {
+        dg_map_destroy(&variants[i]);
+    }
+    free(statuses);
+    free(variants);
+    free(heights);
+    free(widths);
+    dg_template_cache_release(entry);
+    return status;
+}
+
+void dg_template_cache_get_stats(dg_template_cache_stats_t *out_stats)
+{
+    size_t i;
+
+    if (out_stats == NULL) {
+        return;
+    }
+
+    dg_template_cache_lock();
+    out_stats->entry_count = dg_template_cache_count;
+    out_stats->hit_count = dg_template_cache_hits;
+    out_stats->miss_count = dg_template_cache_misses;
+    out_stats->variant_count = 0u;
+    for (i = 0; i < dg_template_cache_count; ++i) {
+        const dg_cached_template_t *entry = dg_template_cache_entries[i];
+
+        out_stats->variant_count += entry->variant_count;
+    }
+    out_stats->pack_count = dg_template_cache_pack_count;
+    dg_template_cache_unlock();
+}
@@ -0,0 +1,354 @@
+#include "io_internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Template pack ("DGTP"): many template files behind one named index.
+ *
+ *   header   magic "DGTP", u32 version, u32 member count
+ *   index    per member: u32 name length, u64 offset, u64 size, name bytes;
+ *            sorted by name (bytewise), names unique
+ *   payload  each member's file bytes (DGCF config or baked map) at its
+ *            offset from the start of the pack
+ *
+ * Names are 1..DG_ROOM_TEMPLATE_PATH_MAX - 1 bytes with no NUL or '#'.
+ */
+static const unsigned char DG_TEMPLATE_PACK_MAGIC[4] = {'D', 'G', 'T', 'P'};
+
+#define DG_TEMPLATE_PACK_VERSION 1u
+#define DG_TEMPLATE_PACK_HEADER_SIZE 12u
+#define DG_TEMPLATE_PACK_RECORD_SIZE 20u
+
+static bool dg_template_pack_name_is_valid(const char *name, size_t length)
+{
+    size_t i;
+
+    if (length == 0u || length >= DG_ROOM_TEMPLATE_PATH_MAX) {
+        return false;
+    }
+    for (i = 0; i < length; ++i) {
+        if (name[i] == '\0' || name[i] == '#') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Bytewise order of two names that may not be NUL-terminated. */
+static int dg_template_pack_compare_names(
+    const char *a,
+    size_t a_length,
+    const char *b,
+    size_t b_length
+)
+{
+    int order = memcmp(a, b, (a_length < b_length) ? a_length : b_length);
+
+    if (order != 0) {
+        return order;
+    }
+    return (a_length < b_length) ? -1 : ((a_length > b_length) ? 1 : 0);
+}
+
+static int dg_template_pack_compare_members(const void *a, const void *b)
+{
+    const dg_template_pack_member_t *left = *(const dg_template_pack_member_t *const *)a;
+    const dg_template_pack_member_t *right = *(const dg_template_pack_member_t *const *)b;
+
+    return strcmp(left->name, right->name);
+}
+
+static dg_status_t dg_template_pack_encode_member(
+    const dg_template_pack_member_t *member,
+    dg_io_writer_t *out_payload
+)
+{
+    dg_baked_save_options_t options;
+    void *data;
+    size_t size;
+    dg_status_t status;
+
+    *out_payload = (dg_io_writer_t){0};
+    if (member->baked != 0) {
+        dg_default_baked_save_options(&options);
+        return dg_bake_map(member->map, &options, out_payload);
+    }
+
+    status = dg_map_save_config_to_allocated_buffer(member->map, &data, &size);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+    out_payload->data = (unsigned char *)data;
+    out_payload->size = size;
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_template_pack_save_to_allocated_buffer(
+    const dg_template_pack_member_t *members,
+    size_t member_count,
+    void **out_data,
+    size_t *out_size
+)
+{
+    const dg_template_pack_member_t **sorted;
+    dg_io_writer_t *payloads;
+    dg_io_writer_t writer;
+    uint64_t offset;
+    size_t i;
+    dg_status_t status;
+
+    if (out_data == NULL || out_size == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    *out_data = NULL;
+    *out_size = 0;
+
+    if ((member_count > 0u && members == NULL) || member_count > UINT32_MAX) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    for (i = 0; i < member_count; ++i) {
+        if (members[i].name == NULL || members[i].map == NULL ||
+            !dg_template_pack_name_is_valid(members[i].name, strlen(members[i].name))) {
+            return DG_STATUS_INVALID_ARGUMENT;
+        }
+    }
+
+    sorted = NULL;
+    payloads = NULL;
+    status = dg_allocate_array((void **)&sorted, member_count, sizeof(*sorted));
+    if (status == DG_STATUS_OK) {
+        status = dg_allocate_array((void **)&payloads, member_count, sizeof(*payloads));
+    }
+    if (status != DG_STATUS_OK) {
+        free(sorted);
+        return status;
+    }
+
+    for (i = 0; i < member_count; ++i) {
+        sorted[i] = &members[i];
+        payloads[i] = (dg_io_writer_t){0};
+    }
+    if (member_count > 1u) {
+        qsort((void *)sorted, member_count, sizeof(*sorted), dg_template_pack_compare_members);
+    }
+    for (i = 1; i < member_count; ++i) {
+        if (strcmp(sorted[i - 1u]->name, sorted[i]->name) == 0) {
+            free(payloads);
+            free(sorted);
+            return DG_STATUS_INVALID_ARGUMENT;
+        }
+    }
+
+    /* Encode every member first; the index needs their sizes. */
+    offset = DG_TEMPLATE_PACK_HEADER_SIZE;
+    for (i = 0; i < member_count; ++i) {
+        offset += DG_TEMPLATE_PACK_RECORD_SIZE + (uint64_t)strlen(sorted[i]->name);
+    }
+    for (i = 0; i < member_count && status == DG_STATUS_OK; ++i) {
+        status = dg_template_pack_encode_member(sorted[i], &payloads[i]);
+    }
+
+    writer = (dg_io_writer_t){0};
+    if (status == DG_STATUS_OK) {
+        status = dg_write_exact(&writer, DG_TEMPLATE_PACK_MAGIC, sizeof(DG_TEMPLATE_PACK_MAGIC));
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(&writer, DG_TEMPLATE_PACK_VERSION);
+    }
+    if (status == DG_STATUS_OK) {
+        status = dg_write_u32(&writer, (uint32_t)member_count);
+    }
+    for (i = 0; i < member_count && status == DG_STATUS_OK; ++i) {
+        size_t name_length = strlen(sorted[i]->name);
+
+        status = dg_write_u32(&writer, (uint32_t)name_length);
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u64(&writer, offset);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_u64(&writer, (uint64_t)payloads[i].size);
+        }
+        if (status == DG_STATUS_OK) {
+            status = dg_write_exact(&writer, sorted[i]->name, name_length);
+        }
+        offset += (uint64_t)payloads[i].size;
+    }
+    for (i = 0; i < member_count && status == DG_STATUS_OK; ++i) {
+        status = dg_write_exact(&writer, payloads[i].data, payloads[i].size);
+    }
+
+    for (i = 0; i < member_count; ++i) {
+        free(payloads[i].data);
+    }
+    free(payloads);
+    free(sorted);
+    if (status != DG_STATUS_OK) {
+        free(writer.data);
+        return status;
+    }
+
+    *out_data = writer.data;
+    *out_size = writer.size;
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_template_pack_save_file(
+    const dg_template_pack_member_t *members,
+    size_t member_count,
+    const char *path
+)
+{
+    void *data;
+    size_t size;
+    FILE *file;
+    dg_status_t status;
+
+    if (path == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+
+    status = dg_template_pack_save_to_allocated_buffer(members, member_count, &data, &size);
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    file = fopen(path, "wb");
+    if (file == NULL) {
+        free(data);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    if (fwrite(data, 1, size, file) != size) {
+        (void)fclose(file);
+        free(data);
+        return DG_STATUS_IO_ERROR;
+    }
+
+    free(data);
+    if (fclose(file) != 0) {
+        return DG_STATUS_IO_ERROR;
+    }
+
+    return DG_STATUS_OK;
+}
+
+dg_status_t dg_template_pack_parse(
+    const unsigned char *data,
+    size_t size,
+    dg_template_pack_entry_t **out_entries,
+    size_t *out_entry_count
+)
+{
+    dg_io_reader_t reader;
+    unsigned char magic[4];
+    uint32_t version;
+    uint32_t count;
+    dg_template_pack_entry_t *entries;
+    size_t i;
+    dg_status_t status;
+
+    if (data == NULL || out_entries == NULL || out_entry_count == NULL) {
+        return DG_STATUS_INVALID_ARGUMENT;
+    }
+    *out_entries = NULL;
+    *out_entry_count = 0;
+
+    reader = (dg_io_reader_t){0};
+    reader.data = data;
+    reader.size = size;
+    if (dg_read_exact(&reader, magic, sizeof(magic)) != DG_STATUS_OK ||
+        memcmp(magic, DG_TEMPLATE_PACK_MAGIC, sizeof(magic)) != 0 ||
+        dg_read_u32(&reader, &version) != DG_STATUS_OK ||
+        version != DG_TEMPLATE_PACK_VERSION ||
+        dg_read_u32(&reader, &count) != DG_STATUS_OK) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    /* Each record needs its fixed part plus a name byte; reject before allocating. */
+    if ((size - reader.offset) / (DG_TEMPLATE_PACK_RECORD_SIZE + 1u) < (size_t)count) {
+        return DG_STATUS_UNSUPPORTED_FORMAT;
+    }
+
+    entries = NULL;
+    status = dg_allocate_array((void **)&entries, (size_t)count, sizeof(*entries));
+    if (status != DG_STATUS_OK) {
+        return status;
+    }
+
+    for (i = 0; i < (size_t)count; ++i) {
+        uint32_t name_length;
+        uint64_t offset;
+        uint64_t member_size;
+
+        if (dg_read_u32(&reader, &name_length) != DG_STATUS_OK ||
+            dg_read_u64(&reader, &offset) != DG_STATUS_OK ||
+            dg_read_u64(&reader, &member_size) != DG_STATUS_OK ||
+            name_length > reader.size - reader.offset ||
+            offset > (uint64_t)size || member_size > (uint64_t)size - offset) {
+            free(entries);
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+
+        entries[i].name = (const char *)(data + reader.offset);
+        entries[i].name_length = (size_t)name_length;
+        entries[i].data = data + (size_t)offset;
+        entries[i].size = (size_t)member_size;
+        reader.offset += (size_t)name_length;
+
+        if (!dg_template_pack_name_is_valid(entries[i].name, entries[i].name_length) ||
+            (i > 0u && dg_template_pack_compare_names(
+                           entries[i - 1u].name,
+                           entries[i - 1u].name_length,
+                           entries[i].name,
+                           entries[i].name_length
+                       ) >= 0)) {
+            free(entries);
+            return DG_STATUS_UNSUPPORTED_FORMAT;
+        }
+    }
+
+    *out_entries = entries;
+    *out_entry_count = (size_t)count;
+    return DG_STATUS_OK;
+}
+
+const dg_template_pack_entry_t *dg_template_pack_find(
+    const dg_template_pack_entry_t *entries,
+    size_t entry_count,
+    const char *name
+)
+{
+    size_t low;
+    size_t high;
+    size_t name_length;
+
+    if (entries == NULL || name == NULL) {
+        return NULL;
+    }
+
+    name_length = strlen(name);
+    low = 0;
+    high = entry_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2u;
+        int order = dg_template_pack_compare_names(
+            entries[mid].name,
+            entries[mid].name_length,
+            name,
+            name_length
+        );
+
+        if (order == 0) {
+            return &entries[mid];
+        }
+        if (order < 0) {
+            low = mid + 1u;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
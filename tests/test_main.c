@@ -1,5 +1,6 @@
 #include "dungeoneer/dungeoneer.h"
 
+#include <png.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -420,7 +421,11 @@ static bool maps_have_same_metadata(const dg_map_t *a, const dg_map_t *b)
         a->metadata.diagnostics.room_type_max_excess_count !=
             b->metadata.diagnostics.room_type_max_excess_count ||
         a->metadata.diagnostics.room_type_target_miss_count !=
-            b->metadata.diagnostics.room_type_target_miss_count) {
+            b->metadata.diagnostics.room_type_target_miss_count ||
+        a->metadata.diagnostics.room_type_min_shortfall !=
+            b->metadata.diagnostics.room_type_min_shortfall ||
+        a->metadata.diagnostics.room_type_short_type_id !=
+            b->metadata.diagnostics.room_type_short_type_id) {
         return false;
     }
 
@@ -3436,6 +3441,362 @@ static int test_map_load_rejects_invalid_magic(void)
     return 0;
 }
 
+static int test_map_config_buffer_roundtrip(void)
+{
+    const char *path;
+    dg_generate_request_t request;
+    dg_map_t original = {0};
+    dg_map_t loaded = {0};
+    dg_map_t truncated = {0};
+    unsigned char small[16];
+    unsigned char *buffer;
+    unsigned char *file_data;
+    void *allocated;
+    size_t required;
+    size_t written;
+    size_t allocated_size;
+    FILE *file;
+
+    path = "dungeoneer_test_config_buffer.dgmap";
+
+    dg_default_generate_request(&request, DG_ALGORITHM_CELLULAR_AUTOMATA, 72, 48, 7474u);
+    ASSERT_STATUS(dg_generate(&request, &original), DG_STATUS_OK);
+
+    ASSERT_STATUS(
+        dg_map_save_config_to_buffer(&original, NULL, 0, &required),
+        DG_STATUS_BUFFER_TOO_SMALL
+    );
+    ASSERT_TRUE(required > sizeof(small));
+    ASSERT_STATUS(
+        dg_map_save_config_to_buffer(&original, small, sizeof(small), &written),
+        DG_STATUS_BUFFER_TOO_SMALL
+    );
+    ASSERT_TRUE(written == required);
+
+    buffer = (unsigned char *)malloc(required);
+    ASSERT_TRUE(buffer != NULL);
+    ASSERT_STATUS(dg_map_save_config_to_buffer(&original, buffer, required, &written), DG_STATUS_OK);
+    ASSERT_TRUE(written == required);
+
+    ASSERT_STATUS(
+        dg_map_save_config_to_allocated_buffer(&original, &allocated, &allocated_size),
+        DG_STATUS_OK
+    );
+    ASSERT_TRUE(allocated_size == required);
+    ASSERT_TRUE(memcmp(allocated, buffer, required) == 0);
+
+    ASSERT_STATUS(dg_map_save_file(&original, path), DG_STATUS_OK);
+    file_data = (unsigned char *)malloc(required);
+    ASSERT_TRUE(file_data != NULL);
+    file = fopen(path, "rb");
+    ASSERT_TRUE(file != NULL);
+    ASSERT_TRUE(fread(file_data, 1, required, file) == required);
+    ASSERT_TRUE(fgetc(file) == EOF);
+    ASSERT_TRUE(fclose(file) == 0);
+    ASSERT_TRUE(memcmp(file_data, buffer, required) == 0);
+
+    ASSERT_STATUS(dg_map_load_config_from_buffer(buffer, required, &loaded), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&original, &loaded));
+    ASSERT_TRUE(maps_have_same_metadata(&original, &loaded));
+
+    ASSERT_STATUS(
+        dg_map_load_config_from_buffer(buffer, required - 1u, &truncated),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+    ASSERT_TRUE(truncated.tiles == NULL);
+
+    dg_buffer_free(allocated);
+    free(file_data);
+    free(buffer);
+    dg_map_destroy(&original);
+    dg_map_destroy(&loaded);
+    (void)remove(path);
+    return 0;
+}
+
+static int test_map_baked_roundtrip(void)
+{
+    const char *path;
+    dg_generate_request_t request;
+    dg_map_t original = {0};
+    dg_map_t loaded = {0};
+    dg_map_t detected = {0};
+    dg_room_type_definition_t definitions[2];
+    dg_edge_opening_spec_t edge_openings[2];
+    size_t i;
+
+    path = "dungeoneer_test_baked_roundtrip.dgmap";
+
+    dg_default_generate_request(&request, DG_ALGORITHM_ROOMS_AND_MAZES, 81, 51, 7171u);
+    dg_default_room_type_definition(&definitions[0], 61u);
+    definitions[0].min_count = 1;
+    dg_default_room_type_definition(&definitions[1], 62u);
+    definitions[1].min_count = 1;
+    request.room_types.definitions = definitions;
+    request.room_types.definition_count = 2;
+    edge_openings[0].side = DG_MAP_EDGE_LEFT;
+    edge_openings[0].start = 10;
+    edge_openings[0].end = 12;
+    edge_openings[0].role = DG_MAP_EDGE_OPENING_ROLE_ENTRANCE;
+    edge_openings[1].side = DG_MAP_EDGE_RIGHT;
+    edge_openings[1].start = 30;
+    edge_openings[1].end = 31;
+    edge_openings[1].role = DG_MAP_EDGE_OPENING_ROLE_EXIT;
+    request.edge_openings.openings = edge_openings;
+    request.edge_openings.opening_count = 2u;
+
+    ASSERT_STATUS(dg_generate(&request, &original), DG_STATUS_OK);
+    /* Report a best-effort shortfall so the baked file has to carry it. */
+    original.metadata.diagnostics.room_type_min_shortfall = 1u;
+    original.metadata.diagnostics.room_type_short_type_id = 42u;
+    ASSERT_STATUS(dg_map_save_baked_file(&original, path), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_load_baked_file(path, &loaded), DG_STATUS_OK);
+
+    ASSERT_TRUE(maps_have_same_tiles(&original, &loaded));
+    ASSERT_TRUE(maps_have_same_metadata(&original, &loaded));
+    ASSERT_TRUE(loaded.metadata.diagnostics.room_type_min_shortfall == 1u);
+    ASSERT_TRUE(loaded.metadata.diagnostics.room_type_short_type_id == 42u);
+    ASSERT_TRUE(loaded.metadata.generation_request.present == 1);
+    ASSERT_TRUE(loaded.metadata.generation_request.seed == 7171u);
+    ASSERT_TRUE(loaded.metadata.generation_request.room_types.definition_count == 2u);
+    for (i = 0; i < original.metadata.edge_opening_count; ++i) {
+        ASSERT_TRUE(
+            original.metadata.edge_openings[i].component_id ==
+            loaded.metadata.edge_openings[i].component_id
+        );
+    }
+    for (i = 0; i < original.metadata.room_neighbor_count; ++i) {
+        ASSERT_TRUE(
+            original.metadata.room_neighbors[i].corridor_index ==
+            loaded.metadata.room_neighbors[i].corridor_index
+        );
+    }
+
+    ASSERT_STATUS(dg_map_load_file(path, &detected), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&original, &detected));
+
+    dg_map_destroy(&original);
+    dg_map_destroy(&loaded);
+    dg_map_destroy(&detected);
+    (void)remove(path);
+    return 0;
+}
+
+static int test_map_baked_rejects_corruption(void)
+{
+    const char *path;
+    dg_generate_request_t request;
+    dg_map_t original = {0};
+    dg_map_t loaded = {0};
+    dg_baked_save_options_t options;
+    dg_map_view_t view = {0};
+    dg_room_neighbor_t *neighbor;
+    int neighbor_room_id;
+    FILE *file;
+    long size;
+    int byte;
+
+    path = "dungeoneer_test_baked_corrupt.dgmap";
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 64, 40, 7272u);
+    ASSERT_STATUS(dg_generate(&request, &original), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_baked_file(&original, path), DG_STATUS_OK);
+
+    file = fopen(path, "r+b");
+    ASSERT_TRUE(file != NULL);
+    ASSERT_TRUE(fseek(file, 0, SEEK_END) == 0);
+    size = ftell(file);
+    ASSERT_TRUE(size > 64);
+    ASSERT_TRUE(fseek(file, size / 2, SEEK_SET) == 0);
+    byte = fgetc(file);
+    ASSERT_TRUE(byte != EOF);
+    ASSERT_TRUE(fseek(file, size / 2, SEEK_SET) == 0);
+    ASSERT_TRUE(fputc(byte ^ 0x5A, file) != EOF);
+    ASSERT_TRUE(fclose(file) == 0);
+
+    ASSERT_STATUS(dg_map_load_baked_file(path, &loaded), DG_STATUS_UNSUPPORTED_FORMAT);
+    ASSERT_TRUE(loaded.tiles == NULL);
+
+    /*
+     * A checksummed file whose records name a missing room or corridor is
+     * rejected too, by loads and by zero-copy views.
+     */
+    ASSERT_TRUE(original.metadata.room_neighbor_count > 0u);
+    neighbor = &original.metadata.room_neighbors[0];
+    neighbor_room_id = neighbor->room_id;
+    neighbor->room_id = (int)original.metadata.room_count;
+    ASSERT_STATUS(dg_map_save_baked_file(&original, path), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_load_baked_file(path, &loaded), DG_STATUS_UNSUPPORTED_FORMAT);
+    ASSERT_TRUE(loaded.tiles == NULL);
+    neighbor->room_id = neighbor_room_id;
+
+    dg_default_baked_save_options(&options);
+    options.layout = DG_BAKED_LAYOUT_NATIVE;
+    neighbor->corridor_index = -1;
+    ASSERT_STATUS(dg_map_save_baked_file_with_options(&original, path, &options), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_view_open(path, &view), DG_STATUS_UNSUPPORTED_FORMAT);
+    ASSERT_TRUE(view.map.tiles == NULL && view.mapping == NULL);
+
+    dg_map_destroy(&original);
+    (void)remove(path);
+    return 0;
+}
+
+static int test_map_view_native_zero_copy(void)
+{
+    const char *native_path;
+    const char *portable_path;
+    dg_generate_request_t request;
+    dg_baked_save_options_t options;
+    dg_map_t original = {0};
+    dg_map_t loaded = {0};
+    dg_map_view_t view = {0};
+    dg_map_view_t portable_view = {0};
+    const unsigned char *mapping_begin;
+    const unsigned char *mapping_end;
+
+    native_path = "dungeoneer_test_view_native.dgmap";
+    portable_path = "dungeoneer_test_view_portable.dgmap";
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 96, 64, 7373u);
+    ASSERT_STATUS(dg_generate(&request, &original), DG_STATUS_OK);
+
+    dg_default_baked_save_options(&options);
+    ASSERT_TRUE(options.layout == DG_BAKED_LAYOUT_PORTABLE);
+    options.layout = DG_BAKED_LAYOUT_NATIVE;
+    ASSERT_STATUS(dg_map_save_baked_file_with_options(&original, native_path, &options), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_baked_file(&original, portable_path), DG_STATUS_OK);
+
+    ASSERT_STATUS(dg_map_view_open(native_path, &view), DG_STATUS_OK);
+    ASSERT_TRUE(!view.owns_map);
+    ASSERT_TRUE(maps_have_same_tiles(&original, &view.map));
+    ASSERT_TRUE(maps_have_same_metadata(&original, &view.map));
+    ASSERT_TRUE(view.map.metadata.generation_request.present == 1);
+    ASSERT_STATUS(dg_map_view_verify(&view), DG_STATUS_OK);
+
+    mapping_begin = (const unsigned char *)view.mapping;
+    mapping_end = mapping_begin + view.mapping_size;
+    ASSERT_TRUE((const unsigned char *)view.map.tiles >= mapping_begin);
+    ASSERT_TRUE((const unsigned char *)view.map.tiles < mapping_end);
+    ASSERT_TRUE((const unsigned char *)view.map.metadata.rooms >= mapping_begin);
+    ASSERT_TRUE((const unsigned char *)view.map.metadata.rooms < mapping_end);
+
+    ASSERT_STATUS(dg_map_load_baked_file(native_path, &loaded), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&original, &loaded));
+    ASSERT_TRUE(maps_have_same_metadata(&original, &loaded));
+
+    ASSERT_STATUS(dg_map_view_open(portable_path, &portable_view), DG_STATUS_OK);
+    ASSERT_TRUE(portable_view.owns_map);
+    ASSERT_TRUE(portable_view.mapping == NULL);
+    ASSERT_TRUE(maps_have_same_tiles(&original, &portable_view.map));
+    ASSERT_TRUE(maps_have_same_metadata(&original, &portable_view.map));
+
+    dg_map_view_close(&view);
+    ASSERT_TRUE(view.map.tiles == NULL && view.mapping == NULL);
+    dg_map_view_close(&portable_view);
+    dg_map_destroy(&original);
+    dg_map_destroy(&loaded);
+    (void)remove(native_path);
+    (void)remove(portable_path);
+    return 0;
+}
+
+static int test_map_tile_codec(void)
+{
+    static const dg_algorithm_t algorithms[2] = {
+        DG_ALGORITHM_CELLULAR_AUTOMATA,
+        DG_ALGORITHM_ROOMS_AND_MAZES
+    };
+    const char *rle_path;
+    const char *packed_path;
+    dg_generate_request_t request;
+    dg_baked_save_options_t options;
+    dg_map_t original = {0};
+    dg_map_t decoded = {0};
+    dg_map_t loaded = {0};
+    dg_map_t striped = {0};
+    unsigned char *data;
+    size_t size;
+    long rle_size;
+    long packed_size;
+    FILE *file;
+    size_t i;
+
+    rle_path = "dungeoneer_test_tiles_rle.dgmap";
+    packed_path = "dungeoneer_test_tiles_packed.dgmap";
+
+    for (i = 0; i < 2; ++i) {
+        dg_default_generate_request(&request, algorithms[i], 97, 61, 7474u + (uint64_t)i);
+        ASSERT_STATUS(dg_generate(&request, &original), DG_STATUS_OK);
+
+        ASSERT_STATUS(dg_map_encode_tiles(&original, (void **)&data, &size), DG_STATUS_OK);
+        ASSERT_TRUE(size < 12u + (97u * 61u + 3u) / 4u);
+        ASSERT_STATUS(dg_map_decode_tiles(data, size, &decoded), DG_STATUS_OK);
+        ASSERT_TRUE(maps_have_same_tiles(&original, &decoded));
+        ASSERT_TRUE(decoded.metadata.room_count == 0);
+        ASSERT_STATUS(dg_map_decode_tiles(data, size, &decoded), DG_STATUS_INVALID_ARGUMENT);
+        dg_map_destroy(&decoded);
+
+        /* Truncated, padded, and wrong-magic streams are rejected. */
+        ASSERT_STATUS(dg_map_decode_tiles(data, size - 1u, &decoded), DG_STATUS_UNSUPPORTED_FORMAT);
+        ASSERT_TRUE(decoded.tiles == NULL);
+        ASSERT_STATUS(dg_map_decode_tiles(data, 11u, &decoded), DG_STATUS_UNSUPPORTED_FORMAT);
+        data[0] ^= 0xFFu;
+        ASSERT_STATUS(dg_map_decode_tiles(data, size, &decoded), DG_STATUS_UNSUPPORTED_FORMAT);
+        dg_buffer_free(data);
+
+        dg_default_baked_save_options(&options);
+        ASSERT_TRUE(options.tile_encoding == DG_BAKED_TILES_RLE);
+        ASSERT_STATUS(
+            dg_map_save_baked_file_with_options(&original, rle_path, &options),
+            DG_STATUS_OK
+        );
+        options.tile_encoding = DG_BAKED_TILES_PACKED;
+        ASSERT_STATUS(
+            dg_map_save_baked_file_with_options(&original, packed_path, &options),
+            DG_STATUS_OK
+        );
+
+        ASSERT_STATUS(dg_map_load_baked_file(rle_path, &loaded), DG_STATUS_OK);
+        ASSERT_TRUE(maps_have_same_tiles(&original, &loaded));
+        ASSERT_TRUE(maps_have_same_metadata(&original, &loaded));
+        dg_map_destroy(&loaded);
+        ASSERT_STATUS(dg_map_load_baked_file(packed_path, &loaded), DG_STATUS_OK);
+        ASSERT_TRUE(maps_have_same_tiles(&original, &loaded));
+        dg_map_destroy(&loaded);
+
+        file = fopen(rle_path, "rb");
+        ASSERT_TRUE(file != NULL);
+        ASSERT_TRUE(fseek(file, 0, SEEK_END) == 0);
+        rle_size = ftell(file);
+        ASSERT_TRUE(fclose(file) == 0);
+        file = fopen(packed_path, "rb");
+        ASSERT_TRUE(file != NULL);
+        ASSERT_TRUE(fseek(file, 0, SEEK_END) == 0);
+        packed_size = ftell(file);
+        ASSERT_TRUE(fclose(file) == 0);
+        ASSERT_TRUE(rle_size < packed_size);
+
+        dg_map_destroy(&original);
+    }
+
+    /* Long runs use the varint length and literals split at 128 tiles. */
+    ASSERT_STATUS(dg_map_init(&striped, 700, 3, DG_TILE_WALL), DG_STATUS_OK);
+    for (i = 0; i < 700u; ++i) {
+        striped.tiles[700u + i] = (dg_tile_t)(i % 4u);
+    }
+    ASSERT_STATUS(dg_map_encode_tiles(&striped, (void **)&data, &size), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_decode_tiles(data, size, &decoded), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&striped, &decoded));
+    dg_buffer_free(data);
+    dg_map_destroy(&decoded);
+    dg_map_destroy(&striped);
+
+    (void)remove(rle_path);
+    (void)remove(packed_path);
+    return 0;
+}
+
 static int test_map_export_png_json(void)
 {
     dg_generate_request_t request;
@@ -3522,6 +3883,528 @@ static int test_map_export_png_json(void)
     return 0;
 }
 
+static unsigned char *read_png_rgba(
+    const char *path,
+    png_image *out_image,
+    png_uint_32 *out_file_format
+)
+{
+    unsigned char *pixels;
+
+    memset(out_image, 0, sizeof(*out_image));
+    out_image->version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(out_image, path)) {
+        return NULL;
+    }
+
+    *out_file_format = out_image->format;
+    out_image->format = PNG_FORMAT_RGBA;
+    pixels = (unsigned char *)malloc(PNG_IMAGE_SIZE(*out_image));
+    if (pixels == NULL) {
+        png_image_free(out_image);
+        return NULL;
+    }
+    if (!png_image_finish_read(out_image, NULL, pixels, 0, NULL)) {
+        free(pixels);
+        return NULL;
+    }
+
+    return pixels;
+}
+
+static long file_size_of(const char *path)
+{
+    FILE *file;
+    long size;
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    size = (fseek(file, 0, SEEK_END) == 0) ? ftell(file) : -1;
+    (void)fclose(file);
+    return size;
+}
+
+static int file_matches_buffer(const char *path, const void *data, size_t size)
+{
+    FILE *file;
+    unsigned char *contents;
+    size_t read_count;
+    int matches;
+
+    if (file_size_of(path) != (long)size) {
+        return 0;
+    }
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    contents = (unsigned char *)malloc(size > 0u ? size : 1u);
+    if (contents == NULL) {
+        (void)fclose(file);
+        return 0;
+    }
+    read_count = fread(contents, 1, size, file);
+    (void)fclose(file);
+
+    matches = read_count == size && memcmp(contents, data, size) == 0;
+    free(contents);
+    return matches;
+}
+
+static int test_map_export_indexed_png(void)
+{
+    dg_generate_request_t request;
+    dg_map_t map = {0};
+    dg_room_type_definition_t definitions[2];
+    dg_export_options_t options;
+    const char *rgba_path = "dungeoneer_test_export_rgba.png";
+    const char *indexed_path = "dungeoneer_test_export_indexed.png";
+    const char *json_path = "dungeoneer_test_export_indexed.json";
+    png_image rgba_image;
+    png_image indexed_image;
+    png_uint_32 rgba_format;
+    png_uint_32 indexed_format;
+    unsigned char *rgba_pixels;
+    unsigned char *indexed_pixels;
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 96, 64, 7575u);
+    dg_default_room_type_definition(&definitions[0], 11u);
+    definitions[0].min_count = 1;
+    dg_default_room_type_definition(&definitions[1], 12u);
+    definitions[1].min_count = 1;
+    request.room_types.definitions = definitions;
+    request.room_types.definition_count = 2;
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+
+    dg_default_export_options(&options);
+    ASSERT_TRUE(options.png_color_mode == DG_PNG_COLOR_MODE_RGBA);
+    ASSERT_STATUS(dg_map_export_png_json_with_options(&map, rgba_path, json_path, &options), DG_STATUS_OK);
+
+    options.png_color_mode = DG_PNG_COLOR_MODE_INDEXED;
+    options.png_compression_level = 9;
+    options.png_compression_strategy = DG_PNG_COMPRESSION_STRATEGY_RLE;
+    ASSERT_STATUS(
+        dg_map_export_png_json_with_options(&map, indexed_path, json_path, &options),
+        DG_STATUS_OK
+    );
+
+    options.png_compression_level = 10;
+    ASSERT_STATUS(
+        dg_map_export_png_json_with_options(&map, indexed_path, json_path, &options),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+
+    rgba_pixels = read_png_rgba(rgba_path, &rgba_image, &rgba_format);
+    ASSERT_TRUE(rgba_pixels != NULL);
+    indexed_pixels = read_png_rgba(indexed_path, &indexed_image, &indexed_format);
+    ASSERT_TRUE(indexed_pixels != NULL);
+
+    ASSERT_TRUE((rgba_format & PNG_FORMAT_FLAG_COLORMAP) == 0u);
+    ASSERT_TRUE((indexed_format & PNG_FORMAT_FLAG_COLORMAP) != 0u);
+    ASSERT_TRUE(indexed_image.width == (png_uint_32)map.width);
+    ASSERT_TRUE(indexed_image.height == (png_uint_32)map.height);
+    ASSERT_TRUE(memcmp(rgba_pixels, indexed_pixels, PNG_IMAGE_SIZE(rgba_image)) == 0);
+    ASSERT_TRUE(file_size_of(indexed_path) < file_size_of(rgba_path));
+
+    free(rgba_pixels);
+    free(indexed_pixels);
+    dg_map_destroy(&map);
+    (void)remove(rgba_path);
+    (void)remove(indexed_path);
+    (void)remove(json_path);
+    return 0;
+}
+
+static int test_map_export_png_pixels_per_tile(void)
+{
+    dg_generate_request_t request;
+    dg_map_t map = {0};
+    dg_room_type_definition_t definition;
+    dg_export_options_t options;
+    const char *base_path = "dungeoneer_test_export_scale1.png";
+    const char *scaled_path = "dungeoneer_test_export_scale3.png";
+    const char *json_path = "dungeoneer_test_export_scale.json";
+    png_image base_image;
+    png_image scaled_image;
+    png_uint_32 base_format;
+    png_uint_32 scaled_format;
+    unsigned char *base_pixels;
+    unsigned char *scaled_pixels;
+    png_uint_32 x;
+    png_uint_32 y;
+    int mismatches;
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 64, 40, 6262u);
+    dg_default_room_type_definition(&definition, 21u);
+    definition.min_count = 1;
+    request.room_types.definitions = &definition;
+    request.room_types.definition_count = 1;
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+
+    dg_default_export_options(&options);
+    ASSERT_TRUE(options.png_pixels_per_tile == 1);
+    ASSERT_STATUS(dg_map_export_png_json_with_options(&map, base_path, json_path, &options), DG_STATUS_OK);
+
+    options.png_color_mode = DG_PNG_COLOR_MODE_INDEXED;
+    options.png_pixels_per_tile = 3;
+    ASSERT_STATUS(
+        dg_map_export_png_json_with_options(&map, scaled_path, json_path, &options),
+        DG_STATUS_OK
+    );
+
+    options.png_pixels_per_tile = 0;
+    ASSERT_STATUS(
+        dg_map_export_png_json_with_options(&map, scaled_path, json_path, &options),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+
+    base_pixels = read_png_rgba(base_path, &base_image, &base_format);
+    ASSERT_TRUE(base_pixels != NULL);
+    scaled_pixels = read_png_rgba(scaled_path, &scaled_image, &scaled_format);
+    ASSERT_TRUE(scaled_pixels != NULL);
+    ASSERT_TRUE(scaled_image.width == base_image.width * 3u);
+    ASSERT_TRUE(scaled_image.height == base_image.height * 3u);
+
+    mismatches = 0;
+    for (y = 0; y < scaled_image.height; ++y) {
+        for (x = 0; x < scaled_image.width; ++x) {
+            const unsigned char *expected =
+                base_pixels + ((size_t)(y / 3u) * base_image.width + (x / 3u)) * 4u;
+            const unsigned char *actual = scaled_pixels + ((size_t)y * scaled_image.width + x) * 4u;
+            if (memcmp(expected, actual, 4u) != 0) {
+                mismatches += 1;
+            }
+        }
+    }
+    ASSERT_TRUE(mismatches == 0);
+
+    free(base_pixels);
+    free(scaled_pixels);
+    dg_map_destroy(&map);
+    (void)remove(base_path);
+    (void)remove(scaled_path);
+    (void)remove(json_path);
+    return 0;
+}
+
+static int test_map_export_to_buffers(void)
+{
+    dg_generate_request_t request;
+    dg_map_t map = {0};
+    dg_room_type_definition_t definition;
+    dg_export_options_t options;
+    const char *png_path = "dungeoneer_test_export_buffers.png";
+    const char *json_path = "dungeoneer_test_export_buffers.json";
+    void *png_data;
+    void *json_data;
+    size_t png_size;
+    size_t json_size;
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 72, 48, 3737u);
+    dg_default_room_type_definition(&definition, 31u);
+    definition.min_count = 1;
+    request.room_types.definitions = &definition;
+    request.room_types.definition_count = 1;
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+
+    dg_default_export_options(&options);
+    options.png_color_mode = DG_PNG_COLOR_MODE_INDEXED;
+    ASSERT_STATUS(dg_map_export_png_json_with_options(&map, png_path, json_path, &options), DG_STATUS_OK);
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(
+            &map,
+            png_path,
+            &options,
+            &png_data,
+            &png_size,
+            &json_data,
+            &json_size
+        ),
+        DG_STATUS_OK
+    );
+    ASSERT_TRUE(png_data != NULL && png_size > 8u);
+    ASSERT_TRUE(json_data != NULL && json_size > 0u);
+    ASSERT_TRUE(file_matches_buffer(png_path, png_data, png_size));
+    ASSERT_TRUE(file_matches_buffer(json_path, json_data, json_size));
+    dg_buffer_free(json_data);
+    dg_buffer_free(png_data);
+
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(&map, NULL, &options, &png_data, &png_size, NULL, NULL),
+        DG_STATUS_OK
+    );
+    ASSERT_TRUE(file_matches_buffer(png_path, png_data, png_size));
+    dg_buffer_free(png_data);
+
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(&map, NULL, &options, NULL, NULL, &json_data, &json_size),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+    ASSERT_TRUE(json_data == NULL && json_size == 0u);
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(&map, png_path, &options, NULL, NULL, NULL, NULL),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+
+    dg_map_destroy(&map);
+    (void)remove(png_path);
+    (void)remove(json_path);
+    return 0;
+}
+
+static size_t strip_json_whitespace(const char *json, size_t size, char *out)
+{
+    size_t i;
+    size_t length = 0;
+    int in_string = 0;
+
+    for (i = 0; i < size; ++i) {
+        char c = json[i];
+
+        if (in_string) {
+            if (c == '\\' && i + 1u < size) {
+                out[length++] = c;
+                c = json[++i];
+            } else if (c == '"') {
+                in_string = 0;
+            }
+        } else if (c == '"') {
+            in_string = 1;
+        } else if (c == ' ' || c == '\n') {
+            continue;
+        }
+        out[length++] = c;
+    }
+    return length;
+}
+
+static int test_map_export_json_compact_and_omit(void)
+{
+    dg_generate_request_t request;
+    dg_map_t map = {0};
+    dg_export_options_t options;
+    void *pretty;
+    void *compact;
+    void *summary;
+    size_t pretty_size;
+    size_t compact_size;
+    size_t summary_size;
+    char *stripped;
+    size_t stripped_size;
+
+    dg_default_generate_request(&request, DG_ALGORITHM_ROOMS_AND_MAZES, 80, 60, 4848u);
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+    ASSERT_TRUE(map.metadata.room_entrance_count > 0u);
+
+    dg_default_export_options(&options);
+    ASSERT_TRUE(options.json_compact == 0);
+    ASSERT_TRUE(options.json_omit_mask == 0u);
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(
+            &map,
+            "a b.png",
+            &options,
+            NULL,
+            NULL,
+            &pretty,
+            &pretty_size
+        ),
+        DG_STATUS_OK
+    );
+
+    options.json_compact = 1;
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(
+            &map,
+            "a b.png",
+            &options,
+            NULL,
+            NULL,
+            &compact,
+            &compact_size
+        ),
+        DG_STATUS_OK
+    );
+    ASSERT_TRUE(compact_size < pretty_size);
+    ASSERT_TRUE(memchr(compact, '\n', compact_size) == NULL);
+
+    stripped = (char *)malloc(pretty_size);
+    ASSERT_TRUE(stripped != NULL);
+    stripped_size = strip_json_whitespace((const char *)pretty, pretty_size, stripped);
+    ASSERT_TRUE(stripped_size == compact_size);
+    ASSERT_TRUE(memcmp(stripped, compact, compact_size) == 0);
+    free(stripped);
+
+    options.json_compact = 0;
+    options.json_omit_mask = DG_EXPORT_JSON_OMIT_ROOM_ENTRANCES | DG_EXPORT_JSON_OMIT_CORRIDORS;
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(
+            &map,
+            "a b.png",
+            &options,
+            NULL,
+            NULL,
+            &summary,
+            &summary_size
+        ),
+        DG_STATUS_OK
+    );
+    ASSERT_TRUE(summary_size < pretty_size);
+    ASSERT_TRUE(((const char *)summary)[summary_size] == '\0');
+    ASSERT_TRUE(strstr((const char *)pretty, "\"room_entrances\": [") != NULL);
+    ASSERT_TRUE(strstr((const char *)summary, "\"room_entrances\": [") == NULL);
+    ASSERT_TRUE(strstr((const char *)summary, "\"corridors\": [") == NULL);
+    ASSERT_TRUE(strstr((const char *)summary, "\"rooms\": [") != NULL);
+    ASSERT_TRUE(strstr((const char *)summary, "\"room_entrance_count\"") != NULL);
+    dg_buffer_free(summary);
+
+    options.json_omit_mask = 1u << 20;
+    ASSERT_STATUS(
+        dg_map_export_png_json_to_buffers(
+            &map,
+            "a b.png",
+            &options,
+            NULL,
+            NULL,
+            &summary,
+            &summary_size
+        ),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+
+    dg_buffer_free(pretty);
+    dg_buffer_free(compact);
+    dg_map_destroy(&map);
+    return 0;
+}
+
+static int test_map_metadata_binary_export(void)
+{
+    dg_generate_request_t request;
+    dg_map_t map = {0};
+    dg_room_type_definition_t definition;
+    dg_edge_opening_spec_t opening;
+    dg_metadata_binary_view_t view;
+    const char *path = "dungeoneer_test_metadata.dgmd";
+    void *data;
+    size_t size;
+    unsigned char *file_data;
+    long file_size;
+    FILE *file;
+    size_t neighbor_offset;
+    int32_t room_id;
+    size_t i;
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 88, 56, 3939u);
+    dg_default_room_type_definition(&definition, 44u);
+    definition.min_count = 1;
+    request.room_types.definitions = &definition;
+    request.room_types.definition_count = 1;
+    opening.side = DG_MAP_EDGE_LEFT;
+    opening.start = 20;
+    opening.end = 22;
+    opening.role = DG_MAP_EDGE_OPENING_ROLE_ENTRANCE;
+    request.edge_openings.openings = &opening;
+    request.edge_openings.opening_count = 1;
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+    ASSERT_TRUE(map.metadata.edge_opening_count > 0u);
+    map.metadata.diagnostics.room_type_min_shortfall = 1u;
+    map.metadata.diagnostics.room_type_short_type_id = 42u;
+
+    ASSERT_STATUS(dg_map_export_metadata_binary_to_buffer(&map, &data, &size), DG_STATUS_OK);
+    ASSERT_STATUS(dg_metadata_binary_view_init(data, size, &view), DG_STATUS_OK);
+
+    ASSERT_TRUE(view.header->version == DG_METADATA_BINARY_VERSION);
+    ASSERT_TRUE(view.header->total_size == size);
+    ASSERT_TRUE(view.header->width == map.width);
+    ASSERT_TRUE(view.header->height == map.height);
+    ASSERT_TRUE(view.header->seed == map.metadata.seed);
+    ASSERT_TRUE(view.header->walkable_tile_count == map.metadata.walkable_tile_count);
+    ASSERT_TRUE(view.header->typed_room_count == map.metadata.diagnostics.typed_room_count);
+    ASSERT_TRUE(view.header->room_type_min_shortfall == 1u);
+    ASSERT_TRUE(view.header->room_type_short_type_id == 42u);
+    ASSERT_TRUE(view.header->connected_floor == (map.metadata.connected_floor ? 1u : 0u));
+
+    ASSERT_TRUE(view.room_count == map.metadata.room_count);
+    for (i = 0; i < view.room_count; ++i) {
+        ASSERT_TRUE(view.rooms[i].id == map.metadata.rooms[i].id);
+        ASSERT_TRUE(view.rooms[i].x == map.metadata.rooms[i].bounds.x);
+        ASSERT_TRUE(view.rooms[i].height == map.metadata.rooms[i].bounds.height);
+        ASSERT_TRUE(view.rooms[i].type_id == map.metadata.rooms[i].type_id);
+    }
+    ASSERT_TRUE(view.corridor_count == map.metadata.corridor_count);
+    for (i = 0; i < view.corridor_count; ++i) {
+        ASSERT_TRUE(view.corridors[i].from_room_id == map.metadata.corridors[i].from_room_id);
+        ASSERT_TRUE(view.corridors[i].length == map.metadata.corridors[i].length);
+    }
+    ASSERT_TRUE(view.room_entrance_count == map.metadata.room_entrance_count);
+    for (i = 0; i < view.room_entrance_count; ++i) {
+        ASSERT_TRUE(
+            view.room_entrances[i].corridor_x == map.metadata.room_entrances[i].corridor_tile.x
+        );
+        ASSERT_TRUE(view.room_entrances[i].normal_y == map.metadata.room_entrances[i].normal_y);
+    }
+    ASSERT_TRUE(view.edge_opening_count == map.metadata.edge_opening_count);
+    for (i = 0; i < view.edge_opening_count; ++i) {
+        ASSERT_TRUE(view.edge_openings[i].start == map.metadata.edge_openings[i].start);
+        ASSERT_TRUE(view.edge_openings[i].role == (int32_t)map.metadata.edge_openings[i].role);
+        ASSERT_TRUE(
+            view.edge_openings[i].component_id ==
+            (uint64_t)map.metadata.edge_openings[i].component_id
+        );
+    }
+    ASSERT_TRUE(view.room_adjacency_count == map.metadata.room_adjacency_count);
+    ASSERT_TRUE(view.room_neighbor_count == map.metadata.room_neighbor_count);
+    for (i = 0; i < view.room_neighbor_count; ++i) {
+        ASSERT_TRUE(view.room_neighbors[i].room_id == map.metadata.room_neighbors[i].room_id);
+    }
+    ASSERT_TRUE(view.room_type_quota_count == map.metadata.diagnostics.room_type_count);
+    ASSERT_TRUE(view.room_type_quotas[0].type_id == 44u);
+    ASSERT_TRUE(view.room_neighbor_count > 0u);
+    neighbor_offset = (size_t)((const unsigned char *)view.room_neighbors -
+                               (const unsigned char *)data);
+
+    ASSERT_STATUS(dg_map_export_metadata_binary(&map, path), DG_STATUS_OK);
+    ASSERT_TRUE(file_matches_buffer(path, data, size));
+
+    /* Truncated buffers are rejected rather than read past their end. */
+    file_size = file_size_of(path);
+    ASSERT_TRUE(file_size == (long)size);
+    file_data = (unsigned char *)malloc((size_t)file_size);
+    ASSERT_TRUE(file_data != NULL);
+    file = fopen(path, "rb");
+    ASSERT_TRUE(file != NULL);
+    ASSERT_TRUE(fread(file_data, 1, (size_t)file_size, file) == (size_t)file_size);
+    ASSERT_TRUE(fclose(file) == 0);
+    ASSERT_STATUS(
+        dg_metadata_binary_view_init(file_data, (size_t)file_size - 4u, &view),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+
+    /* So are records naming a room that does not exist. */
+    room_id = (int32_t)map.metadata.room_count;
+    memcpy(file_data + neighbor_offset, &room_id, sizeof(room_id));
+    ASSERT_STATUS(
+        dg_metadata_binary_view_init(file_data, (size_t)file_size, &view),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+    ASSERT_TRUE(view.room_neighbors == NULL);
+    file_data[0] = 'X';
+    ASSERT_STATUS(
+        dg_metadata_binary_view_init(file_data, (size_t)file_size, &view),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+
+    free(file_data);
+    dg_buffer_free(data);
+    dg_map_destroy(&map);
+    (void)remove(path);
+    return 0;
+}
+
 static int test_room_type_config_scaffold(void)
 {
     dg_generate_request_t request;
@@ -3818,6 +4701,358 @@ static int test_room_type_untyped_template_map_application(void)
     return 0;
 }
 
+static int test_room_type_template_cache(void)
+{
+    const char *template_path;
+    dg_generate_request_t template_request;
+    dg_generate_request_t request;
+    dg_map_t template_map = {0};
+    dg_map_t first = {0};
+    dg_map_t second = {0};
+    dg_map_t edited = {0};
+    dg_room_type_definition_t definition;
+    dg_template_cache_stats_t stats;
+
+    template_path = "dungeoneer_test_room_template_cache.dgmap";
+    dg_template_cache_invalidate(NULL);
+
+    dg_default_generate_request(&template_request, DG_ALGORITHM_VALUE_NOISE, 40, 28, 424351u);
+    ASSERT_STATUS(dg_generate(&template_request, &template_map), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_file(&template_map, template_path), DG_STATUS_OK);
+    dg_map_destroy(&template_map);
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 88, 48, 424352u);
+    dg_default_room_type_definition(&definition, 561u);
+    definition.min_count = 1;
+    (void)snprintf(
+        definition.template_map_path,
+        sizeof(definition.template_map_path),
+        "%s",
+        template_path
+    );
+    request.room_types.definitions = &definition;
+    request.room_types.definition_count = 1u;
+    request.room_types.policy.allow_untyped_rooms = 0;
+    request.room_types.policy.default_type_id = 561u;
+
+    /* The second generation reuses the parsed template and matches the first. */
+    ASSERT_STATUS(dg_generate(&request, &first), DG_STATUS_OK);
+    ASSERT_STATUS(dg_generate(&request, &second), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&first, &second));
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.entry_count == 1u);
+    ASSERT_TRUE(stats.miss_count == 1u);
+    ASSERT_TRUE(stats.hit_count == 1u);
+
+    /* Changed file bytes replace the entry instead of serving stale tiles. */
+    template_request.seed = 424353u;
+    ASSERT_STATUS(dg_generate(&template_request, &template_map), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_file(&template_map, template_path), DG_STATUS_OK);
+    dg_map_destroy(&template_map);
+    ASSERT_STATUS(dg_generate(&request, &edited), DG_STATUS_OK);
+    ASSERT_TRUE(!maps_have_same_tiles(&first, &edited));
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.entry_count == 1u);
+    ASSERT_TRUE(stats.miss_count == 2u);
+
+    dg_template_cache_invalidate(template_path);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.entry_count == 0u);
+    ASSERT_STATUS(dg_template_cache_preload(template_path), DG_STATUS_OK);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.entry_count == 1u);
+    ASSERT_STATUS(
+        dg_template_cache_preload("dungeoneer_test_missing_template.dgmap"),
+        DG_STATUS_IO_ERROR
+    );
+
+    dg_template_cache_invalidate(NULL);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.entry_count == 0u && stats.hit_count == 0u && stats.miss_count == 0u);
+
+    dg_map_destroy(&first);
+    dg_map_destroy(&second);
+    dg_map_destroy(&edited);
+    (void)remove(template_path);
+    return 0;
+}
+
+static int test_room_type_template_pack(void)
+{
+    const char *pack_path;
+    const char *cave_path;
+    const char *ruin_path;
+    dg_generate_request_t template_request;
+    dg_generate_request_t request;
+    dg_map_t cave_map = {0};
+    dg_map_t ruin_map = {0};
+    dg_map_t from_files = {0};
+    dg_map_t from_pack = {0};
+    dg_room_type_definition_t definitions[2];
+    dg_template_pack_member_t members[2];
+    dg_template_cache_stats_t stats;
+    void *data;
+    size_t size;
+
+    pack_path = "dungeoneer_test_room_template_pack.dgtp";
+    cave_path = "dungeoneer_test_room_template_pack_cave.dgmap";
+    ruin_path = "dungeoneer_test_room_template_pack_ruin.dgmap";
+    dg_template_cache_invalidate(NULL);
+
+    dg_default_generate_request(&template_request, DG_ALGORITHM_VALUE_NOISE, 40, 28, 424361u);
+    ASSERT_STATUS(dg_generate(&template_request, &cave_map), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_file(&cave_map, cave_path), DG_STATUS_OK);
+    dg_default_generate_request(&template_request, DG_ALGORITHM_DRUNKARDS_WALK, 36, 24, 424362u);
+    ASSERT_STATUS(dg_generate(&template_request, &ruin_map), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_baked_file(&ruin_map, ruin_path), DG_STATUS_OK);
+
+    /* Members are written in name order whatever order they are given in. */
+    members[0] = (dg_template_pack_member_t){"ruin", &ruin_map, 1};
+    members[1] = (dg_template_pack_member_t){"cave", &cave_map, 0};
+    ASSERT_STATUS(dg_template_pack_save_file(members, 2u, pack_path), DG_STATUS_OK);
+
+    members[1].name = "ruin";
+    ASSERT_STATUS(
+        dg_template_pack_save_to_allocated_buffer(members, 2u, &data, &size),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+    members[1].name = "ca#ve";
+    ASSERT_STATUS(dg_template_pack_save_file(members, 2u, pack_path), DG_STATUS_INVALID_ARGUMENT);
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 88, 48, 424363u);
+    request.params.bsp.min_rooms = 8;
+    request.params.bsp.max_rooms = 10;
+    dg_default_room_type_definition(&definitions[0], 571u);
+    definitions[0].min_count = 1;
+    dg_default_room_type_definition(&definitions[1], 572u);
+    definitions[1].min_count = 1;
+    (void)snprintf(
+        definitions[0].template_map_path,
+        sizeof(definitions[0].template_map_path),
+        "%s",
+        cave_path
+    );
+    (void)snprintf(
+        definitions[1].template_map_path,
+        sizeof(definitions[1].template_map_path),
+        "%s",
+        ruin_path
+    );
+    request.room_types.definitions = definitions;
+    request.room_types.definition_count = 2u;
+    request.room_types.policy.allow_untyped_rooms = 0;
+    request.room_types.policy.default_type_id = 571u;
+    ASSERT_STATUS(dg_generate(&request, &from_files), DG_STATUS_OK);
+    ASSERT_TRUE(count_rooms_with_type_id(&from_files, 572u) > 0u);
+
+    /* Pack members stamp the same rooms as the standalone files they came from. */
+    dg_template_cache_invalidate(NULL);
+    (void)snprintf(
+        definitions[0].template_map_path,
+        sizeof(definitions[0].template_map_path),
+        "%s#cave",
+        pack_path
+    );
+    (void)snprintf(
+        definitions[1].template_map_path,
+        sizeof(definitions[1].template_map_path),
+        "%s#ruin",
+        pack_path
+    );
+    ASSERT_STATUS(dg_generate(&request, &from_pack), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&from_files, &from_pack));
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.pack_count == 1u);
+    ASSERT_TRUE(stats.entry_count == 2u);
+    ASSERT_TRUE(stats.miss_count == 2u);
+
+    ASSERT_STATUS(dg_template_cache_preload(definitions[1].template_map_path), DG_STATUS_OK);
+    ASSERT_STATUS(
+        dg_template_cache_preload("dungeoneer_test_room_template_pack.dgtp#missing"),
+        DG_STATUS_IO_ERROR
+    );
+    ASSERT_STATUS(
+        dg_template_cache_preload("dungeoneer_test_room_template_pack_cave.dgmap#cave"),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.pack_count == 1u && stats.hit_count == 1u);
+
+    /* Invalidating the pack drops its index and every member loaded from it. */
+    dg_template_cache_invalidate(pack_path);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.pack_count == 0u && stats.entry_count == 0u);
+
+    dg_template_cache_invalidate(NULL);
+    dg_map_destroy(&cave_map);
+    dg_map_destroy(&ruin_map);
+    dg_map_destroy(&from_files);
+    dg_map_destroy(&from_pack);
+    (void)remove(pack_path);
+    (void)remove(cave_path);
+    (void)remove(ruin_path);
+    return 0;
+}
+
+static int test_room_type_template_size_variants(void)
+{
+    const char *template_path;
+    const char *maze_path;
+    const char *config_path;
+    dg_generate_request_t template_request;
+    dg_generate_request_t request;
+    dg_map_t template_map = {0};
+    dg_map_t first = {0};
+    dg_map_t second = {0};
+    dg_map_t per_room = {0};
+    dg_map_t legacy = {0};
+    dg_map_t rejected = {0};
+    dg_room_type_definition_t definition;
+    dg_template_variant_options_t options;
+    dg_template_cache_stats_t stats;
+    void *config;
+    size_t config_size;
+    size_t trailer_size;
+    unsigned char *padded;
+
+    template_path = "dungeoneer_test_room_template_variants.dgmap";
+    maze_path = "dungeoneer_test_room_template_variants_maze.dgmap";
+    config_path = "dungeoneer_test_room_template_variants_config.dgmap";
+    dg_template_cache_invalidate(NULL);
+
+    dg_default_generate_request(&template_request, DG_ALGORITHM_VALUE_NOISE, 40, 28, 424371u);
+    template_request.params.value_noise.feature_size = 7;
+    template_request.params.value_noise.floor_threshold_percent = 72;
+    ASSERT_STATUS(dg_generate(&template_request, &template_map), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_file(&template_map, template_path), DG_STATUS_OK);
+    dg_map_destroy(&template_map);
+    dg_default_generate_request(&template_request, DG_ALGORITHM_ROOMS_AND_MAZES, 41, 29, 424372u);
+    ASSERT_STATUS(dg_generate(&template_request, &template_map), DG_STATUS_OK);
+    ASSERT_STATUS(dg_map_save_file(&template_map, maze_path), DG_STATUS_OK);
+    dg_map_destroy(&template_map);
+
+    /* Sizes 4..10 with step 3 round to buckets 3, 6 and 9; a second step adds its own. */
+    dg_default_template_variant_options(&options);
+    options.min_size = 4;
+    options.max_size = 10;
+    options.step = 3;
+    ASSERT_STATUS(dg_template_cache_prepare_variants(template_path, &options), DG_STATUS_OK);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.variant_count == 9u);
+    options.step = 4;
+    ASSERT_STATUS(dg_template_cache_prepare_variants(template_path, &options), DG_STATUS_OK);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.variant_count == 18u);
+    options.step = 3;
+    ASSERT_STATUS(dg_template_cache_prepare_variants(template_path, &options), DG_STATUS_OK);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.variant_count == 18u);
+    ASSERT_STATUS(
+        dg_template_cache_prepare_variants(maze_path, &options),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+    options.step = 0;
+    ASSERT_STATUS(
+        dg_template_cache_prepare_variants(template_path, &options),
+        DG_STATUS_INVALID_ARGUMENT
+    );
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 88, 48, 424373u);
+    request.params.bsp.min_rooms = 12;
+    request.params.bsp.max_rooms = 12;
+    request.params.bsp.room_min_size = 4;
+    request.params.bsp.room_max_size = 10;
+    dg_default_room_type_definition(&definition, 581u);
+    definition.min_count = 1;
+    (void)snprintf(
+        definition.template_map_path,
+        sizeof(definition.template_map_path),
+        "%s",
+        template_path
+    );
+    request.room_types.definitions = &definition;
+    request.room_types.definition_count = 1u;
+    request.room_types.policy.allow_untyped_rooms = 0;
+    request.room_types.policy.default_type_id = 581u;
+
+    /* Prepared variants are ignored unless the room type asks for them. */
+    ASSERT_STATUS(dg_generate(&request, &per_room), DG_STATUS_OK);
+    dg_template_cache_invalidate(NULL);
+    ASSERT_STATUS(dg_generate(&request, &second), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&per_room, &second));
+    dg_map_destroy(&second);
+
+    /* With a step, rooms stamp fitted variants: repeatable, connected, and not per room. */
+    definition.template_variant_step = 3;
+    definition.template_required_opening_matches = 1;
+    ASSERT_STATUS(dg_generate(&request, &first), DG_STATUS_INVALID_ARGUMENT);
+    definition.template_required_opening_matches = 0;
+    ASSERT_STATUS(dg_generate(&request, &first), DG_STATUS_OK);
+    dg_template_cache_get_stats(&stats);
+    ASSERT_TRUE(stats.variant_count > 0u && stats.variant_count <= 9u);
+    ASSERT_STATUS(dg_generate(&request, &second), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&first, &second));
+    ASSERT_TRUE(!maps_have_same_tiles(&first, &per_room));
+    ASSERT_TRUE(count_wall_tiles_inside_rooms(&first) > 0u);
+    ASSERT_TRUE(room_entrances_are_valid(&first));
+    ASSERT_TRUE(connected_rooms_have_at_least_one_entrance(&first));
+
+    /* The saved config alone reproduces the map, whatever the cache holds. */
+    ASSERT_STATUS(dg_map_save_file(&first, config_path), DG_STATUS_OK);
+    dg_template_cache_invalidate(NULL);
+    dg_map_destroy(&second);
+    ASSERT_STATUS(dg_map_load_file(config_path, &second), DG_STATUS_OK);
+    ASSERT_TRUE(maps_have_same_tiles(&first, &second));
+    ASSERT_TRUE(second.metadata.generation_request.room_types.definitions[0]
+                    .template_variant_step == 3);
+
+    /*
+     * Configs saved before variant steps end without the tagged trailer and
+     * load as per-room. Padded, truncated or untagged trailers are rejected.
+     */
+    ASSERT_STATUS(
+        dg_map_save_config_to_allocated_buffer(&per_room, &config, &config_size),
+        DG_STATUS_OK
+    );
+    trailer_size = 4u + sizeof(int32_t);
+    ASSERT_TRUE(config_size > trailer_size);
+    ASSERT_TRUE(memcmp((unsigned char *)config + config_size - trailer_size, "DGVS", 4u) == 0);
+    ASSERT_STATUS(
+        dg_map_load_config_from_buffer(config, config_size - trailer_size, &legacy),
+        DG_STATUS_OK
+    );
+    ASSERT_TRUE(maps_have_same_tiles(&per_room, &legacy));
+    ASSERT_STATUS(
+        dg_map_load_config_from_buffer(config, config_size - 2u, &rejected),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+    padded = (unsigned char *)calloc(config_size + 4u, 1u);
+    ASSERT_TRUE(padded != NULL);
+    memcpy(padded, config, config_size);
+    dg_buffer_free(config);
+    ASSERT_STATUS(
+        dg_map_load_config_from_buffer(padded, config_size + 4u, &rejected),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+    memset(padded + config_size - trailer_size, 0, trailer_size);
+    ASSERT_STATUS(
+        dg_map_load_config_from_buffer(padded, config_size, &rejected),
+        DG_STATUS_UNSUPPORTED_FORMAT
+    );
+    ASSERT_TRUE(rejected.tiles == NULL);
+    free(padded);
+
+    dg_template_cache_invalidate(NULL);
+    dg_map_destroy(&first);
+    dg_map_destroy(&second);
+    dg_map_destroy(&per_room);
+    dg_map_destroy(&legacy);
+    (void)remove(template_path);
+    (void)remove(maze_path);
+    (void)remove(config_path);
+    return 0;
+}
+
 static int test_room_type_template_respects_process_enabled_toggle(void)
 {
     const char *template_path;
@@ -3983,6 +5218,82 @@ static int test_room_type_strict_minimum_infeasible(void)
     return 0;
 }
 
+static int test_room_type_strict_minimums_use_exact_matching(void)
+{
+    dg_generate_request_t request;
+    dg_map_t map = {0};
+    dg_room_type_definition_t definitions[2];
+    size_t room_count;
+    size_t eligible_count;
+    size_t highest_degree;
+    size_t threshold_degree;
+    size_t i;
+
+    dg_default_generate_request(&request, DG_ALGORITHM_BSP_TREE, 88, 48, 8124u);
+    request.params.bsp.min_rooms = 6;
+    request.params.bsp.max_rooms = 6;
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+
+    /* Type 42 only fits rooms whose degree is at least the second highest. */
+    room_count = map.metadata.room_count;
+    ASSERT_TRUE(map.metadata.room_adjacency_count == room_count);
+    highest_degree = 0;
+    threshold_degree = 0;
+    for (i = 0; i < room_count; ++i) {
+        size_t degree = map.metadata.room_adjacency[i].count;
+
+        if (degree > highest_degree) {
+            threshold_degree = highest_degree;
+            highest_degree = degree;
+        } else if (degree > threshold_degree) {
+            threshold_degree = degree;
+        }
+    }
+    eligible_count = 0;
+    for (i = 0; i < room_count; ++i) {
+        if (map.metadata.room_adjacency[i].count >= threshold_degree) {
+            eligible_count += 1;
+        }
+    }
+    dg_map_destroy(&map);
+    ASSERT_TRUE(room_count >= 3);
+    ASSERT_TRUE(eligible_count >= 2 && eligible_count < room_count);
+
+    /*
+     * Type 41 comes first and greedily takes the best-connected rooms, which
+     * strands type 42; the minimums still fit, so strict mode must succeed.
+     */
+    dg_default_room_type_definition(&definitions[0], 41u);
+    definitions[0].min_count = (int)room_count - 1;
+    definitions[0].preferences.higher_degree_bias = 100;
+    dg_default_room_type_definition(&definitions[1], 42u);
+    definitions[1].min_count = 1;
+    definitions[1].constraints.degree_min = (int)threshold_degree;
+
+    request.room_types.definitions = definitions;
+    request.room_types.definition_count = 2;
+    request.room_types.policy.strict_mode = 1;
+
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+    ASSERT_TRUE(count_rooms_with_type_id(&map, 41u) == room_count - 1);
+    ASSERT_TRUE(count_rooms_with_type_id(&map, 42u) == 1);
+    ASSERT_TRUE(map.metadata.diagnostics.room_type_min_shortfall == 0);
+    dg_map_destroy(&map);
+
+    /* One more type-42 room than can exist: strict fails, best effort names the type. */
+    definitions[0].min_count = 1;
+    definitions[1].min_count = (int)eligible_count + 1;
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_GENERATION_FAILED);
+
+    request.room_types.policy.strict_mode = 0;
+    ASSERT_STATUS(dg_generate(&request, &map), DG_STATUS_OK);
+    ASSERT_TRUE(map.metadata.diagnostics.room_type_min_shortfall == 1);
+    ASSERT_TRUE(map.metadata.diagnostics.room_type_short_type_id == 42u);
+    ASSERT_TRUE(map.metadata.diagnostics.room_type_min_miss_count >= 1);
+    dg_map_destroy(&map);
+    return 0;
+}
+
 static int test_room_type_strict_requires_full_coverage(void)
 {
     dg_generate_request_t request;
@@ -4531,7 +5842,17 @@ int main(void)
         {"map_serialization_roundtrip_value_noise",
          test_map_serialization_roundtrip_value_noise},
         {"map_load_rejects_invalid_magic", test_map_load_rejects_invalid_magic},
+        {"map_config_buffer_roundtrip", test_map_config_buffer_roundtrip},
+        {"map_baked_roundtrip", test_map_baked_roundtrip},
+        {"map_baked_rejects_corruption", test_map_baked_rejects_corruption},
+        {"map_view_native_zero_copy", test_map_view_native_zero_copy},
+        {"map_tile_codec", test_map_tile_codec},
         {"map_export_png_json", test_map_export_png_json},
+        {"map_export_indexed_png", test_map_export_indexed_png},
+        {"map_export_png_pixels_per_tile", test_map_export_png_pixels_per_tile},
+        {"map_export_to_buffers", test_map_export_to_buffers},
+        {"map_export_json_compact_and_omit", test_map_export_json_compact_and_omit},
+        {"map_metadata_binary_export", test_map_metadata_binary_export},
         {"room_type_config_scaffold", test_room_type_config_scaffold},
         {"room_type_assignment_determinism", test_room_type_assignment_determinism},
         {"room_type_assignment_stable_across_post_process",
@@ -4541,6 +5862,9 @@ int main(void)
          test_room_type_template_map_application_with_scale_process},
         {"room_type_untyped_template_map_application",
          test_room_type_untyped_template_map_application},
+        {"room_type_template_cache", test_room_type_template_cache},
+        {"room_type_template_pack", test_room_type_template_pack},
+        {"room_type_template_size_variants", test_room_type_template_size_variants},
         {"room_type_template_respects_process_enabled_toggle",
          test_room_type_template_respects_process_enabled_toggle},
         {"room_type_template_respects_room_entrances",
@@ -4548,6 +5872,8 @@ int main(void)
         {"room_type_assignment_minimums", test_room_type_assignment_minimums},
         {"room_type_strict_minimum_infeasible", test_room_type_strict_minimum_infeasible},
         {"room_type_strict_requires_full_coverage", test_room_type_strict_requires_full_coverage},
+        {"room_type_strict_minimums_use_exact_matching",
+         test_room_type_strict_minimums_use_exact_matching},
         {"invalid_generate_request", test_invalid_generate_request},
         {"bsp_generation_failure_for_tiny_map", test_bsp_generation_failure_for_tiny_map},
     };